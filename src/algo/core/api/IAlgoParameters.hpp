@@ -138,6 +138,12 @@ public:
     /** URI (filepath) of the file where the algorithm results (alignments list). */
     std::string outputfile;
 
+    /** Directory where the subject indexes are saved (and loaded from); empty if indexes are not saved. */
+    std::string indexDirectory;
+
+    /** Tells whether only the subject index has to be built, without running the comparison. */
+    bool indexOnly;
+
     /** List of strands to be used. */
     std::vector<misc::ReadingFrame_e> strands;
 
@@ -113,7 +113,8 @@ AbstractAlgorithm::AbstractAlgorithm (
       _seedsModel(0), _scoreMatrix(0), _globalStats(0), _queryInfo(0),
       _indexator(0), _hitIterator(0), _timeStats(0),
       _ungapAlignmentResult(0), _gapAlignmentResult(0),
-      _isRunning (isRunning)
+      _isRunning (isRunning), _outputStage(0), _isPrepared(false), _prepareError(0),
+      _prepareTimeStats(0), _outputTimeStats(0), _deferredSubjectDb(0), _deferredQueryDb(0)
 {
     /** We use the provided arguments. */
     setConfig            (config);
@@ -126,6 +127,9 @@ AbstractAlgorithm::AbstractAlgorithm (
     setIndexator         (indexator);
     setTimeStats         (timeStats);
 
+    setPrepareTimeStats  (new TimeInfo ());
+    setOutputTimeStats   (new TimeInfo ());
+
 #if 0
     /** We create the seeds model. */
     setSeedsModel (getConfig()->createSeedModel (
@@ -177,6 +181,11 @@ AbstractAlgorithm::~AbstractAlgorithm (void)
     setUngapAlignmentResult (0);
     setGapAlignmentResult   (0);
 
+    setPrepareTimeStats  (0);
+    setOutputTimeStats   (0);
+    setDeferredSubjectDb (0);
+    setDeferredQueryDb   (0);
+
     DEBUG (("AbstractAlgorithm::~AbstractAlgorithm : releasing instances  DONE.\n"));
 }
 
@@ -214,6 +223,9 @@ void AbstractAlgorithm::execute (void)
 
     DEBUG (("AbstractAlgorithm::execute : starting...\n"));
 
+    /** The preparation may have failed in another thread; we report its error here. */
+    if (_prepareError != 0)  {  throw _prepareError;  }
+
     /** We create a command dispatcher used for indexation commands. */
     ICommandDispatcher* indexationDispatcher = getConfig()->createIndexationDispatcher();
     LOCAL (indexationDispatcher);
@@ -222,17 +234,29 @@ void AbstractAlgorithm::execute (void)
     ICommandDispatcher* dispatcher = getConfig()->createDispatcher ();
     LOCAL (dispatcher);
 
-    _timeStats->addEntry (keyRead);
+    if (_isPrepared == false)
+    {
+        _timeStats->addEntry (keyRead);
 
-    /** We create the subject database (more than one for tplastn) and the
-     *  query database   (more than one for plastx) */
-    getDatabasesProvider()->createDatabases (getParams(), getSubjectFrames(), getQueryFrames(), 0, 0);
+        /** We create the subject database (more than one for tplastn) and the
+         *  query database   (more than one for plastx) */
+        getDatabasesProvider()->createDatabases (getParams(), getSubjectFrames(), getQueryFrames(), 0, 0);
+
+        _timeStats->stopEntry (keyRead);
+    }
+    else
+    {
+        /** The databases have already been read (and the first indexes built) by 'prepare'. */
+        _timeStats->merge (*_prepareTimeStats);
+    }
 
     /** We retrieve two iterators for the subject and query databases. */
     Iterator<ISequenceDatabase*>* subjectDbIt = getDatabasesProvider()->getSubjectDbIterator();     LOCAL (subjectDbIt);
     Iterator<ISequenceDatabase*>* queryDbIt   = getDatabasesProvider()->getQueryDbIterator();       LOCAL (queryDbIt);
 
-    _timeStats->stopEntry (keyRead);
+    /** We need the number of databases for knowing which alignments are the last ones (see setOutputStage). */
+    size_t nbQueryDb   = 0;  for (queryDbIt->first();   !queryDbIt->isDone();   queryDbIt->next())    { nbQueryDb++;   }
+    size_t nbSubjectDb = 0;  for (subjectDbIt->first(); !subjectDbIt->isDone(); subjectDbIt->next())  { nbSubjectDb++; }
 
     DEBUG (("AbstractAlgorithm::execute : databases created...\n"));
 
@@ -261,7 +285,8 @@ void AbstractAlgorithm::execute (void)
     /********************************************************************************/
     /**********                     FIRST LOOP ON QUERY PARTS              **********/
     /********************************************************************************/
-    for (queryDbIt->first(); !queryDbIt->isDone(); queryDbIt->next())
+    size_t queryIdx = 0;
+    for (queryDbIt->first(); !queryDbIt->isDone(); queryDbIt->next(), queryIdx++)
     {
         DEBUG (("AbstractAlgorithm::execute : QUERY LOOP...\n"));
 
@@ -294,7 +319,8 @@ void AbstractAlgorithm::execute (void)
         /********************************************************************************/
         /**********                  SECOND LOOP ON SUBJECT PARTS              **********/
         /********************************************************************************/
-        for (subjectDbIt->first(); !subjectDbIt->isDone(); subjectDbIt->next(), postTreatment (queryDbIt, subjectDbIt))
+        size_t subjectIdx = 0;
+        for (subjectDbIt->first(); !subjectDbIt->isDone(); subjectDbIt->next(), subjectIdx++, postTreatment (queryDbIt, subjectDbIt))
         {
             DEBUG (("AbstractAlgorithm::execute : SUBJECT LOOP...\n"));
 
@@ -339,6 +365,13 @@ void AbstractAlgorithm::execute (void)
 
             DEBUG (("AbstractAlgorithm::execute : indexation finished in %d msec...\n", _timeStats->getEntryByKey(keyIndex) ));
 
+            /** In 'index only' mode, we are done once the subject index is built (and saved). */
+            if (_params->indexOnly)
+            {
+                _timeStats->stopEntry (keyAlgorithm);
+                continue;
+            }
+
             /** We create an ungap alignment result. This ungap alignment will be shared betweed different Hit
              * iterators, in particular for filtering out already processed hits.
              * Warning! This instance will have concurrent accesses both for reading and writing, so the implementation
@@ -364,6 +397,22 @@ void AbstractAlgorithm::execute (void)
                 alignmentResult->getFirstLevelNumber()
             ));
 
+            /** The output of the last alignments may be deferred; it is then done by the output stage, possibly
+             *  while the next algorithm is running. Nothing may modify our databases afterwards. */
+            if (_outputStage != 0  &&  queryIdx+1 == nbQueryDb  &&  subjectIdx+1 == nbSubjectDb)
+            {
+                setDeferredSubjectDb (subjectDb);
+                setDeferredQueryDb   (queryDb);
+
+                _timeStats->stopEntry (keyAlgorithm);
+
+                _outputStage->defer (this);
+                continue;
+            }
+
+            /** Previously deferred outputs must be done before ours (and before we modify our databases). */
+            if (_outputStage != 0)  {  _outputStage->wait ();  }
+
             /** We may have specific post treatment on the found alignments (in particular serialization into a file). */
             finalizeAlignments (alignmentResult, _timeStats);
 
@@ -385,10 +434,96 @@ void AbstractAlgorithm::execute (void)
 
         }  /* end of for (subjectDbIt.first(); ... */
 
+        /** The subject indexes don't depend on the query, so one query part is enough in 'index only' mode. */
+        if (_params->indexOnly)  { break; }
+
     }  /* end of for (queryDbIt.first(); ... */
     //printf ("checksum=%ld nbData=%ld\n", checksum,	nbDataSeq);
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AbstractAlgorithm::prepare (ICommandDispatcher* indexationDispatcher)
+{
+    DEBUG (("AbstractAlgorithm::prepare : starting...\n"));
+
+    /** Note that we use our own time statistics since we may run in another thread than 'execute'. */
+    _prepareTimeStats->addEntry (keyRead);
+
+    getDatabasesProvider()->createDatabases (getParams(), getSubjectFrames(), getQueryFrames(), 0, 0);
+
+    Iterator<ISequenceDatabase*>* subjectDbIt = getDatabasesProvider()->getSubjectDbIterator();     LOCAL (subjectDbIt);
+    Iterator<ISequenceDatabase*>* queryDbIt   = getDatabasesProvider()->getQueryDbIterator();       LOCAL (queryDbIt);
+
+    _prepareTimeStats->stopEntry (keyRead);
+
+    /** We build the indexes of the first subject and query parts; 'execute' won't build them again
+     *  since the indexator is given the same databases. */
+    subjectDbIt->first();
+    queryDbIt->first();
+
+    if (!subjectDbIt->isDone() && !queryDbIt->isDone())
+    {
+        _prepareTimeStats->addEntry (keyIndex);
+
+        getIndexator()->setQueryDatabase   (queryDbIt->currentItem());
+        getIndexator()->setSubjectDatabase (subjectDbIt->currentItem());
+        getIndexator()->build (indexationDispatcher);
+
+        _prepareTimeStats->stopEntry (keyIndex);
+    }
+
+    _isPrepared = true;
+
+    DEBUG (("AbstractAlgorithm::prepare : done...\n"));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AbstractAlgorithm::finalizeDeferredAlignments ()
+{
+    if (_gapAlignmentResult != 0)  {  finalizeAlignments (_gapAlignmentResult, _outputTimeStats);  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AbstractAlgorithm::reportDeferredAlignments ()
+{
+    _timeStats->merge (*_outputTimeStats);
+
+    /** We notify some report to potential listeners. */
+    this->notify (new AlgorithmReportEvent (
+        this,
+        _deferredSubjectDb,
+        _deferredQueryDb,
+        _timeStats,
+        _ungapAlignmentResult,
+        _gapAlignmentResult,
+        _filter
+    ) );
+
+    setDeferredSubjectDb (0);
+    setDeferredQueryDb   (0);
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -55,6 +55,32 @@ namespace core {
 namespace impl {
 /********************************************************************************/
 
+class AbstractAlgorithm;
+
+/** \brief Stage receiving the deferred output of algorithms (see AbstractAlgorithm::setOutputStage)
+ *
+ * Such a stage may finalize (ie. filter and dump) the alignments of an algorithm in another
+ * thread, while the next algorithm computes its own alignments. The deferred outputs are done
+ * in the order they are received.
+ */
+class IOutputStage
+{
+public:
+
+    /** Destructor. */
+    virtual ~IOutputStage ()  {}
+
+    /** Finalizes the alignments of the given algorithm (see AbstractAlgorithm::finalizeDeferredAlignments),
+     *  possibly in another thread.
+     * \param[in] algo : the algorithm whose output is deferred. */
+    virtual void defer (AbstractAlgorithm* algo) = 0;
+
+    /** Waits until all the deferred outputs are done. */
+    virtual void wait () = 0;
+};
+
+/********************************************************************************/
+
 /** \brief Default implementation of IAlgorithm
  *
  * This implementation of the IAlgorithm interface provides a execute() method
@@ -117,6 +143,32 @@ public:
      */
     void execute (void);
 
+    /** Reads the subject and query databases and builds the indexes for the first subject and query
+     * parts. This is the first step of 'execute'; calling it beforehand (likely in another thread, see
+     * AlgorithmsPipeline) allows to overlap it with the execution of another algorithm.
+     * \param[in] indexationDispatcher : dispatcher used for the indexation commands.
+     */
+    void prepare (dp::ICommandDispatcher* indexationDispatcher);
+
+    /** Keeps an error that occurred during 'prepare' in another thread; 'execute' will throw it.
+     * \param[in] error : the error message.
+     */
+    void setPrepareError (const char* error)  { _prepareError = error; }
+
+    /** Set a stage that will finalize the alignments of the last subject and query parts, instead
+     * of finalizing them at the end of 'execute'. Other alignments are finalized by 'execute' once
+     * the outputs previously deferred to the stage are done.
+     * \param[in] outputStage : the stage (0 for finalizing everything in 'execute').
+     */
+    void setOutputStage (IOutputStage* outputStage)  { _outputStage = outputStage; }
+
+    /** Finalizes the alignments deferred to the output stage. May be called in another thread.  */
+    void finalizeDeferredAlignments ();
+
+    /** Notifies the report of the deferred alignments; to be called in the thread of 'execute' once
+     * finalizeDeferredAlignments is done. */
+    void reportDeferredAlignments ();
+
     /** \copydoc IAlgorithm::getConfig */
     IConfiguration*                         getConfig           ()  { return _config;           }
 
@@ -276,6 +328,30 @@ protected:
     /**  */
     bool& _isRunning;
 
+    /** Stage receiving the deferred output (if any). */
+    IOutputStage* _outputStage;
+
+    /** Tells whether 'prepare' has been called. */
+    bool _isPrepared;
+
+    /** Error of 'prepare' to be thrown by 'execute' (0 if none). */
+    const char* _prepareError;
+
+    /** Time statistics of 'prepare' and of the deferred output, merged into _timeStats in the
+     *  thread of 'execute'. */
+    os::impl::TimeInfo* _prepareTimeStats;
+    void setPrepareTimeStats (os::impl::TimeInfo* prepareTimeStats)  { SP_SETATTR(prepareTimeStats); }
+
+    os::impl::TimeInfo* _outputTimeStats;
+    void setOutputTimeStats (os::impl::TimeInfo* outputTimeStats)  { SP_SETATTR(outputTimeStats); }
+
+    /** Databases of the deferred alignments. */
+    database::ISequenceDatabase* _deferredSubjectDb;
+    void setDeferredSubjectDb (database::ISequenceDatabase* deferredSubjectDb)  { SP_SETATTR(deferredSubjectDb); }
+
+    database::ISequenceDatabase* _deferredQueryDb;
+    void setDeferredQueryDb (database::ISequenceDatabase* deferredQueryDb)  { SP_SETATTR(deferredQueryDb); }
+
     /** */
     class AlgoTimeInfo : public os::impl::TimeInfo
     {
@@ -15,6 +15,7 @@
  *****************************************************************************/
 
 #include <algo/core/impl/AlgoIndexatorNucleotide.hpp>
+#include <algo/core/impl/IterativeResources.hpp>
 
 #include <designpattern/impl/Property.hpp>
 #include <designpattern/impl/CommandDispatcher.hpp>
@@ -62,7 +63,8 @@ IndexatorNucleotide::IndexatorNucleotide (
       _subjectDatabase(0),  _queryDatabase(0),
       _subjectIndex(0),     _queryIndex(0),
       _seedsUseRatio (seedsUseRatio),
-      _isRunning (isRunning), _sbjHasChanged(true), _qryHasChanged(true)
+      _isRunning (isRunning), _sbjHasChanged(true), _qryHasChanged(true),
+      _sbjIndexDirection(ISequenceDatabase::PLUS)
 {
     /** We use some resources. */
     setModel   (model);
@@ -101,7 +103,7 @@ IndexatorNucleotide::~IndexatorNucleotide ()
 *********************************************************************/
 void IndexatorNucleotide::setSubjectDatabase (ISequenceDatabase* subjectDatabase)
 {
-    _sbjHasChanged =  (_subjectDatabase==0) || (_subjectDatabase && subjectDatabase && _subjectDatabase->getId() != subjectDatabase->getId());
+    _sbjHasChanged =  _sbjHasChanged || (_subjectDatabase != subjectDatabase) || (_subjectDatabase && subjectDatabase && _subjectDatabase->getId() != subjectDatabase->getId());
 
     SP_SETATTR (subjectDatabase);
 
@@ -118,7 +120,7 @@ void IndexatorNucleotide::setSubjectDatabase (ISequenceDatabase* subjectDatabase
 *********************************************************************/
 void IndexatorNucleotide::setQueryDatabase (ISequenceDatabase* queryDatabase)
 {
-    _qryHasChanged = (_queryDatabase==0) || (_queryDatabase && queryDatabase && _queryDatabase->getId() != queryDatabase->getId());
+    _qryHasChanged = _qryHasChanged || (_queryDatabase != queryDatabase) || (_queryDatabase && queryDatabase && _queryDatabase->getId() != queryDatabase->getId());
 
     SP_SETATTR (queryDatabase);
 
@@ -139,6 +141,10 @@ void IndexatorNucleotide::build (dp::ICommandDispatcher* dispatcher)
     {
         DEBUG (("IndexatorNucleotide::build:  (qry=%ld  sbj=%ld) \n",  _queryDatabase->getSize(),_subjectDatabase->getSize() ));
 
+        /** The indexes may have already been built for the same databases and subject strand
+         *  (see AbstractAlgorithm::prepare). */
+        if (!_qryHasChanged && !_sbjHasChanged && _subjectIndex != 0 && _sbjIndexDirection == _subjectDatabase->getDirection())  { return; }
+
         if (_qryHasChanged)  {  setQueryIndex(0);  setSubjectIndex(0);    _qryHasChanged=false; }
 
         if (_params->kmersPerSequence != 0)
@@ -158,6 +164,9 @@ void IndexatorNucleotide::build (dp::ICommandDispatcher* dispatcher)
             buildIndex (_queryIndex ,  _queryDatabase,   _model, dispatcher, 0);
             buildIndex (_subjectIndex, _subjectDatabase, _model, dispatcher, _queryIndex);
         }
+
+        _sbjHasChanged     = false;
+        _sbjIndexDirection = _subjectDatabase->getDirection();
     }
 }
 
@@ -227,6 +236,67 @@ IProperties* IndexatorNucleotide::getProperties ()
     return props;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+IndexatorNucleotideIterative::IndexatorNucleotideIterative (
+    ISeedModel* model,
+    algo::core::IParameters* params,
+    indexation::IDatabaseIndexFactory* factory,
+    float seedsUseRatio,
+    bool& isRunning,
+    IterativeResources& resources
+)
+    : IndexatorNucleotide (model, params, factory, seedsUseRatio, isRunning), _resources (resources)
+{
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void IndexatorNucleotideIterative::build (dp::ICommandDispatcher* dispatcher)
+{
+    if (_queryDatabase && _subjectDatabase)
+    {
+        DEBUG (("IndexatorNucleotideIterative::build:  (qry=%ld  sbj=%ld) \n",  _queryDatabase->getSize(),_subjectDatabase->getSize() ));
+
+        /** The query database doesn't change between the two strands, so its index is built only once. */
+        if (_qryHasChanged)
+        {
+            setQueryIndex (0);
+            _qryHasChanged = false;
+
+            if (_params->kmersPerSequence != 0)
+            {
+                FakeDatabaseNucleotideIndex indexforMask(_subjectDatabase,
+                        _model,
+                        _params->subjectUri,
+                        _params->queryUri,
+                        _params->kmersPerSequence);
+                indexforMask.build();
+                buildIndex (_queryIndex, _queryDatabase, _model, dispatcher, &indexforMask);
+            }
+            else
+            {
+                buildIndex (_queryIndex, _queryDatabase, _model, dispatcher, 0);
+            }
+        }
+
+        /** The subject index is shared by the steps. */
+        setSubjectIndex (_resources.getSubjectIndex (_subjectDatabase, _model, _factory, dispatcher, _params));
+    }
+}
+
 /********************************************************************************/
 }}} /* end of namespaces. */
 /********************************************************************************/
@@ -133,6 +133,9 @@ protected:
     bool _sbjHasChanged;
     bool _qryHasChanged;
 
+    /** Strand of the subject database when its index was built. */
+    database::ISequenceDatabase::StrandId_e _sbjIndexDirection;
+
     /** */
     float _seedsUseRatio;
 
@@ -153,6 +156,42 @@ protected:
     );
 };
 
+/********************************************************************************/
+
+class IterativeResources;
+
+/** \brief Indexator for the steps of an iterative plastn.
+ *
+ * The query index is built once per step (the two strands share it) with the
+ * seeds mask of the step. The subject index is retrieved from the resources shared
+ * by all the steps (see IterativeResources), so it is built only once per strand.
+ */
+class IndexatorNucleotideIterative : public IndexatorNucleotide
+{
+public:
+
+    /** Constructor.
+     * \param[in] model : the seed model to be used for indexation
+     * \param[in] params : holds parameters for customization
+     * \param[in] resources : resources shared by the steps
+     * */
+    IndexatorNucleotideIterative (
+        seed::ISeedModel* model,
+        algo::core::IParameters* params,
+        indexation::IDatabaseIndexFactory* factory,
+        float seedsUseRatio,
+        bool& isRunning,
+        IterativeResources& resources
+    );
+
+    /** \copydoc IIndexator::build */
+    void build (dp::ICommandDispatcher* dispatcher);
+
+private:
+
+    IterativeResources& _resources;
+};
+
 /********************************************************************************/
 }}} /* end of namespaces. */
 /********************************************************************************/
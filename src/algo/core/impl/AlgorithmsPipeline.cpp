@@ -0,0 +1,204 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+#include <algo/core/impl/AlgorithmsPipeline.hpp>
+
+#include <designpattern/impl/CommandDispatcher.hpp>
+
+#include <os/impl/DefaultOsFactory.hpp>
+
+#include <stdio.h>
+#define DEBUG(a)  //printf a
+
+using namespace dp;
+using namespace dp::impl;
+using namespace os;
+using namespace os::impl;
+
+/********************************************************************************/
+namespace algo {
+namespace core {
+namespace impl {
+/********************************************************************************/
+
+/** Command that reads the databases of an algorithm and builds its first indexes. */
+class PrepareCommand : public ICommand
+{
+public:
+    PrepareCommand (AbstractAlgorithm* algo, ICommandDispatcher* dispatcher)
+        : _algo(algo), _dispatcher(dispatcher)  {  _algo->use();  }
+    virtual ~PrepareCommand ()  {  _algo->forget();  }
+
+    void execute ()
+    {
+        /** An error can't be reported from this thread; it is kept by the algorithm, whose
+         *  'execute' method will throw it in the thread of the algorithms. */
+        try  {  _algo->prepare (_dispatcher);  }
+        catch (const char* error)  {  _algo->setPrepareError (error);  }
+        catch (...)                {  _algo->setPrepareError ("error during the reading of the databases");  }
+    }
+
+private:
+    AbstractAlgorithm*  _algo;
+    ICommandDispatcher* _dispatcher;
+};
+
+/** Command that finalizes the deferred alignments of an algorithm. */
+class OutputCommand : public ICommand
+{
+public:
+    OutputCommand (AbstractAlgorithm* algo)  : _algo(algo)  {  _algo->use();  }
+    virtual ~OutputCommand ()  {  _algo->forget();  }
+
+    void execute ()  {  _algo->finalizeDeferredAlignments ();  }
+
+private:
+    AbstractAlgorithm* _algo;
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+AlgorithmsPipeline::AlgorithmsPipeline (ICommandDispatcher* indexationDispatcher)
+    : _indexationDispatcher(0), _prepareInvoker(0), _outputInvoker(0), _outputAlgo(0)
+{
+    setIndexationDispatcher (indexationDispatcher);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+AlgorithmsPipeline::~AlgorithmsPipeline ()
+{
+    waitPrepare ();
+    wait ();
+
+    setIndexationDispatcher (0);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AlgorithmsPipeline::prepare (IAlgorithm* algo)
+{
+    waitPrepare ();
+
+    /** Only our own algorithms can be prepared; the other ones will do everything in 'execute'. */
+    AbstractAlgorithm* abstractAlgo = dynamic_cast<AbstractAlgorithm*> (algo);
+    if (abstractAlgo == 0)  { return; }
+
+    DEBUG (("AlgorithmsPipeline::prepare : algo=%p\n", algo));
+
+    _prepareInvoker = new DefaultCommandInvoker (& DefaultFactory::thread());
+    _prepareInvoker->use ();
+    _prepareInvoker->executeCommand (new PrepareCommand (abstractAlgo, _indexationDispatcher));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AlgorithmsPipeline::waitPrepare ()
+{
+    if (_prepareInvoker != 0)
+    {
+        _prepareInvoker->join   ();
+        _prepareInvoker->forget ();
+        _prepareInvoker = 0;
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AlgorithmsPipeline::waitOutput (IAlgorithm* algo)
+{
+    if (algo != 0  &&  algo == _outputAlgo)  {  wait ();  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AlgorithmsPipeline::defer (AbstractAlgorithm* algo)
+{
+    /** The outputs are done one after the other, in the order of the algorithms. */
+    wait ();
+
+    DEBUG (("AlgorithmsPipeline::defer : algo=%p\n", algo));
+
+    _outputAlgo = algo;
+    _outputAlgo->use ();
+
+    _outputInvoker = new DefaultCommandInvoker (& DefaultFactory::thread());
+    _outputInvoker->use ();
+    _outputInvoker->executeCommand (new OutputCommand (algo));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AlgorithmsPipeline::wait ()
+{
+    if (_outputInvoker != 0)
+    {
+        _outputInvoker->join   ();
+        _outputInvoker->forget ();
+        _outputInvoker = 0;
+
+        /** We are back in the thread of the algorithms, so the report can be notified. */
+        _outputAlgo->reportDeferredAlignments ();
+        _outputAlgo->forget ();
+        _outputAlgo = 0;
+    }
+}
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,102 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+/** \file AlgorithmsPipeline.hpp
+ *  \brief Overlapping of the reading, alignment and output steps of successive algorithms.
+ */
+
+#ifndef _ALGORITHMS_PIPELINE_HPP_
+#define _ALGORITHMS_PIPELINE_HPP_
+
+/********************************************************************************/
+
+#include <algo/core/impl/AbstractAlgorithm.hpp>
+
+#include <designpattern/api/ICommand.hpp>
+
+/********************************************************************************/
+namespace algo {
+namespace core {
+/** \brief Implementation of concepts for configuring and running PLAST. */
+namespace impl {
+/********************************************************************************/
+
+/** \brief Scheduler overlapping the steps of successive algorithms
+ *
+ * When the databases are segmented (see -max-database-size), one algorithm is executed per
+ * (subject block, query block) couple. Each algorithm reads its databases and builds its indexes,
+ * computes its alignments and dumps them; only the alignments computation uses all the cores.
+ *
+ * This class allows to overlap these steps: while the main thread computes the alignments of
+ * block N, the databases of block N+1 are read and indexed (see AbstractAlgorithm::prepare) in
+ * a second thread, and the alignments of block N-1 are dumped in a third thread (this class is
+ * the IOutputStage of the algorithms). The outputs are done in the order of the algorithms.
+ *
+ * The pipeline doesn't decide how many blocks are in flight; this is the job of the client, who
+ * should provide distinct databases providers and indexators to the algorithms in flight, and
+ * should wait for the output of an algorithm (see waitOutput) before reusing its resources.
+ *
+ * All methods are to be called from the same thread (the one executing the algorithms).
+ */
+class AlgorithmsPipeline : public IOutputStage
+{
+public:
+
+    /** Constructor.
+     * \param[in] indexationDispatcher : dispatcher used for the indexation of the prepared algorithms.
+     */
+    AlgorithmsPipeline (dp::ICommandDispatcher* indexationDispatcher);
+
+    /** Destructor. Waits for the running steps. */
+    virtual ~AlgorithmsPipeline ();
+
+    /** Prepares the given algorithm in the reading thread. The previous preparation must be done (see waitPrepare).
+     * \param[in] algo : the algorithm to be prepared.
+     */
+    void prepare (IAlgorithm* algo);
+
+    /** Waits until the current preparation is done. */
+    void waitPrepare ();
+
+    /** Waits until the output of the given algorithm is done, if it is the running one.
+     * \param[in] algo : the algorithm.
+     */
+    void waitOutput (IAlgorithm* algo);
+
+    /** \copydoc IOutputStage::defer */
+    void defer (AbstractAlgorithm* algo);
+
+    /** \copydoc IOutputStage::wait */
+    void wait ();
+
+private:
+
+    dp::ICommandDispatcher* _indexationDispatcher;
+    void setIndexationDispatcher (dp::ICommandDispatcher* indexationDispatcher)  { SP_SETATTR(indexationDispatcher); }
+
+    /** Invoker running the current preparation (if any). */
+    dp::ICommandInvoker* _prepareInvoker;
+
+    /** Invoker running the current output (if any), and the concerned algorithm. */
+    dp::ICommandInvoker* _outputInvoker;
+    AbstractAlgorithm*   _outputAlgo;
+};
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _ALGORITHMS_PIPELINE_HPP_ */
@@ -180,8 +180,61 @@ void BasicIndexator::setQueryDatabase (ISequenceDatabase* db)
 *********************************************************************/
 void BasicIndexator::build (dp::ICommandDispatcher* dispatcher)
 {
-    if (_queryIndex == 0)    {  _queryIndex  = buildIndex (_queryDatabase,   _model, dispatcher, 0); }
-    if (_subjectIndex == 0)  { _subjectIndex = buildIndex (_subjectDatabase, _model, dispatcher, _queryIndex); }
+    /** In 'index only' mode, we don't need the query index. */
+    if (_queryIndex == 0 && _params->indexOnly == false)  {  _queryIndex  = buildIndex (_queryDatabase, _model, dispatcher, 0); }
+
+    if (_subjectIndex == 0)
+    {
+        /** The subject index may be saved in (and loaded from) the index directory. */
+        if (_params->indexDirectory.empty() == false)  { _subjectIndex = buildPersistentIndex (_subjectDatabase, _model, dispatcher, _queryIndex); }
+        else                                           { _subjectIndex = buildIndex           (_subjectDatabase, _model, dispatcher, _queryIndex); }
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the file name is the signature of the index, so an index file
+**           is reused for any execution having the same database and
+**           the same seed model.
+*********************************************************************/
+IDatabaseIndex* BasicIndexator::buildPersistentIndex (ISequenceDatabase* database, ISeedModel* model, ICommandDispatcher* dispatcher, IDatabaseIndex* otherIndex)
+{
+    /** We create the index and use it. */
+    IDatabaseIndex* index = _factory->newDatabaseIndex (database, model, otherIndex, dispatcher);
+    index->use ();
+
+    /** Only DatabaseIndex instances can be saved. */
+    DatabaseIndex* persistentIndex = dynamic_cast<DatabaseIndex*> (index);
+    if (persistentIndex == 0)
+    {
+        index->forget ();
+        return buildIndex (database, model, dispatcher, otherIndex);
+    }
+
+    /** The signature reads the whole database, so we compute it only once. */
+    u_int64_t signature = persistentIndex->getSignature();
+
+    char filename[64];
+    snprintf (filename, sizeof(filename), "%016llx.pidx", (long long unsigned) signature);
+    string uri = _params->indexDirectory + "/" + filename;
+
+    /** We try to load an index saved by a previous execution. */
+    if (persistentIndex->load (uri, signature) == true)
+    {
+        DEBUG (("BasicIndexator::buildPersistentIndex: loaded '%s'\n", uri.c_str()));
+        return index;
+    }
+
+    /** We build the same index (as buildIndex does for DatabaseIndex) and save it for next executions.
+     *  We don't fail if the index can't be saved (unknown or read-only directory for instance). */
+    persistentIndex->build (dispatcher);
+    persistentIndex->save (uri, signature);
+
+    return index;
 }
 
 /*********************************************************************
@@ -202,9 +255,16 @@ IDatabaseIndex* BasicIndexator::buildIndex (ISequenceDatabase* database, ISeedMo
     size_t nbSplits = dispatcher->getExecutionUnitsNumber();
     DEBUG (("BasicIndexator::buildIndex:  nbSplits=%ld \n", nbSplits));
 
-    /** Note that we distingish two cases for optimization concerns. */
+    /** Note that we distingish three cases for optimization concerns. */
 
-    if (nbSplits > 1)
+    DatabaseIndex* csrIndex = dynamic_cast<DatabaseIndex*> (index);
+
+    if (csrIndex != 0)
+    {
+        /** The index splits the database itself and builds its tables in parallel; no merge needed. */
+        csrIndex->build (dispatcher);
+    }
+    else if (nbSplits > 1)
     {
         /** We try to split the base in several smaller ones. */
         vector<ISequenceDatabase*> splits = database->split (nbSplits);
@@ -276,7 +336,7 @@ IProperties* BasicIndexator::getProperties ()
     props->add (0, "indexes");
 
     props->add (1, getSubjectIndex()->getProperties("subject"));
-    props->add (1, getQueryIndex()->getProperties  ("query"));
+    if (getQueryIndex() != 0)  {  props->add (1, getQueryIndex()->getProperties  ("query"));  }
 
     return props;
 }
@@ -144,6 +144,19 @@ protected:
         dp::ICommandDispatcher*      dispatcher,
         indexation::IDatabaseIndex*  otherIndex
     );
+
+    /** Build an index for the some database, or load it if it has been saved by a previous execution
+     * in the index directory (see IParameters::indexDirectory). A built index is saved in this directory.
+     * \param[in] database : the database to be indexed
+     * \param[in] model : the seed model used for the indexation
+     * \param[in] dispatcher : command dispatcher for running the indexation.
+     */
+    indexation::IDatabaseIndex* buildPersistentIndex (
+        database::ISequenceDatabase* database,
+        seed::ISeedModel*            model,
+        dp::ICommandDispatcher*      dispatcher,
+        indexation::IDatabaseIndex*  otherIndex
+    );
 };
 
 /********************************************************************************/
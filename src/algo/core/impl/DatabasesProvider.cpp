@@ -17,6 +17,7 @@
 #include <algo/core/api/IAlgoConfig.hpp>
 #include <algo/core/api/IAlgoParameters.hpp>
 #include <algo/core/impl/DatabasesProvider.hpp>
+#include <algo/core/impl/IterativeResources.hpp>
 
 #include <designpattern/api/ICommand.hpp>
 #include <designpattern/impl/CommandDispatcher.hpp>
@@ -173,9 +174,15 @@ void DatabasesProvider::createDatabaseList (
         list<ISequenceDatabase*> framedList;
         readReadingFrameDatabases (frames, db, filtering, framedList);
 
-        /** We could improve this by reading only once the nucleotid databases and generating 6 reading frames
-         *  from this single reading. */
+        /** We build the reading frames by reading only once each strand of the nucleotid database. */
+        ReadingFrameSequenceDatabase::buildCaches (framedList);
+
         dbList.push_back (new CompositeSequenceDatabase (framedList));
+
+        /** Once the reading frames are built, the nucleotid database is only used for retrieving a few
+         *  sequences (for converting alignments into nucleotid coordinates), so we can pack its residues. */
+        BufferedSequenceDatabase* nucleotidDb = dynamic_cast<BufferedSequenceDatabase*> (db);
+        if (nucleotidDb != 0)  {  nucleotidDb->pack ();  }
     }
     else
     {
@@ -437,6 +444,44 @@ void DatabasesProviderReverse::createDatabases (
     DatabasesProvider::createDatabases(params, sbjFrames, qryFrames, sbjFactory, qryFactory);
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void DatabasesProviderIterative::createDatabases (
+        algo::core::IParameters* params,
+        const std::vector<misc::ReadingFrame_e>& sbjFrames,
+        const std::vector<misc::ReadingFrame_e>& qryFrames,
+        database::ISequenceIteratorFactory* sbjFactory,
+        database::ISequenceIteratorFactory* qryFactory)
+{
+    /** We first release potential resources. */
+    clearDatabaseList (_sbjDbList);
+    clearDatabaseList (_qryDbList);
+
+    /** The subject database is shared by the steps; as for DatabasesProviderReverse, the same
+     *  database is used for the two strands. */
+    ISequenceDatabase* sbjDb = _resources.getSubjectDatabase (this, params);
+    _sbjDbList.push_back (sbjDb);
+    if (sbjFrames.size() >= 2)  {  _sbjDbList.push_back (sbjDb); }
+
+    /** The query database is a view of the shared one, without the queries found by the previous steps. */
+    ISequenceDatabase* qryDb = new CachedSubDatabase (_resources.getQueryDatabase (params), params->querySequencesBlacklist);
+    _qryDbList.push_back (qryDb);
+    if (qryFrames.size() >= 2)  {  _qryDbList.push_back (qryDb); }
+
+    /** We use the databases of the lists. */
+    for (list<ISequenceDatabase*>::iterator it = _sbjDbList.begin();  it != _sbjDbList.end(); it++)  {  (*it)->use();  }
+    for (list<ISequenceDatabase*>::iterator it = _qryDbList.begin();  it != _qryDbList.end(); it++)  {  (*it)->use();  }
+
+    /** We keep the provided params. */
+    setCurrentParams (params);
+}
+
 /********************************************************************************/
 }}} /* end of namespaces. */
 /********************************************************************************/
@@ -246,6 +246,42 @@ private:
     );
 };
 
+/********************************************************************************/
+
+class IterativeResources;
+
+/** \brief Databases provider for the steps of an iterative plastn.
+ *
+ * The subject database and the query database are not read for each step but
+ * retrieved from resources shared by all the steps (see IterativeResources). The
+ * query database of a step is a view of the shared one, without the queries of
+ * the parameters blacklist.
+ */
+class DatabasesProviderIterative : public DatabasesProvider
+{
+public:
+
+    /** Constructor. */
+    DatabasesProviderIterative (algo::core::IConfiguration* config, IterativeResources& resources)
+        : DatabasesProvider(config), _resources(resources)  {}
+
+    /** Destructor. */
+    virtual ~DatabasesProviderIterative ()  { }
+
+    /** \copydoc DatabasesProvider::createDatabases */
+    virtual void createDatabases (
+        algo::core::IParameters* params,
+        const std::vector<misc::ReadingFrame_e>&    sbjFrames,
+        const std::vector<misc::ReadingFrame_e>&    qryFrames,
+        database::ISequenceIteratorFactory*         sbjFactory,
+        database::ISequenceIteratorFactory*         qryFactory
+    );
+
+private:
+
+    IterativeResources& _resources;
+};
+
 /********************************************************************************/
 }}} /* end of namespaces. */
 /********************************************************************************/
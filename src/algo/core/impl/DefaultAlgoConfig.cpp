@@ -43,22 +43,29 @@
 #include <algo/hits/ungap/UngapHitIterator.hpp>
 #include <algo/hits/ungap/UngapHitIteratorSSE8.hpp>
 #include <algo/hits/ungap/UngapHitIteratorSSE16.hpp>
+#include <algo/hits/ungap/UngapHitIteratorAVX2.hpp>
+#include <algo/hits/ungap/UngapHitIteratorAVX512.hpp>
 #include <algo/hits/ungap/UngapHitIteratorNull.hpp>
 #include <algo/hits/ungap/UngapExtendHitIterator.hpp>
 
 #include <algo/hits/gap/SmallGapHitIterator.hpp>
 #include <algo/hits/gap/SmallGapHitIteratorSSE8.hpp>
+#include <algo/hits/gap/SmallGapHitIteratorAVX2.hpp>
+#include <algo/hits/gap/SmallGapHitIteratorAVX512.hpp>
 #include <algo/hits/gap/SmallGapHitIteratorNull.hpp>
 #include <algo/hits/gap/FullGapHitIterator.hpp>
 #include <algo/hits/gap/CompositionHitIterator.hpp>
 
 #include <alignment/core/impl/BasicAlignmentContainer.hpp>
+#include <alignment/core/impl/FlatAlignmentContainer.hpp>
 #include <alignment/core/impl/NullAlignmentContainer.hpp>
+#include <alignment/core/impl/UngapAlignmentContainerLockFree.hpp>
 
 #include <alignment/tools/impl/AlignmentSplitter.hpp>
 #include <alignment/tools/impl/AlignmentSplitterBanded.hpp>
 
 #include <alignment/tools/impl/SemiGappedAlign.hpp>
+#include <alignment/tools/impl/SemiGappedAlignAVX2.hpp>
 #include <alignment/tools/impl/SemiGappedAlignTraceback.hpp>
 
 #include <alignment/visitors/impl/OstreamVisitor.hpp>
@@ -120,7 +127,7 @@ namespace impl {
 ** REMARKS :
 *********************************************************************/
 DefaultConfiguration::DefaultConfiguration (IEnvironment* environment, IProperties* properties)
-    : _environment(environment), _properties(0)
+    : _environment(environment), _properties(0), _threadPool(0)
 {
     /** We may have to create empty properties if no one is provided. */
     if (properties == 0)  {  properties = new Properties(); }
@@ -139,6 +146,7 @@ DefaultConfiguration::DefaultConfiguration (IEnvironment* environment, IProperti
 DefaultConfiguration::~DefaultConfiguration ()
 {
     setProperties (0);
+    setThreadPool (0);
 }
 
 /*********************************************************************
@@ -159,11 +167,15 @@ database::IDatabaseQuickReader* DefaultConfiguration::createDefaultQuickReader (
 		if ((databaseType==DatabaseLookupType::ENUM_BLAST_PIN)||(databaseType==DatabaseLookupType::ENUM_BLAST_NIN)
 				||(databaseType==DatabaseLookupType::ENUM_BLAST_PAL)||(databaseType==DatabaseLookupType::ENUM_BLAST_NAL))
 			return new BlastdbDatabaseQuickReader (uri, shouldInferType);
-		else
-			return new FastaDatabaseQuickReader (uri, shouldInferType);
 	}
-	else
-		return new FastaDatabaseQuickReader (uri, shouldInferType);
+
+	FastaDatabaseQuickReader* reader = new FastaDatabaseQuickReader (uri, shouldInferType);
+
+	/** The file is parsed with the number of threads wanted by the user (number of cores otherwise). */
+	IProperty* propNbProcessors = _properties->getProperty (STR_OPTION_NB_PROCESSORS);
+	if (propNbProcessors != 0)  {  reader->setNbThreads (propNbProcessors->getInt());  }
+
+	return reader;
 }
 
 /*********************************************************************
@@ -311,6 +323,10 @@ IParameters* DefaultConfiguration::createDefaultParameters (const std::string& a
     params->nbAlignPerHit = (prop = _properties->getProperty (STR_OPTION_MAX_HSP_PER_HIT))   != 0 ?  prop->getInt() : 0;
     params->nbHitPerQuery = (prop = _properties->getProperty (STR_OPTION_MAX_HIT_PER_QUERY)) != 0 ?  prop->getInt() : 500;
 
+    /** We may want to save the subject indexes, or to only build them. */
+    params->indexDirectory = (prop = _properties->getProperty (STR_OPTION_INDEX_DIRECTORY)) != 0 ?  prop->getValue() : "";
+    params->indexOnly      = _properties->getProperty (STR_OPTION_INDEX_ONLY) != 0;
+
     return params;
 }
 
@@ -349,6 +365,12 @@ ICommandDispatcher* DefaultConfiguration::createDispatcher ()
     {
         result = new ParallelCommandDispatcher (nbProc);
     }
+    else if (prop && prop->value.compare(STR_CONFIG_CLASS_ThreadPoolCommandDispatcher)==0)
+    {
+        /** The pool is created once and then shared by all the dispatching clients. */
+        if (_threadPool == 0)  {  setThreadPool (new ThreadPoolCommandDispatcher (nbProc));  }
+        result = _threadPool;
+    }
     else
     {
         result = new ParallelCommandDispatcher (nbProc);
@@ -643,9 +665,29 @@ IHitIterator* DefaultConfiguration::createUngapHitIterator (
     {
         result = new UngapHitIteratorSSE16 (source, model, matrix, params, actualUngapResult, maxHitsPerIter, isRunning);
     }
+    else if (prop && prop->value.compare(STR_CONFIG_CLASS_UngapHitIteratorAVX2)==0  &&  UngapHitIteratorAVX2::isSupported())
+    {
+        result = new UngapHitIteratorAVX2 (source, model, matrix, params, actualUngapResult, maxHitsPerIter, isRunning);
+    }
+    else if (prop && prop->value.compare(STR_CONFIG_CLASS_UngapHitIteratorAVX512)==0  &&  UngapHitIteratorAVX512::isSupported())
+    {
+        result = new UngapHitIteratorAVX512 (source, model, matrix, params, actualUngapResult, maxHitsPerIter, isRunning);
+    }
     else
     {
-        result = new UngapHitIteratorSSE16 (source, model, matrix, params, actualUngapResult, maxHitsPerIter, isRunning);
+        /** By default, we use the widest SIMD implementation supported by the running CPU. */
+        if (UngapHitIteratorAVX512::isSupported())
+        {
+            result = new UngapHitIteratorAVX512 (source, model, matrix, params, actualUngapResult, maxHitsPerIter, isRunning);
+        }
+        else if (UngapHitIteratorAVX2::isSupported())
+        {
+            result = new UngapHitIteratorAVX2 (source, model, matrix, params, actualUngapResult, maxHitsPerIter, isRunning);
+        }
+        else
+        {
+            result = new UngapHitIteratorSSE16 (source, model, matrix, params, actualUngapResult, maxHitsPerIter, isRunning);
+        }
     }
 
     return result;
@@ -695,6 +737,9 @@ IHitIterator* DefaultConfiguration::createSmallGapHitIterator (
 {
     IHitIterator* result = 0;
 
+    /** Number of hits the source iterator should forward at a time (0 for keeping its default). */
+    size_t hitsBatchSize = 0;
+
     /** We retrieve the property. */
     IProperty* prop = _properties->getProperty (STR_OPTION_FACTORY_HIT_SMALLGAP);
 
@@ -710,11 +755,32 @@ IHitIterator* DefaultConfiguration::createSmallGapHitIterator (
     {
         result = new SmallGapHitIteratorSSE8 (source, model, matrix, params, ungapResult, alignmentResult);
     }
+    else if (prop && prop->value.compare(STR_CONFIG_CLASS_SmallGapHitIteratorAVX2)==0  &&  SmallGapHitIteratorAVX2::isSupported())
+    {
+        result = new SmallGapHitIteratorAVX2 (source, model, matrix, params, ungapResult, alignmentResult);
+        hitsBatchSize = SmallGapHitIteratorAVX2::NB / 2;
+    }
+    else if (prop && prop->value.compare(STR_CONFIG_CLASS_SmallGapHitIteratorAVX512)==0  &&  SmallGapHitIteratorAVX512::isSupported())
+    {
+        result = new SmallGapHitIteratorAVX512 (source, model, matrix, params, ungapResult, alignmentResult);
+        hitsBatchSize = SmallGapHitIteratorAVX512::NB / 2;
+    }
     else
     {
+        /** By default, we use the SSE implementation. The wide ones have to be asked explicitly: they need
+         *  bigger hits batches, which changes the moments where the ungap redundancy check sees the alignments
+         *  found by the next stages, so the results would depend on the CPU running the comparison. */
         result = new SmallGapHitIteratorSSE8 (source, model, matrix, params, ungapResult, alignmentResult);
     }
 
+    /** A wide small gap kernel needs one left and one right score per hit for each of its lanes,
+     *  so we ask the ungap iterator (if it is a SIMD one) to forward its hits by bigger batches. */
+    if (hitsBatchSize > 0)
+    {
+        UngapHitIteratorSSE16* ungapIterator = dynamic_cast<UngapHitIteratorSSE16*> (source);
+        if (ungapIterator != 0)  {  ungapIterator->setHitsBatchSize (hitsBatchSize);  }
+    }
+
     return result;
 }
 
@@ -870,16 +936,21 @@ IAlignmentContainer* DefaultConfiguration::createGapAlignmentResult  ()
 {
     IAlignmentContainer* result = 0;
 
-    /** We retrieve the property. */
+    /** We retrieve the property. Note that 'prop' is reused below, so we keep the factory name. */
     IProperty* prop = _properties->getProperty (STR_OPTION_FACTORY_GAP_RESULT);
+    string factoryName = prop ? prop->value : "";
 
     size_t nbHitPerQuery = (prop = _properties->getProperty (STR_OPTION_MAX_HIT_PER_QUERY)) != 0 ?  prop->getInt() : 500;
     size_t nbAlignPerHit = (prop = _properties->getProperty (STR_OPTION_MAX_HSP_PER_HIT))   != 0 ?  prop->getInt() : 0;
 
-    if (prop && prop->value.compare(STR_CONFIG_CLASS_BasicAlignmentResult)==0)
+    if (factoryName.compare(STR_CONFIG_CLASS_BasicAlignmentResult)==0)
     {
         result = new BasicAlignmentContainer (nbHitPerQuery, nbAlignPerHit);
     }
+    else if (factoryName.compare(STR_CONFIG_CLASS_FlatAlignmentResult)==0)
+    {
+        result = new FlatAlignmentContainer (nbHitPerQuery, nbAlignPerHit);
+    }
     else
     {
         result = new BasicAlignmentContainer (nbHitPerQuery, nbAlignPerHit);
@@ -907,9 +978,13 @@ IAlignmentContainer* DefaultConfiguration::createUnapAlignmentResult (size_t que
     {
         result = new UngapAlignmentResult (querySize);
     }
+    else if (prop && prop->value.compare(STR_CONFIG_CLASS_UngapAlignmentResultLockFree)==0)
+    {
+        result = new UngapAlignmentResultLockFree (querySize);
+    }
     else
     {
-        result = new UngapAlignmentResult (querySize);
+        result = new UngapAlignmentResultLockFree (querySize);
     }
 
     return result;
@@ -960,7 +1035,17 @@ alignment::tools::ISemiGapAlign* DefaultConfiguration::createSemiGapAlign (
     int Xdropoff
 )
 {
-    return new SemiGapAlign (scoreMatrix, openGapCost, extendGapCost, Xdropoff);
+    IProperty* prop = _properties->getProperty (STR_OPTION_FACTORY_SEMIGAP_ALIGN);
+
+    if (prop && prop->value.compare(STR_CONFIG_CLASS_SemiGapAlignAVX2)==0)
+    {
+        /** Note that this implementation falls back to scalar code if AVX2 is not supported. */
+        return new SemiGapAlignAVX2 (scoreMatrix, openGapCost, extendGapCost, Xdropoff);
+    }
+    else
+    {
+        return new SemiGapAlign (scoreMatrix, openGapCost, extendGapCost, Xdropoff);
+    }
     //return new SemiGapAlignTraceback (scoreMatrix, openGapCost, extendGapCost, Xdropoff);
 }
 
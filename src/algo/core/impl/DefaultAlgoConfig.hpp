@@ -197,6 +197,11 @@ protected:
 
     dp::IProperties* _properties;
     void setProperties (dp::IProperties* properties)  { SP_SETATTR(properties);  }
+
+    /** Thread pool shared by the dispatchers created through this configuration; its threads
+     *  are therefore created once for the whole run (hits iteration and indexation). */
+    dp::ICommandDispatcher* _threadPool;
+    void setThreadPool (dp::ICommandDispatcher* threadPool)  { SP_SETATTR(threadPool);  }
 };
 
 /********************************************************************************/
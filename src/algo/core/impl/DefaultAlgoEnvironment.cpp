@@ -30,6 +30,7 @@
 #include <algo/core/impl/PlastnAlgoConfig.hpp>
 #include <algo/core/impl/AbstractAlgorithm.hpp>
 #include <algo/core/impl/AlgorithmPlastn.hpp>
+#include <algo/core/impl/AlgorithmsPipeline.hpp>
 #include <algo/core/impl/DatabasesProvider.hpp>
 #include <algo/core/impl/ResultVisitorsFactory.hpp>
 
@@ -39,6 +40,7 @@
 #include <alignment/visitors/impl/XmlOutputVisitor.hpp>
 #include <alignment/visitors/impl/NucleotidConversionVisitor.hpp>
 #include <alignment/visitors/impl/ReverseStrandVisitor.hpp>
+#include <alignment/visitors/impl/QueryReorderVisitor.hpp>
 
 #include <set>
 
@@ -160,7 +162,13 @@ void DefaultEnvironment::configure ()
     if (queryProp == 0)  {  queryProp = _properties->add (0, STR_OPTION_QUERY_URI, "foo"); }
     if (queryProp != 0)
     {
-        setQuickQueryDbReader (new FastaDatabaseQuickReader (queryProp->value, inferType));
+        FastaDatabaseQuickReader* queryReader = new FastaDatabaseQuickReader (queryProp->value, inferType);
+
+        /** The file is parsed with the number of threads wanted by the user (number of cores otherwise). */
+        IProperty* propNbProcessors = _properties->getProperty (STR_OPTION_NB_PROCESSORS);
+        if (propNbProcessors != 0)  {  queryReader->setNbThreads (propNbProcessors->getInt());  }
+
+        setQuickQueryDbReader (queryReader);
         _quickQueryDbReader->read (maxblocksize);
     }
 
@@ -289,57 +297,67 @@ void DefaultEnvironment::run ()
     );
     LOCAL (seedsModel);
 
-    /** We create an object for indexing subject and query databases. This object will be in
-     * charge to feed the algorithm with the source Hit Iterator, ie the one that provides for
-     * a given seed all the occurrences in subject and query databases.
-     */
-    IIndexator* indexator = getConfig()->createIndexator (seedsModel, _parametersList[0], _isRunning);
-    LOCAL (indexator);
+    /** We may process several blocks at the same time. */
+    size_t nbBlocks = getBlocksInFlight ();
 
-    /** We iterate each parameters. */
-    for (size_t i=0; _isRunning && i<_parametersList.size(); i++)
+    if (nbBlocks > 1  &&  _parametersList.size() > 1)
+    {
+        runPipeline (seedsModel, nbBlocks);
+    }
+    else
     {
-        list<ICommand*> algosCmd;
-
-        /** We send a notification to potential listeners. */
-        this->notify (new AlgorithmConfigurationEvent (_properties, i, _parametersList.size()));
-
-        bool dbStatsOverwrite = _parametersList[i]->completeSubjectDatabaseStats.isFilled;
-        int completeSubjectDatabaseSize = (dbStatsOverwrite) ?
-                _parametersList[i]->completeSubjectDatabaseStats.size : _quickSubjectDbReader->getDataSize();
-
-        /** We create an Algorithm instance. */
-        list<IAlgorithm*> algos = this->createAlgorithm (
-            getConfig(),
-            _quickSubjectDbReader,
-            _parametersList[i],
-            _filter,
-            _resultVisitor,
-            seedsModel,
-            _dbProvider,
-            indexator,
-            getConfig()->createGlobalParameters (_parametersList[i], completeSubjectDatabaseSize),
-            _timeInfoAlgo,
-            _isRunning
-        );
-        if (algos.empty())  { continue; }
-
-        /** We loop over each created algorithm. */
-        for (list<IAlgorithm*>::iterator it = algos.begin(); it != algos.end(); ++it)
+        /** We create an object for indexing subject and query databases. This object will be in
+         * charge to feed the algorithm with the source Hit Iterator, ie the one that provides for
+         * a given seed all the occurrences in subject and query databases.
+         */
+        IIndexator* indexator = getConfig()->createIndexator (seedsModel, _parametersList[0], _isRunning);
+        LOCAL (indexator);
+
+        /** We iterate each parameters. */
+        for (size_t i=0; _isRunning && i<_parametersList.size(); i++)
         {
-        	/** We can register ourself to be notified by execution events. */
-        	(*it)->addObserver (this);
+            list<ICommand*> algosCmd;
+
+            /** We send a notification to potential listeners. */
+            this->notify (new AlgorithmConfigurationEvent (_properties, i, _parametersList.size()));
+
+            bool dbStatsOverwrite = _parametersList[i]->completeSubjectDatabaseStats.isFilled;
+            int completeSubjectDatabaseSize = (dbStatsOverwrite) ?
+                    _parametersList[i]->completeSubjectDatabaseStats.size : _quickSubjectDbReader->getDataSize();
+
+            /** We create an Algorithm instance. */
+            list<IAlgorithm*> algos = this->createAlgorithm (
+                getConfig(),
+                _quickSubjectDbReader,
+                _parametersList[i],
+                _filter,
+                _resultVisitor,
+                seedsModel,
+                _dbProvider,
+                indexator,
+                getConfig()->createGlobalParameters (_parametersList[i], completeSubjectDatabaseSize),
+                _timeInfoAlgo,
+                _isRunning
+            );
+            if (algos.empty())  { continue; }
+
+            /** We loop over each created algorithm. */
+            for (list<IAlgorithm*>::iterator it = algos.begin(); it != algos.end(); ++it)
+            {
+            	/** We can register ourself to be notified by execution events. */
+            	(*it)->addObserver (this);
 
-        	/** We add this instance to the algorithms list. */
-        	algosCmd.push_back (*it);
-        }
+            	/** We add this instance to the algorithms list. */
+            	algosCmd.push_back (*it);
+            }
 
-        /** We create a commands dispatcher. */
-        ICommandDispatcher* dispatcher = new SerialCommandDispatcher ();
-        LOCAL (dispatcher);
+            /** We create a commands dispatcher. */
+            ICommandDispatcher* dispatcher = new SerialCommandDispatcher ();
+            LOCAL (dispatcher);
 
-        /** We execute the algorithms through the dispatcher. */
-        dispatcher->dispatchCommands (algosCmd, 0);
+            /** We execute the algorithms through the dispatcher. */
+            dispatcher->dispatchCommands (algosCmd, 0);
+        }
     }
 
     /** We may check whether we are actually done or the request has been canceled. */
@@ -363,6 +381,150 @@ void DefaultEnvironment::run ()
     this->notify (new TimeInfoEvent ("algorithm",   _timeInfoAlgo));
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+size_t DefaultEnvironment::getBlocksInFlight ()
+{
+    IProperty* prop = _properties->getProperty (STR_OPTION_BLOCKS_IN_FLIGHT);
+
+    return (prop != 0  &&  prop->getInt() > 1) ? prop->getInt() : 1;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void DefaultEnvironment::runPipeline (seed::ISeedModel* seedsModel, size_t nbBlocks)
+{
+    DEBUG (("DefaultEnvironment::runPipeline: %ld blocks, %ld in flight\n", _parametersList.size(), nbBlocks));
+
+    /** The blocks in flight can't share their databases and indexes, so we need one databases provider
+     *  and one indexator per block in flight. Block i uses the ones of slot i%nbBlocks; note that the
+     *  query database (and index) of a slot is kept as long as its blocks have the same query range. */
+    vector<IDatabasesProvider*> providers  (nbBlocks, 0);
+    vector<IIndexator*>         indexators (nbBlocks, 0);
+
+    for (size_t s=0; s<nbBlocks; s++)
+    {
+        providers[s]  = (s==0 ? _dbProvider : getConfig()->createDatabaseProvider());
+        providers[s]->use ();
+
+        indexators[s] = getConfig()->createIndexator (seedsModel, _parametersList[0], _isRunning);
+        indexators[s]->use ();
+    }
+
+    /** We create a command dispatcher used for the indexation of the prepared blocks. */
+    ICommandDispatcher* indexationDispatcher = getConfig()->createIndexationDispatcher();
+    LOCAL (indexationDispatcher);
+
+    /** We create the algorithms on the fly; each of them is kept until its output is done. */
+    vector<IAlgorithm*> algos (_parametersList.size(), (IAlgorithm*)0);
+
+    {
+        AlgorithmsPipeline pipeline (indexationDispatcher);
+
+        for (size_t i=0; _isRunning && i<_parametersList.size(); i++)
+        {
+            /** The first block is prepared here; the other ones are prepared during the execution of the previous one. */
+            if (i==0)
+            {
+                algos[0] = createBlockAlgorithm (0, seedsModel, providers[0], indexators[0]);
+                pipeline.prepare (algos[0]);
+            }
+
+            pipeline.waitPrepare ();
+
+            /** We prepare the next block; its resources must have been released by the block that used them before. */
+            size_t next = i+1;
+            if (next < _parametersList.size())
+            {
+                if (next >= nbBlocks  &&  algos[next-nbBlocks] != 0)
+                {
+                    pipeline.waitOutput (algos[next-nbBlocks]);
+                    algos[next-nbBlocks]->forget ();
+                    algos[next-nbBlocks] = 0;
+                }
+
+                algos[next] = createBlockAlgorithm (next, seedsModel, providers[next%nbBlocks], indexators[next%nbBlocks]);
+                pipeline.prepare (algos[next]);
+            }
+
+            /** We send a notification to potential listeners. */
+            this->notify (new AlgorithmConfigurationEvent (_properties, i, _parametersList.size()));
+
+            if (algos[i] != 0)
+            {
+                /** The output of the block will be done while the next one is running. */
+                AbstractAlgorithm* abstractAlgo = dynamic_cast<AbstractAlgorithm*> (algos[i]);
+                if (abstractAlgo != 0)  {  abstractAlgo->setOutputStage (&pipeline);  }
+
+                algos[i]->execute ();
+            }
+        }
+
+        /** The pipeline destruction waits for the last output. */
+    }
+
+    for (size_t i=0; i<algos.size(); i++)       {  if (algos[i] != 0)  { algos[i]->forget(); }  }
+    for (size_t s=0; s<nbBlocks; s++)           {  providers[s]->forget();  indexators[s]->forget();  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+IAlgorithm* DefaultEnvironment::createBlockAlgorithm (
+    size_t                      idx,
+    seed::ISeedModel*           seedsModel,
+    IDatabasesProvider*         dbProvider,
+    IIndexator*                 indexator
+)
+{
+    IParameters* params = _parametersList[idx];
+
+    bool dbStatsOverwrite = params->completeSubjectDatabaseStats.isFilled;
+    int completeSubjectDatabaseSize = (dbStatsOverwrite) ?
+            params->completeSubjectDatabaseStats.size : _quickSubjectDbReader->getDataSize();
+
+    /** Note that we have one algorithm per parameters item. */
+    list<IAlgorithm*> algos = this->createAlgorithm (
+        getConfig(),
+        _quickSubjectDbReader,
+        params,
+        _filter,
+        _resultVisitor,
+        seedsModel,
+        dbProvider,
+        indexator,
+        getConfig()->createGlobalParameters (params, completeSubjectDatabaseSize),
+        _timeInfoAlgo,
+        _isRunning
+    );
+    if (algos.empty())  { return 0; }
+
+    IAlgorithm* result = algos.front();
+    result->use ();
+
+    /** We can register ourself to be notified by execution events. */
+    result->addObserver (this);
+
+    return result;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -387,6 +549,11 @@ list<IAlgorithm*> DefaultEnvironment::createAlgorithm (
 {
 	list<IAlgorithm*> result;
 
+    /** When the queries are reordered, the alignments must tell which query block they come from. */
+    QueryReorderVisitor* reorderVisitor = dynamic_cast<QueryReorderVisitor*> (resultVisitor);
+    if (reorderVisitor != 0)  {  resultVisitor = reorderVisitor->createBlockVisitor (params->queryRange);  }
+    LOCAL (resultVisitor);
+
     switch (params->algoKind)
     {
         case ENUM_PLASTP:
@@ -158,6 +158,31 @@ protected:
 
     /** Obtain an instance of a factory for result visitor creation */
     virtual IResultVisitorsFactory* getResultsVisitorFactory();
+
+    /** Returns the maximum number of database blocks (ie. items of the parameters list) that may be
+     *  processed at the same time (see runPipeline). Each of them holds its own databases and indexes.
+     * \return the number of blocks (1 for processing the blocks one after the other). */
+    virtual size_t getBlocksInFlight ();
+
+    /** Process the items of the parameters list with an AlgorithmsPipeline: the databases of the next
+     *  blocks are read and indexed, and the alignments of the previous block are dumped, while the
+     *  alignments of the current block are computed.
+     * \param[in] seedsModel : the seeds model of the algorithms
+     * \param[in] nbBlocks : maximum number of blocks in flight (at least 2). */
+    void runPipeline (seed::ISeedModel* seedsModel, size_t nbBlocks);
+
+    /** Create the algorithm for an item of the parameters list.
+     * \param[in] idx : index of the item in the parameters list
+     * \param[in] seedsModel : the seeds model of the algorithm
+     * \param[in] dbProvider : the databases provider of the algorithm
+     * \param[in] indexator : the indexator of the algorithm
+     * \return the created algorithm (used), 0 if none. */
+    IAlgorithm* createBlockAlgorithm (
+        size_t                          idx,
+        seed::ISeedModel*               seedsModel,
+        algo::core::IDatabasesProvider* dbProvider,
+        algo::core::IIndexator*         indexator
+    );
 };
 
 /********************************************************************************/
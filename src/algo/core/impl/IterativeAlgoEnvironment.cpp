@@ -2,9 +2,13 @@
 #include <algo/core/impl/SingleIterationAlgoEnvironment.hpp>
 
 #include <algo/core/impl/IterativeAlgorithmResultVisitorFactory.hpp>
+#include <algo/core/impl/IterativeResources.hpp>
 
 #include <designpattern/impl/TokenizerIterator.hpp>
 
+#include <cstdlib>
+#include <vector>
+
 #define DEBUG(a)  //a
 
 /********************************************************************************/
@@ -45,16 +49,28 @@ void IterativeAlgoEnvironment::run ()
 
     std::set<u_int64_t> foundQueryIndexes;
 
+    std::vector<std::string> steps;
+    std::vector<long> kmersPerStep;
+
     dp::impl::TokenizerIterator it (iterationSteps->getString(), ",");
     for (it.first(); !it.isDone(); it.next())
     {
-        std::string kmersToSelect = it.currentItem();
+        steps.push_back(it.currentItem());
+        kmersPerStep.push_back(atol(it.currentItem()));
+    }
+
+    // The databases and the subject indexes are kept from one step to the other.
+    IterativeResources resources(kmersPerStep);
+
+    for (size_t i = 0; i < steps.size(); i++)
+    {
+        std::string kmersToSelect = steps[i];
         dp::IProperties* currentStepProps = _properties->clone();
         LOCAL(currentStepProps);
 
         currentStepProps->add(1, STR_OPTION_KMERS_TO_SELECT, kmersToSelect);
         bool tmpIsRunning = _isRunning;
-        SingleIterationAlgoEnvironment stepEnvironment(currentStepProps, tmpIsRunning, foundQueryIndexes, visitorFactory);
+        SingleIterationAlgoEnvironment stepEnvironment(currentStepProps, tmpIsRunning, foundQueryIndexes, visitorFactory, resources);
         stepEnvironment.addObserver(this);
 
         stepEnvironment.configure ();
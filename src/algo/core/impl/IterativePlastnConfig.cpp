@@ -1,7 +1,10 @@
 #include <algo/core/impl/IterativePlastnConfig.hpp>
 #include <algo/core/api/IAlgoEnvironment.hpp>
 #include <algo/core/api/IAlgoParameters.hpp>
+#include <algo/core/impl/AlgoIndexatorNucleotide.hpp>
+#include <algo/core/impl/DatabasesProvider.hpp>
 #include <alignment/visitors/impl/FoundQuerySequencesGeneratingVisitor.hpp>
+#include <index/impl/DatabaseNucleotidIndexOptim.hpp>
 
 #include <set>
 
@@ -15,8 +18,9 @@ namespace impl {
 
 IterativePlastnConfig::IterativePlastnConfig(IEnvironment* environment,
         dp::IProperties* properties,
-        std::set<u_int64_t>& blacklist)
-    : PlastnConfiguration(environment, properties), _blacklist(blacklist)
+        std::set<u_int64_t>& blacklist,
+        IterativeResources& resources)
+    : PlastnConfiguration(environment, properties), _blacklist(blacklist), _resources(resources)
 {
 }
 
@@ -33,6 +37,20 @@ IParameters* IterativePlastnConfig::createDefaultParameters (const std::string&
     return params;
 }
 
+algo::core::IDatabasesProvider* IterativePlastnConfig::createDatabaseProvider ()
+{
+    return new DatabasesProviderIterative (this, _resources);
+}
+
+IIndexator* IterativePlastnConfig::createIndexator (
+    seed::ISeedModel*           seedsModel,
+    algo::core::IParameters*    params,
+    bool&                       isRunning)
+{
+    return new IndexatorNucleotideIterative (seedsModel, params,
+            new indexation::impl::DatabaseNucleotidIndexOptimFactory (), 1.0, isRunning, _resources);
+}
+
 void IterativePlastnConfig::updateKmersPerSequence(IParameters* params)
 {
     dp::IProperty* kmersToSelect= _properties->getProperty(STR_OPTION_KMERS_TO_SELECT);
@@ -2,6 +2,7 @@
 #define _ITERATIVE_PLASTN_CONFIG_HPP_
 
 #include <algo/core/impl/PlastnAlgoConfig.hpp>
+#include <algo/core/impl/IterativeResources.hpp>
 
 #include <set>
 
@@ -22,7 +23,8 @@ public:
     /** Constructor */
     IterativePlastnConfig(IEnvironment* environment,
             dp::IProperties* properties,
-            std::set<u_int64_t>& blacklist);
+            std::set<u_int64_t>& blacklist,
+            IterativeResources& resources);
 
     /** Destructor */
     virtual ~IterativePlastnConfig ();
@@ -30,11 +32,26 @@ public:
     /** \copydoc PlastnConfiguration::createDefaultParameters */
     IParameters* createDefaultParameters (const std::string& algoName);
 
+    /** \copydoc PlastnConfiguration::createDatabaseProvider
+     *  The databases are shared by the steps (see IterativeResources). */
+    algo::core::IDatabasesProvider* createDatabaseProvider ();
+
+    /** \copydoc PlastnConfiguration::createIndexator
+     *  The subject index is shared by the steps (see IterativeResources). */
+    IIndexator*  createIndexator (
+        seed::ISeedModel*        seedsModel,
+        algo::core::IParameters* params,
+        bool&                    isRunning
+    );
+
 private:
 
     // Unique identifiers of query sequences that should not be used.
     std::set<u_int64_t>& _blacklist;
 
+    // Databases and indexes shared by all the steps.
+    IterativeResources& _resources;
+
     /** Update the value of kmersPerSequence in params, based on the value
      *  in the properties. */
     void updateKmersPerSequence(IParameters* params);
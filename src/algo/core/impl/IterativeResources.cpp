@@ -0,0 +1,112 @@
+#include <algo/core/impl/IterativeResources.hpp>
+
+#include <database/impl/FastaSequencePureIterator.hpp>
+
+#include <index/impl/FakeDatabaseNucleotideIndex.hpp>
+
+#define DEBUG(a)  //a
+
+/********************************************************************************/
+namespace algo {
+namespace core {
+/** \brief Implementation of concepts for configuring and running PLAST. */
+namespace impl {
+/********************************************************************************/
+
+IterativeResources::IterativeResources (const std::vector<long>& kmersPerStep)
+    : _kmersPerStep(kmersPerStep), _subjectDatabase(0), _queryDatabase(0)
+{
+    _subjectIndexes[0] = _subjectIndexes[1] = 0;
+}
+
+IterativeResources::~IterativeResources ()
+{
+    for (size_t i = 0; i < 2; i++) {
+        if (_subjectIndexes[i] != 0) { _subjectIndexes[i]->forget(); }
+    }
+
+    setSubjectDatabase(0);
+    setQueryDatabase(0);
+}
+
+database::ISequenceDatabase* IterativeResources::getSubjectDatabase (IDatabasesProvider* provider, IParameters* params)
+{
+    if (_subjectDatabase == 0 || _subjectUri != params->subjectUri || _subjectRange != params->subjectRange)
+    {
+        // The indexes of the previous subject database are useless now.
+        for (size_t i = 0; i < 2; i++) {
+            if (_subjectIndexes[i] != 0) { _subjectIndexes[i]->forget(); _subjectIndexes[i] = 0; }
+        }
+
+        setSubjectDatabase(provider->createDatabase(params->subjectUri, params->subjectRange, false, 0));
+        _subjectUri   = params->subjectUri;
+        _subjectRange = params->subjectRange;
+
+        DEBUG(std::cout << "IterativeResources::getSubjectDatabase NEW " << _subjectUri << " " << _subjectRange << std::endl);
+    }
+
+    // The previous step may have left the database on its minus strand.
+    if (_subjectDatabase->getDirection() == database::ISequenceDatabase::MINUS) {
+        _subjectDatabase->reverse();
+    }
+
+    return _subjectDatabase;
+}
+
+database::impl::CachedSubDatabase* IterativeResources::getQueryDatabase (IParameters* params)
+{
+    if (_queryDatabase == 0 || _queryUri != params->queryUri || _queryRange != params->queryRange)
+    {
+        setQueryDatabase(new database::impl::CachedSubDatabase(new database::impl::FastaSequencePureIterator(
+            params->queryUri.c_str(),
+            SEQUENCE_MAX_COMMENT_SIZE,
+            params->queryRange.begin,
+            params->queryRange.end
+        )));
+        _queryUri   = params->queryUri;
+        _queryRange = params->queryRange;
+
+        DEBUG(std::cout << "IterativeResources::getQueryDatabase NEW " << _queryUri << " " << _queryRange << std::endl);
+    }
+
+    return _queryDatabase;
+}
+
+indexation::IDatabaseIndex* IterativeResources::getSubjectIndex (
+    database::ISequenceDatabase*       database,
+    seed::ISeedModel*                  model,
+    indexation::IDatabaseIndexFactory* factory,
+    dp::ICommandDispatcher*            dispatcher,
+    IParameters*                       params)
+{
+    if (database != _subjectDatabase) {
+        throw "Internal error! IterativeResources::getSubjectIndex called for an unknown database";
+    }
+
+    indexation::IDatabaseIndex*& index =
+        _subjectIndexes[database->getDirection() == database::ISequenceDatabase::PLUS ? 0 : 1];
+
+    if (index == 0)
+    {
+        // The mask of the index is the union of the masks of all the steps.
+        indexation::impl::FakeDatabaseNucleotideIndex indexForMask(database,
+                model,
+                params->subjectUri,
+                params->queryUri,
+                _kmersPerStep);
+        indexForMask.build();
+
+        index = factory->newDatabaseIndex(0, model, &indexForMask, dispatcher);
+        index->use();
+        index->setDatabase(database);
+        index->build();
+
+        DEBUG(std::cout << "IterativeResources::getSubjectIndex NEW " << database->getDirection() << std::endl);
+    }
+
+    return index;
+}
+
+} // namespace impl
+} // namespace core
+} // namespace algo
@@ -0,0 +1,98 @@
+#ifndef _ITERATIVE_RESOURCES_HPP_
+#define _ITERATIVE_RESOURCES_HPP_
+
+/********************************************************************************/
+
+#include <algo/core/api/IAlgoParameters.hpp>
+#include <algo/core/api/IDatabasesProvider.hpp>
+
+#include <database/api/ISequenceDatabase.hpp>
+#include <database/impl/CachedSubDatabase.hpp>
+
+#include <index/api/IDatabaseIndex.hpp>
+
+#include <designpattern/api/ICommand.hpp>
+
+#include <string>
+#include <vector>
+
+/********************************************************************************/
+namespace algo {
+namespace core {
+/** \brief Implementation of concepts for configuring and running PLAST. */
+namespace impl {
+/********************************************************************************/
+
+/**
+ * Resources shared by the steps of an IterativeAlgoEnvironment.
+ *
+ * From one step to the other, only the number of kmers selected per query and
+ * the set of the remaining queries change. So the steps share:
+ *  - the subject database,
+ *  - the query database; each step works on a view of it without the queries
+ *    already found (see CachedSubDatabase),
+ *  - the subject indexes (one per strand). They are built with the union of the
+ *    seeds masks of all the steps, so they hold, for each seed used by a step,
+ *    the same occurrences as an index built with the mask of this step only.
+ */
+class IterativeResources
+{
+public:
+    /** Constructor
+     *  \param[in] kmersPerStep : number of kmers selected per query for each step. */
+    IterativeResources (const std::vector<long>& kmersPerStep);
+
+    /** Destructor */
+    ~IterativeResources ();
+
+    /** Returns the subject database for the given parameters. It is read only if the
+     *  subject uri or range has changed since the previous call. The database is
+     *  always returned on its plus strand.
+     *  \param[in] provider : provider used for reading the database.
+     *  \param[in] params : parameters holding the subject uri and range. */
+    database::ISequenceDatabase* getSubjectDatabase (IDatabasesProvider* provider, IParameters* params);
+
+    /** Returns the whole query database (no query is filtered out) for the given
+     *  parameters. It is read only if the query uri or range has changed since the
+     *  previous call.
+     *  \param[in] params : parameters holding the query uri and range. */
+    database::impl::CachedSubDatabase* getQueryDatabase (IParameters* params);
+
+    /** Returns the index of the subject database for its current strand. The index
+     *  is built by the first call for this database and strand.
+     *  \param[in] database : the subject database (see getSubjectDatabase).
+     *  \param[in] model : the seed model used for the indexation.
+     *  \param[in] factory : factory creating the index.
+     *  \param[in] dispatcher : command dispatcher for running the indexation.
+     *  \param[in] params : parameters holding the subject and query uris. */
+    indexation::IDatabaseIndex* getSubjectIndex (
+        database::ISequenceDatabase*       database,
+        seed::ISeedModel*                  model,
+        indexation::IDatabaseIndexFactory* factory,
+        dp::ICommandDispatcher*            dispatcher,
+        IParameters*                       params
+    );
+
+private:
+
+    std::vector<long> _kmersPerStep;
+
+    database::ISequenceDatabase* _subjectDatabase;
+    void setSubjectDatabase (database::ISequenceDatabase* subjectDatabase)  { SP_SETATTR(subjectDatabase); }
+    std::string     _subjectUri;
+    misc::Range64   _subjectRange;
+
+    database::impl::CachedSubDatabase* _queryDatabase;
+    void setQueryDatabase (database::impl::CachedSubDatabase* queryDatabase)  { SP_SETATTR(queryDatabase); }
+    std::string     _queryUri;
+    misc::Range64   _queryRange;
+
+    // Subject indexes, for the plus and the minus strand.
+    indexation::IDatabaseIndex* _subjectIndexes[2];
+};
+
+} // namespace impl
+} // namespace core
+} // namespace algo
+
+#endif // _ITERATIVE_RESOURCES_HPP_
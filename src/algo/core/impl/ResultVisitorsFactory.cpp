@@ -6,6 +6,7 @@
 #include <alignment/visitors/impl/TabulatedOutputVisitor.hpp>
 #include <alignment/visitors/impl/RawOutputVisitor.hpp>
 #include <alignment/visitors/impl/XmlOutputVisitor.hpp>
+#include <alignment/visitors/impl/BinaryOutputVisitor.hpp>
 #include <alignment/visitors/impl/ShrinkContainerVisitor.hpp>
 #include <alignment/visitors/impl/FilterContainerVisitor.hpp>
 #include <alignment/visitors/impl/ProxyVisitor.hpp>
@@ -83,10 +84,15 @@ alignment::core::IAlignmentContainerVisitor* ResultVisitorsFactory::createResult
             new database::impl::FastaDatabaseQuickReader(queryProp->value, true);
         queryQuickReader->read (maxblocksize);
 
+        /** The alignments are dumped as sorted runs (after a potential conversion), then merged by query. */
+        alignment::visitors::impl::QueryRunsVisitor* runsVisitor =
+            new alignment::visitors::impl::QueryRunsVisitor (uri + ".tmp");
+
         result = new alignment::visitors::impl::QueryReorderVisitor(
             databaseProvider,
             uri,
-            createAlgorithmResultVisitor(properties, uri + ".tmp", 3), // visitor wanted by user with a forced outfmt
+            createAlgorithmResultVisitor(properties, runsVisitor), // visitor for the runs, according to the algorithm
+            runsVisitor,
             createSimpleResultVisitor(uri, outfmt),    // visitor for final dump with the user outfmt
             queryQuickReader,
             (u_int32_t)nbAlignPerNotif,
@@ -116,6 +122,7 @@ alignment::core::IAlignmentContainerVisitor* ResultVisitorsFactory::createSimple
         case 2:     result = new  alignment::visitors::impl::TabulatedOutputExtendedVisitor (uri);     break;
         case 3:     result = new  alignment::visitors::impl::RawOutputVisitor               (uri);     break;
         case 4:     result = new  alignment::visitors::impl::XmlOutputVisitor               (uri);     break;
+        case 5:     result = new  alignment::visitors::impl::BinaryOutputVisitor            (uri);     break;
         case 1:
         default:    result = new  alignment::visitors::impl::TabulatedOutputVisitor         (uri);     break;
     }
@@ -133,7 +140,20 @@ alignment::core::IAlignmentContainerVisitor* ResultVisitorsFactory::createSimple
 *********************************************************************/
 alignment::core::IAlignmentContainerVisitor* ResultVisitorsFactory::createAlgorithmResultVisitor (dp::IProperties* properties, const std::string& uri, int outfmt)
 {
-    alignment::core::IAlignmentContainerVisitor* result = createSimpleResultVisitor (uri, outfmt);
+    return createAlgorithmResultVisitor (properties, createSimpleResultVisitor (uri, outfmt));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+alignment::core::IAlignmentContainerVisitor* ResultVisitorsFactory::createAlgorithmResultVisitor (dp::IProperties* properties, alignment::core::IAlignmentContainerVisitor* visitor)
+{
+    alignment::core::IAlignmentContainerVisitor* result = visitor;
 
     /** Now, we have to take into account the kind of the algorithm (plastp, plastx...)
      *  since we may have to convert back to nucleotid alphabet. */
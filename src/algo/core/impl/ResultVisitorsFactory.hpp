@@ -38,6 +38,7 @@ private:
     alignment::core::IAlignmentContainerVisitor* createSimpleResultVisitor (const std::string& uri, int outfmt);
 
     alignment::core::IAlignmentContainerVisitor* createAlgorithmResultVisitor (dp::IProperties* properties, const std::string& uri, int outfmt);
+    alignment::core::IAlignmentContainerVisitor* createAlgorithmResultVisitor (dp::IProperties* properties, alignment::core::IAlignmentContainerVisitor* visitor);
 };
 
 
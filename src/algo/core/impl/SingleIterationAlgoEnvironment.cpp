@@ -10,9 +10,11 @@ namespace impl {
 SingleIterationAlgoEnvironment::SingleIterationAlgoEnvironment (dp::IProperties* properties,
         bool& isRunning,
         std::set<u_int64_t>& blacklist,
-        IResultVisitorsFactory* resultVisitorsFactory)
+        IResultVisitorsFactory* resultVisitorsFactory,
+        IterativeResources& resources)
     : DefaultEnvironment(properties, isRunning),
     _blacklist(blacklist),
+    _resources(resources),
     _resultVisitorsFactory(0)
 {
     setResultVisitorsFactory(resultVisitorsFactory);
@@ -26,7 +28,7 @@ SingleIterationAlgoEnvironment::~SingleIterationAlgoEnvironment ()
 
 IConfiguration* SingleIterationAlgoEnvironment::createConfiguration (dp::IProperties* properties)
 {
-    return new IterativePlastnConfig (this, properties, _blacklist);
+    return new IterativePlastnConfig (this, properties, _blacklist, _resources);
 }
 
 void SingleIterationAlgoEnvironment::flushResults() { }
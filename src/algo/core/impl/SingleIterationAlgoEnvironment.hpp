@@ -30,7 +30,8 @@ public:
     SingleIterationAlgoEnvironment (dp::IProperties* properties,
             bool& isRunning,
             std::set<u_int64_t>& blacklist,
-            IResultVisitorsFactory* resultVisitorsFactory);
+            IResultVisitorsFactory* resultVisitorsFactory,
+            IterativeResources& resources);
 
     virtual ~SingleIterationAlgoEnvironment ();
 
@@ -45,9 +46,15 @@ protected:
     /** \copydoc DefaultEnvironment::getResultsVisitorFactory */
     virtual IResultVisitorsFactory* getResultsVisitorFactory();
 
+    /** The steps share their databases and indexes (see IterativeResources), so
+     *  the blocks are processed one after the other. */
+    virtual size_t getBlocksInFlight ()  { return 1; }
+
 private:
     std::set<u_int64_t>& _blacklist;
 
+    IterativeResources& _resources;
+
     IResultVisitorsFactory* _resultVisitorsFactory;
 
     void setResultVisitorsFactory(IResultVisitorsFactory* resultVisitorsFactory) { SP_SETATTR(resultVisitorsFactory); }
@@ -57,7 +57,118 @@ namespace hits   {
 
 #define HIT_BAD_SCORE  -100
 
-typedef std::pair<size_t,size_t> IdxCouple;
+typedef std::pair<u_int32_t,u_int32_t> IdxCouple;
+
+/********************************************************************************/
+
+/** \brief Flat buffer of index couples with a survivor bitmask
+ *
+ * The couples are stored contiguously in insertion order, each one owning a slot.
+ * Removing a couple only clears its bit in the survivor bitmask, so the other couples
+ * keep their slots and the couples are never moved.
+ *
+ * The memory is kept by 'clear', so once the buffer has grown to the largest batch of
+ * couples, no allocation is done anymore.
+ *
+ * The alive couples are iterated through their slots:
+ * \code
+ * for (size_t k=buffer.first(); k!=buffer.end(); k=buffer.next(k))
+ * {
+ *     IdxCouple& idx = buffer[k];
+ *     if (idx.first == idx.second)  { buffer.erase (k); }
+ * }
+ * \endcode
+ */
+class IdxCoupleBuffer
+{
+public:
+
+    /** Constructor. */
+    IdxCoupleBuffer () : _nbSlots(0), _nbAlive(0)  {}
+
+    /** Adds an alive couple.
+     * \return the number of slots since the last clear. */
+    size_t push_back (size_t i, size_t j)
+    {
+        if (_nbSlots == _couples.size())
+        {
+            _couples.resize (_couples.empty() ? 64 : 2*_couples.size());
+            _alive.resize   (_couples.size() / 64, 0);
+        }
+
+        _couples[_nbSlots] = IdxCouple (i,j);
+        _alive [_nbSlots >> 6] |= (u_int64_t)1 << (_nbSlots & 63);
+        _nbAlive++;
+
+        return ++_nbSlots;
+    }
+
+    /** Removes all the couples; the memory is kept. */
+    void clear ()
+    {
+        for (size_t w=0; w<(_nbSlots+63)/64; w++)  { _alive[w] = 0; }
+        _nbSlots = 0;
+        _nbAlive = 0;
+    }
+
+    /** Removes the couple of a slot; the other couples keep their slots. */
+    void erase (size_t k)
+    {
+        u_int64_t bit = (u_int64_t)1 << (k & 63);
+        if (_alive[k >> 6] & bit)  {  _alive[k >> 6] &= ~bit;  _nbAlive--;  }
+    }
+
+    /** Number of alive couples. */
+    size_t size  () const  { return _nbAlive;      }
+    bool   empty () const  { return _nbAlive == 0; }
+
+    /** Slot of the first alive couple, or end() if none. */
+    size_t first () const  { return findAlive (0); }
+
+    /** Slot of the alive couple following the slot k, or end() if none. */
+    size_t next (size_t k) const  { return findAlive (k+1); }
+
+    /** Slot past the last one. */
+    size_t end () const  { return _nbSlots; }
+
+    /** Couple of a slot. */
+    IdxCouple&       operator[] (size_t k)        { return _couples[k]; }
+    const IdxCouple& operator[] (size_t k) const  { return _couples[k]; }
+
+private:
+
+    std::vector<IdxCouple> _couples;
+    std::vector<u_int64_t> _alive;
+    size_t _nbSlots;
+    size_t _nbAlive;
+
+    size_t findAlive (size_t k) const
+    {
+        if (k >= _nbSlots)  { return _nbSlots; }
+
+        size_t    w    = k >> 6;
+        u_int64_t bits = _alive[w] & (~(u_int64_t)0 << (k & 63));
+
+        while (bits == 0)
+        {
+            if (++w >= (_nbSlots+63)/64)  { return _nbSlots; }
+            bits = _alive[w];
+        }
+
+        return (w << 6) + lowestBit (bits);
+    }
+
+    static size_t lowestBit (u_int64_t bits)
+    {
+#if defined(__GNUC__)
+        return __builtin_ctzll (bits);
+#else
+        size_t n = 0;
+        while ((bits & 1) == 0)  { bits >>= 1;  n++; }
+        return n;
+#endif
+    }
+};
 
 /********************************************************************************/
 
@@ -89,6 +200,10 @@ typedef std::pair<size_t,size_t> IdxCouple;
  * of the algorithm. For instance, it is likely that entries of the 'indexes' attribute
  * will be removed between the beginning of the small gap algorithm and its end.
  *
+ * Since a Hit instance belongs to one (split) iterator, ie. to one thread, the 'indexes'
+ * buffer is reused from one seed to another and the stages don't allocate memory for
+ * handing the matches to each other (see IdxCoupleBuffer).
+ *
  * Hit instances should be through iterators, in particular through the IHitIterator
  * interface.
  *
@@ -102,7 +217,7 @@ typedef std::pair<size_t,size_t> IdxCouple;
 struct Hit
 {
     /** Constructor. */
-    Hit () : _code(0), occur1(1), neighbourhoodsOccur1(0), occur2(1), neighbourhoodsOccur2(0), _size(0)  { }
+    Hit () : _code(0), occur1(1), neighbourhoodsOccur1(0), occur2(1), neighbourhoodsOccur2(0), occur2Block(NO_BLOCK)  { }
 
     /** Destructor. */
     ~Hit ()  {  resetIndexes();  }
@@ -136,6 +251,14 @@ struct Hit
         }
     }
 
+    /** Value of 'occur2Block' when the query occurrences are not provided again for the same seed. */
+    static const size_t NO_BLOCK = ~((size_t)0);
+
+    /** Set the block of query occurrences (for the current seed).
+     * \param[in] block : index of the first occurrence of the block among the query occurrences of the seed, or NO_BLOCK
+     */
+    void setOccur2Block (size_t block)  { occur2Block = block; }
+
     /** Keep a reference on the two buffer holding the neighbourhoods of all hits.
      * \param[in] neighbourhoods1 : reference to be memorized
      * \param[in] neighbourhoods2 : reference to be memorized
@@ -158,19 +281,23 @@ struct Hit
     /** Buffer holding the neighbourhoods of all occurrences in the subject database. */
     const database::LETTER* neighbourhoodsOccur2;
 
-    /** Add a couple of vector indexes in the list of valid matches. */
-    size_t addIndexes   (size_t i, size_t j)  {   indexes.push_back (std::pair<size_t,size_t> (i,j));   return ++_size; }
+    /** Index of the first query occurrence of the hit among the query occurrences of the current seed. Two hits
+     *  having the same seed code and the same block (not NO_BLOCK) hold the same query occurrences and neighbourhoods,
+     *  so data computed from them can be reused (see UngapHitIteratorSSE16). */
+    size_t occur2Block;
 
-    /** Clear the list of valid matches. */
-    size_t resetIndexes (void)  {  indexes.clear ();  _size=0;  return _size; }
+    /** Add a couple of vector indexes in the list of valid matches.
+     * \return the number of couples added since the last reset. */
+    size_t addIndexes   (size_t i, size_t j)  {  return indexes.push_back (i,j);  }
 
-    /** Returns the number of indexes. */
-    size_t size (void)  {  return _size;  }
+    /** Clear the list of valid matches. */
+    size_t resetIndexes (void)  {  indexes.clear ();  return 0; }
 
-    /** List of valid matches [index in subject, index in query] for the defining seed. */
-    std::list<IdxCouple> indexes;
+    /** Returns the number of couples added since the last reset (removed ones included). */
+    size_t size (void)  {  return indexes.end();  }
 
-    size_t _size;
+    /** Valid matches [index in subject, index in query] for the defining seed. */
+    IdxCoupleBuffer indexes;
 };
 
 /********************************************************************************/
@@ -120,10 +120,11 @@ void CompositionHitIterator::iterateMethod  (Hit* hit)
     /** Statistics. */
     HIT_STATS (_inputHitsNumber += hit->indexes.size();)
 
-    for (list<IdxCouple>::iterator it = hit->indexes.begin();  it != hit->indexes.end();  )
+    IdxCoupleBuffer& indexes = hit->indexes;
+    for (size_t it=indexes.first();  it != indexes.end();  it=indexes.next(it))
     {
         /** Shortcut. */
-        IdxCouple& idx = *it;
+        IdxCouple& idx = indexes[it];
 
         /** Shortcuts. */
         const ISeedOccurrence* occurSubject = occur1Vector.data [idx.first];
@@ -192,7 +193,7 @@ void CompositionHitIterator::iterateMethod  (Hit* hit)
                 else
                 	align.setEvalue   (evalue);
 
-                align.setBitScore (_globalStats->rawToBitsValue((double)score));
+                align.setBitScore (_globalStats->scoreToBits (score));
                 align.setScore    (score);
 
                 /** This will compute identity, nb gaps, ... */
@@ -212,9 +213,6 @@ void CompositionHitIterator::iterateMethod  (Hit* hit)
                     /** We add the alignment into the global alignment container. */
                     _alignmentResult->insert (align, 0);
                 }
-
-                /** We just go to the next item. */
-                it++;
             }
             else
             {
@@ -222,7 +220,7 @@ void CompositionHitIterator::iterateMethod  (Hit* hit)
                 HIT_STATS (_gapKnownNumber++;)
 
                 /** We remove the current index couple. */
-                it = hit->indexes.erase(it);
+                indexes.erase (it);
             }
 
         } /* end of if (score >= info.cut_offs) */
@@ -230,7 +228,7 @@ void CompositionHitIterator::iterateMethod  (Hit* hit)
         else
         {
             /** We remove the current index couple. */
-            it = hit->indexes.erase(it);
+            indexes.erase (it);
         }
 
     } /* end of for (IdxCouple* it = hit->indexes... */
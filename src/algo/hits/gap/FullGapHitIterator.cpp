@@ -80,7 +80,7 @@ FullGapHitIterator::FullGapHitIterator (
 )
     : AbstractPipeHitIterator (realIterator, model, scoreMatrix, parameters, ungapResult),
       _config(0), _queryInfo(0), _globalStats(0), _alignmentResult(0), _splitter(0), _dynpro(0),
-      _ungapKnownNumber(0), _gapKnownNumber(0)
+      _ungapKnownNumber(0), _gapKnownNumber(0), _batchSize(1)
 {
     setConfig           (config);
     setQueryInfo        (queryInfo);
@@ -95,6 +95,10 @@ FullGapHitIterator::FullGapHitIterator (
         _scoreMatrix, _parameters->openGapCost, _parameters->extendGapCost, _parameters->XdroppofGap
     ));
 
+    /** Each index couple needs two extensions (left and right). */
+    _batchSize = MAX (_dynpro->getBatchSize() / 2, (size_t)1);
+    _extensions.resize (2*_batchSize);
+
     DEBUG  (("xdrop=%d  finalxdrop=%d \n", _parameters->XdroppofGap, _parameters->finalXdroppofGap));
 }
 
@@ -128,6 +132,9 @@ void FullGapHitIterator::iterateMethod  (Hit* hit)
 {
     HIT_STATS_VERBOSE (_iterateMethodNbCalls++);
 
+    /** We may compute several extensions at the same time if the dynamic programming supports it. */
+    if (_batchSize > 1)  {  iterateMethodBatch (hit);  return;  }
+
     /** Shortcuts. */
     const Vector<const ISeedOccurrence*>& occur1Vector = hit->occur1;
     const Vector<const ISeedOccurrence*>& occur2Vector = hit->occur2;
@@ -139,10 +146,11 @@ void FullGapHitIterator::iterateMethod  (Hit* hit)
     /** Statistics. */
     HIT_STATS (_inputHitsNumber += hit->indexes.size();)
 
-    for (list<IdxCouple>::iterator it = hit->indexes.begin();  it != hit->indexes.end();  )
+    IdxCoupleBuffer& indexes = hit->indexes;
+    for (size_t it=indexes.first();  it != indexes.end();  it=indexes.next(it))
     {
         /** Shortcut. */
-        IdxCouple& idx = *it;
+        IdxCouple& idx = indexes[it];
 
         /** Shortcuts. */
         const ISeedOccurrence* occurSubject = occur1Vector.data [idx.first];
@@ -154,7 +162,7 @@ void FullGapHitIterator::iterateMethod  (Hit* hit)
             HIT_STATS (_ungapKnownNumber ++;)
 
             /** We remove the current index couple. */
-            it = hit->indexes.erase(it);
+            indexes.erase (it);
 
             continue;
         }
@@ -167,9 +175,6 @@ void FullGapHitIterator::iterateMethod  (Hit* hit)
         LETTER* subjectData = subjectSeq.data.letters.data;
         LETTER* queryData   = querySeq.data.letters.data;
 
-        /** By default, we don't want to keep this current hit. */
-        shouldKeep = false;
-
         /** We compute the left part of the score. Note that the left extension includes the starting point,
          * the right extension does not. */
         scoreLeft = _dynpro->compute (
@@ -193,37 +198,17 @@ void FullGapHitIterator::iterateMethod  (Hit* hit)
             0
         );
 
-        int score = scoreLeft + scoreRight;
-
-        /** We retrieve statistical information for the current query sequence. */
-        IQueryInformation::SequenceInfo& info = _queryInfo->getSeqInfo (querySeq);
-        double evalue = 0;
-        if (!_globalStats->useCutoff())
-        	evalue =_globalStats->scoreToEvalue((double) info.eff_searchsp, (double) score,querySeq.getLength(), subjectSeq.getLength());
-
-        if (((_globalStats->useCutoff())&&(score >= info.cut_offs))||
-        	((!_globalStats->useCutoff())&&(evalue <= _parameters->evalue)))
-        {
-            /** We create a new alignment. */
-            Alignment align (
-                &querySeq,                      &subjectSeq,
-                occurQuery->offsetInSequence,   occurSubject->offsetInSequence,
-                leftOffsetInQuery   - 1,        leftOffsetInSubject - 1,
-                rightOffsetInQuery,             rightOffsetInSubject
-            );
-
-            /** We add this alignment as ungap alignments (ie the gapped alignment will be split in ungap ones). */
-            _ungapResult->insert (align, _splitter);
-            shouldKeep = _alignmentResult->doesExist (align) == false;
-        }
+        /** We check whether we keep the gap alignment. */
+        shouldKeep = processExtensions (
+            occurSubject, occurQuery,
+            scoreLeft,  leftOffsetInQuery,  leftOffsetInSubject,
+            scoreRight, rightOffsetInQuery, rightOffsetInSubject
+        );
 
         if (shouldKeep == true)
         {
             /** We increase the number of found decent hits. */
             HIT_STATS (_outputHitsNumber ++;)
-
-            /** We just go to the next item. */
-            it++;
         }
         else
         {
@@ -231,7 +216,7 @@ void FullGapHitIterator::iterateMethod  (Hit* hit)
             HIT_STATS (_gapKnownNumber++;)
 
             /** We remove the current index couple. */
-            it = hit->indexes.erase(it);
+            indexes.erase (it);
         }
 
     } /* end of for (IdxCouple* it = hit->indexes... */
@@ -241,6 +226,173 @@ void FullGapHitIterator::iterateMethod  (Hit* hit)
     if (hit->indexes.empty() == false)      {  (_client->*_method) (hit);  }
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the index couples are processed by batches of _batchSize items; the left and right
+**           extensions of a whole batch are computed by one call to ISemiGapAlign::computeBatch.
+**           The results are then used in the original order, and each item is checked again
+**           against the ungap alignments found by the previous items of the batch, so the
+**           outcome is the same as iterateMethod without batches.
+*********************************************************************/
+void FullGapHitIterator::iterateMethodBatch (Hit* hit)
+{
+    /** Shortcuts. */
+    const Vector<const ISeedOccurrence*>& occur1Vector = hit->occur1;
+    const Vector<const ISeedOccurrence*>& occur2Vector = hit->occur2;
+
+    /** Statistics. */
+    HIT_STATS (_inputHitsNumber += hit->indexes.size();)
+
+    IdxCoupleBuffer& indexes = hit->indexes;
+    size_t it = indexes.first();
+
+    while (it != indexes.end())
+    {
+        /** We collect the index couples of the batch, skipping the already known ones. */
+        _pending.clear ();
+
+        for ( ; it != indexes.end() && _pending.size() < _batchSize;  it=indexes.next(it))
+        {
+            const ISeedOccurrence* occurSubject = occur1Vector.data [indexes[it].first];
+            const ISeedOccurrence* occurQuery   = occur2Vector.data [indexes[it].second];
+
+            if (_ungapResult && _ungapResult->doesExist (occurSubject, occurQuery, 0) == true)
+            {
+                HIT_STATS (_ungapKnownNumber ++;)
+                indexes.erase (it);
+                continue;
+            }
+
+            /** Shortcuts. */
+            const ISequence& subjectSeq = occurSubject->sequence;
+            const ISequence& querySeq   = occurQuery->sequence;
+
+            LETTER* subjectData = subjectSeq.data.letters.data;
+            LETTER* queryData   = querySeq.data.letters.data;
+
+            /** Left extension (including the starting point). */
+            ISemiGapAlign::Extension& left = _extensions [2*_pending.size() + 0];
+            left.A                = queryData;
+            left.B                = subjectData;
+            left.M                = occurQuery->offsetInSequence   + 1;
+            left.N                = occurSubject->offsetInSequence + 1;
+            left.reverse_sequence = true;
+
+            /** Right extension. */
+            ISemiGapAlign::Extension& right = _extensions [2*_pending.size() + 1];
+            right.A                = queryData   + occurQuery->offsetInSequence;
+            right.B                = subjectData + occurSubject->offsetInSequence;
+            right.M                = querySeq.data.letters.size   - occurQuery->offsetInSequence   - 1;
+            right.N                = subjectSeq.data.letters.size - occurSubject->offsetInSequence - 1;
+            right.reverse_sequence = false;
+
+            _pending.push_back (it);
+        }
+
+        if (_pending.empty())  { break; }
+
+        /** We compute all the extensions of the batch. */
+        _dynpro->computeBatch (_extensions.data(), 2*_pending.size());
+
+        /** We use the results in the original order. */
+        for (size_t i=0; i<_pending.size(); i++)
+        {
+            size_t current = _pending[i];
+
+            const ISeedOccurrence* occurSubject = occur1Vector.data [indexes[current].first];
+            const ISeedOccurrence* occurQuery   = occur2Vector.data [indexes[current].second];
+
+            /** The alignment may have been found by a previous item of the batch. */
+            if (i > 0 && _ungapResult && _ungapResult->doesExist (occurSubject, occurQuery, 0) == true)
+            {
+                HIT_STATS (_ungapKnownNumber ++;)
+                indexes.erase (current);
+                continue;
+            }
+
+            const ISemiGapAlign::Extension& left  = _extensions [2*i + 0];
+            const ISemiGapAlign::Extension& right = _extensions [2*i + 1];
+
+            bool shouldKeep = processExtensions (
+                occurSubject, occurQuery,
+                left.score,  left.a_offset,  left.b_offset,
+                right.score, right.a_offset, right.b_offset
+            );
+
+            if (shouldKeep == true)
+            {
+                HIT_STATS (_outputHitsNumber ++;)
+            }
+            else
+            {
+                HIT_STATS (_gapKnownNumber++;)
+                indexes.erase (current);
+            }
+        }
+    }
+
+    /** We are supposed to have computed scores for each hit,
+     *  we can forward the information to the client.  */
+    if (hit->indexes.empty() == false)      {  (_client->*_method) (hit);  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool FullGapHitIterator::processExtensions (
+    const ISeedOccurrence* occurSubject,
+    const ISeedOccurrence* occurQuery,
+    int       scoreLeft,
+    u_int32_t leftOffsetInQuery,
+    u_int32_t leftOffsetInSubject,
+    int       scoreRight,
+    u_int32_t rightOffsetInQuery,
+    u_int32_t rightOffsetInSubject
+)
+{
+    /** Shortcuts. */
+    const ISequence& subjectSeq = occurSubject->sequence;
+    const ISequence& querySeq   = occurQuery->sequence;
+
+    /** By default, we don't want to keep this current hit. */
+    bool shouldKeep = false;
+
+    int score = scoreLeft + scoreRight;
+
+    /** We retrieve statistical information for the current query sequence. */
+    IQueryInformation::SequenceInfo& info = _queryInfo->getSeqInfo (querySeq);
+    double evalue = 0;
+    if (!_globalStats->useCutoff())
+    	evalue =_globalStats->scoreToEvalue((double) info.eff_searchsp, (double) score,querySeq.getLength(), subjectSeq.getLength());
+
+    if (((_globalStats->useCutoff())&&(score >= info.cut_offs))||
+    	((!_globalStats->useCutoff())&&(evalue <= _parameters->evalue)))
+    {
+        /** We create a new alignment. */
+        Alignment align (
+            &querySeq,                      &subjectSeq,
+            occurQuery->offsetInSequence,   occurSubject->offsetInSequence,
+            leftOffsetInQuery   - 1,        leftOffsetInSubject - 1,
+            rightOffsetInQuery,             rightOffsetInSubject
+        );
+
+        /** We add this alignment as ungap alignments (ie the gapped alignment will be split in ungap ones). */
+        _ungapResult->insert (align, _splitter);
+        shouldKeep = _alignmentResult->doesExist (align) == false;
+    }
+
+    return shouldKeep;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
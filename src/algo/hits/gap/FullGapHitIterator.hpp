@@ -42,6 +42,8 @@
 #include <alignment/tools/impl/SemiGappedAlign.hpp>
 
 #include <set>
+#include <list>
+#include <vector>
 
 /********************************************************************************/
 namespace algo   {
@@ -98,6 +100,26 @@ protected:
     /** \copydoc common::AbstractPipeHitIterator::iterateMethod */
     void iterateMethod (algo::hits::Hit* hit);
 
+    /** Same as iterateMethod, but the extensions are computed by batches (see ISemiGapAlign::computeBatch).
+     * \param[in] hit : the hit to be processed
+     */
+    void iterateMethodBatch (algo::hits::Hit* hit);
+
+    /** Check the score of a gap alignment built from a left and a right extension; if the alignment is
+     * significant, its ungap parts are added to the ungap alignments.
+     * \return true if the alignment is significant and not already known.
+     */
+    bool processExtensions (
+        const indexation::ISeedOccurrence* occurSubject,
+        const indexation::ISeedOccurrence* occurQuery,
+        int       scoreLeft,
+        u_int32_t leftOffsetInQuery,
+        u_int32_t leftOffsetInSubject,
+        int       scoreRight,
+        u_int32_t rightOffsetInQuery,
+        u_int32_t rightOffsetInSubject
+    );
+
     /** We may need a way to create instances through a factory with user configuration. */
     algo::core::IConfiguration* _config;
     void setConfig (algo::core::IConfiguration* config)  { SP_SETATTR(config); }
@@ -132,6 +154,13 @@ protected:
 
     u_int64_t _ungapKnownNumber;
     u_int64_t _gapKnownNumber;
+
+    /** Number of index couples whose extensions are computed together (1 means no batch). */
+    size_t _batchSize;
+
+    /** Extensions of the current batch (two per index couple) and the slots of the index couples. */
+    std::vector<alignment::tools::ISemiGapAlign::Extension> _extensions;
+    std::vector<size_t> _pending;
 };
 
 /********************************************************************************/
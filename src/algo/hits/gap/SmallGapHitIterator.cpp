@@ -100,10 +100,11 @@ void SmallGapHitIterator::iterateMethod  (Hit* hit)
     std::vector<bool> isExtended1 (nb1);   for (size_t k=0; k<nb1; k++)  { isExtended1[k] = false; }
     std::vector<bool> isExtended2 (nb2);   for (size_t k=0; k<nb2; k++)  { isExtended2[k] = false; }
 
-    for (list<IdxCouple>::iterator it = hit->indexes.begin();  it != hit->indexes.end();  )
+    IdxCoupleBuffer& indexes = hit->indexes;
+    for (size_t it=indexes.first();  it != indexes.end();  it=indexes.next(it))
     {
         /** Shortcut. */
-        IdxCouple& idx = *it;
+        IdxCouple& idx = indexes[it];
 
         IWord& neighbour1 = neighbourhood1[idx.first];
         IWord& neighbour2 = neighbourhood2[idx.second];
@@ -134,14 +135,11 @@ void SmallGapHitIterator::iterateMethod  (Hit* hit)
         {
             /** We increase the number of iterations. */
             _outputHitsNumber ++;
-
-            /** We just continue the iteration. */
-            it++;
         }
         else
         {
             /** We remove the current index couple. */
-            it = hit->indexes.erase (it);
+            indexes.erase (it);
         }
     }
 
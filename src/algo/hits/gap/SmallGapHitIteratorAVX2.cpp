@@ -0,0 +1,243 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+
+#include <misc/api/Vector.hpp>
+#include <misc/api/macros.hpp>
+
+#include <algo/hits/gap/SmallGapHitIteratorAVX2.hpp>
+
+/** The AVX2 kernel is compiled through the 'target' function attribute, so we don't need
+ *  specific compilation flags; this is only available with GCC (or compatible) on x86. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define SMALLGAP_WITH_AVX2  1
+    #include <immintrin.h>
+#endif
+
+using namespace std;
+using namespace misc;
+using namespace database;
+using namespace seed;
+using namespace algo::core;
+using namespace alignment::core;
+
+#include <stdio.h>
+#define DEBUG(a)   //printf a
+
+// Define a macro for optimized score retrieval through the vector-matrix.
+#define getScore(i,j)  (_matrixAsVector [(i)+((j)<<5)])
+
+/********************************************************************************/
+namespace algo   {
+namespace hits   {
+namespace gapped {
+/********************************************************************************/
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+SmallGapHitIteratorAVX2::SmallGapHitIteratorAVX2 (
+    IHitIterator*         realIterator,
+    ISeedModel*           model,
+    IScoreMatrix*         scoreMatrix,
+    IParameters*          parameters,
+    IAlignmentContainer*  ungapResult,
+    IAlignmentContainer*  alignmentResult
+)
+    : SmallGapHitIteratorSSE8 (realIterator, model, scoreMatrix, parameters, ungapResult, alignmentResult)
+{
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool SmallGapHitIteratorAVX2::isSupported ()
+{
+#ifdef SMALLGAP_WITH_AVX2
+    /** Note that the check of the OS support of the AVX registers is done by the builtin. */
+    __builtin_cpu_init ();
+    return __builtin_cpu_supports ("avx2");
+#else
+    return false;
+#endif
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+#ifdef SMALLGAP_WITH_AVX2
+__attribute__ ((target ("avx2")))
+#endif
+void SmallGapHitIteratorAVX2::computeScores (
+    size_t nb,
+    const LETTER* neighbourhoods1,
+    const LETTER* neighbourhoods2,
+    int* scores
+)
+{
+    /** Shortcuts. */
+    size_t neighbourLength = getNeighbourLength ();
+    size_t neighbourWidth  = getNeighbourWidth  ();
+
+    /** Number of scores we can compute with the full width of the registers. */
+    size_t nbWide = 0;
+
+#ifdef SMALLGAP_WITH_AVX2
+
+    nbWide = (nb / NB) * NB;
+
+    __m256i vscore_gap_col;
+    __m256i vscore_gap_row;
+    __m256i vnext_score;
+    __m256i vscore;
+    __m256i vbest_score;
+    __m256i vbest_gap_arr[neighbourLength];
+    __m256i vbest_arr[neighbourLength];
+    __m256i vgap_extend;
+    __m256i vgap_open_extend;
+    __m256i vscore_min;
+    __m256i vtemp;
+
+    /** We load gap extension penalty to all elements of a constant. */
+    vgap_extend = _mm256_set1_epi16 (-_parameters->extendGapCost);
+
+    /** We load gap opening penalty to all elements of a constant. */
+    vgap_open_extend =  _mm256_set1_epi16 (-(_parameters->openGapCost + _parameters->extendGapCost));
+
+    /* Load minimal score to all elements of a constant */
+    vscore_min = _mm256_set1_epi16 (-100);
+
+    size_t first_b;
+    size_t last_b;
+
+    int16_t scoreTmp [NB] __attribute__ ((aligned (32)));
+
+    for (size_t k=0; k < nbWide ; k+=NB)
+    {
+        /** Shortcut. */
+        size_t kNeighbourLength = k*neighbourLength;
+
+        vbest_arr[0]     = _mm256_setzero_si256 ();
+        vscore           = vgap_open_extend;
+        vbest_gap_arr[0] = vgap_open_extend;
+
+        for (size_t i=1; i<neighbourWidth; i++)
+        {
+            vbest_arr[i]     = vscore;
+            vbest_gap_arr[i] = _mm256_adds_epi16 (vscore, vgap_open_extend);
+            vscore           = _mm256_adds_epi16 (vscore, vgap_extend);
+        }
+
+        vbest_score = _mm256_setzero_si256 ();
+
+        first_b = 0;
+        last_b  = neighbourWidth / 2;
+
+        for (size_t i=0; i<neighbourLength; i++)
+        {
+            /** Shortcut (and optimization). */
+            const LETTER* pt_A = neighbourhoods1 + i + kNeighbourLength;
+
+            vscore_gap_row = vscore_min;
+            vscore         = vscore_min;
+
+            for (size_t j=first_b; j<last_b; j++)
+            {
+                /** Shortcut (and optimization). */
+                const LETTER* pt_B = neighbourhoods2 + j + kNeighbourLength;
+
+                vscore_gap_col = vbest_gap_arr[j];
+
+                /** vnext_score = vbest_arr[j] + matrix[A[l+i]][B[l+j]] for each lane l. */
+                const LETTER* cursor_A = pt_A;
+                const LETTER* cursor_B = pt_B;
+
+                for (size_t l=0; l<NB; l++)
+                {
+                    scoreTmp[l] = getScore (*cursor_A, *cursor_B);
+
+                    cursor_A += neighbourLength;
+                    cursor_B += neighbourLength;
+                }
+
+                vnext_score = _mm256_adds_epi16 (_mm256_load_si256 ((__m256i*)scoreTmp), vbest_arr[j]);
+
+                vscore      = _mm256_max_epi16 (vscore, vscore_gap_col);
+                vscore      = _mm256_max_epi16 (vscore, vscore_gap_row);
+                vbest_score = _mm256_max_epi16 (vbest_score, vscore);
+
+                vscore_gap_col = _mm256_adds_epi16 (vscore_gap_col, vgap_extend);
+                vscore_gap_row = _mm256_adds_epi16 (vscore_gap_row, vgap_extend);
+
+                vtemp            = _mm256_adds_epi16 (vscore, vgap_open_extend);
+                vbest_gap_arr[j] = _mm256_max_epi16  (vtemp,  vscore_gap_col);
+                vscore_gap_row   = _mm256_max_epi16  (vtemp,  vscore_gap_row);
+
+                vbest_arr[j] = vscore;
+                vscore       = vnext_score;
+
+            } /* end of for (size_t j=first_b; j<last_b; j++) */
+
+            if (i > 7)      first_b += 1;
+
+            if (last_b < neighbourLength)
+            {
+                vbest_arr[last_b]     = vscore_gap_row;
+                vbest_gap_arr[last_b] = _mm256_adds_epi16 (vscore_gap_row, vgap_open_extend);
+
+                last_b += 1;
+            }
+
+        }  /* end of for (i=0; i<neighbourLength; i++) */
+
+        _mm256_store_si256 ((__m256i*)scoreTmp, vbest_score);
+
+        for (size_t l=0; l<NB; l++)  {  scores[k+l] = (u_int16_t) scoreTmp[l];  }
+
+    } /* end of for (k=0; k < nbWide; k+=NB) */
+
+#endif
+
+    /** The remaining scores are computed by the SSE implementation. */
+    if (nbWide < nb)
+    {
+        SmallGapHitIteratorSSE8::computeScores (
+            nb - nbWide,
+            neighbourhoods1 + nbWide*neighbourLength,
+            neighbourhoods2 + nbWide*neighbourLength,
+            scores + nbWide
+        );
+    }
+}
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
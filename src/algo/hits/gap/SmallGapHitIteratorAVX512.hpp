@@ -0,0 +1,92 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+/** \file SmallGapHitIteratorAVX512.hpp
+ *  \brief AVX-512 implementation of IHitIterator interface for small gap alignments.
+ */
+
+#ifndef _SMALLGAP_HIT_ITERATOR_AVX512_HPP_
+#define _SMALLGAP_HIT_ITERATOR_AVX512_HPP_
+
+/********************************************************************************/
+
+#include <algo/hits/gap/SmallGapHitIteratorSSE8.hpp>
+
+/********************************************************************************/
+namespace algo   {
+namespace hits   {
+namespace gapped {
+/********************************************************************************/
+
+/** \brief Implementation of IHitIterator for small gap alignments with AVX-512 usage
+ *
+ * The banded scores computation of SmallGapHitIteratorSSE8 is done here on 512 bits
+ * registers, ie. 32 scores (16 bits saturated values) at a time instead of 8. Remaining
+ * scores (when the scores number is not a multiple of 32) are computed by the parent class.
+ *
+ * In order to fill the 32 lanes, the source iterator should provide hits by blocks of 16
+ * (see ungapped::UngapHitIteratorSSE16::setHitsBatchSize).
+ *
+ * The kernel is compiled for the AVX-512BW instructions set whatever the compilation flags are,
+ * so the isSupported() method has to be checked at runtime before creating an instance.
+ */
+class SmallGapHitIteratorAVX512 : public SmallGapHitIteratorSSE8
+{
+public:
+
+    /** \copydoc SmallGapHitIteratorSSE8::SmallGapHitIteratorSSE8 */
+    SmallGapHitIteratorAVX512 (
+        algo::hits::IHitIterator*               sourceIterator,
+        ::seed::ISeedModel*                     model,
+        algo::core::IScoreMatrix*               scoreMatrix,
+        algo::core::IParameters*                parameters,
+        alignment::core::IAlignmentContainer*   ungapResult,
+        alignment::core::IAlignmentContainer*   alignmentResult
+    );
+
+    /** \copydoc SmallGapHitIteratorSSE8::getName */
+    const char* getName ()  { return "SmallGapHitIteratorAVX512"; }
+
+    /** Tells whether the running CPU (and OS) supports the AVX-512BW instructions set.
+     * \return true if the AVX-512 implementation can be used.
+     */
+    static bool isSupported ();
+
+    /** Number of scores computed at a time. */
+    static const size_t NB = 32;
+
+protected:
+
+    /** \copydoc SmallGapHitIteratorSSE8::clone */
+    virtual AbstractPipeHitIterator* clone (algo::hits::IHitIterator* sourceIterator)
+    {
+        return new SmallGapHitIteratorAVX512 (sourceIterator, _model, _scoreMatrix, _parameters, _ungapResult, _alignmentResult);
+    }
+
+    /** \copydoc SmallGapHitIteratorSSE8::computeScores */
+    void computeScores (
+        size_t nb,
+        const database::LETTER* neighbourhoods1,
+        const database::LETTER* neighbourhoods2,
+        int* scores
+    );
+};
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _SMALLGAP_HIT_ITERATOR_AVX512_HPP_ */
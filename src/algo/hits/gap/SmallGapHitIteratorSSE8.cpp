@@ -192,7 +192,8 @@ void SmallGapHitIteratorSSE8::iterateMethod  (Hit* hit)
     LETTER* left2  = 0;
 
     /** We prepare some neighbourhoods data in specific memory chunk. */
-    for (list<IdxCouple>::iterator it = hit->indexes.begin();  it != hit->indexes.end();  it++)
+    IdxCoupleBuffer& indexes = hit->indexes;
+    for (size_t it=indexes.first();  it != indexes.end();  it=indexes.next(it))
     {
         /** We get references on neighbourhoods buffers to be extended. */
         right1 = cursor1;   cursor1 += bandLength;
@@ -202,8 +203,8 @@ void SmallGapHitIteratorSSE8::iterateMethod  (Hit* hit)
         left2  = cursor2;   cursor2 += bandLength;
 
         /** We compute right and left neighbourhoods for both sequences. */
-        extendNeighbourhood (occur1Vector.data[it->first],  right1, left1);
-        extendNeighbourhood (occur2Vector.data[it->second], right2, left2);
+        extendNeighbourhood (occur1Vector.data[indexes[it].first],  right1, left1);
+        extendNeighbourhood (occur2Vector.data[indexes[it].second], right2, left2);
     }
 
     /** Now, 'neighbourhoods1' and 'neighbourhoods2' should hold all the wanted neighbourhoods. */
@@ -211,7 +212,7 @@ void SmallGapHitIteratorSSE8::iterateMethod  (Hit* hit)
 
     /** We check the scores versus the threshold. */
     size_t k=0;
-    for (list<IdxCouple>::iterator it = hit->indexes.begin();  it != hit->indexes.end();  k++)
+    for (size_t it=indexes.first();  it != indexes.end();  it=indexes.next(it), k++)
     {
         bool removable = true;
 
@@ -221,22 +222,14 @@ void SmallGapHitIteratorSSE8::iterateMethod  (Hit* hit)
         {
             /** We check that the alignment is not already known. */
             removable = _alignmentResult->doesExist (
-                occur1Vector.data[it->first],
-                occur2Vector.data[it->second],
+                occur1Vector.data[indexes[it].first],
+                occur2Vector.data[indexes[it].second],
                 bandLength
             );
         }
 
-        if (removable)
-        {
-            /** We remove the current index couple. */
-            it = hit->indexes.erase (it);
-        }
-        else
-        {
-            /** We just continue the iteration. */
-            it++;
-        }
+        /** We remove the current index couple; the following ones keep their slots. */
+        if (removable)  {  indexes.erase (it);  }
     }
 
     /** We update the statistics about iterations. */
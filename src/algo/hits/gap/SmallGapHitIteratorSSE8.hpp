@@ -48,6 +48,12 @@ namespace gapped {
  * The vectorization scheme allows here to compute 8 scores in the same time, so each
  * score can be computed on 128/8= 16 bits. Absolute values of maximal ungap scores
  * can't be greater than 2^16, so we don't fear any potential truncations in scores.
+ *
+ * Wider implementations (AVX2, AVX-512) are provided by subclasses that override the
+ * computeScores method.
+ *
+ * \see SmallGapHitIteratorAVX2
+ * \see SmallGapHitIteratorAVX512
  */
 class SmallGapHitIteratorSSE8 : public algo::hits::common::AbstractPipeHitIterator
 {
@@ -95,12 +101,12 @@ protected:
     );
 
     /** Compute the scores.
-     * \param[in] nb : number of scores
+     * \param[in] nb : number of scores (multiple of 8)
      * \param[in]  neighbourhoods1 : neighbourhoods in subject
      * \param[in]  neighbourhoods2 : neighbourhoods in query
      * \param[out] scores          : computed scores
      */
-    void computeScores (
+    virtual void computeScores (
         size_t nb,
         const database::LETTER* neighbourhoods1,
         const database::LETTER* neighbourhoods2,
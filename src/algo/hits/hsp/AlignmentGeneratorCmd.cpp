@@ -160,7 +160,7 @@ void AlignmentGeneratorCmd::execute ()
 
              /** We complete missing alignment information. */
              align.setEvalue       (evalue);
-             align.setBitScore     (_globalStats->rawToBitsValue((double)score));
+             align.setBitScore     (_globalStats->scoreToBits (score));
              align.setScore        (score);
              align.setLength       (output.alignSize);
              align.setNbIdentities (output.identity);
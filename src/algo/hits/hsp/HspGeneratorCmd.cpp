@@ -26,6 +26,10 @@
 
 #include <string.h>
 
+#if __SSE2__
+    #include <emmintrin.h>
+#endif
+
 using namespace std;
 
 using namespace misc;
@@ -106,6 +110,54 @@ static inline u_int64_t calculate_neighbors_minus_strand(u_int64_t bitset, const
 	return neighborM;
 }
 
+/* Bitmask of the matches of 16 letters, bit b for the letters s1[b] and s2[b]. Like in the
+ * extension loops, a match needs equal letters that are valid (lower than 'bad').
+ */
+static inline u_int32_t getMatches16 (const LETTER* s1, const LETTER* s2, LETTER bad)
+{
+#if __SSE2__
+    __m128i v1 = _mm_loadu_si128 ((const __m128i*) s1);
+    __m128i v2 = _mm_loadu_si128 ((const __m128i*) s2);
+
+    return _mm_movemask_epi8 (_mm_and_si128 (_mm_cmpeq_epi8 (v1, v2), _mm_cmplt_epi8 (v1, _mm_set1_epi8 (bad))));
+#else
+    u_int32_t result = 0;
+    for (u_int32_t b=0; b<16; b++)  {  if (s1[b] == s2[b]  &&  s1[b] < bad)  { result |= 1 << b; }  }
+    return result;
+#endif
+}
+
+static inline u_int32_t reverse16 (u_int32_t x)
+{
+    x = ((x >> 1) & 0x5555) | ((x & 0x5555) << 1);
+    x = ((x >> 2) & 0x3333) | ((x & 0x3333) << 2);
+    x = ((x >> 4) & 0x0F0F) | ((x & 0x0F0F) << 4);
+    x = ((x >> 8) & 0x00FF) | ((x & 0x00FF) << 8);
+    return x;
+}
+
+/* Matches of the letters following s1 and s2 (bit b for s1[b] and s2[b]); at most 'nb' letters are read.
+ * Returns the number of letters of the bitmask. */
+static inline u_int32_t getMatchesForward (const LETTER* s1, const LETTER* s2, size_t nb, LETTER bad, u_int32_t& matches)
+{
+    if (nb >= 16)  {  matches = getMatches16 (s1, s2, bad);  return 16;  }
+
+    matches = 0;
+    for (u_int32_t b=0; b<nb; b++)  {  if (s1[b] == s2[b]  &&  s1[b] < bad)  { matches |= 1 << b; }  }
+    return nb;
+}
+
+/* Matches of the letters preceding s1 and s2 (bit b for s1[-1-b] and s2[-1-b]); at most 'nb' letters are read.
+ * Returns the number of letters of the bitmask. */
+static inline u_int32_t getMatchesBackward (const LETTER* s1, const LETTER* s2, size_t nb, LETTER bad, u_int32_t& matches)
+{
+    if (nb >= 16)  {  matches = reverse16 (getMatches16 (s1-16, s2-16, bad));  return 16;  }
+
+    matches = 0;
+    for (u_int32_t b=0; b<nb; b++)  {  if (s1[-1-(int)b] == s2[-1-(int)b]  &&  s1[-1-(int)b] < bad)  { matches |= 1 << b; }  }
+    return nb;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -181,6 +233,15 @@ void HSPGenerator::execute ()
 
     IMemoryAllocator& allocator = DefaultFactory::singleton().memory();
 
+    /** The parameters of the seeds extensions. */
+    ExtensionParams extension;
+    extension.match     = _match;
+    extension.mismatch  = _mismatch;
+    extension.xdrop     = _xdrop;
+    extension.extraSpan = _extraSpan;
+    extension.badLetter = _badLetter;
+    extension.mask      = idx2->getMask();
+
     Entry* seqs1 = 0;
     Entry* seqs2 = 0;
 
@@ -377,10 +438,10 @@ void HSPGenerator::execute ()
 						size_t rightLen = MIN (rightLen1, rightLen2);
 						size_t leftLen  = MIN (leftLen1,  leftLen2);
 
-						int rightScore = computeExtensionRight (seed.code, s1, s2, rightLen, _span, alreadySeenRight);
+						int rightScore = computeExtensionRight (extension, seed.code, s1, s2, rightLen, _span, alreadySeenRight);
 						if (alreadySeenRight)  {  continue;  }
 
-						int leftScore  = computeExtensionLeft  (seed.code, s1, s2, leftLen,  _span, alreadySeenLeft);
+						int leftScore  = computeExtensionLeft  (extension, seed.code, s1, s2, leftLen,  _span, alreadySeenLeft);
 						if (alreadySeenLeft)   {  continue;  }
 
 						int score = rightScore + leftScore - _span * _match;
@@ -422,45 +483,47 @@ void HSPGenerator::execute ()
 ** INPUT   :
 ** OUTPUT  :
 ** RETURN  :
-** REMARKS :
+** REMARKS : the matches are computed 16 letters at once; a run of mismatches
+**           is then processed in one step, up to the letter where the X-drop
+**           is reached. The matches are processed letter by letter since the
+**           seed code has to be checked for each of them.
+**           Note that the seed code needs only the 'span' last letters, which
+**           all belong to the current run of matches when it is checked.
 *********************************************************************/
-int HSPGenerator::computeExtensionRight (int code, const LETTER* s1, const LETTER* s2, size_t& length, size_t span, bool& alreadySeen)
+int HSPGenerator::computeExtensionRight (const ExtensionParams& params, int code, const LETTER* s1, const LETTER* s2, size_t& length, size_t span, bool& alreadySeen)
 {
     int code_ss1 = code;
 
     alreadySeen = false;
-    IDatabaseIndex* idx = _indexator->getQueryIndex();
-    u_int8_t* mask = idx->getMask();
+    u_int8_t* mask = params.mask;
 
     /** We reset the score. */
     size_t  nbMatch = span;
-    int32_t score   = nbMatch * _match;
+    int32_t score   = nbMatch * params.match;
     int32_t maxi    = score;
 
-    const LETTER* ss1 = s1 + span;
-    const LETTER* ss2 = s2 + span;
-
-    LETTER ss1Letter = 0;
-
     int32_t bitshift = 2*(span-1);
     int32_t bitmask  = (1 << (2*span)) - 1;
 
+    /** Matches of the next letters (bit 0 for the letter k) and number of letters they describe. */
+    u_int32_t matches = 0;
+    u_int32_t nbKnown = 0;
+
     u_int32_t kmaxi=span;
-    u_int32_t k=0;
-    for (k=span;  ((maxi-score) <= _xdrop) && k<length;  k++, ss1++, ss2++)
+    u_int32_t k=span;
+    while (((maxi-score) <= params.xdrop) && k<length)
     {
-        /** Shortcut. */
-        ss1Letter = *ss1;
+        if (nbKnown == 0)  {  nbKnown = getMatchesForward (s1+k, s2+k, length-k, params.badLetter, matches);  }
 
-        /** We update the seed code for the current letter.
-         *  Note that we use a bitmask: this will assure that we don't corrupt code update
-         *  even if the ss1Letter is not valid (like 'N' letter whose value should be 4).
-         */
-        code_ss1 = ((code_ss1 >> 2)  +  (ss1Letter << bitshift)) & bitmask;
-
-        if (ss1Letter == *ss2  &&  ss1Letter < _badLetter)
+        if (matches & 1)
         {
-            score += _match;
+            /** We update the seed code for the current letter.
+             *  Note that we use a bitmask: this will assure that we don't corrupt code update
+             *  even if the letter is not valid (like 'N' letter whose value should be 4).
+             */
+            code_ss1 = ((code_ss1 >> 2)  +  (s1[k] << bitshift)) & bitmask;
+
+            score += params.match;
             nbMatch++;
 
             if (score > maxi)
@@ -469,7 +532,7 @@ int HSPGenerator::computeExtensionRight (int code, const LETTER* s1, const LETTE
                 kmaxi = k;
             }
 
-            if ((_extraSpan==0)&&(nbMatch >= span))
+            if ((params.extraSpan==0)&&(nbMatch >= span))
             {
                 if (code_ss1 < code && GETMASK(mask, code_ss1))
                 {
@@ -481,14 +544,23 @@ int HSPGenerator::computeExtensionRight (int code, const LETTER* s1, const LETTE
                 /** In case we find a common seed, we reset the max score which would allow to escape from some local minima. */
                 // else if (code_ss1 != code)  {  maxi = score; }
             }
+
+            matches >>= 1;  nbKnown--;  k++;
         }
         else
         {
-            score += _mismatch;
+            /** We skip the mismatches up to the next match, or up to the X-drop. */
+            u_int32_t nb = (matches != 0 ? __builtin_ctz (matches) : nbKnown);
+
+            if (params.mismatch < 0)  {  nb = MIN (nb, (u_int32_t) ((params.xdrop - (maxi-score)) / (-params.mismatch) + 1));  }
+
+            score  += nb * params.mismatch;
             nbMatch = 0;
+
+            matches >>= nb;  nbKnown -= nb;  k += nb;
         }
 
-    }  /* end of for (size_t k... */
+    }  /* end of while (... */
 
     length = kmaxi + 1;
 
@@ -501,44 +573,41 @@ int HSPGenerator::computeExtensionRight (int code, const LETTER* s1, const LETTE
 ** INPUT   :
 ** OUTPUT  :
 ** RETURN  :
-** REMARKS :
+** REMARKS : see computeExtensionRight; the letters are read backwards.
 *********************************************************************/
-int HSPGenerator::computeExtensionLeft (int code, const LETTER* s1, const LETTER* s2, size_t& length, size_t span, bool& alreadySeen)
+int HSPGenerator::computeExtensionLeft (const ExtensionParams& params, int code, const LETTER* s1, const LETTER* s2, size_t& length, size_t span, bool& alreadySeen)
 {
     int code_ss1 = code;
 
     alreadySeen = false;
-    IDatabaseIndex* idx = _indexator->getQueryIndex();
-    u_int8_t* mask = idx->getMask();
+    u_int8_t* mask = params.mask;
 
     /** We reset the score. */
     size_t  nbMatch = span;
-    int32_t score   = nbMatch * _match;
+    int32_t score   = nbMatch * params.match;
     int32_t maxi    = score;
 
     int32_t bitshift = (1 << (2*span)) - 1;
 
-    const LETTER* ss1 = s1 - 1;
-    const LETTER* ss2 = s2 - 1;
-
-    LETTER ss1Letter = 0;
+    /** Matches of the previous letters (bit 0 for the letter k) and number of letters they describe. */
+    u_int32_t matches = 0;
+    u_int32_t nbKnown = 0;
 
     u_int32_t kmaxi=0;
     u_int32_t k=0;
-    for (k=0;  (maxi-score) <= _xdrop  &&  k<length;  k++, ss1--, ss2--)
+    while ((maxi-score) <= params.xdrop  &&  k<length)
     {
-        /** Shortcut. */
-        ss1Letter = *ss1;
+        if (nbKnown == 0)  {  nbKnown = getMatchesBackward (s1-k, s2-k, length-k, params.badLetter, matches);  }
 
-        /** We update the seed code for the current letter.
-         *  Note that we use (ss1Letter & 3): this will assure that we don't corrupt code update
-         *  even if the ss1Letter is not valid (like 'N' letter whose value should be 4).
-         */
-        code_ss1 = ( (code_ss1 << 2) & bitshift) + (ss1Letter & 3);
-
-        if (ss1Letter == *ss2  &&  ss1Letter < _badLetter)
+        if (matches & 1)
         {
-            score += _match;
+            /** We update the seed code for the current letter.
+             *  Note that we use (letter & 3): this will assure that we don't corrupt code update
+             *  even if the letter is not valid (like 'N' letter whose value should be 4).
+             */
+            code_ss1 = ( (code_ss1 << 2) & bitshift) + (s1[-1-(int)k] & 3);
+
+            score += params.match;
             nbMatch++;
 
             if (score > maxi)
@@ -547,7 +616,7 @@ int HSPGenerator::computeExtensionLeft (int code, const LETTER* s1, const LETTER
                 kmaxi = k;
             }
 
-            if ((_extraSpan==0)&&(nbMatch >= span))
+            if ((params.extraSpan==0)&&(nbMatch >= span))
             {
                 if (code_ss1 < code && GETMASK(mask, code_ss1))
                 {
@@ -559,14 +628,23 @@ int HSPGenerator::computeExtensionLeft (int code, const LETTER* s1, const LETTER
                 /** In case we find a common seed, we reset the max score which would allow to escape from some local minima. */
                 // else if (code_ss1 != code)  {  maxi = score; }
             }
+
+            matches >>= 1;  nbKnown--;  k++;
         }
         else
         {
-            score += _mismatch;
+            /** We skip the mismatches up to the next match, or up to the X-drop. */
+            u_int32_t nb = (matches != 0 ? __builtin_ctz (matches) : nbKnown);
+
+            if (params.mismatch < 0)  {  nb = MIN (nb, (u_int32_t) ((params.xdrop - (maxi-score)) / (-params.mismatch) + 1));  }
+
+            score  += nb * params.mismatch;
             nbMatch = 0;
+
+            matches >>= nb;  nbKnown -= nb;  k += nb;
         }
 
-    }  /* end of for (size_t k... */
+    }  /* end of while (... */
 
     length = kmaxi + 1;
 
@@ -67,6 +67,34 @@ public:
     /** */
     void execute ();
 
+    /** Parameters of the ungapped extensions of the seeds. */
+    struct ExtensionParams
+    {
+        int32_t           match;
+        int32_t           mismatch;
+        int32_t           xdrop;
+        size_t            extraSpan;
+        database::LETTER  badLetter;
+        u_int8_t*         mask;
+    };
+
+    /** Extends without gaps and with a X-drop a seed on its right (on its left for computeExtensionLeft).
+     *  The matches are computed 16 letters at once. The extension stops when it finds a seed whose code
+     *  is lower than the one of the extended seed and that is set in the mask (this seed has been extended).
+     * \param[in] params : scores, X-drop and mask of the query seeds
+     * \param[in] code : code of the extended seed
+     * \param[in] s1 : first letter of the seed in the first sequence
+     * \param[in] s2 : first letter of the seed in the second sequence
+     * \param[in,out] length : the extendable length as input, the extension length as output
+     * \param[in] span : span of the seed
+     * \param[out] alreadySeen : true if the extension has been stopped by an already extended seed
+     * \return the best score of the extension (seed included)
+     */
+    static int computeExtensionRight (const ExtensionParams& params, int code, const database::LETTER* s1, const database::LETTER* s2, size_t& length, size_t span, bool& alreadySeen);
+
+    /** \copydoc computeExtensionRight */
+    static int computeExtensionLeft  (const ExtensionParams& params, int code, const database::LETTER* s1, const database::LETTER* s2, size_t& length, size_t span, bool& alreadySeen);
+
 private:
 
     algo::core::IIndexator* _indexator;
@@ -122,11 +150,7 @@ private:
         u_int32_t	            threshold;
     };
 
-    /** */
-    int computeExtensionRight (int code, const database::LETTER* s1, const database::LETTER* s2, size_t& length, size_t span, bool& alreadySeen);
-    int computeExtensionLeft  (int code, const database::LETTER* s1, const database::LETTER* s2, size_t& length, size_t span, bool& alreadySeen);
-
-    void dump (seed::SeedHashCode code, u_int32_t qryIdx, u_int32_t sbjIdx, u_int32_t off1, u_int32_t off2);
+    void dump (::seed::SeedHashCode code, u_int32_t qryIdx, u_int32_t sbjIdx, u_int32_t off1, u_int32_t off2);
 
     static char CONVERT (database::LETTER i);
 };
@@ -21,6 +21,8 @@
 #include <algo/hits/seed/SeedHitIteratorCached.hpp>
 #include <algo/core/api/IAlgoEvents.hpp>
 
+#include <algorithm>
+
 using namespace std;
 using namespace misc;
 using namespace os;
@@ -56,7 +58,8 @@ SeedHitIteratorCached::SeedHitIteratorCached (
     bool&           isRunning,
     ISeedIterator*  seedIterator
 )
-    : SeedHitIterator (indexDb, indexQuery, neighbourhoodSize, seedsUseRatio, isRunning, seedIterator)
+    : SeedHitIterator (indexDb, indexQuery, neighbourhoodSize, seedsUseRatio, isRunning, seedIterator),
+      _tiles (0), _busyTime (0)
 {
     DEBUG (("SeedHitIteratorCached::SeedHitIteratorCached   this=%p  seedIterator=%p  _seedIterator=%p\n",
         this, seedIterator, _seedIterator
@@ -73,8 +76,30 @@ SeedHitIteratorCached::SeedHitIteratorCached (
 *********************************************************************/
 SeedHitIteratorCached::~SeedHitIteratorCached ()
 {
+    setTiles (0);
 }
 
+/** We define a threshold that determines how many seeds occurrences will be handled during an iteration
+ *  of the IOccurrenceBlockIterator (see below); it is also the size of the tiles (in each dimension).
+ *
+ *  Note that this threshold has a direct influence on the memory usage since IOccurrenceBlockIterator makes
+ *  a copy of all needed neighbourhoods for the N seeds occurrences to be processed (where the copied data size
+ *  is typically 4+2*22 = 48 bytes). We must also count 112 bytes for each ISeedOccurrence created instance.
+ *  As a result, we need about 48+112 = 160 bytes for each seed occurrence.
+ *
+ *  We have also to multiply by the number of CPUs running since each CPU deals with one tile.
+ *
+ *  We have also to multiply by 2 because we instanciate twice IOccurrenceBlockIterator.
+ *
+ *  Thus, we may choose our threshold for having a controlled amount of used memory. For instance, if we use
+ *  8 CPUs and deal with a seed having about 20000 occurrences, we will need something like:
+ *      20000 * 160 * 8 * 2 = 51.200.000 bytes
+ *
+ *  We have also to keep in mind that these neighbourhoods may be extended by further steps
+ *  (like small gap extension step).
+ */
+static const size_t maxNbSeedsOccurPerIteration = 20000;
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -90,51 +115,48 @@ void SeedHitIteratorCached::iterate (void* aClient, Method method)
     /** Some checks. */
     if (!client ||  !method)  { return; }
 
-    size_t nbSeeds = 0;
+    size_t nbTiles = 0;
 
     /** We reset the number of iterations. */
     _outputHitsNumber = 0;
 
-    DEBUG (("SeedHitIteratorCached::iterate (%p): BEGIN SEEDS ITERATION  (seedIterator=%p) \n", this, _seedIterator));
+    /** This instance may be iterated without having been split; we have to compute the tiles in such a case. */
+    if (_tiles == 0)  {  setTiles (createTiles (maxNbSeedsOccurPerIteration, false));  }
+
+    DEBUG (("SeedHitIteratorCached::iterate (%p): BEGIN TILES ITERATION  (nbTiles=%ld) \n", this, _tiles->tiles.size()));
 
-    u_int64_t nbTotal     = _seedIterator->getNbTotal();
+    u_int64_t nbTotal     = _tiles->tiles.size();
     u_int64_t nbRetrieved = 0;
 
-    /** We define a threshold that determines how many seeds occurrences will be handled during an iteration
-     *  of the IOccurrenceBlockIterator (see below).
-     *
-     *  Note that this threshold has a direct influence on the memory usage since IOccurrenceBlockIterator makes
-     *  a copy of all needed neighbourhoods for the N seeds occurrences to be processed (where the copied data size
-     *  is typically 4+2*22 = 48 bytes). We must also count 112 bytes for each ISeedOccurrence created instance.
-     *  As a result, we need about 48+112 = 160 bytes for each seed occurrence.
-     *
-     *  We have also to multiply by the number of CPUs running since each CPU deals with one seed.
-     *
-     *  We have also to multiply by 2 because we instanciate twice IOccurrenceBlockIterator.
-     *
-     *  Thus, we may choose our threshold for having a controlled amount of used memory. For instance, if we use
-     *  8 CPUs and deal with a seed having about 20000 occurrences, we will need something like:
-     *      20000 * 160 * 8 * 2 = 51.200.000 bytes
-     *
-     *  We have also to keep in mind that these neighbourhoods may be extended by further steps
-     *  (like small gap extension step).
-     */
-    size_t maxNbSeedsOccurPerIteration = 20000;
+    /** We memorize the beginning of the iteration. */
+    u_int32_t t0 = DefaultFactory::time().gettime();
+    _tiles->start (t0);
 
     /** We notify potential clients that we start the iteration. */
     this->notify (new IterationStatusEvent (ITER_STARTING, nbRetrieved, nbTotal, MSG_HITS_MSG3));
 
-    /** We loop over the possible seeds. Note that we use the 'retrieve' method that is protected from
-     *  concurrent access by different threads. */
-    for (ISeed seed; _isRunning && _seedIterator->retrieve (seed, nbRetrieved);  nbSeeds++)
+    /** The occurrences tables are allocated in the arena of the current thread (see DatabaseIndex);
+     *  we release all of them at once when we are done with a block of subject occurrences. */
+    ArenaMemoryAllocator&       arena  = ArenaMemoryAllocator::local();
+    ArenaMemoryAllocator::Stats arena0 = arena.getStats();
+
+    /** Successive tiles of a seed may share the same subject occurrences block (when the seed has many
+     *  occurrences in the query database); we keep the last one in order to avoid to build it again. */
+    IOccurrenceBlockIterator* itOccurBlockDb1 = 0;
+    Tile*                     previous        = 0;
+
+    /** We loop over the tiles. Note that the 'retrieve' method can be called concurrently by different threads
+     *  without lock, so a thread that is done with its tiles can process the tiles of a big seed. */
+    Tile*  tile = 0;
+    size_t idx  = 0;
+    for ( ; _isRunning && _tiles->retrieve (tile, idx);  nbTiles++)
     {
-        _hit.setSeedHashCode (seed.code);
+        ISeed& seed = _tiles->seeds[tile->seedIdx];
 
-        /** we retrieve the number of occurrences for the current seed. */
-        size_t nbOccur1 = _indexDb1->getOccurrenceNumber (&seed);
-        size_t nbOccur2 = _indexDb2->getOccurrenceNumber (&seed);
+        _hit.setSeedHashCode (seed.code);
 
         /** We notify potential clients that we have made some progress in the iteration. */
+        nbRetrieved = idx + 1;
         this->notify (new IterationStatusEvent (
             ITER_ON_GOING,
             nbRetrieved,
@@ -143,74 +165,92 @@ void SeedHitIteratorCached::iterate (void* aClient, Method method)
             nbRetrieved, nbTotal
         ));
 
-        VERBOSE (("ITERATE SEED  code=%d  '%s' [%ld,%ld]  nb1=%ld  nb2=%ld (%ld) \n",
-            seed.code, seed.kmer.toString().c_str(), nbRetrieved, nbTotal, nbOccur1, nbOccur2, nbOccur1*nbOccur2
+        VERBOSE (("ITERATE TILE  code=%d  '%s' [%ld,%ld]  range1=[%ld,%ld]  range2=[%ld,%ld] \n",
+            seed.code, seed.kmer.toString().c_str(), nbRetrieved, nbTotal,
+            tile->range1.begin, tile->range1.end, tile->range2.begin, tile->range2.end
         ));
 
-        /** We test whether this seed has occurrences in both databases. */
-        if ( ! (nbOccur1 > 0  &&  nbOccur2 > 0) )  { continue; }
-
         /** We increase the number of iterations. */
-        HIT_STATS (_outputHitsNumber += nbOccur1 * nbOccur2;)
+        HIT_STATS (_outputHitsNumber += tile->range1.getLength() * tile->range2.getLength();)
 
-        /** We use a statements block for locally allocate our iterators. */
+        /** For the current tile, we retrieve the occurrences of the seed in the subject database.
+         *  The information is retrieved as a an iterator that loops over ISeedOccurrence instance (holding
+         *  sequence, offset of the seed in the sequence, ...)
+         */
+        if (previous==0  ||  previous->seedIdx != tile->seedIdx  ||  previous->range1.begin != tile->range1.begin)
         {
-            /** For the currenly iterated seed, We retrieve the occurrences that seed in the subject database.
-             *  The information is retrieved as a an iterator that loops over ISeedOccurrence instance (holding
-             *  sequence, offset of the seed in the sequence, ...)
-             */
-            IOccurrenceBlockIterator* itOccurBlockDb1 = _indexDb1->createOccurrenceBlockIterator (
+            if (itOccurBlockDb1 != 0)  { itOccurBlockDb1->forget();  arena.reset(); }
+
+            itOccurBlockDb1 = _indexDb1->createOccurrenceBlockIterator (
                 &seed,
                 _neighbourhoodSize,
-                MIN (nbOccur1, maxNbSeedsOccurPerIteration)
+                tile->range1.getLength(),
+                tile->range1
             );
-            if (itOccurBlockDb1 == 0)    { continue; }
-            LOCAL (itOccurBlockDb1);
 
-            /** For the currenly iterated seed, We retrieve the occurrences that seed in the query database.
-             *  The information is retrieved as a an iterator that loops over ISeedOccurrence instance (holding
-             *  sequence, offset of the seed in the sequence, ...)
-             */
+            if (itOccurBlockDb1 != 0)  { itOccurBlockDb1->use();  itOccurBlockDb1->first(); }
+        }
+        previous = tile;
+
+        if (itOccurBlockDb1 == 0  ||  itOccurBlockDb1->isDone())    { continue; }
+
+        /** We use a statements block for locally allocate our iterator. */
+        {
+            /** For the current tile, we retrieve the occurrences of the seed in the query database. */
             IOccurrenceBlockIterator* itOccurBlockDb2 = _indexDb2->createOccurrenceBlockIterator (
                 &seed,
                 _neighbourhoodSize,
-                MIN (nbOccur2, maxNbSeedsOccurPerIteration)
+                tile->range2.getLength(),
+                tile->range2
             );
             if (itOccurBlockDb2 == 0)    { continue; }
             LOCAL (itOccurBlockDb2);
 
-            /** We loop over ISeedOccurrence instances (both from subject and query db). */
-            for (itOccurBlockDb1->first(); _isRunning &&  !itOccurBlockDb1->isDone(); itOccurBlockDb1->next())
+            Vector<const ISeedOccurrence*>& table1 = itOccurBlockDb1->currentItem ();
+
+            /** We loop over ISeedOccurrence instances of the query db (only one block here). */
+            for (itOccurBlockDb2->first(); _isRunning && !itOccurBlockDb2->isDone(); itOccurBlockDb2->next())
             {
-                Vector<const ISeedOccurrence*>& table1 = itOccurBlockDb1->currentItem ();
+                Vector<const ISeedOccurrence*>& table2 = itOccurBlockDb2->currentItem ();
 
-                for (itOccurBlockDb2->first(); _isRunning && !itOccurBlockDb2->isDone(); itOccurBlockDb2->next())
-                {
-                    Vector<const ISeedOccurrence*>& table2 = itOccurBlockDb2->currentItem ();
+                /** We have now two containers holding occurrences of the current seed in both
+                 *  subject and query databases. We set them as reference to the Hit instance. */
+                _hit.setOccurrencesRef (table1, table2);
 
-                    /** We have now two containers holding occurrences of the current seed in both
-                     *  subject and query databases. We set them as reference to the Hit instance. */
-                    _hit.setOccurrencesRef (table1, table2);
+                /** We also get a reference on the two buffers holding the neighbourhoods. */
+                _hit.setNeighbourhoods (itOccurBlockDb1->getNeighbourhoods(), itOccurBlockDb2->getNeighbourhoods());
 
-                    /** We also get a reference on the two buffers holding the neighbourhoods. */
-                    _hit.setNeighbourhoods (itOccurBlockDb1->getNeighbourhoods(), itOccurBlockDb2->getNeighbourhoods());
+                /** The same query block comes back with the next subject blocks of the seed; we tell it
+                 *  to the client, which may then reuse what it computed from the query occurrences. */
+                _hit.setOccur2Block (tile->sharedRange2 ? tile->range2.begin : Hit::NO_BLOCK);
 
-                    /** We call the callback of a potential client; this is likely another IHitIterator,
-                     *  used for filtering out all possible hits (ie. table1 x table2) for the current seed. */
-                    (client->*method) (&_hit);
-                }
+                /** We call the callback of a potential client; this is likely another IHitIterator,
+                 *  used for filtering out all possible hits (ie. table1 x table2) for the current tile. */
+                (client->*method) (&_hit);
             }
 
-            /** Here we are done with hits iteration for the current seed. */
+            /** Here we are done with hits iteration for the current tile. */
         }
 
-    } /* end of for (_seedIterator... */
+    } /* end of for (_tiles... */
+
+    if (itOccurBlockDb1 != 0)  { itOccurBlockDb1->forget();  arena.reset(); }
+
+    _arenaStats = arena.getStats() - arena0;
+
+    /** The arena can now be used by another thread (the current one may be done). */
+    ArenaMemoryAllocator::releaseLocal ();
+
+    /** We memorize the time spent in the iteration. */
+    u_int32_t t1 = DefaultFactory::time().gettime();
+    _busyTime = t1 - t0;
+    _tiles->stop (t1);
 
     /** We notify potential clients that we finish the iteration. */
     this->notify (new IterationStatusEvent (ITER_DONE, nbRetrieved, nbTotal, MSG_HITS_MSG5));
 
-    DEBUG (("SeedHitIteratorCached::iterate (%p): END SEEDS ITERATION (found %ld seeds, %ld hits)\n",
-        this, nbSeeds, _outputHitsNumber
+    DEBUG (("SeedHitIteratorCached::iterate (%p): END TILES ITERATION (found %ld tiles, %ld hits)\n",
+        this, nbTiles, _outputHitsNumber
     ));
 }
 
@@ -233,16 +273,20 @@ std::vector<IHitIterator*> SeedHitIteratorCached::split (size_t nbSplit)
 
     DEBUG (("SeedHitIteratorCached::split  sortSeeds done,  _seedIterator=%p\n", _seedIterator));
 
-    /** We have to reinit the seeds iterator. */
-    _seedIterator->first ();
+    /** We compute the tiles to be shared by the split instances. The heaviest seeds go first only
+     *  if there are several instances to balance; otherwise we keep the seeds iterator order. */
+    setTiles (createTiles (maxNbSeedsOccurPerIteration, nbSplit > 1));
 
-    DEBUG (("SeedHitIteratorCached::split  entering loop\n"));
+    DEBUG (("SeedHitIteratorCached::split  entering loop (%ld tiles)\n", _tiles->tiles.size()));
 
     /** We split the current iterator. */
     for (size_t i=0; i<nbSplit; i++)
     {
         /** We clone the instance. */
-        SeedHitIterator* clone = this->clone (_seedIterator);
+        SeedHitIteratorCached* clone = this->clone (_seedIterator);
+
+        /** The clone shares the tiles with the other split instances. */
+        clone->setTiles (_tiles);
 
         DEBUG (("SeedHitIteratorCached::split  clone %d created \n", i));
 
@@ -261,6 +305,107 @@ std::vector<IHitIterator*> SeedHitIteratorCached::split (size_t nbSplit)
     return result;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+SeedHitIteratorCached::TileQueue* SeedHitIteratorCached::createTiles (size_t maxNbOccur, bool sortByHitsNb)
+{
+    TileQueue* result = new TileQueue ();
+
+    /** We loop over the seeds. */
+    for (_seedIterator->first(); ! _seedIterator->isDone(); _seedIterator->next())
+    {
+        const ISeed* current = _seedIterator->currentItem();
+
+        size_t nbOccur1 = _indexDb1->getOccurrenceNumber (current);
+        size_t nbOccur2 = _indexDb2->getOccurrenceNumber (current);
+
+        /** We keep only seeds having occurrences in both databases. */
+        if ( ! (nbOccur1 > 0  &&  nbOccur2 > 0) )  { continue; }
+
+        /** We memorize a copy of the seed (the seed iterator may reuse its kmer buffer). */
+        ISeed seed (current->kmer.letters.size, current->kmer.letters.data);
+        seed.kmer.encoding = current->kmer.encoding;
+        seed.code          = current->code;
+        seed.offset        = current->offset;
+        result->seeds.push_back (seed);
+
+        /** We cut the occurrences of the seed into blocks of at most 'maxNbOccur' occurrences;
+         *  each couple (subject block, query block) is a tile. */
+        for (size_t i=0; i<nbOccur1; i+=maxNbOccur)
+        {
+            for (size_t j=0; j<nbOccur2; j+=maxNbOccur)
+            {
+                Tile tile;
+                tile.seedIdx      = result->seeds.size() - 1;
+                tile.range1       = misc::Range<size_t> (i, MIN (i+maxNbOccur, nbOccur1) - 1);
+                tile.range2       = misc::Range<size_t> (j, MIN (j+maxNbOccur, nbOccur2) - 1);
+                tile.seedHitsNb   = (u_int64_t)nbOccur1 * (u_int64_t)nbOccur2;
+                tile.sharedRange2 = nbOccur1 > maxNbOccur;
+
+                result->tiles.push_back (tile);
+            }
+        }
+    }
+
+    /** We may sort the tiles by decreasing hits number of their seed. Note that the sort is stable,
+     *  so the tiles of a seed remain contiguous and the order of the seeds iterator is kept
+     *  for seeds having the same hits number. */
+    if (sortByHitsNb)  {  std::stable_sort (result->tiles.begin(), result->tiles.end(), sortTilesByHitsNb);  }
+
+    DEBUG (("SeedHitIteratorCached::createTiles  nbSeeds=%ld  nbTiles=%ld\n", result->seeds.size(), result->tiles.size()));
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+IProperties* SeedHitIteratorCached::getProperties ()
+{
+    IProperties* result = AbstractHitIterator::getProperties ();
+
+    if (_tiles != 0)
+    {
+        result->add (1, "tiles", "%ld", _tiles->tiles.size());
+
+        /** We give the busy and idle times of each split instance. */
+        u_int32_t duration = _tiles->getDuration();
+
+        for (size_t i=0; i<_splitIterators.size(); i++)
+        {
+            SeedHitIteratorCached* current = dynamic_cast<SeedHitIteratorCached*> (_splitIterators[i]);
+            if (current)
+            {
+                u_int32_t busy = MIN (current->_busyTime, duration);
+
+                result->add (1, "thread", "%ld", i);
+                result->add (2, "busy", "%ld", busy);
+                result->add (2, "idle", "%ld", duration - busy);
+
+                result->add (2, "arena", "");
+                result->add (3, "allocs",   "%lld", current->_arenaStats.nbAllocs);
+                result->add (3, "bytes",    "%lld", current->_arenaStats.nbBytes);
+                result->add (3, "resets",   "%lld", current->_arenaStats.nbResets);
+                result->add (3, "peak",     "%lld", current->_arenaStats.peak);
+                result->add (3, "capacity", "%lld", current->_arenaStats.capacity);
+            }
+        }
+    }
+
+    return result;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
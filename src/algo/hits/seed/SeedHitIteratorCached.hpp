@@ -29,6 +29,7 @@
 
 #include <index/api/IDatabaseIndex.hpp>
 #include <index/impl/DatabaseIndex.hpp>
+#include <os/impl/ArenaMemory.hpp>
 
 #include <algo/hits/seed/SeedHitIterator.hpp>
 
@@ -52,10 +53,16 @@ namespace seed   {
  * This is an improvement compared to SeedHitIterator, where the same information may
  * have to be retrieved several times.
  *
- * This implementation uses the seed iterator through the seed::ISeedIterator::retrieve()
- * method. Since the same seed iterator instance is used by different SeedHitIterator
- * instances (because of the parallelization scheme), it is important that the
- * seed::ISeedIterator::retrieve() method is robust with regard to concurrent thread accesses.
+ * The unit of work is not the seed itself but a tile, ie. a (seed, subject block, query block)
+ * triplet. All the tiles are computed once (see split) and shared by all the split instances
+ * through a TileQueue; each instance takes the next tile of the queue with an atomic increment,
+ * so no lock is needed. When there are several split instances, the tiles are sorted by decreasing
+ * number of hits of their seed, so the heaviest seeds are processed first and the tiles of a big
+ * seed can be processed by several threads at the same time; we avoid in this way having one thread
+ * working long after the other ones are finished. With only one instance, the tiles follow the order
+ * of the seeds iterator, so the alignments are found in the same order as by a seed per seed iteration.
+ *
+ * The busy and idle times of each split instance are provided by getProperties.
  */
 class SeedHitIteratorCached : public SeedHitIterator
 {
@@ -83,16 +90,111 @@ public:
     /** \copydoc SeedHitIterator::split */
     std::vector<IHitIterator*> split (size_t nbSplit);
 
+    /** \copydoc common::AbstractHitIterator::getProperties */
+    dp::IProperties* getProperties ();
+
 protected:
 
     /** Sort the seeds to be iterated.
      */
     virtual void sortSeeds (void) { /* does nothing by default. */  }
 
+    /** \brief Unit of work of the iteration.
+     * A tile is a block of occurrences of a seed in the subject database crossed with a block of
+     * occurrences of the same seed in the query database.
+     */
+    struct Tile
+    {
+        /** Index of the seed in the TileQueue::seeds vector. */
+        size_t seedIdx;
+
+        /** Range of the seed occurrences in the subject database. */
+        misc::Range<size_t> range1;
+
+        /** Range of the seed occurrences in the query database. */
+        misc::Range<size_t> range2;
+
+        /** Number of hits of the whole seed (used for sorting the tiles). */
+        u_int64_t seedHitsNb;
+
+        /** Tells whether the query block of the tile is paired with several subject blocks. */
+        bool sharedRange2;
+    };
+
+    /** \brief Tiles shared by the split instances.
+     * The tiles are computed before the iteration, so retrieving the next tile to be processed is
+     * only an atomic increment of an index. This class also keeps the time of the first retrieval
+     * and of the end of the last tile, which allows to compute the idle time of each thread.
+     */
+    class TileQueue : public dp::SmartPointer
+    {
+    public:
+
+        /** Constructor. */
+        TileQueue () : _next(0), _startTime(0), _endTime(0)  {}
+
+        /** Seeds referenced by the tiles. */
+        std::vector< ::seed::ISeed> seeds;
+
+        /** Tiles to be iterated. */
+        std::vector<Tile> tiles;
+
+        /** Get the next tile to be processed; may be called concurrently.
+         * \param[out] tile : the retrieved tile
+         * \param[out] idx : index of the retrieved tile
+         * \return true if a tile has been retrieved, false if the queue is empty.
+         */
+        bool retrieve (Tile*& tile, size_t& idx)
+        {
+            idx = __sync_fetch_and_add (&_next, 1);
+            if (idx < tiles.size())  { tile = &tiles[idx];  return true; }
+            return false;
+        }
+
+        /** Memorize the beginning of the iteration (only the first call is taken into account). */
+        void start (u_int32_t t)  { __sync_bool_compare_and_swap (&_startTime, 0, t); }
+
+        /** Memorize the end of the iteration (the last call is taken into account). */
+        void stop (u_int32_t t)
+        {
+            for (u_int32_t e=_endTime; t>e && !__sync_bool_compare_and_swap (&_endTime, e, t); e=_endTime)  {}
+        }
+
+        /** Duration of the iteration for all the threads. */
+        u_int32_t getDuration ()  { return _endTime - _startTime; }
+
+    private:
+        size_t    _next;
+        u_int32_t _startTime;
+        u_int32_t _endTime;
+    };
+
+    /** Tiles shared by all the split instances. */
+    TileQueue* _tiles;
+
+    /** Smart setter for the _tiles attribute. */
+    void setTiles (TileQueue* tiles)  { SP_SETATTR(tiles); }
+
+    /** Compute the tiles from the seeds of the seeds iterator.
+     * \param[in] maxNbOccur    : maximum number of seed occurrences in a block.
+     * \param[in] sortByHitsNb  : true for sorting the tiles by decreasing hits number of their seed.
+     * \return the created tiles.
+     */
+    TileQueue* createTiles (size_t maxNbOccur, bool sortByHitsNb);
+
+    /** Comparison of tiles by decreasing hits number of their seed. */
+    static bool sortTilesByHitsNb (const Tile& t1, const Tile& t2)  { return t1.seedHitsNb > t2.seedHitsNb; }
+
+    /** Time spent by this instance in the iteration. */
+    u_int32_t _busyTime;
+
+    /** Use of the arena allocator (see os::impl::ArenaMemoryAllocator) by this instance during the iteration. */
+    os::impl::ArenaMemoryAllocator::Stats _arenaStats;
+
 private:
 
     /** \copydoc SeedHitIterator::clone */
-    SeedHitIterator* clone (::seed::ISeedIterator* seedIterator)
+    SeedHitIteratorCached* clone (::seed::ISeedIterator* seedIterator)
     {
         return new SeedHitIteratorCached (_indexDb1, _indexDb2, _neighbourhoodSize, _seedsUseRatio, _isRunning, seedIterator);
     }
@@ -145,7 +247,7 @@ protected:
 private:
 
     /** \copydoc SeedHitIteratorCached::clone */
-    SeedHitIterator* clone (::seed::ISeedIterator* seedIterator)
+    SeedHitIteratorCached* clone (::seed::ISeedIterator* seedIterator)
     {
         return new SeedHitIteratorCachedWithSortedSeeds (_indexDb1, _indexDb2, _neighbourhoodSize, _seedsUseRatio, _isRunning, seedIterator);
     }
@@ -104,10 +104,11 @@ void UngapExtendHitIterator::iterateMethod (Hit* hit)
     /** Statistics. */
     HIT_STATS (_inputHitsNumber += hit->indexes.size(); )
 
-    for (list<IdxCouple>::iterator it = hit->indexes.begin();  it != hit->indexes.end();  )
+    IdxCoupleBuffer& indexes = hit->indexes;
+    for (size_t it=indexes.first();  it != indexes.end();  it=indexes.next(it))
     {
         /** Shortcut. */
-        IdxCouple& idx = *it;
+        IdxCouple& idx = indexes[it];
 
         /** Shortcuts. */
         const ISeedOccurrence* occurSbj = occurSbjVector.data [idx.first];
@@ -184,7 +185,7 @@ void UngapExtendHitIterator::iterateMethod (Hit* hit)
                 //align.setEvalue   ((double) info.eff_searchsp * exp((-_globalStats->lambda * (double) score) + _globalStats->logK));
 				align.setEvalue   (_globalStats->scoreToEvalue((double) info.eff_searchsp, (double) score, querySeq.getLength(),subjectSeq.getLength()));
 
-                align.setBitScore (_globalStats->rawToBitsValue((double)score));
+                align.setBitScore (_globalStats->scoreToBits (score));
                 align.setScore    (score);
                 align.setLength   (indexRight + indexLeft + 1);
 
@@ -203,18 +204,15 @@ void UngapExtendHitIterator::iterateMethod (Hit* hit)
 
                 /** We add the alignment into the global alignment container. */
                 _ungapResult->insert (align, 0);
-
-                /** We just continue the iteration. */
-                it++;
             }
             else
             {
-                it = hit->indexes.erase (it);
+                indexes.erase (it);
             }
         }
         else
         {
-            it = hit->indexes.erase (it);
+            indexes.erase (it);
         }
     }
 
@@ -0,0 +1,184 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+
+#include <os/impl/DefaultOsFactory.hpp>
+
+#include <misc/api/Vector.hpp>
+#include <misc/api/macros.hpp>
+
+#include <algo/hits/ungap/UngapHitIteratorAVX2.hpp>
+
+/** The AVX2 kernel is compiled through the 'target' function attribute, so we don't need
+ *  specific compilation flags; this is only available with GCC (or compatible) on x86. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define UNGAP_WITH_AVX2  1
+    #include <immintrin.h>
+#endif
+
+using namespace std;
+using namespace misc;
+using namespace os;
+using namespace os::impl;
+using namespace database;
+using namespace seed;
+using namespace indexation;
+using namespace algo::core;
+using namespace alignment::core;
+
+#include <stdio.h>
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace algo     {
+namespace hits     {
+namespace ungapped {
+/********************************************************************************/
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+UngapHitIteratorAVX2::UngapHitIteratorAVX2 (
+    IHitIterator*        realIterator,
+    ISeedModel*          model,
+    IScoreMatrix*        scoreMatrix,
+    IParameters*         parameters,
+    IAlignmentContainer* ungapResult,
+    u_int32_t            maxHitsPerIteration,
+    bool&                isRunning
+)
+    : UngapHitIteratorWide (realIterator, model, scoreMatrix, parameters, ungapResult, maxHitsPerIteration, isRunning, NB)
+{
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool UngapHitIteratorAVX2::isSupported ()
+{
+#ifdef UNGAP_WITH_AVX2
+    /** Note that the check of the OS support of the AVX registers is done by the builtin. */
+    __builtin_cpu_init ();
+    return __builtin_cpu_supports ("avx2");
+#else
+    return false;
+#endif
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void UngapHitIteratorAVX2::iterateMethod (Hit* hit)
+{
+#ifndef UNGAP_WITH_AVX2
+    /** No AVX2 support at compilation time: we use the SSE implementation. */
+    UngapHitIteratorSSE16::iterateMethod (hit);
+#else
+    UngapHitIteratorWide::iterateMethod (hit);
+#endif
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+#ifdef UNGAP_WITH_AVX2
+__attribute__ ((target ("avx2")))
+#endif
+void UngapHitIteratorAVX2::computeMasks (Hit* hit, const char* profile, size_t j, u_int32_t& currentNbHits)
+{
+#ifdef UNGAP_WITH_AVX2
+    __m256i pvScore;
+    __m256i vscore;
+    __m256i vMaxScore;
+
+    const __m256i* pvb = (const __m256i*) profile;
+
+    u_int8_t sizeNeighbour     = _span + 2*_parameters->ungapNeighbourLength;
+    u_int8_t sizeHalfNeighbour = _span + 1*_parameters->ungapNeighbourLength;
+
+    __m256i vBias       = _mm256_set1_epi8 (- _scoreMatrix->getDefaultScore());
+    __m256i vThreshold  = _mm256_set1_epi8 (_parameters->ungapScoreThreshold - 1);
+    __m256i vThreshold2 = _mm256_set1_epi8 (_parameters->ungapScoreThreshold);
+
+    const Vector<const ISeedOccurrence*>& occur1Vector = hit->occur1;
+
+    /** We loop over subject occurrences. */
+    for (size_t i=0; i<occur1Vector.size; i++)
+    {
+        LETTER* neighbour1 = occur1Vector.data[i]->neighbourhood.letters.data;
+
+        vMaxScore = _mm256_setzero_si256 ();
+        vscore    = _mm256_setzero_si256 ();
+
+        for (u_int8_t k=0; k<sizeHalfNeighbour; k++)
+        {
+            pvScore   = *(pvb + (neighbour1[k] * sizeNeighbour + k));
+            vscore    = _mm256_adds_epu8 (vscore,    pvScore);
+            vscore    = _mm256_subs_epu8 (vscore,    vBias);
+            vMaxScore = _mm256_max_epu8  (vMaxScore, vscore);
+        }
+
+        vscore = vMaxScore;
+
+        for (u_int8_t k=sizeHalfNeighbour; k<sizeNeighbour; k++)
+        {
+            pvScore   = *(pvb + (neighbour1[k] * sizeNeighbour + k));
+            vscore    = _mm256_adds_epu8 (vscore,    pvScore);
+            vscore    = _mm256_subs_epu8 (vscore,    vBias);
+            vMaxScore = _mm256_max_epu8  (vMaxScore, vscore);
+        }
+
+        /** Note the trick here: we first re-calibrate the computed max score
+         *  in order to get rid of possible saturations. */
+        vMaxScore = _mm256_min_epu8 (vMaxScore, vThreshold2);
+
+        /** We compare the max score to the wanted threshold.
+         *  We get the test result as a mask of 32 bits.
+         *  For each bit, 1 means that the score passed the threshold test. */
+        u_int32_t maskTestThreshold = _mm256_movemask_epi8 (_mm256_cmpgt_epi8 (vMaxScore, vThreshold));
+
+        /** Possible optimization: just continue if we know that every threshold tests failed. */
+        if (maskTestThreshold == 0)  {  continue; }
+
+        processMask (hit, i, j, maskTestThreshold, currentNbHits);
+
+    }  /* end of for (size_t i=0; i<nb1; i++) */
+#endif
+}
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,92 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+/** \file UngapHitIteratorAVX512.hpp
+ *  \brief AVX-512 implementation of IHitIterator interface for ungap alignments.
+ */
+
+#ifndef _UNGAP_HIT_ITERATOR_AVX512_HPP_
+#define _UNGAP_HIT_ITERATOR_AVX512_HPP_
+
+/********************************************************************************/
+
+#include <algo/hits/ungap/UngapHitIteratorWide.hpp>
+
+/********************************************************************************/
+namespace algo     {
+namespace hits     {
+namespace ungapped {
+/********************************************************************************/
+
+/** \brief IHitIterator for ungap alignments with AVX-512 usage
+ *
+ * This implementation computes 64 scores at a time with 512 bits registers (AVX-512BW), ie. four
+ * times as much as UngapHitIteratorSSE16. The scores are computed on 8 bits as for UngapHitIteratorSSE16.
+ *
+ * The kernel is compiled for the AVX-512BW instructions set whatever the compilation flags are,
+ * so the isSupported() method has to be checked at runtime before creating an instance.
+ *
+ * The loop over the query occurrences and the hits forwarding are shared with the other wide
+ * implementations (see UngapHitIteratorWide), so the algorithm results are the same.
+ */
+class UngapHitIteratorAVX512 : public UngapHitIteratorWide
+{
+public:
+
+    /** \copydoc UngapHitIteratorSSE16::UngapHitIteratorSSE16 */
+    UngapHitIteratorAVX512 (
+        algo::hits::IHitIterator*               sourceIterator,
+        seed::ISeedModel*                       model,
+        algo::core::IScoreMatrix*               scoreMatrix,
+        algo::core::IParameters*                parameters,
+        alignment::core::IAlignmentContainer*   ungapResult,
+        u_int32_t                               maxHitsPerIteration,
+        bool&                                   isRunning
+    );
+
+    /** \copydoc UngapHitIteratorSSE16::getName */
+    const char* getName ()  { return "UngapHitIteratorAVX512"; }
+
+    /** Tells whether the running CPU (and OS) supports the AVX-512BW instructions set.
+     * \return true if the AVX-512 implementation can be used.
+     */
+    static bool isSupported ();
+
+protected:
+
+    /** \copydoc UngapHitIteratorSSE16::clone */
+    virtual common::AbstractPipeHitIterator* clone (IHitIterator* sourceIterator)
+    {
+        UngapHitIteratorAVX512* result = new UngapHitIteratorAVX512 (sourceIterator, _model, _scoreMatrix, _parameters, _ungapResult, _maxHitsPerIteration, _isRunning);
+        result->setHitsBatchSize     (_hitsBatchSize);
+        result->setProfilesCacheSize (_profilesCacheSize);
+        return result;
+    }
+
+    /** \copydoc UngapHitIteratorWide::iterateMethod */
+    void iterateMethod  (Hit* hit);
+
+    /** \copydoc UngapHitIteratorWide::computeMasks */
+    void computeMasks (Hit* hit, const char* profile, size_t j, u_int32_t& currentNbHits);
+
+    static const unsigned char NB = 64;
+};
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _UNGAP_HIT_ITERATOR_AVX512_HPP_ */
@@ -68,7 +68,9 @@ UngapHitIteratorSSE16::UngapHitIteratorSSE16 (
     bool&                isRunning
 )
     : AbstractPipeHitIterator (realIterator, model, scoreMatrix, parameters, ungapResult),
-      _ungapKnownNumber(0), _databk(0), _isRunning (isRunning)
+      _profilesSeed(0), _profilesBuffer(0), _profilesBufferUsed(0), _profilesCacheSize(PROFILES_CACHE_SIZE),
+      _ungapKnownNumber(0), _profilesCacheHits(0), _profilesCacheMisses(0),
+      _databk(0), _hitsBatchSize(4), _isRunning (isRunning)
 {
     DEBUG (("UngapHitIteratorSSE16::UngapHitIteratorSSE16:  span=%ld  _neighbourLength=%d \n",
         _model->getSpan(),
@@ -97,6 +99,131 @@ UngapHitIteratorSSE16::~UngapHitIteratorSSE16 ()
 {
     /** Some clean up. */
     DefaultFactory::memory().free (_databk);
+
+    if (_profilesBuffer != 0)  { DefaultFactory::memory().free (_profilesBuffer); }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void UngapHitIteratorSSE16::iterate (void* aClient, Method method)
+{
+    /** The blocks identifiers are only meaningful during one iteration of the source iterator. */
+    _profiles.clear ();
+    _profilesBufferUsed = 0;
+
+    AbstractPipeHitIterator::iterate (aClient, method);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+char* UngapHitIteratorSSE16::getProfile (Hit* hit, size_t j, size_t nbLanes)
+{
+    size_t size = getProfileSize (nbLanes);
+
+    /** The query block of this hit will come back with other subject occurrences of the seed. */
+    if (hit->occur2Block != Hit::NO_BLOCK  &&  _profilesCacheSize > 0)
+    {
+        /** The cache holds the profiles of one seed only (the tiles of a seed are processed in a row);
+         *  note that this only bounds the cache: the seed is also part of the key. */
+        if (hit->getSeedHashCode() != _profilesSeed)
+        {
+            _profiles.clear ();
+            _profilesBufferUsed = 0;
+            _profilesSeed       = hit->getSeedHashCode();
+        }
+
+        /** The profile is built from the query occurrences [j, j+nbOccur[ of the hit; 'occur2Block' is the index
+         *  of the first occurrence of the hit among the occurrences of the seed. */
+        size_t nbOccur = MIN (hit->occur2.size - j, nbLanes);
+
+        ProfileKey key (hit->getSeedHashCode(), hit->occur2Block + j, nbOccur, nbLanes);
+
+        map<ProfileKey,char*>::iterator lookup = _profiles.find (key);
+        if (lookup != _profiles.end())
+        {
+            _profilesCacheHits++;
+            return lookup->second;
+        }
+
+        _profilesCacheMisses++;
+
+        /** We keep the profile if there is room left in the cache. The profiles are aligned on 64 bytes,
+         *  whatever their number of lanes. */
+        size_t sizeAligned = (size + 0x3f) & ~(0x3f);
+
+        if (_profilesBufferUsed + sizeAligned <= _profilesCacheSize)
+        {
+            if (_profilesBuffer == 0)  { _profilesBuffer = (char*) DefaultFactory::memory().malloc (_profilesCacheSize + 64); }
+
+            char* profile = (char*) ((((size_t) _profilesBuffer) + 0x3f) & ~(0x3f)) + _profilesBufferUsed;
+            _profilesBufferUsed += sizeAligned;
+
+            memset (profile, 0, size);
+            buildProfile (hit, j, nbLanes, profile);
+
+            _profiles[key] = profile;
+            return profile;
+        }
+    }
+
+    /** The profile is built in the inner buffer. */
+    memset (_databk, 0, size);
+
+    char* profile = (char*) (((size_t) (_databk + nbLanes - 1)) & ~(nbLanes - 1));
+    buildProfile (hit, j, nbLanes, profile);
+
+    return profile;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void UngapHitIteratorSSE16::buildProfile (Hit* hit, size_t j, size_t nbLanes, char* profile)
+{
+    u_int8_t sizeMatrix    = _scoreMatrix->getN();
+    u_int8_t sizeNeighbour = _span + 2*_parameters->ungapNeighbourLength;
+
+    short bias = _scoreMatrix->getDefaultScore();
+
+    const LETTER* neighboursOccur2 = hit->neighbourhoodsOccur2;
+
+    char* pc = profile;
+
+    u_int8_t lmin  = MIN (hit->occur2.size - j, nbLanes);
+    u_int8_t delta = (nbLanes - lmin);
+
+    for (u_int8_t m=0; m<sizeMatrix; m++)
+    {
+        int8_t* matrixRow = _matrix[m];
+
+        for (u_int8_t k=0; k<sizeNeighbour; k++)
+        {
+            for (u_int8_t l=0; l<lmin; l++)
+            {
+                *pc++ = (char) (matrixRow [(int) neighboursOccur2[(j+l)*sizeNeighbour+k]] - bias);
+            }
+
+            /** We may have to skip some null scores (in case lmin < nbLanes). */
+            pc += delta;
+        }
+    }
 }
 
 /*********************************************************************
@@ -116,17 +243,11 @@ void UngapHitIteratorSSE16::iterateMethod (Hit* hit)
     __m128i vscore;
     __m128i vMaxScore;
 
-    u_int8_t sizeMatrix        = _scoreMatrix->getN();
     u_int8_t sizeNeighbour     = _span + 2*_parameters->ungapNeighbourLength;
     u_int8_t sizeHalfNeighbour = _span + 1*_parameters->ungapNeighbourLength;
 
     u_int32_t currentNbHits = hit->size();
 
-    char* databk = _databk;
-
-    size_t aligned = ((size_t) (databk + 0x0f)) & ~(0x0f);
-    pvb = (__m128i *) aligned;
-
     short   bias  = _scoreMatrix->getDefaultScore();
     __m128i vBias = _mm_set1_epi8 (-bias);
 
@@ -144,36 +265,11 @@ void UngapHitIteratorSSE16::iterateMethod (Hit* hit)
     /** Statistics. */
     HIT_STATS (_inputHitsNumber += nb1 * nb2;)
 
-    /** We retrieve the whole neighbourhoods buffer. This is important to get the full buffer
-     * for locality concerns (ie. for optimizing CPU cache usage). */
-    const LETTER* neighboursOccur2 = hit->neighbourhoodsOccur2;
-
     /** We loop over query occurrences. */
     for (size_t j=0; _isRunning && j<nb2; j+=NB)
     {
-        /** We first reset to 0 all scores of the pseudo SSE score matrix. */
-        memset (databk, 0, (sizeMatrix*sizeNeighbour + 64) * sizeof(__m128i));
-
-        char* pc = (char *) pvb;
-
-        u_int8_t lmin  = MIN (nb2 - j, NB);
-        u_int8_t delta = (NB - lmin);
-
-        for (u_int8_t m=0; m<sizeMatrix; m++)
-        {
-            int8_t* matrixRow = _matrix[m];
-
-            for (u_int8_t k=0; k<sizeNeighbour; k++)
-            {
-                for (u_int8_t l=0; l<lmin; l++)
-                {
-                    *pc++ = (char) (matrixRow [(int) neighboursOccur2[(j+l)*sizeNeighbour+k]] - bias);
-                }
-
-                /** We may have to skip some null scores (in case lmin > NB). */
-                pc += delta;
-            }
-        }
+        /** We get the pseudo SSE score matrix of the current query occurrences. */
+        pvb = (__m128i *) getProfile (hit, j, NB);
 
         /** We loop over subject occurrences. */
         for (size_t i=0; i<nb1; i++)
@@ -216,36 +312,8 @@ void UngapHitIteratorSSE16::iterateMethod (Hit* hit)
             /** Possible optimization: just continue if we know that every threshold tests failed. */
             if (maskTestThreshold == 0)  {  continue; }
 
-            for (u_int8_t k=0; k<NB; k++)
-            {
-                /** If the value is 0, it means that the two comparisons failed the threshold test. */
-                if ( (maskTestThreshold >> k) & 0x1)
-                {
-                    size_t idx = j+k;
-
-                    if (_ungapResult->doesExist(occur1ForIndexI, occur2Vector.data[idx], 0) == false)
-                    {
-                        /** We tag this hit to be used for further processing. */
-                        currentNbHits = hit->addIndexes (i, idx);
-
-                        /** We may want to go further in the algorithm with the currently found hits.
-                         *  The important consequence is that we can limit the number of hits processed by
-                         *  further iterators. Without such a threshold, these iterators may have to deal with
-                         *  thousands of hits, which can be prohibitive in terms of memory usage.
-                         */
-                        /** Note the "== 4" here; since the next step (likely small gaps) uses a SIMD scheme
-                         *  that vectorizes 8 scores computation at a time, we try to send to it blocks of 4 hits
-                         *  in order to compute 4 left and 4 right useful scores (and no fake score used to fill up
-                         *  to 8 the SIMD 128 bits variables).  */
-                        if (currentNbHits == 4)
-                        {
-                            HIT_STATS (_outputHitsNumber += currentNbHits;)
-                            (_client->*_method) (hit);
-                            currentNbHits = hit->resetIndexes();
-                        }
-                    }
-                }
-            }
+            /** We forward the hits that passed the threshold test. */
+            forwardHits (hit, i, j, maskTestThreshold, currentNbHits);
 
         }  /* end of for (size_t i=0; i<nb1; i++) */
 
@@ -260,6 +328,51 @@ void UngapHitIteratorSSE16::iterateMethod (Hit* hit)
     }
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void UngapHitIteratorSSE16::forwardHits (Hit* hit, size_t i, size_t j, u_int16_t mask, u_int32_t& currentNbHits)
+{
+    /** We use a shortcut (avoids several memory accesses). */
+    const ISeedOccurrence* occur1ForIndexI = hit->occur1.data[i];
+
+    for (u_int8_t k=0; k<NB; k++)
+    {
+        /** If the value is 0, it means that the two comparisons failed the threshold test. */
+        if ( (mask >> k) & 0x1)
+        {
+            size_t idx = j+k;
+
+            if (_ungapResult->doesExist(occur1ForIndexI, hit->occur2.data[idx], 0) == false)
+            {
+                /** We tag this hit to be used for further processing. */
+                currentNbHits = hit->addIndexes (i, idx);
+
+                /** We may want to go further in the algorithm with the currently found hits.
+                 *  The important consequence is that we can limit the number of hits processed by
+                 *  further iterators. Without such a threshold, these iterators may have to deal with
+                 *  thousands of hits, which can be prohibitive in terms of memory usage.
+                 */
+                /** Note the batch size here (4 by default); since the next step (likely small gaps) uses
+                 *  a SIMD scheme that vectorizes 8 scores computation at a time, we try to send to it blocks
+                 *  of 4 hits in order to compute 4 left and 4 right useful scores (and no fake score used to
+                 *  fill up to 8 the SIMD 128 bits variables). Wider small gap kernels use bigger batches. */
+                if (currentNbHits == _hitsBatchSize)
+                {
+                    HIT_STATS (_outputHitsNumber += currentNbHits;)
+                    (_client->*_method) (hit);
+                    currentNbHits = hit->resetIndexes();
+                }
+            }
+        }
+    }
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -276,6 +389,8 @@ dp::IProperties* UngapHitIteratorSSE16::getProperties ()
     u_int64_t scoreKO           = _scoreKO;
     u_int64_t scoreOK           = _scoreOK;
     u_int64_t ungapKnownNumber  = _ungapKnownNumber;
+    u_int64_t profilesHits      = _profilesCacheHits;
+    u_int64_t profilesMisses    = _profilesCacheMisses;
     for (size_t i=0; i<_splitIterators.size(); i++)
     {
         UngapHitIteratorSSE16* current = dynamic_cast<UngapHitIteratorSSE16*> (_splitIterators[i]);
@@ -284,6 +399,8 @@ dp::IProperties* UngapHitIteratorSSE16::getProperties ()
             scoreKO          += current->_scoreKO;
             scoreOK          += current->_scoreOK;
             ungapKnownNumber += current->_ungapKnownNumber;
+            profilesHits     += current->_profilesCacheHits;
+            profilesMisses   += current->_profilesCacheMisses;
         }
     }
 
@@ -292,6 +409,11 @@ dp::IProperties* UngapHitIteratorSSE16::getProperties ()
     result->add (2, "score_ok",    "%ld",  scoreOK);
     result->add (2, "known_ungap", "%ld",  ungapKnownNumber);
 
+    result->add (1, "profiles_cache");
+    result->add (2, "hits",     "%ld",   profilesHits);
+    result->add (2, "misses",   "%ld",   profilesMisses);
+    result->add (2, "hit_rate", "%.3f",  (profilesHits + profilesMisses) > 0 ? (double)profilesHits / (double)(profilesHits + profilesMisses) : 0.0);
+
     /** We call the parent method in case we have split instances. */
     return result;
 }
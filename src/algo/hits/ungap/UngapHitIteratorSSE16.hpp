@@ -31,6 +31,8 @@
 
 #include <algo/hits/ungap/UngapHitIterator.hpp>
 
+#include <map>
+
 /********************************************************************************/
 namespace algo     {
 namespace hits     {
@@ -47,7 +49,17 @@ namespace ungapped {
  * score can be computed on 128/16= 8 bits. Absolute values of maximal ungap scores
  * can be greater than 2^8, so we may have some potential truncations in scores.
  *
+ * Wider implementations (AVX2, AVX-512) are provided by subclasses; they compute the same
+ * scores and forward the hits in the same order.
+ *
+ * The scores of a group of query occurrences against all the letters are first gathered in
+ * a profile (see getProfile). When a query block comes back for the same seed with other
+ * subject occurrences (big seeds, see SeedHitIteratorCached), the profiles of the block are
+ * kept in a bounded cache instead of being built again.
+ *
  * \see UngapHitIteratorSSE8
+ * \see UngapHitIteratorAVX2
+ * \see UngapHitIteratorAVX512
  */
 class UngapHitIteratorSSE16 : public algo::hits::common::AbstractPipeHitIterator
 {
@@ -72,15 +84,37 @@ public:
     /** \copydoc common::AbstractPipeHitIterator::getName */
     const char* getName ()  { return "UngapHitIteratorSSE16"; }
 
+    /** \copydoc common::AbstractPipeHitIterator::iterate */
+    void iterate (void* aClient, Method method);
+
     /** \copydoc common::AbstractPipeHitIterator::getProperties */
     dp::IProperties* getProperties ();
 
+    /** Set the number of hits forwarded at a time to the client iterator. The default value (4)
+     * fits the 8 lanes of the SSE small gap kernel (one left and one right score per hit); wider
+     * small gap kernels should ask for bigger batches.
+     * \param[in] hitsBatchSize : number of hits per batch.
+     */
+    void setHitsBatchSize (size_t hitsBatchSize)  { if (hitsBatchSize > 0)  { _hitsBatchSize = hitsBatchSize; } }
+
+    /** Set the memory size of the profiles cache (PROFILES_CACHE_SIZE by default). It has to be called
+     * before the iteration.
+     * \param[in] profilesCacheSize : size in bytes, 0 for not caching the profiles.
+     */
+    void setProfilesCacheSize (size_t profilesCacheSize)  { _profilesCacheSize = profilesCacheSize; }
+
+    /** Default memory size of the profiles cache (allocated for the first big seed only). */
+    static const size_t PROFILES_CACHE_SIZE = 4*1024*1024;
+
 protected:
 
     /** \copydoc common::AbstractPipeHitIterator::clone */
     virtual common::AbstractPipeHitIterator* clone (IHitIterator* sourceIterator)
     {
-        return new UngapHitIteratorSSE16 (sourceIterator, _model, _scoreMatrix, _parameters, _ungapResult, _maxHitsPerIteration, _isRunning);
+        UngapHitIteratorSSE16* result = new UngapHitIteratorSSE16 (sourceIterator, _model, _scoreMatrix, _parameters, _ungapResult, _maxHitsPerIteration, _isRunning);
+        result->setHitsBatchSize     (_hitsBatchSize);
+        result->setProfilesCacheSize (_profilesCacheSize);
+        return result;
     }
 
     /** \copydoc common::AbstractPipeHitIterator::iterateMethod */
@@ -88,12 +122,75 @@ protected:
 
     static const unsigned char NB = 16;
 
+    /** Forward to the client the hits that passed the threshold test for a subject occurrence
+     * and a block of NB query occurrences.
+     * \param[in] hit : hit holding the occurrences
+     * \param[in] i : index of the subject occurrence
+     * \param[in] j : index of the first query occurrence of the block
+     * \param[in] mask : one bit per query occurrence of the block, 1 if the threshold test passed
+     * \param[in,out] currentNbHits : number of hits tagged in the hit instance
+     */
+    void forwardHits (Hit* hit, size_t i, size_t j, u_int16_t mask, u_int32_t& currentNbHits);
+
+    /** Returns the profile of a group of query occurrences: for each letter m and each position k in
+     * the neighbourhoods, the scores (plus the matrix bias) of m against the letters at position k of
+     * the nbLanes query occurrences of the group, ie. one SIMD vector per (m,k).
+     * The profile comes from the cache if the hit query block is known for the current seed; otherwise
+     * it is built, in the cache if there is room left, in the inner buffer if not.
+     * \param[in] hit : hit holding the query occurrences
+     * \param[in] j : index of the first query occurrence of the group
+     * \param[in] nbLanes : number of query occurrences per group (one byte per score)
+     * \return the profile, aligned on nbLanes bytes; it is valid until the next call.
+     */
+    char* getProfile (Hit* hit, size_t j, size_t nbLanes);
+
+    /** Fills a zeroed profile buffer (see getProfile). */
+    void buildProfile (Hit* hit, size_t j, size_t nbLanes, char* profile);
+
+    /** Size in bytes of a profile buffer (we keep some margin after the vectors of the letters). */
+    size_t getProfileSize (size_t nbLanes)
+    {
+        return (_scoreMatrix->getN() * (_span + 2*_parameters->ungapNeighbourLength) + 64) * nbLanes;
+    }
+
+    /** Key of a profile in the cache: the seed, the index of the first query occurrence of the profile
+     *  among the occurrences of the seed, the number of occurrences in the profile and its number of lanes.
+     *  These data don't depend on the tile that provides the occurrences. */
+    struct ProfileKey
+    {
+        ProfileKey (seed::SeedHashCode seed, size_t occur, size_t nbOccur, size_t nbLanes)
+            : seed(seed), occur(occur), nbOccur(nbOccur), nbLanes(nbLanes)  {}
+        seed::SeedHashCode seed;
+        size_t occur;
+        size_t nbOccur;
+        size_t nbLanes;
+        bool operator< (const ProfileKey& other) const
+        {
+            if (seed    != other.seed)     { return seed    < other.seed;    }
+            if (occur   != other.occur)    { return occur   < other.occur;   }
+            if (nbOccur != other.nbOccur)  { return nbOccur < other.nbOccur; }
+            return nbLanes < other.nbLanes;
+        }
+    };
+
+    /** Profiles of the current seed, located in the profiles buffer. */
+    std::map<ProfileKey,char*> _profiles;
+    seed::SeedHashCode         _profilesSeed;
+    char*                      _profilesBuffer;
+    size_t                     _profilesBufferUsed;
+    size_t                     _profilesCacheSize;
+
     /* Statistics. */
     u_int64_t _ungapKnownNumber;
+    u_int64_t _profilesCacheHits;
+    u_int64_t _profilesCacheMisses;
 
     /** Inner buffer. */
     char* _databk;
 
+    /** Number of hits forwarded at a time to the client iterator. */
+    size_t _hitsBatchSize;
+
     /** */
     bool& _isRunning;
 };
@@ -0,0 +1,126 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+
+#include <os/impl/DefaultOsFactory.hpp>
+
+#include <misc/api/Vector.hpp>
+#include <misc/api/macros.hpp>
+
+#include <algo/hits/ungap/UngapHitIteratorWide.hpp>
+
+using namespace std;
+using namespace misc;
+using namespace os;
+using namespace os::impl;
+using namespace database;
+using namespace seed;
+using namespace indexation;
+using namespace algo::core;
+using namespace alignment::core;
+
+#include <stdio.h>
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace algo     {
+namespace hits     {
+namespace ungapped {
+/********************************************************************************/
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+UngapHitIteratorWide::UngapHitIteratorWide (
+    IHitIterator*        realIterator,
+    ISeedModel*          model,
+    IScoreMatrix*        scoreMatrix,
+    IParameters*         parameters,
+    IAlignmentContainer* ungapResult,
+    u_int32_t            maxHitsPerIteration,
+    bool&                isRunning,
+    size_t               nbLanes
+)
+    : UngapHitIteratorSSE16 (realIterator, model, scoreMatrix, parameters, ungapResult, maxHitsPerIteration, isRunning),
+      _nbLanes (nbLanes)
+{
+    /** We need a bigger inner buffer than the parent class (nbLanes bytes per score). */
+    DefaultFactory::memory().free (_databk);
+    _databk = (char *) DefaultFactory::memory().calloc (getProfileSize (_nbLanes),  1);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void UngapHitIteratorWide::iterateMethod (Hit* hit)
+{
+    HIT_STATS_VERBOSE (_iterateMethodNbCalls++);
+
+    u_int32_t currentNbHits = hit->size();
+
+    size_t nb1 = hit->occur1.size;
+    size_t nb2 = hit->occur2.size;
+
+    /** Few query occurrences would leave most of the lanes unused; the profile building
+     *  would then cost more than the scores computation, so we use the SSE implementation. */
+    if (nb2 <= UngapHitIteratorSSE16::NB)  {  UngapHitIteratorSSE16::iterateMethod (hit);  return;  }
+
+    /** Statistics. */
+    HIT_STATS (_inputHitsNumber += nb1 * nb2;)
+
+    /** We loop over query occurrences. */
+    for (size_t j=0; _isRunning && j<nb2; j+=_nbLanes)
+    {
+        _pendingMasks.clear();
+
+        /** We compute the scores against the pseudo SIMD score matrix of the current query occurrences. */
+        computeMasks (hit, getProfile (hit, j, _nbLanes), j, currentNbHits);
+
+        /** We forward the hits of the next blocks of 16 query occurrences. */
+        for (size_t b=1; b<_nbLanes/16; b++)
+        {
+            for (size_t p=0; p<_pendingMasks.size(); p++)
+            {
+                u_int16_t mask = (_pendingMasks[p].second >> (16*(b-1))) & 0xFFFF;
+
+                if (mask)  {  forwardHits (hit, _pendingMasks[p].first, j+16*b, mask, currentNbHits);  }
+            }
+        }
+
+    }  /* end of for (size_t j=0; j<nb2; j+=_nbLanes) */
+
+    /** We are supposed to have computed scores for each hit, we can forward the information to the client.  */
+    if (currentNbHits > 0)
+    {
+        HIT_STATS (_outputHitsNumber += currentNbHits;)
+        (_client->*_method) (hit);
+        currentNbHits = hit->resetIndexes();
+    }
+}
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
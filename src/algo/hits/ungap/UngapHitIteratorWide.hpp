@@ -0,0 +1,106 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+/** \file UngapHitIteratorWide.hpp
+ *  \brief Common part of the ungap hit iterators using registers wider than 128 bits.
+ */
+
+#ifndef _UNGAP_HIT_ITERATOR_WIDE_HPP_
+#define _UNGAP_HIT_ITERATOR_WIDE_HPP_
+
+/********************************************************************************/
+
+#include <algo/hits/ungap/UngapHitIteratorSSE16.hpp>
+
+#include <vector>
+
+/********************************************************************************/
+namespace algo     {
+namespace hits     {
+namespace ungapped {
+/********************************************************************************/
+
+/** \brief Common part of the ungap hit iterators with wide SIMD registers
+ *
+ * The subclasses compute the scores of nbLanes (32, 64) query occurrences at a time; they only
+ * implement the scores computation for one group of query occurrences (see computeMasks).
+ *
+ * This class loops over the groups and forwards the hits in the same order than
+ * UngapHitIteratorSSE16 would do: for each group, the hits of its first 16 query occurrences
+ * are forwarded while looping over the subject occurrences, then the hits of the next blocks
+ * of 16 query occurrences, one block after the other. So the algorithm results are the same
+ * whatever the implementation.
+ */
+class UngapHitIteratorWide : public UngapHitIteratorSSE16
+{
+public:
+
+    /** \copydoc UngapHitIteratorSSE16::UngapHitIteratorSSE16
+     * \param[in] nbLanes : number of scores computed at a time (multiple of 16, at most 64).
+     */
+    UngapHitIteratorWide (
+        algo::hits::IHitIterator*               sourceIterator,
+        seed::ISeedModel*                       model,
+        algo::core::IScoreMatrix*               scoreMatrix,
+        algo::core::IParameters*                parameters,
+        alignment::core::IAlignmentContainer*   ungapResult,
+        u_int32_t                               maxHitsPerIteration,
+        bool&                                   isRunning,
+        size_t                                  nbLanes
+    );
+
+protected:
+
+    /** \copydoc UngapHitIteratorSSE16::iterateMethod */
+    void iterateMethod  (Hit* hit);
+
+    /** Computes the scores of the subject occurrences of the hit against a group of nbLanes query
+     * occurrences and gives the threshold masks to processMask.
+     * \param[in] hit : hit holding the occurrences
+     * \param[in] profile : profile of the group (see UngapHitIteratorSSE16::getProfile)
+     * \param[in] j : index of the first query occurrence of the group
+     * \param[in,out] currentNbHits : number of hits tagged in the hit instance
+     */
+    virtual void computeMasks (Hit* hit, const char* profile, size_t j, u_int32_t& currentNbHits) = 0;
+
+    /** Handles the threshold mask of a subject occurrence against a group of query occurrences.
+     * \param[in] hit : hit holding the occurrences
+     * \param[in] i : index of the subject occurrence
+     * \param[in] j : index of the first query occurrence of the group
+     * \param[in] mask : one bit per query occurrence of the group, 1 if the threshold test passed
+     * \param[in,out] currentNbHits : number of hits tagged in the hit instance
+     */
+    void processMask (Hit* hit, size_t i, size_t j, u_int64_t mask, u_int32_t& currentNbHits)
+    {
+        /** We forward the hits of the first 16 query occurrences now; the other ones will be
+         *  forwarded after, in order to keep the same hits order than the SSE implementation. */
+        if (mask & 0xFFFF)  {  forwardHits (hit, i, j, mask & 0xFFFF, currentNbHits);  }
+
+        if (mask >> 16)  {  _pendingMasks.push_back (std::make_pair ((u_int32_t)i, mask >> 16));  }
+    }
+
+    /** Number of scores computed at a time. */
+    size_t _nbLanes;
+
+    /** Threshold masks (subject occurrence index, mask) whose blocks after the first one are still to be forwarded. */
+    std::vector <std::pair<u_int32_t,u_int64_t> > _pendingMasks;
+};
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _UNGAP_HIT_ITERATOR_WIDE_HPP_ */
@@ -28,6 +28,7 @@
 #include <designpattern/api/SmartPointer.hpp>
 #include <database/api/ISequence.hpp>
 #include <math.h>
+#include <vector>
 
 /********************************************************************************/
 /** \brief Statistics concepts */
@@ -109,6 +110,15 @@ public:
         return (((score * M_LN2)+ logK) / lambda);
     }
 
+    /** Same as rawToBitsValue for an integer score; the usual scores are read from a precomputed table.
+     * \param[in] score : score value
+     * \return bit score
+     */
+    inline double scoreToBits (int score)
+    {
+        return (score >= 0 && (size_t)score < _bitsTable.size()) ? _bitsTable[score] : rawToBitsValue (score);
+    }
+
     /** Returns the Evalue calculated with the score.
      * \param[in] effSearchSp : search space.
      * \param[in] score : score value
@@ -129,6 +139,11 @@ public:
     virtual bool evalueToCutoff(int&cutoff, double effSearchSp, double evalue, size_t qryLength, size_t sbjLength) = 0;
 
     virtual bool useCutoff() = 0;
+
+protected:
+
+    /** Bit scores of the scores [0..N[ (see scoreToBits). */
+    std::vector<double> _bitsTable;
 };
 
 /********************************************************************************/
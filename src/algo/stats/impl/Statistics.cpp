@@ -126,9 +126,33 @@ bool AbstractGlobalParameters::lookup (AbstractGlobalParameters* globalParams, v
 *********************************************************************/
 double AbstractGlobalParameters::scoreToEvalue(double effSearchSp, double score, size_t qryLength, size_t sbjLength)
 {
+    /** The scores are integer values most of the time, so we use the table if possible. */
+    int s = (int) score;
+    if (s == score  &&  s >= 0  &&  (size_t)s < _evalueTable.size())  {  return effSearchSp * _evalueTable[s];  }
+
 	return effSearchSp * exp((-lambda * (double) score) + logK);
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AbstractGlobalParameters::buildTables ()
+{
+    _bitsTable.resize   (TABLES_SCORE_MAX);
+    _evalueTable.resize (TABLES_SCORE_MAX);
+
+    for (int score=0; score<TABLES_SCORE_MAX; score++)
+    {
+        _bitsTable[score]   = rawToBitsValue ((double)score);
+        _evalueTable[score] = exp((-lambda * (double) score) + logK);
+    }
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -280,6 +304,7 @@ QueryInformation::QueryInformation (
       _queryDb (0),
       _subjectDbSize(subjectDbSize),
       _subjectNbSequences(subjectNbSequences),
+      _firstDb (0), _firstInfo (0),
       _isBuilt (false), _synchro(0)
 {
     /** We remind the global parameters. */
@@ -321,6 +346,9 @@ QueryInformation::~QueryInformation ()
 *********************************************************************/
 IQueryInformation::SequenceInfo& QueryInformation::getSeqInfo (const database::ISequence& seq)
 {
+    /** This method is called for each hit, so we avoid the map lookup for the usual database. */
+    if (seq.database == _firstDb)  {  return (*_firstInfo) [seq.index];  }
+
     map <ISequenceDatabase*, Container>::iterator lookup = _seqInfoMap.find (seq.database);
     if (lookup != _seqInfoMap.end())
     {
@@ -427,6 +455,13 @@ void QueryInformation::build (void)
         if  (_parameters->smallGapThreshold < 46)   {  _parameters->smallGapThreshold = 46;  }
     }
 
+    /** We keep a shortcut on the first database. */
+    if (_seqInfoMap.empty() == false)
+    {
+        _firstDb   = _seqInfoMap.begin()->first;
+        _firstInfo = &(_seqInfoMap.begin()->second);
+    }
+
     /** We memorize (for next call) that we have computed the needed information. */
     _isBuilt = true;
 }
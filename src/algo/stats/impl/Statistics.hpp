@@ -61,6 +61,9 @@ public:
 
     ~AbstractGlobalParameters () { setParameters (0); }
 
+    /** Number of scores [0..N[ whose bit scores and E-values factors are precomputed. */
+    static const int TABLES_SCORE_MAX = 8*1024;
+
     /** Structure holding statistical information. */
     struct Info
     {
@@ -94,6 +97,13 @@ protected:
     /** \copydoc IGlobalParameters::useCutoff */
     bool useCutoff() {return true;};
 
+    /** Fills the tables of the scores [0..TABLES_SCORE_MAX[ once lambda and K are known (ie. after 'build').
+     * The values are computed with the same expressions as without tables, so they are identical. */
+    virtual void buildTables ();
+
+    /** E-values factors exp(-lambda*score + logK) of the scores; the E-value of a query is the
+     *  factor multiplied by the search space of the query. */
+    std::vector<double> _evalueTable;
 };
 
 /********************************************************************************/
@@ -114,7 +124,7 @@ public:
      *
      */
     GlobalParameters (algo::core::IParameters* parameters, size_t subjectDbLength)
-        : AbstractGlobalParameters (parameters,subjectDbLength)  {  build(); }
+        : AbstractGlobalParameters (parameters,subjectDbLength)  {  build();  buildTables(); }
 
 protected:
 
@@ -182,6 +192,10 @@ private:
     /** We need a map whose key is a database. */
     std::map <database::ISequenceDatabase*, Container> _seqInfoMap;
 
+    /** Shortcut on the first database of the map (usually the only one), set once built. */
+    database::ISequenceDatabase* _firstDb;
+    Container*                   _firstInfo;
+
     bool _isBuilt;
     os::ISynchronizer* _synchro;
 
@@ -48,7 +48,7 @@ public:
      *  \param[in] subjectDbLength : Subject database length
      */
     GlobalParametersPlastn (algo::core::IParameters* parameters, size_t subjectDbLength)
-        : AbstractGlobalParameters (parameters, subjectDbLength)  { build (); }
+        : AbstractGlobalParameters (parameters, subjectDbLength)  { build ();  buildTables (); }
 
 private:
 	#define BLAST_KARLIN_LAMBDA_ACCURACY_DEFAULT    (1.e-5) /**< LAMBDA_ACCURACY_DEFAULT == accuracy to which Lambda should be calc'd */
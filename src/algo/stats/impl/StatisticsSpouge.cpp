@@ -268,10 +268,31 @@ double GlobalParametersSpouge::scoreToEvalue(double effSearchSp, double score, s
     c_y = MAX(2.0*sigma_hat_/lambda_, sigma_hat_*score+tau_hat_);
     area = p1 * p2 + c_y * P_m_F * P_n_F;
 
-    double res = area * k_ * exp(-lambda_ * score) * db_scale_factor;
+    /** The scores are integer values most of the time, so we use the table if possible. */
+    int s = (int) score;
+    double expScore = (s == score  &&  s >= 0  &&  (size_t)s < _expTable.size()) ? _expTable[s] : exp(-lambda_ * score);
+
+    double res = area * k_ * expScore * db_scale_factor;
     return res;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void GlobalParametersSpouge::buildTables ()
+{
+    AbstractGlobalParameters::buildTables ();
+
+    _expTable.resize (TABLES_SCORE_MAX);
+
+    for (int score=0; score<TABLES_SCORE_MAX; score++)  {  _expTable[score] = exp(-lambda * (double) score);  }
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -59,7 +59,7 @@ public:
      *  \param[in] subjectDbLength : Subject database length
      */
 	GlobalParametersSpouge (algo::core::IParameters* parameters, size_t subjectDbLength)
-        : AbstractGlobalParameters (parameters,subjectDbLength)  {  build(); }
+        : AbstractGlobalParameters (parameters,subjectDbLength)  {  build();  buildTables(); }
 
     /** Structure holding statistical information. */
     struct Info
@@ -90,6 +90,12 @@ protected:
 
     /** Computes statistics. */
     void build (void);
+
+    /** \copydoc AbstractGlobalParameters::buildTables */
+    void buildTables ();
+
+    /** Factors exp(-lambda*score) of the scores; the rest of the E-value depends on the sequences lengths. */
+    std::vector<double> _expTable;
 };
 
 /********************************************************************************/
@@ -124,7 +124,7 @@ public:
     /** Get the list of alignments for a given [query,subject] pair
      * \param[in] seqLevel1 : sequence at level 1 (likely the query)
      * \param[in] seqLevel2 : sequence at level 2 (likely the subject)
-     * \return the alignments list
+     * \return the alignments list (owned by the container), 0 if the pair is unknown
      */
     virtual std::list<Alignment>* getContainer (
         const database::ISequence* seqLevel1,
@@ -17,6 +17,7 @@
 #include <alignment/core/impl/AlignmentContainerFactory.hpp>
 #include <alignment/core/impl/BasicAlignmentContainer.hpp>
 #include <alignment/core/impl/ReaderAlignmentContainer.hpp>
+#include <alignment/core/impl/BinaryAlignmentReader.hpp>
 
 #include <designpattern/impl/FileLineIterator.hpp>
 #include <designpattern/impl/TokenizerIterator.hpp>
@@ -60,6 +61,8 @@ IAlignmentContainer* AlignmentContainerFactory::createContainer ()
 *********************************************************************/
 IAlignmentContainer* AlignmentContainerFactory::createContainerFromUri (const std::string& uri, void* context)
 {
+    if (BinaryAlignmentReader::isBinaryFile (uri))  {  return createContainerFromBinaryUri (uri, context);  }
+
     return createContainerFromUri (new FileLineIterator (uri.c_str()), context);
 }
 
@@ -221,6 +224,128 @@ IAlignmentContainer* AlignmentContainerFactory::createContainerFromUri (dp::impl
     return result;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the query and subject indexes are computed like in the
+**           text version (see createContainerFromUri)
+*********************************************************************/
+IAlignmentContainer* AlignmentContainerFactory::createContainerFromBinaryUri (const std::string& uri, void* context)
+{
+    BinaryAlignmentReader* reader = new BinaryAlignmentReader (uri);
+    LOCAL (reader);
+
+    /** We first create the new container. */
+    ReaderAlignmentContainer* result = new ReaderAlignmentContainer ();
+
+    /** We may recover some extra information (not very pretty...) */
+    ReaderAlignmentContainer* ref = (ReaderAlignmentContainer*) context;
+
+    /** We need some maps. */
+    std::map<std::string,int>& subjectMapComments = (ref ? ref->_subjectMapComments : result->_subjectMapComments);
+    std::map<std::string,int>& queryMapComments   = (ref ? ref->_queryMapComments   : result->_queryMapComments);
+
+    int queryIdx   = (ref != 0 ? queryMapComments.size  () : 0);
+    int subjectIdx = (ref != 0 ? subjectMapComments.size () : 0);
+
+    /** Indexes of the sequences as query and as subject, for each name of the file (-1 if not known yet). */
+    vector<int> queryIndexes;
+    vector<int> subjectIndexes;
+
+    ISequence sbjSequence;
+    ISequence qrySequence;
+
+    size_t nbAlign = 0;
+
+    BinaryAlignmentBlock block;
+    while (reader->read (block))
+    {
+        const vector<string>&    names   = reader->getNames   ();
+        const vector<u_int32_t>& lengths = reader->getLengths ();
+
+        queryIndexes.resize   (names.size(), -1);
+        subjectIndexes.resize (names.size(), -1);
+
+        for (size_t i=0; i<block.size(); i++, nbAlign++)
+        {
+            u_int32_t qryId = block.queryId[i];
+            u_int32_t sbjId = block.subjectId[i];
+
+            if (queryIndexes[qryId] < 0)
+            {
+                map<string,int>::iterator qsearch = queryMapComments.find (names[qryId]);
+                if (qsearch == queryMapComments.end())  {  queryMapComments[names[qryId]] = queryIdx;  queryIndexes[qryId] = queryIdx++;  }
+                else                                    {  queryIndexes[qryId] = qsearch->second;  }
+            }
+
+            if (subjectIndexes[sbjId] < 0)
+            {
+                map<string,int>::iterator ssearch = subjectMapComments.find (names[sbjId]);
+                if (ssearch == subjectMapComments.end())  {  subjectMapComments[names[sbjId]] = subjectIdx;  subjectIndexes[sbjId] = subjectIdx++;  }
+                else                                      {  subjectIndexes[sbjId] = ssearch->second;  }
+            }
+
+            qrySequence.index  = queryIndexes[qryId];
+            qrySequence.length = lengths[qryId];
+            sbjSequence.index  = subjectIndexes[sbjId];
+            sbjSequence.length = lengths[sbjId];
+
+            Alignment align;
+
+            align.setSequence     (Alignment::QUERY,   &qrySequence);
+            align.setSequence     (Alignment::SUBJECT, &sbjSequence);
+            align.setRange        (Alignment::QUERY,   misc::Range32 (block.queryBegin[i],   block.queryEnd[i]));
+            align.setRange        (Alignment::SUBJECT, misc::Range32 (block.subjectBegin[i], block.subjectEnd[i]));
+            align.setFrame        (Alignment::QUERY,   block.queryFrame[i]);
+            align.setFrame        (Alignment::SUBJECT, block.subjectFrame[i]);
+            align.setNbGaps       (Alignment::QUERY,   block.queryNbGaps[i]);
+            align.setNbGaps       (Alignment::SUBJECT, block.subjectNbGaps[i]);
+            align.setLength       (block.length[i]);
+            align.setNbIdentities (block.nbIdentities[i]);
+            align.setNbPositives  (block.nbPositives[i]);
+            align.setNbMisses     (block.nbMisses[i]);
+            align.setScore        (block.score[i]);
+            align.setBitScore     (block.bitScore[i]);
+            align.setEvalue       (block.evalue[i]);
+
+            /** We insert the alignment. */
+            result->insert (align, NULL);
+        }
+    }
+
+    /** Shorcuts. */
+    std::vector<std::string>&  subjectComments = result->_subjectComments;
+    std::vector<std::string>&  queryComments   = result->_queryComments;
+
+    subjectComments.resize (subjectMapComments.size());
+    for (map<string,int>::iterator it = subjectMapComments.begin(); it != subjectMapComments.end(); it++)
+    {
+        subjectComments [it->second] = it->first;
+    }
+
+    queryComments.resize (queryMapComments.size());
+    for (map<string,int>::iterator it = queryMapComments.begin(); it != queryMapComments.end(); it++)
+    {
+        queryComments [it->second] = it->first;
+    }
+
+    /** We have now to associate a comment on each ISequence. */
+    result->setComments ();
+
+    DEBUG (cout <<  "AlignmentContainerFactory::createContainerFromBinaryUri:  "
+            << "    nbQry="   << queryComments.size()
+            << "    nbSbj="   << subjectComments.size()
+            << "    nbAlign=" << nbAlign
+            << endl
+    );
+
+    /** We return the result. */
+    return result;
+}
+
 /********************************************************************************/
 }}} /* end of namespaces. */
 /********************************************************************************/
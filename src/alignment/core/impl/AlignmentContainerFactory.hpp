@@ -41,8 +41,8 @@ namespace impl      {
  * can do with -outfmt 6). This is useful for instance for GatTool that reads result
  * files through this API; it can then compare alignments containers from two results
  * files (one from blast, one from plast for instance) and estimate the global overlap
- * between the two containers.
- *
+ * between the two containers. Files in the binary format (see BinaryOutputVisitor) are
+ * detected and loaded without text parsing.
  */
 class AlignmentContainerFactory : public IAlignmentContainerFactory
 {
@@ -63,6 +63,12 @@ public:
 
     /** \copydoc IAlignmentContainerFactory::createContainerFromUri(dp::impl::FileLineIterator*,void*)  */
     IAlignmentContainer* createContainerFromUri (dp::impl::FileLineIterator* it, void* context=0);
+
+    /** Creates a container from a file in the binary format (see BinaryAlignmentReader).
+     * \param[in] uri : path of the binary file.
+     * \param[in] context : same as for createContainerFromUri.
+     * \return the created container. */
+    IAlignmentContainer* createContainerFromBinaryUri (const std::string& uri, void* context=0);
 };
 
 /********************************************************************************/
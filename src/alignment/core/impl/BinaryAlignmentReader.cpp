@@ -0,0 +1,264 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+#include <alignment/core/impl/BinaryAlignmentReader.hpp>
+
+#include <string.h>
+
+#define DEBUG(a)  //printf a
+
+using namespace std;
+
+/********************************************************************************/
+namespace alignment {
+namespace core      {
+namespace impl      {
+/********************************************************************************/
+
+const char* BinaryAlignmentReader::MAGIC = "PLASTALN";
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BinaryAlignmentBlock::clear ()
+{
+    resize (0);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BinaryAlignmentBlock::resize (size_t nb)
+{
+    queryId.resize       (nb);
+    subjectId.resize     (nb);
+    queryBegin.resize    (nb);
+    queryEnd.resize      (nb);
+    subjectBegin.resize  (nb);
+    subjectEnd.resize    (nb);
+    queryFrame.resize    (nb);
+    subjectFrame.resize  (nb);
+    queryNbGaps.resize   (nb);
+    subjectNbGaps.resize (nb);
+    length.resize        (nb);
+    nbIdentities.resize  (nb);
+    nbPositives.resize   (nb);
+    nbMisses.resize      (nb);
+    score.resize         (nb);
+    bitScore.resize      (nb);
+    evalue.resize        (nb);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BinaryAlignmentReader::BinaryAlignmentReader (const std::string& uri)
+    : _file(0)
+{
+    if (isBinaryFile (uri) == false)  { throw "not a binary alignments file"; }
+
+    _file = fopen (uri.c_str(), "rb");
+    if (_file == 0)  { throw "unable to open the binary alignments file"; }
+
+    char magic [MAGIC_SIZE];
+    readBytes (magic, MAGIC_SIZE);
+
+    if (readInt() >  VERSION)      { throw "unsupported version of the binary alignments file"; }
+    if (readInt() != ORDER_MARKER) { throw "bad byte order of the binary alignments file";       }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BinaryAlignmentReader::~BinaryAlignmentReader ()
+{
+    if (_file != 0)  { fclose (_file); }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool BinaryAlignmentReader::isBinaryFile (const std::string& uri)
+{
+    bool result = false;
+
+    FILE* file = fopen (uri.c_str(), "rb");
+    if (file != 0)
+    {
+        char magic [MAGIC_SIZE];
+        result = fread (magic, 1, MAGIC_SIZE, file) == MAGIC_SIZE  &&  memcmp (magic, MAGIC, MAGIC_SIZE) == 0;
+        fclose (file);
+    }
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool BinaryAlignmentReader::read (BinaryAlignmentBlock& block)
+{
+    block.clear ();
+
+    /** We check whether there is another block. */
+    u_int32_t nbNames = 0;
+    if (fread (&nbNames, sizeof(nbNames), 1, _file) != 1)  { return false; }
+
+    /** We read the names added by this block. */
+    for (u_int32_t i=0; i<nbNames; i++)
+    {
+        string name (readInt(), ' ');
+        if (name.empty() == false)  { readBytes (&name[0], name.size()); }
+
+        _names.push_back   (name);
+        _lengths.push_back (readInt());
+    }
+
+    size_t nbAlign   = readInt ();
+    size_t nbColumns = readInt ();
+
+    DEBUG (("BinaryAlignmentReader::read  nbNames=%d  nbAlign=%ld  nbColumns=%ld\n", nbNames, nbAlign, nbColumns));
+
+    /** We read the columns we know, in the order of the format. */
+    for (size_t col=0; col<nbColumns; col++)
+    {
+        switch (col)
+        {
+            case BinaryAlignmentBlock::QUERY_ID:         readColumn (block.queryId,       nbAlign);  break;
+            case BinaryAlignmentBlock::SUBJECT_ID:       readColumn (block.subjectId,     nbAlign);  break;
+            case BinaryAlignmentBlock::QUERY_BEGIN:      readColumn (block.queryBegin,    nbAlign);  break;
+            case BinaryAlignmentBlock::QUERY_END:        readColumn (block.queryEnd,      nbAlign);  break;
+            case BinaryAlignmentBlock::SUBJECT_BEGIN:    readColumn (block.subjectBegin,  nbAlign);  break;
+            case BinaryAlignmentBlock::SUBJECT_END:      readColumn (block.subjectEnd,    nbAlign);  break;
+            case BinaryAlignmentBlock::QUERY_FRAME:      readColumn (block.queryFrame,    nbAlign);  break;
+            case BinaryAlignmentBlock::SUBJECT_FRAME:    readColumn (block.subjectFrame,  nbAlign);  break;
+            case BinaryAlignmentBlock::QUERY_NB_GAPS:    readColumn (block.queryNbGaps,   nbAlign);  break;
+            case BinaryAlignmentBlock::SUBJECT_NB_GAPS:  readColumn (block.subjectNbGaps, nbAlign);  break;
+            case BinaryAlignmentBlock::LENGTH:           readColumn (block.length,        nbAlign);  break;
+            case BinaryAlignmentBlock::NB_IDENTITIES:    readColumn (block.nbIdentities,  nbAlign);  break;
+            case BinaryAlignmentBlock::NB_POSITIVES:     readColumn (block.nbPositives,   nbAlign);  break;
+            case BinaryAlignmentBlock::NB_MISSES:        readColumn (block.nbMisses,      nbAlign);  break;
+            case BinaryAlignmentBlock::SCORE:            readColumn (block.score,         nbAlign);  break;
+            case BinaryAlignmentBlock::BITSCORE:         readColumn (block.bitScore,      nbAlign);  break;
+            case BinaryAlignmentBlock::EVALUE:           readColumn (block.evalue,        nbAlign);  break;
+            default:                                     skipColumn ();                               break;
+        }
+    }
+
+    /** The columns missing in the file (older version) are filled with 0. */
+    block.resize (nbAlign);
+
+    /** We check the ids, so clients can use them without care. */
+    for (size_t i=0; i<nbAlign; i++)
+    {
+        if (block.queryId[i] >= _names.size() || block.subjectId[i] >= _names.size())  { throw "bad sequence id in the binary alignments file"; }
+    }
+
+    return true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int32_t BinaryAlignmentReader::readInt ()
+{
+    u_int32_t result = 0;
+    readBytes (&result, sizeof(result));
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BinaryAlignmentReader::readBytes (void* buffer, size_t size)
+{
+    if (size > 0  &&  fread (buffer, 1, size, _file) != size)  { throw "truncated binary alignments file"; }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<typename T> void BinaryAlignmentReader::readColumn (std::vector<T>& column, size_t nb)
+{
+    size_t size = readInt ();
+    if (size != nb * sizeof(T))  { throw "bad column size in the binary alignments file"; }
+
+    column.resize (nb);
+    if (nb > 0)  { readBytes (&column[0], size); }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BinaryAlignmentReader::skipColumn ()
+{
+    size_t size = readInt ();
+    if (fseek (_file, size, SEEK_CUR) != 0)  { throw "truncated binary alignments file"; }
+}
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
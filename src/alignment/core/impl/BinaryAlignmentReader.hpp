@@ -0,0 +1,176 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+/** \file BinaryAlignmentReader.hpp
+ *  \brief Reader of the binary columnar alignments format.
+ */
+
+#ifndef _BINARY_ALIGNMENT_READER_HPP_
+#define _BINARY_ALIGNMENT_READER_HPP_
+
+/********************************************************************************/
+
+#include <designpattern/api/SmartPointer.hpp>
+#include <misc/api/types.hpp>
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/********************************************************************************/
+namespace alignment {
+namespace core      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Columns of a block of alignments of the binary format
+ *
+ * A binary alignments file (see alignment::visitors::impl::BinaryOutputVisitor) is made of:
+ *   - a header: the 8 characters "PLASTALN", the format version (u_int32_t) and the
+ *     0x01020304 marker (u_int32_t) telling the byte order of the file.
+ *   - blocks of alignments, each one made of:
+ *       - the names added to the names table by the block: their number (u_int32_t), then for
+ *         each name its size (u_int32_t), its characters and the length of the sequence (u_int32_t).
+ *       - the number of alignments of the block (u_int32_t) and the number of columns (u_int32_t).
+ *       - the columns, in the order of the Column enum; each column is its size in bytes (u_int32_t)
+ *         followed by the values of the alignments.
+ *
+ * The query and subject ids are indexes in the names table of the whole file; the ranges start
+ * at 0. Readers skip the columns they don't know, so columns can be appended to the format.
+ */
+struct BinaryAlignmentBlock
+{
+    /** Columns of the format, in the order of the file. */
+    enum Column
+    {
+        QUERY_ID, SUBJECT_ID,
+        QUERY_BEGIN, QUERY_END, SUBJECT_BEGIN, SUBJECT_END,
+        QUERY_FRAME, SUBJECT_FRAME,
+        QUERY_NB_GAPS, SUBJECT_NB_GAPS,
+        LENGTH, NB_IDENTITIES, NB_POSITIVES, NB_MISSES,
+        SCORE, BITSCORE, EVALUE,
+        NB_COLUMNS
+    };
+
+    std::vector<u_int32_t> queryId;
+    std::vector<u_int32_t> subjectId;
+    std::vector<u_int32_t> queryBegin;
+    std::vector<u_int32_t> queryEnd;
+    std::vector<u_int32_t> subjectBegin;
+    std::vector<u_int32_t> subjectEnd;
+    std::vector<int8_t>    queryFrame;
+    std::vector<int8_t>    subjectFrame;
+    std::vector<u_int16_t> queryNbGaps;
+    std::vector<u_int16_t> subjectNbGaps;
+    std::vector<u_int32_t> length;
+    std::vector<u_int32_t> nbIdentities;
+    std::vector<u_int32_t> nbPositives;
+    std::vector<u_int32_t> nbMisses;
+    std::vector<u_int32_t> score;
+    std::vector<double>    bitScore;
+    std::vector<double>    evalue;
+
+    /** Number of alignments of the block. */
+    size_t size () const  { return queryId.size(); }
+
+    /** Removes all the alignments. */
+    void clear ();
+
+    /** Resizes all the columns. */
+    void resize (size_t nb);
+};
+
+/********************************************************************************/
+
+/** \brief Reader of the binary columnar alignments format
+ *
+ * The file is read block by block; the names table grows with the blocks read so far.
+ * The values are not parsed, they are copied as they are into the columns.
+ *
+ * Code sample:
+ * \code
+ * void sample ()
+ * {
+ *     BinaryAlignmentReader reader ("/tmp/result.bin");
+ *
+ *     BinaryAlignmentBlock block;
+ *     while (reader.read (block))
+ *     {
+ *         for (size_t i=0; i<block.size(); i++)
+ *         {
+ *             printf ("%s %s %g\n", reader.getNames()[block.queryId[i]].c_str(),
+ *                 reader.getNames()[block.subjectId[i]].c_str(), block.evalue[i]);
+ *         }
+ *     }
+ * }
+ * \endcode
+ */
+class BinaryAlignmentReader : public dp::SmartPointer
+{
+public:
+
+    /** Magic string at the beginning of the files. */
+    static const char*     MAGIC;
+    static const size_t    MAGIC_SIZE = 8;
+    static const u_int32_t VERSION    = 1;
+    static const u_int32_t ORDER_MARKER = 0x01020304;
+
+    /** Constructor. Reads the header of the file and throws an exception if the file is not in the binary format.
+     * \param[in] uri : path of the file. */
+    BinaryAlignmentReader (const std::string& uri);
+
+    /** Destructor. */
+    virtual ~BinaryAlignmentReader ();
+
+    /** Tells whether a file is in the binary format (by checking its magic string).
+     * \param[in] uri : path of the file.
+     * \return true if the file is a binary alignments file. */
+    static bool isBinaryFile (const std::string& uri);
+
+    /** Reads the next block of alignments.
+     * \param[out] block : the alignments of the block.
+     * \return false if there is no more block. */
+    bool read (BinaryAlignmentBlock& block);
+
+    /** Names of the sequences (from the blocks read so far). */
+    const std::vector<std::string>& getNames   ()  { return _names;   }
+
+    /** Lengths of the sequences (from the blocks read so far). */
+    const std::vector<u_int32_t>&   getLengths ()  { return _lengths; }
+
+private:
+
+    FILE* _file;
+
+    std::vector<std::string> _names;
+    std::vector<u_int32_t>   _lengths;
+
+    /** Reads a value, throws an exception if the file is truncated. */
+    u_int32_t readInt ();
+    void      readBytes (void* buffer, size_t size);
+
+    /** Reads a column of values into a vector of nb items (the missing values are set to 0). */
+    template<typename T> void readColumn (std::vector<T>& column, size_t nb);
+
+    /** Skips a column unknown by this version. */
+    void skipColumn ();
+};
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _BINARY_ALIGNMENT_READER_HPP_ */
@@ -0,0 +1,785 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+
+#include <alignment/core/impl/FlatAlignmentContainer.hpp>
+
+#include <os/impl/DefaultOsFactory.hpp>
+#include <misc/api/macros.hpp>
+
+#include <algorithm>
+
+#include <stdio.h>
+#define DEBUG(a) //printf a
+
+using namespace std;
+using namespace dp;
+using namespace os;
+using namespace os::impl;
+using namespace database;
+
+/********************************************************************************/
+namespace alignment {
+namespace core      {
+namespace impl      {
+/********************************************************************************/
+
+/** Definition of the static constant (needed when passed by reference). */
+const u_int32_t FlatAlignmentContainer::NONE;
+
+/** We need a functor for sorting alignments (see BasicAlignmentContainer::shrink). */
+struct FlatSortAlignmentsFunctor  { bool operator() (const Alignment& i, const Alignment& j)
+{
+    return i.getBitScore() > j.getBitScore();
+}};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+FlatAlignmentContainer::Stripe::Stripe ()  : synchro(0)
+{
+    synchro = DefaultFactory::thread().newSynchronizer();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+FlatAlignmentContainer::Stripe::~Stripe ()
+{
+    /** We have to get rid of all copied ISequence instances. */
+    for (map<Key,ISequence*>::iterator it = queries.begin();  it != queries.end();  ++it)  {  delete it->second;  }
+    for (size_t i=0; i<hits.size(); i++)  {  release (hits[i]);  }
+
+    if (synchro)  { delete synchro; }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int32_t* FlatAlignmentContainer::Stripe::lookup (const Key& key1, const Key& key2)
+{
+    /** The table is created at the first call. */
+    if (hitsTable.empty())  {  buildHitsTable ();  }
+
+    u_int64_t h = (u_int64_t)key1.second * 0x9E3779B97F4A7C15ULL;
+    h ^= ((u_int64_t)key2.second + ((u_int64_t)key2.first >> 4)) * 0xC2B2AE3D27D4EB4FULL;
+    h ^= ((u_int64_t)key1.first >> 4);
+    h ^= h >> 29;
+
+    size_t mask = hitsTable.size() - 1;
+
+    /** Linear probing; the table is never more than half full, so there is always an empty slot. */
+    for (size_t i = h & mask; ; i = (i+1) & mask)
+    {
+        u_int32_t& slot = hitsTable[i];
+
+        if (slot == NONE  ||  (hits[slot].key1 == key1  &&  hits[slot].key2 == key2))  {  return &slot;  }
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int32_t FlatAlignmentContainer::Stripe::addHit (const Hit& hit)
+{
+    u_int32_t idx = hits.size();
+    hits.push_back (hit);
+
+    if (2*hits.size() > hitsTable.size())  {  buildHitsTable ();  }
+    else                                   {  *lookup (hit.key1, hit.key2) = idx;  }
+
+    return idx;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void FlatAlignmentContainer::Stripe::buildHitsTable ()
+{
+    size_t size = 64;
+    while (size < 4*hits.size())  {  size <<= 1;  }
+
+    hitsTable.assign (size, NONE);
+
+    for (size_t i=0; i<hits.size(); i++)  {  *lookup (hits[i].key1, hits[i].key2) = i;  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+struct SortHitsIndexFunctor
+{
+    SortHitsIndexFunctor (const vector<FlatAlignmentContainer::Hit>& hits) : _hits(hits) {}
+
+    bool operator() (u_int32_t i, u_int32_t j)
+    {
+        const FlatAlignmentContainer::Hit& a = _hits[i];
+        const FlatAlignmentContainer::Hit& b = _hits[j];
+        return (a.key1 < b.key1) || (a.key1 == b.key1 && a.key2 < b.key2);
+    }
+
+    const vector<FlatAlignmentContainer::Hit>& _hits;
+};
+
+void FlatAlignmentContainer::Stripe::getSortedHits (vector<u_int32_t>& order)
+{
+    order.resize (hits.size());
+    for (size_t i=0; i<order.size(); i++)  { order[i] = i; }
+
+    std::sort (order.begin(), order.end(), SortHitsIndexFunctor (hits));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool FlatAlignmentContainer::Stripe::isInContainer (const Hit* hit, const misc::Range32& sbjRange, const misc::Range32& qryRange)
+{
+    bool found = false;
+
+    if (hit != 0)
+    {
+        for (u_int32_t i=hit->first; !found && i!=NONE; i=entries[i].next)
+        {
+            const Alignment& a = entries[i].align;
+
+            found = a.getRange(Alignment::SUBJECT).includes (sbjRange)  &&  a.getRange(Alignment::QUERY).includes (qryRange);
+        }
+    }
+
+    return found;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+FlatAlignmentContainer::FlatAlignmentContainer (size_t nbHitPerQuery, size_t nbHspPerHit, size_t nbStripes)
+    : _nbHitPerQuery(nbHitPerQuery), _nbHspPerHit(nbHspPerHit)
+{
+    DEBUG (("FlatAlignmentContainer::FlatAlignmentContainer  nbStripes=%ld\n", nbStripes));
+
+    _stripes.resize (MAX (nbStripes, (size_t)1));
+    for (size_t i=0; i<_stripes.size(); i++)  {  _stripes[i] = new Stripe ();  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+FlatAlignmentContainer::~FlatAlignmentContainer ()
+{
+    DEBUG (("FlatAlignmentContainer::~FlatAlignmentContainer\n"));
+
+    for (size_t i=0; i<_stripes.size(); i++)  {  delete _stripes[i];  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool FlatAlignmentContainer::doesExist (const Alignment& align)
+{
+    const ISequence* seqLevel1 = align.getSequence(Alignment::QUERY);
+    const ISequence* seqLevel2 = align.getSequence(Alignment::SUBJECT);
+
+    if (seqLevel1 == 0  ||  seqLevel2 == 0)  { return false; }
+
+    Stripe& stripe = getStripe (seqLevel1);
+
+    /** We need to be protected against concurrent accesses. */
+    LocalSynchronizer local (stripe.synchro);
+
+    return stripe.isInContainer (
+        stripe.getHit (seqLevel1, seqLevel2),
+        align.getRange(Alignment::SUBJECT),
+        align.getRange(Alignment::QUERY)
+    );
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool FlatAlignmentContainer::doesExist (
+    const indexation::ISeedOccurrence* subOccur,
+    const indexation::ISeedOccurrence* qryOccur,
+    u_int32_t bandLength
+)
+{
+    bool found = false;
+
+    /** We determine first and second level sequences for the search. */
+    const ISequence* seqLevel1  = & (qryOccur->sequence);
+    const ISequence* seqLevel2  = & (subOccur->sequence);
+
+    Stripe& stripe = getStripe (seqLevel1);
+
+    /** We need to be protected against concurrent accesses. */
+    LocalSynchronizer local (stripe.synchro);
+
+    Hit* hit = stripe.getHit (seqLevel1, seqLevel2);
+    if (hit != 0)
+    {
+        size_t subLen = seqLevel2->data.letters.size;
+        size_t qryLen = seqLevel1->data.letters.size;
+
+        misc::Range32 sbjRange (
+            subOccur->offsetInSequence >= bandLength           ? subOccur->offsetInSequence - bandLength : 0,
+            subOccur->offsetInSequence  + bandLength <  subLen ? subOccur->offsetInSequence + bandLength : subLen-1
+        );
+
+        misc::Range32 qryRange (
+            qryOccur->offsetInSequence >= bandLength           ? qryOccur->offsetInSequence - bandLength : 0,
+            qryOccur->offsetInSequence  + bandLength <  qryLen ? qryOccur->offsetInSequence + bandLength : qryLen-1
+        );
+
+        found = stripe.isInContainer (hit, sbjRange, qryRange);
+    }
+
+    return found;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool FlatAlignmentContainer::insertFirstLevel (const database::ISequence* firstLevelSeq)
+{
+    Stripe& stripe = getStripe (firstLevelSeq);
+
+    LocalSynchronizer local (stripe.synchro);
+
+    Key firstKey (firstLevelSeq->database, firstLevelSeq->index);
+
+    if (stripe.queries.find (firstKey) == stripe.queries.end())
+    {
+        /** We copy the provided sequence. */
+        stripe.queries [firstKey] = new ISequence (*firstLevelSeq);
+    }
+
+    return true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool FlatAlignmentContainer::doesFirstLevelExists (const database::ISequence* firstLevelSeq)
+{
+    Stripe& stripe = getStripe (firstLevelSeq);
+
+    LocalSynchronizer local (stripe.synchro);
+
+    return stripe.queries.find (Key (firstLevelSeq->database, firstLevelSeq->index)) != stripe.queries.end();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int32_t FlatAlignmentContainer::getFirstLevelNumber ()
+{
+    u_int32_t result = 0;
+    for (size_t i=0; i<_stripes.size(); i++)  {  result += _stripes[i]->queries.size();  }
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int32_t FlatAlignmentContainer::getSecondLevelNumber ()
+{
+    u_int32_t result = 0;
+    for (size_t i=0; i<_stripes.size(); i++)  {  result += _stripes[i]->hits.size();  }
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : same rules as BasicAlignmentContainer::insert
+*********************************************************************/
+bool FlatAlignmentContainer::insert (Alignment& align, void* context)
+{
+    /** We determine first and second level sequences for the search. */
+    ISequence* seqLevel1 = (ISequence*) align.getSequence(Alignment::QUERY);
+    ISequence* seqLevel2 = (ISequence*) align.getSequence(Alignment::SUBJECT);
+
+    /** Some check. */
+    if (seqLevel1 == 0  ||  seqLevel2 == 0)  { return false; }
+
+    Stripe& stripe = getStripe (seqLevel1);
+
+    /** We need to be protected against concurrent accesses. */
+    LocalSynchronizer local (stripe.synchro);
+
+    /** We look for the first level entry. */
+    Key firstKey (seqLevel1->database,seqLevel1->index);
+    map<Key,ISequence*>::iterator lookFirstLevel = stripe.queries.find (firstKey);
+    if (lookFirstLevel == stripe.queries.end())
+    {
+        /** We copy the provided sequence. */
+        seqLevel1 = new ISequence (*seqLevel1);
+        stripe.queries [firstKey] = seqLevel1;
+    }
+    else
+    {
+        seqLevel1 = lookFirstLevel->second;
+    }
+
+    /** We look for the hit. */
+    Key secondKey (seqLevel2->database,seqLevel2->index);
+
+    u_int32_t hitIdx = *stripe.lookup (firstKey, secondKey);
+    if (hitIdx == NONE)
+    {
+        /** We copy the provided sequence; the copy belongs to the hit. Note that it can't be shared
+         *  with other hits through its key, since a database of a previous block may have had the
+         *  same address. */
+        seqLevel2 = new ISequence (*seqLevel2);
+
+        hitIdx = stripe.addHit (Hit (firstKey, secondKey, seqLevel1, seqLevel2));
+    }
+
+    Hit& hit = stripe.hits[hitIdx];
+
+    /** We can update the alignment sequences references (see BasicAlignmentContainer::insert). */
+    align.setSequence (Alignment::QUERY,   hit.seqLevel1);
+    align.setSequence (Alignment::SUBJECT, hit.seqLevel2);
+
+    /** We look for an alignment including the new one (and with a better score); the alignments
+     *  included in the new one are removed from the chain. */
+    bool foundBiggerAlignment = false;
+
+    for (u_int32_t i=hit.first, prev=NONE;  i!=NONE;  )
+    {
+        const Alignment& current = stripe.entries[i].align;
+        u_int32_t        next    = stripe.entries[i].next;
+
+        foundBiggerAlignment = current.getRange(Alignment::SUBJECT).includes (align.getRange(Alignment::SUBJECT))  &&
+            current.getRange(Alignment::QUERY).includes (align.getRange(Alignment::QUERY)) &&
+            (current.getScore() >= align.getScore());
+
+        if (foundBiggerAlignment)  { break; }
+
+        bool foundIncludedAlign = align.getRange(Alignment::SUBJECT).includes (current.getRange(Alignment::SUBJECT))  &&
+            align.getRange(Alignment::QUERY).includes (current.getRange(Alignment::QUERY));
+
+        if (foundIncludedAlign)
+        {
+            /** We unlink the entry; its cell will be reclaimed at the next rewrite (accept or shrink). */
+            if (prev != NONE)  {  stripe.entries[prev].next = next;  }  else  {  hit.first = next;  }
+            if (hit.last == i) {  hit.last = prev;  }
+            hit.nb--;
+
+            for (u_int32_t n=_nbAlignments; n>0 && !__sync_bool_compare_and_swap (&_nbAlignments, n, n-1); n=_nbAlignments)  {}
+        }
+        else
+        {
+            prev = i;
+        }
+
+        i = next;
+    }
+
+    if (!foundBiggerAlignment)
+    {
+        /** Finally, we can simply append the alignment into the container. */
+        u_int32_t idx = stripe.entries.size();
+        stripe.entries.push_back (Entry (align));
+
+        if (hit.last != NONE)  {  stripe.entries[hit.last].next = idx;  }  else  {  hit.first = idx;  }
+        hit.last = idx;
+        hit.nb++;
+
+        __sync_fetch_and_add (&_nbAlignments, 1);
+    }
+
+    stripe.updateContainer (hit);
+
+    return foundBiggerAlignment;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : note that the order of the hits doesn't matter since the rules of
+**           insert only involve the alignments of the same hit.
+*********************************************************************/
+void FlatAlignmentContainer::merge (const std::vector<IAlignmentContainer*> containers)
+{
+    for (size_t i=0; i<containers.size(); i++)
+    {
+        FlatAlignmentContainer* current = dynamic_cast<FlatAlignmentContainer*> (containers[i]);
+
+        if (current == 0  ||  current == this)  { continue; }
+
+        for (size_t s=0; s<current->_stripes.size(); s++)
+        {
+            Stripe& stripe = *(current->_stripes[s]);
+
+            for (size_t h=0; h<stripe.hits.size(); h++)
+            {
+                for (u_int32_t k=stripe.hits[h].first; k!=NONE; k=stripe.entries[k].next)
+                {
+                    Alignment align = stripe.entries[k].align;
+                    this->insert (align, 0);
+                }
+            }
+        }
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the visit order is the one of BasicAlignmentContainer (queries and
+**           then subjects sorted by keys).
+*********************************************************************/
+struct FlatQueryRef
+{
+    FlatQueryRef (const pair<database::ISequenceDatabase*,u_int32_t>& k, ISequence* s, size_t st) : key(k), seq(s), stripe(st) {}
+    pair<database::ISequenceDatabase*,u_int32_t> key;
+    ISequence* seq;
+    size_t     stripe;
+    bool operator< (const FlatQueryRef& o) const  { return key < o.key; }
+};
+
+void FlatAlignmentContainer::accept (IAlignmentContainerVisitor* visitor)
+{
+    /** We need to be protected against concurrent accesses. */
+    LocalSynchronizer local (_synchro);
+
+    size_t nbStripes = _stripes.size();
+
+    /** We gather the queries of all the stripes and sort them. */
+    vector<FlatQueryRef> queries;
+    for (size_t s=0; s<nbStripes; s++)
+    {
+        for (map<Key,ISequence*>::iterator it = _stripes[s]->queries.begin(); it != _stripes[s]->queries.end(); ++it)
+        {
+            queries.push_back (FlatQueryRef (it->first, it->second, s));
+        }
+    }
+    std::sort (queries.begin(), queries.end());
+
+    /** We sort the hits of each stripe; since the queries are sorted too, each stripe is read sequentially. */
+    vector < vector<u_int32_t> > order   (nbStripes);
+    vector < size_t >            cursor  (nbStripes, 0);
+    vector < vector<Entry> >     entries (nbStripes);
+
+    for (size_t s=0; s<nbStripes; s++)
+    {
+        _stripes[s]->getSortedHits (order[s]);
+        entries[s].reserve (_stripes[s]->entries.size());
+    }
+
+    DEBUG (("FlatAlignmentContainer::accept  nbQueries=%ld\n", queries.size()));
+
+    misc::ProgressInfo level1Progress (1, queries.size ());
+
+    list<Alignment> alignments;
+
+    for (size_t q=0; q<queries.size(); q++, ++level1Progress)
+    {
+        /** Shortcuts. */
+        Stripe&                 stripe    = *(_stripes[queries[q].stripe]);
+        vector<u_int32_t>&      hitsOrder = order  [queries[q].stripe];
+        size_t&                 first     = cursor [queries[q].stripe];
+        ISequence*              seqLevel1 = queries[q].seq;
+
+        /** We call the visitor. */
+        visitor->visitQuerySequence (seqLevel1, level1Progress);
+
+        /** We look for the hits of the query. */
+        size_t last = first;
+        while (last < hitsOrder.size()  &&  stripe.hits[hitsOrder[last]].key1 == queries[q].key)  { last++; }
+
+        misc::ProgressInfo level2Progress (1, last - first);
+
+        for ( ; first < last; first++, ++level2Progress)
+        {
+            Hit& hit = stripe.hits [hitsOrder[first]];
+
+            /** We call the visitor for the subject. */
+            visitor->visitSubjectSequence (hit.seqLevel2, level2Progress);
+
+            /** We call the visitor for the list of alignments. */
+            alignments.clear ();
+            stripe.getAlignments (hit, alignments);
+
+            visitor->visitAlignmentsList (seqLevel1, hit.seqLevel2, alignments);
+
+            /** The visitor may have modified the alignments; we rewrite them contiguously. */
+            Stripe::setAlignments (hit, alignments.begin(), alignments.end(), entries[queries[q].stripe]);
+        }
+    }
+
+    /** The new entries replace the previous ones. */
+    for (size_t s=0; s<nbStripes; s++)
+    {
+        _stripes[s]->entries.swap (entries[s]);
+
+        for (size_t h=0; h<_stripes[s]->hits.size(); h++)  {  _stripes[s]->updateContainer (_stripes[s]->hits[h]);  }
+    }
+
+    /** We may want to have extra process to be done by the visitor at the end of the visit. */
+    visitor->postVisit (this);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : same process as BasicAlignmentContainer::shrink
+*********************************************************************/
+
+/** We need a functor for sorting hits (see SortHitsFunctor in BasicAlignmentContainer). */
+struct FlatSortHitsFunctor
+{
+    FlatSortHitsFunctor (const vector<Alignment>& alignments, const vector<size_t>& firsts, const vector<size_t>& lasts)
+        : _alignments(alignments), _firsts(firsts), _lasts(lasts) {}
+
+    bool operator() (size_t i, size_t j)
+    {
+        /** A hit without alignment is considered as the worst one. */
+        if (_firsts[i] == _lasts[i])  { return false; }
+        if (_firsts[j] == _lasts[j])  { return true;  }
+
+        /** Shortcuts. */
+        const Alignment& a = _alignments[_firsts[i]];
+        const Alignment& b = _alignments[_firsts[j]];
+
+        return (a.getBitScore() >  b.getBitScore()) ||
+           /** Due to BLAST strange ordering, we have to sort the subjects by decreasing indexes... */
+               (a.getBitScore()                          == b.getBitScore()  &&
+                a.getFrame(Alignment::SUBJECT)           == b.getFrame(Alignment::SUBJECT) &&
+                a.getSequence(Alignment::SUBJECT)->index >  b.getSequence(Alignment::SUBJECT)->index) ||
+               (a.getBitScore() == b.getBitScore()  &&  a.getFrame(Alignment::SUBJECT) > b.getFrame(Alignment::SUBJECT));
+    }
+
+    const vector<Alignment>& _alignments;
+    const vector<size_t>&    _firsts;
+    const vector<size_t>&    _lasts;
+};
+
+/** Functor for sorting hits by their (new) subject key. */
+struct FlatSortHitsByKeyFunctor
+{
+    FlatSortHitsByKeyFunctor (const vector<FlatAlignmentContainer::Hit>& hits) : _hits(hits) {}
+    bool operator() (size_t i, size_t j)  {  return _hits[i].key2 < _hits[j].key2;  }
+    const vector<FlatAlignmentContainer::Hit>& _hits;
+};
+
+void FlatAlignmentContainer::shrink ()
+{
+    /** We need to be protected against concurrent accesses. */
+    LocalSynchronizer local (_synchro);
+
+    FlatSortAlignmentsFunctor sortAlign;
+
+    for (size_t s=0; s<_stripes.size(); s++)
+    {
+        Stripe& stripe = *(_stripes[s]);
+
+        vector<u_int32_t> order;
+        stripe.getSortedHits (order);
+
+        vector<Hit>   newHits;
+        vector<Entry> newEntries;
+        newHits.reserve    (stripe.hits.size());
+        newEntries.reserve (stripe.entries.size());
+
+        /** The hits of one query are contiguous in 'order'. */
+        for (size_t first=0, last=0; first < order.size(); first=last)
+        {
+            while (last < order.size()  &&  stripe.hits[order[last]].key1 == stripe.hits[order[first]].key1)  { last++; }
+
+            size_t nbHits = last - first;
+
+            vector<Hit>       hits;
+            vector<Alignment> alignments;
+            vector<size_t>    firsts (nbHits), lasts (nbHits), rank (nbHits);
+
+            /** FIRST: we sort the alignments of each hit and keep the best ones. */
+            for (size_t i=0; i<nbHits; i++)
+            {
+                hits.push_back (stripe.hits [order[first+i]]);
+
+                firsts[i] = alignments.size();
+                stripe.getAlignments (hits[i], alignments);
+
+                std::stable_sort (alignments.begin() + firsts[i], alignments.end(), sortAlign);
+
+                if (_nbHspPerHit > 0  &&  alignments.size() - firsts[i] > _nbHspPerHit)
+                {
+                    alignments.resize (firsts[i] + _nbHspPerHit);
+                }
+
+                lasts[i] = alignments.size();
+                rank [i] = i;
+            }
+
+            /** SECOND: we sort the hits (best ones first) and we 'cheat' on the subject key index. */
+            std::stable_sort (rank.begin(), rank.end(), FlatSortHitsFunctor (alignments, firsts, lasts));
+
+            for (size_t i=0; i<nbHits; i++)  {  hits[rank[i]].key2.second = i;  }
+
+            /** The hits are now ordered as in a map with the new keys; we keep the first ones. */
+            std::sort (rank.begin(), rank.end(), FlatSortHitsByKeyFunctor (hits));
+
+            for (size_t i=0; i<nbHits; i++)
+            {
+                Hit& hit = hits[rank[i]];
+
+                if (_nbHitPerQuery == 0  ||  i < _nbHitPerQuery)
+                {
+                    Stripe::setAlignments (hit, alignments.begin() + firsts[rank[i]], alignments.begin() + lasts[rank[i]], newEntries);
+                    newHits.push_back (hit);
+                }
+                else
+                {
+                    /** We delete the subject sequence copy of the removed hit (as BasicAlignmentContainer does). */
+                    Stripe::release (hit);
+                }
+            }
+        }
+
+        /** We replace the content of the stripe. */
+        stripe.hits.swap    (newHits);
+        stripe.entries.swap (newEntries);
+
+        stripe.buildHitsTable ();
+
+        for (size_t h=0; h<stripe.hits.size(); h++)  {  stripe.updateContainer (stripe.hits[h]);  }
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+std::list<Alignment>* FlatAlignmentContainer::getContainer (
+    const database::ISequence* seqLevel1,
+    const database::ISequence* seqLevel2
+)
+{
+    if (seqLevel1 == 0  ||  seqLevel2 == 0)  { return 0; }
+
+    Stripe& stripe = getStripe (seqLevel1);
+
+    /** We need to be protected against concurrent accesses. */
+    LocalSynchronizer local (stripe.synchro);
+
+    Hit* hit = stripe.getHit (seqLevel1, seqLevel2);
+    if (hit == 0)  { return 0; }
+
+    /** The list is built at the first call and then kept up to date by the container, which owns it. */
+    if (hit->container == 0)
+    {
+        hit->container = new std::list<Alignment> ();
+        stripe.getAlignments (*hit, *hit->container);
+    }
+
+    return hit->container;
+}
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
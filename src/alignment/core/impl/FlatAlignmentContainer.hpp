@@ -0,0 +1,240 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+
+/** \file FlatAlignmentContainer.hpp
+ *  \brief Implementation of IAlignmentContainer with contiguous storage of the alignments
+ */
+
+#ifndef _FLAT_ALIGNMENT_CONTAINER_HPP_
+#define _FLAT_ALIGNMENT_CONTAINER_HPP_
+
+/********************************************************************************/
+
+#include <alignment/core/impl/AbstractAlignmentContainer.hpp>
+
+#include <map>
+#include <list>
+#include <vector>
+
+/********************************************************************************/
+namespace alignment {
+namespace core      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Implementation of IAlignmentContainer with contiguous storage of the alignments
+ *
+ * This implementation has the same behaviour as BasicAlignmentContainer (same rules for
+ * inserting an alignment, same visit order, same shrink), but it doesn't use one std::list
+ * node per alignment nor one std::map per query.
+ *
+ * The container is split into stripes according to the query index; each stripe has its own
+ * synchronizer, so threads inserting alignments for different queries don't wait for each other.
+ * In a stripe:
+ *  - the alignments are appended to a vector; the alignments of a [query,subject] pair are
+ *    chained (in insertion order) through the index of the next one.
+ *  - the [query,subject] pairs (called hits here) are stored in a vector too, and found through
+ *    an open addressing hash table of hits indexes.
+ *  - each hit owns its copy of the subject sequence (as in BasicAlignmentContainer), so a copy
+ *    never outlives the hit, even if the database it comes from is deleted.
+ *
+ * The grouping query -> subject -> alignments is only built when needed (accept and shrink),
+ * by sorting the hits of each stripe; the alignments are then rewritten contiguously for each
+ * hit in the visit order, which also gets rid of the alignments removed during the insertions.
+ *
+ * Since the IAlignmentContainerVisitor interface works on std::list<Alignment>, a list is
+ * built for each hit during accept, and its content (possibly modified by the visitor) is
+ * copied back afterwards.
+ */
+class FlatAlignmentContainer : public AbstractAlignmentContainer
+{
+public:
+
+    /** Constructor.
+     * \param[in] nbHitPerQuery : max number of hits per query kept by shrink (0 means no limit)
+     * \param[in] nbHspPerHit   : max number of alignments per hit kept by shrink (0 means no limit)
+     * \param[in] nbStripes     : number of stripes (ie. of independent synchronizers)
+     */
+    FlatAlignmentContainer (size_t nbHitPerQuery=0, size_t nbHspPerHit=0, size_t nbStripes=64);
+
+    /** Destructor. */
+    ~FlatAlignmentContainer ();
+
+    /** \copydoc AbstractAlignmentContainer::doesExist(const Alignment&) */
+    bool doesExist (const Alignment& align);
+
+    /** \copydoc AbstractAlignmentContainer::doesExist */
+    bool doesExist (
+        const indexation::ISeedOccurrence* subjectOccur,
+        const indexation::ISeedOccurrence* queryOccur,
+        u_int32_t bandSize
+    );
+
+    /** \copydoc AbstractAlignmentContainer::insertFirstLevel */
+    bool insertFirstLevel (const database::ISequence* sequence);
+
+    /** \copydoc IAlignmentResult::doesFirstLevelExists */
+    bool doesFirstLevelExists (const database::ISequence* sequence);
+
+    /** \copydoc AbstractAlignmentContainer::getFirstLevelNumber */
+    u_int32_t getFirstLevelNumber ();
+
+    /** \copydoc IAlignmentContainer::getSecondLevelNumber */
+    u_int32_t getSecondLevelNumber ();
+
+    /** \copydoc AbstractAlignmentContainer::insert(Alignment&,void*) */
+    bool insert (Alignment& align, void* context);
+
+    /** \copydoc AbstractAlignmentContainer::merge */
+    void merge (const std::vector<IAlignmentContainer*> containers);
+
+    /** \copydoc AbstractAlignmentContainer::accept */
+    void accept (IAlignmentContainerVisitor* visitor);
+
+    /** \copydoc AbstractAlignmentContainer::shrink */
+    void shrink ();
+
+    /** \copydoc AbstractAlignmentContainer::getContainer */
+    std::list<Alignment>* getContainer (
+        const database::ISequence* seqLevel1,
+        const database::ISequence* seqLevel2
+    );
+
+protected:
+
+    /** Key of a sequence (see BasicAlignmentContainer). */
+    typedef std::pair <database::ISequenceDatabase*, u_int32_t> Key;
+
+    /** End of a chain of alignments. */
+    static const u_int32_t NONE = ~0;
+
+    /** An alignment and the index of the next alignment of the same hit. */
+    struct Entry
+    {
+        Entry (const Alignment& a) : align(a), next(NONE)  {}
+        Alignment align;
+        u_int32_t next;
+    };
+
+    /** A [query,subject] pair and its chain of alignments. The subject sequence copy and the
+     * alignments list given by getContainer belong to the hit (and are deleted with it). */
+    struct Hit
+    {
+        Hit (const Key& k1, const Key& k2, database::ISequence* s1, database::ISequence* s2)
+            : key1(k1), key2(k2), seqLevel1(s1), seqLevel2(s2), first(NONE), last(NONE), nb(0), container(0)  {}
+
+        Key                    key1;
+        Key                    key2;
+        database::ISequence*   seqLevel1;
+        database::ISequence*   seqLevel2;
+        u_int32_t              first;
+        u_int32_t              last;
+        u_int32_t              nb;
+        std::list<Alignment>*  container;
+    };
+
+    /** Part of the container holding the alignments of a subset of the queries. */
+    struct Stripe
+    {
+        Stripe ();
+        ~Stripe ();
+
+        os::ISynchronizer*                  synchro;
+        std::vector<Entry>                  entries;
+        std::vector<Hit>                    hits;
+        std::vector<u_int32_t>              hitsTable;
+        std::map<Key,database::ISequence*>  queries;
+
+        /** Get the hit for a [query,subject] pair.
+         * \return the hit or 0 if not found */
+        Hit* getHit (const database::ISequence* seqLevel1, const database::ISequence* seqLevel2)
+        {
+            u_int32_t* slot = lookup (Key (seqLevel1->database, seqLevel1->index), Key (seqLevel2->database, seqLevel2->index));
+            return *slot != NONE ? &hits[*slot] : 0;
+        }
+
+        /** Look for the slot of a [query,subject] pair in the hits table.
+         * \return the slot holding the hit index, or the empty slot where it should be put. */
+        u_int32_t* lookup (const Key& key1, const Key& key2);
+
+        /** Add a hit (which must not already exist).
+         * \return the index of the new hit */
+        u_int32_t addHit (const Hit& hit);
+
+        /** Rebuild the hits table from the hits vector (with a size suited to the number of hits). */
+        void buildHitsTable ();
+
+        /** Give the hits indexes sorted by [query,subject] keys, ie. in the visit order. */
+        void getSortedHits (std::vector<u_int32_t>& order);
+
+        /** Copy the alignments of a hit into a container (list or vector). */
+        template<typename T> void getAlignments (const Hit& hit, T& result)
+        {
+            for (u_int32_t i=hit.first; i!=NONE; i=entries[i].next)  {  result.push_back (entries[i].align);  }
+        }
+
+        /** Append alignments as the (contiguous) chain of a hit into a vector of entries. */
+        template<typename It> static void setAlignments (Hit& hit, It begin, It end, std::vector<Entry>& target)
+        {
+            hit.first = hit.last = NONE;
+            hit.nb    = 0;
+            for (It it = begin; it != end; ++it)
+            {
+                u_int32_t idx = target.size();
+                target.push_back (Entry (*it));
+                if (hit.last != NONE)  {  target[hit.last].next = idx;  }  else  {  hit.first = idx;  }
+                hit.last = idx;
+                hit.nb++;
+            }
+        }
+
+        /** Update the alignments list of a hit (if getContainer has been called for it). */
+        void updateContainer (Hit& hit)
+        {
+            if (hit.container != 0)  {  hit.container->clear();  getAlignments (hit, *hit.container);  }
+        }
+
+        /** Delete what a hit owns. */
+        static void release (Hit& hit)
+        {
+            delete hit.seqLevel2;
+            delete hit.container;
+        }
+
+        /** Tells whether an alignment of a hit includes the provided ranges. */
+        bool isInContainer (const Hit* hit, const misc::Range32& sbjRange, const misc::Range32& qryRange);
+    };
+
+    std::vector<Stripe*> _stripes;
+
+    /** Get the stripe of a query sequence. */
+    Stripe& getStripe (const database::ISequence* seqLevel1)  {  return *(_stripes [seqLevel1->index % _stripes.size()]);  }
+
+    /** */
+    size_t _nbHitPerQuery;
+    size_t _nbHspPerHit;
+
+    /** */
+    friend struct SortHitsIndexFunctor;
+    friend struct FlatSortHitsByKeyFunctor;
+};
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _FLAT_ALIGNMENT_CONTAINER_HPP_ */
@@ -142,102 +142,67 @@ bool HspContainer::insert (
     int32_t score
 )
 {
-    LocalSynchronizer sync (_synchro);
-
     bool alreadyExist = false;
 
     u_int32_t d = 0;
 
-    /** We retrieve the list of interest (and its diagonal). */
-    LISTGAP** diagList = getItem (q_start, s_start, d, q_idx);
-
-    LISTGAP* gl = *diagList;
+    /** We retrieve the list of interest (and its diagonal). Note that we don't lock the list: since no cell
+     *  is removed during the insertions, a new cell can be linked with a compare-and-swap on the pointer
+     *  that references its successor (head of the list or 'next' of the previous cell). If this pointer
+     *  has been modified by another thread in the meantime, we resume the search from it. */
+    LISTGAP** link = getItem (q_start, s_start, d, q_idx);
 
-    LISTGAP* prev_gl = 0;
-    size_t k = 0;
+    LISTGAP* ngl = 0;
 
-
-    /** We try to find in the list the item of interest. */
-    while ((gl!=NULL) && ( (d<gl->hsp.diag) || ((gl->hsp.diag==d) && (q_start>=gl->hsp.q_stop))) )
+    while (true)
     {
-        prev_gl=gl;
-        gl = gl -> next;
-        k++;
-    }
-
-//    VERBOSE (("HspContainer::insert (0):  qry=[%ld,%ld] (len=%ld)   sbj=[%ld,%ld]  delta=%d  d=%d\n",
-//        q_start, q_stop,  q_stop-q_start+1,
-//        s_start, s_start + q_stop - q_start,
-//        delta, d
-//    ));
+        LISTGAP* gl = *((LISTGAP* volatile*) link);
 
+        /** We try to find in the list the item of interest. */
+        while ((gl!=NULL) && ( (d<gl->hsp.diag) || ((gl->hsp.diag==d) && (q_start>=gl->hsp.q_stop))) )
+        {
+            link = &(gl->next);
+            gl   = *((LISTGAP* volatile*) link);
+        }
 
-    // we can add a new alignment to the list (ngl) if it's satisfied one of the following conditions
-    //      gl = NULL  : no alignment identified
-    //      d>gl->diag : as the diagonals are sorted in ascending order, we have not met d = gl->diag
-    //      d=gl->diag and index1>gl->stop : a diagonal exists, but the index is outside the scope
-    // k indicates the number of alignment on which stopped (k = 0 -> empty list)
+        // we can add a new alignment to the list (ngl) if it's satisfied one of the following conditions
+        //      gl = NULL  : no alignment identified
+        //      d>gl->diag : as the diagonals are sorted in ascending order, we have not met d = gl->diag
+        //      d=gl->diag and index1>gl->stop : a diagonal exists, but the index is outside the scope
 
-    if ((gl==NULL) || (d>gl->hsp.diag) || ((gl->hsp.diag==d) && (q_start<gl->hsp.q_start)))
-    {
-        /** We create a new cell. */
-        LISTGAP* ngl = (LISTGAP*) DefaultFactory::memory().malloc (sizeof(LISTGAP));
-
-        ngl->hsp.diag      = d;
-        ngl->hsp.q_start   = q_start;
-        ngl->hsp.q_stop    = q_stop;
-        ngl->hsp.s_start   = s_start;
-        ngl->hsp.s_stop    = s_stop;
-        ngl->hsp.q_idx     = q_idx;
-        ngl->hsp.s_idx     = s_idx;
-        ngl->hsp.score     = score;
-
-//        VERBOSE (("HspContainer::insert (1):  qry=[%ld,%ld] (len=%ld)   sbj=[%ld,%ld] score=%d  delta=%d => diag=0x%x \n",
-//            q_start, q_stop,  q_stop-q_start+1,
-//            s_start, s_start + q_stop - q_start,
-//            score,
-//            delta,
-//            d
-//        ));
-
-        // 4 cas sont a considerer suivant : k et gl
-        if (gl == NULL)
+        if ((gl==NULL) || (d>gl->hsp.diag) || ((gl->hsp.diag==d) && (q_start<gl->hsp.q_start)))
         {
-            if (k==0)
+            /** We create a new cell (only once, even if we have to retry). */
+            if (ngl == 0)
             {
-                // gl = NULL et k = 0  --> empty list : connection to ngl (first element)
-                ngl->next = (LISTGAP *) NULL;
-                *diagList = ngl;
-            }
-            else
-            {
-                // gl = NULL et k = 1 --> insert ngl at the end of list
-                ngl->next     =  (LISTGAP *) NULL;
-                prev_gl->next = ngl;
+                ngl = (LISTGAP*) DefaultFactory::memory().malloc (sizeof(LISTGAP));
+
+                ngl->hsp.diag      = d;
+                ngl->hsp.q_start   = q_start;
+                ngl->hsp.q_stop    = q_stop;
+                ngl->hsp.s_start   = s_start;
+                ngl->hsp.s_stop    = s_stop;
+                ngl->hsp.q_idx     = q_idx;
+                ngl->hsp.s_idx     = s_idx;
+                ngl->hsp.score     = score;
             }
+
+            /** We insert ngl before gl (gl may be null). */
+            ngl->next = gl;
+
+            if (__sync_bool_compare_and_swap (link, gl, ngl) == false)  {  continue;  }
+
+            alreadyExist = false;
         }
+
         else
         {
-            if (k==0)
-            {
-                // gl <> NULL et k = 0 --> insert ngl at beginning of list
-                ngl->next = gl;
-                *diagList = ngl;
-            }
-            else
-            {
-                // gl <> NULL et k > 0 --> insert ngl before gl
-                ngl->next       = gl;
-                prev_gl->next   = ngl;
-            }
-        }
+            if (ngl != 0)  {  DefaultFactory::memory().free (ngl);  }
 
-        alreadyExist = false;
-    }
+            alreadyExist = true;
+        }
 
-    else
-    {
-        alreadyExist = true;
+        break;
     }
 
     VERBOSE (("HspContainer::insert (0):  qry=[%ld,%ld] (len=%ld)   sbj=[%ld,%ld]  delta=%d  d=%d => alreadyExists=%d \n",
@@ -260,9 +225,10 @@ bool HspContainer::insert (
 *********************************************************************/
 bool HspContainer::doesExist (u_int64_t q_start, u_int64_t s_start, u_int32_t delta)
 {
-#if 1
+#if 0
         /** We may want to lock the iteration of the list. In doing so, we may avoid some cell creations,
-         * but we may slow down concurrent thread that access the list.
+         * but we may slow down concurrent thread that access the list. Since insert links the cells
+         * with a compare-and-swap, the lists can be read without lock.
          */
         LocalSynchronizer local (_synchro);
 #endif
@@ -92,7 +92,7 @@ public:
         const database::ISequence* seqLevel2
     ) { return 0; }
 
-private:
+protected:
 
     int _DIVDIAG;
 
@@ -109,7 +109,9 @@ private:
     LISTGAP** _listGaplessAlign;
     size_t    _listGaplessAlignSize;
 
-    bool addDiag (
+    /** Insert an ungap alignment in the list of its diagonal.
+     * \return true if the alignment was already known, false otherwise. */
+    virtual bool addDiag (
         u_int64_t q_start,
         u_int64_t q_stop,
         u_int64_t s_start,
@@ -0,0 +1,108 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+
+
+#include <alignment/core/impl/UngapAlignmentContainerLockFree.hpp>
+
+#include <os/impl/DefaultOsFactory.hpp>
+
+#include <stdio.h>
+#define DEBUG(a)  //printf a
+
+using namespace std;
+using namespace os;
+using namespace os::impl;
+
+/********************************************************************************/
+namespace alignment {
+namespace core      {
+namespace impl      {
+/********************************************************************************/
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : same logic as UngapAlignmentResult::addDiag
+*********************************************************************/
+bool UngapAlignmentResultLockFree::addDiag (
+    u_int64_t q_start,
+    u_int64_t q_stop,
+    u_int64_t s_start,
+    u_int64_t s_stop,
+    u_int32_t seqIdx
+)
+{
+    u_int32_t d = 0;
+
+    /** We retrieve the diagonal of interest (we don't need the list itself but its head). */
+    getItem (q_start, s_start, seqIdx, d);
+
+    /** The pointer to be modified for linking a new cell (head of the list or 'next' of the previous cell). */
+    LISTGAP** link = _listGaplessAlign + d/_DIVDIAG;
+
+    LISTGAP* ngl = 0;
+
+    while (true)
+    {
+        LISTGAP* gl = *((LISTGAP* volatile*) link);
+
+        /** We try to find in the list the item of interest. */
+        while ((gl!=NULL) && ( (d<gl->diag) || ((gl->diag==d) && (q_start>=gl->stop))) )
+        {
+            link = &(gl->next);
+            gl   = *((LISTGAP* volatile*) link);
+        }
+
+        /** The alignment is already known. */
+        if ( ! ((gl==NULL) || (d>gl->diag) || ((gl->diag==d) && (q_start<gl->start))) )
+        {
+            if (ngl != 0)  {  DefaultFactory::memory().free (ngl);  }
+            return true;
+        }
+
+        /** We create a new cell (only once, even if we have to retry). */
+        if (ngl == 0)
+        {
+            ngl = (LISTGAP*) DefaultFactory::memory().malloc (sizeof(LISTGAP));
+
+            ngl->diag  = d;
+            ngl->start = q_start;
+            ngl->stop  = q_stop;
+        }
+
+        ngl->next = gl;
+
+        /** We link the new cell; the CAS is a full barrier, so the content of the cell is visible
+         *  to other threads as soon as the cell is. */
+        if (__sync_bool_compare_and_swap (link, gl, ngl) == true)
+        {
+            __sync_fetch_and_add (&_listGaplessAlignSize, 1);
+            return false;
+        }
+
+        /** Another thread has linked a cell at the same place; we resume the search from 'link'
+         *  (the cells before it can't have changed). */
+        DEBUG (("UngapAlignmentResultLockFree::addDiag : retry for diag=%d  q_start=%ld\n", d, q_start));
+    }
+}
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,73 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+
+/** \file UngapAlignmentContainerLockFree.hpp
+ *  \brief Lock free implementation of IAlignmentResult interface for ungap alignments.
+ */
+
+#ifndef _UNGAP_ALIGNMENT_RESULT_LOCK_FREE_HPP_
+#define _UNGAP_ALIGNMENT_RESULT_LOCK_FREE_HPP_
+
+/********************************************************************************/
+
+#include <alignment/core/impl/UngapAlignmentContainer.hpp>
+
+/********************************************************************************/
+namespace alignment {
+namespace core      {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Implementation of UngapAlignmentResult without lock
+ *
+ * The storage is the same as UngapAlignmentResult: an array of buckets hashed by diagonal,
+ * each bucket holding a list sorted by diagonal and then by query offset.
+ *
+ * Since the cells are never removed while the algorithm runs, a new cell can be linked in
+ * its list with a single compare-and-swap on the 'next' pointer of its predecessor (or on
+ * the head of the bucket); if another thread has modified this pointer in the meantime,
+ * the search goes on from the same predecessor, so an alignment is never inserted twice
+ * and no inserted cell is lost. The doesExist method only reads the lists, so it doesn't
+ * need any synchronization either.
+ *
+ * This is useful with many threads, where the mutex of UngapAlignmentResult::addDiag may
+ * become a contention point.
+ */
+class UngapAlignmentResultLockFree : public UngapAlignmentResult
+{
+public:
+
+    /** \copydoc UngapAlignmentResult::UngapAlignmentResult */
+    UngapAlignmentResultLockFree (size_t nbQuerySequences)  : UngapAlignmentResult (nbQuerySequences)  {}
+
+protected:
+
+    /** \copydoc UngapAlignmentResult::addDiag */
+    bool addDiag (
+        u_int64_t q_start,
+        u_int64_t q_stop,
+        u_int64_t s_start,
+        u_int64_t s_stop,
+        u_int32_t seqIdx
+    );
+};
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _UNGAP_ALIGNMENT_RESULT_LOCK_FREE_HPP_ */
@@ -52,6 +52,42 @@ public:
         u_int32_t* b_offset,
         bool reverse_sequence
     ) = 0;
+
+    /** Description of one extension for the computeBatch method. */
+    struct Extension
+    {
+        /** Input: sequences, lengths and direction (same meaning as for compute). */
+        const char* A;
+        const char* B;
+        u_int32_t   M;
+        u_int32_t   N;
+        bool        reverse_sequence;
+
+        /** Output: score and offsets of the best extension. */
+        int         score;
+        u_int32_t   a_offset;
+        u_int32_t   b_offset;
+    };
+
+    /** Compute several independent extensions; the results are the same as calling compute for
+     * each of them. The default implementation does so; vectorized implementations may compute
+     * several extensions at the same time (see getBatchSize).
+     * \param[in,out] extensions : extensions to be computed
+     * \param[in] nb : number of extensions
+     */
+    virtual void computeBatch (Extension* extensions, size_t nb)
+    {
+        for (size_t i=0; i<nb; i++)
+        {
+            Extension& e = extensions[i];
+            e.score = compute (e.A, e.B, e.M, e.N, &e.a_offset, &e.b_offset, e.reverse_sequence);
+        }
+    }
+
+    /** Number of extensions that the implementation can compute at the same time.
+     * \return 1 if there is no benefit in using computeBatch.
+     */
+    virtual size_t getBatchSize ()  { return 1; }
 };
 
 /********************************************************************************/
@@ -0,0 +1,717 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+
+#include <alignment/tools/impl/SemiGappedAlignAVX2.hpp>
+#include <os/impl/DefaultOsFactory.hpp>
+
+/** The AVX2 code is compiled through the 'target' function attribute, so we don't need
+ *  specific compilation flags; this is only available with GCC (or compatible) on x86. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define SEMIGAP_WITH_AVX2  1
+    #include <immintrin.h>
+#endif
+
+#include <stdio.h>
+#define DEBUG(a)  //printf a
+
+using namespace std;
+using namespace os;
+using namespace os::impl;
+using namespace algo::core;
+
+/********************************************************************************/
+namespace alignment {
+namespace tools     {
+namespace impl      {
+/********************************************************************************/
+
+/** Lower bound for scores (same value as SemiGapAlign). */
+#define MININT - ( 1 << (8*sizeof(ScoreInt) - 2) )
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+SemiGapAlignAVX2::SemiGapAlignAVX2 (
+    algo::core::IScoreMatrix* scoreMatrix,
+    int openGapCost,
+    int extendGapCost,
+    int Xdropoff
+)
+    : SemiGapAlign (scoreMatrix, openGapCost, extendGapCost, Xdropoff),
+      _profile(0), _rowSize(0), _bestScore(0), _bestGapScore(0), _capacity(0),
+      _laneBestScore(0), _laneBestGapScore(0), _laneLetters(0), _laneCapacity(0),
+      _useAVX2(isSupported())
+{
+    size_t  n      = _scoreMatrix->getN();
+    int8_t** matrix = _scoreMatrix->getMatrix();
+
+    /** We build the profile: the scores are stored as 32 bits values, so computeLanes can read
+     *  the scores of all its lanes with one gather. */
+    _rowSize = n;
+    _profile = (ScoreInt*) DefaultFactory::memory().calloc (n*_rowSize, sizeof(ScoreInt));
+
+    for (size_t i=0; i<n; i++)
+    {
+        for (size_t j=0; j<n; j++)  {  _profile[i*_rowSize + j] = matrix[i][j];  }
+    }
+
+    /** We allocate the dynamic programming arrays with the same initial size as SemiGapAlign. */
+    resize (1000);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+SemiGapAlignAVX2::~SemiGapAlignAVX2 ()
+{
+    DefaultFactory::memory().free (_profile);
+    DefaultFactory::memory().free (_bestScore);
+    DefaultFactory::memory().free (_bestGapScore);
+    DefaultFactory::memory().free (_laneBestScore);
+    DefaultFactory::memory().free (_laneBestGapScore);
+    DefaultFactory::memory().free (_laneLetters);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool SemiGapAlignAVX2::isSupported ()
+{
+#ifdef SEMIGAP_WITH_AVX2
+    /** Note that the check of the OS support of the AVX registers is done by the builtin. */
+    __builtin_cpu_init ();
+    return __builtin_cpu_supports ("avx2");
+#else
+    return false;
+#endif
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void SemiGapAlignAVX2::resize (u_int32_t size)
+{
+    if (size <= _capacity)  { return; }
+
+    _bestScore    = (ScoreInt*) DefaultFactory::memory().realloc (_bestScore,    size * sizeof(ScoreInt));
+    _bestGapScore = (ScoreInt*) DefaultFactory::memory().realloc (_bestGapScore, size * sizeof(ScoreInt));
+
+    _capacity = size;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void SemiGapAlignAVX2::resizeLanes (u_int32_t size)
+{
+    if (size <= _laneCapacity)  { return; }
+
+    _laneBestScore    = (ScoreInt*) DefaultFactory::memory().realloc (_laneBestScore,    size * NB_LANES * sizeof(ScoreInt));
+    _laneBestGapScore = (ScoreInt*) DefaultFactory::memory().realloc (_laneBestGapScore, size * NB_LANES * sizeof(ScoreInt));
+    _laneLetters      = (ScoreInt*) DefaultFactory::memory().realloc (_laneLetters,      size * NB_LANES * sizeof(ScoreInt));
+
+    _laneCapacity = size;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void SemiGapAlignAVX2::computeBatch (Extension* extensions, size_t nb)
+{
+    /** Without AVX2, we compute the extensions one by one. */
+    if (_useAVX2 == false)  {  SemiGapAlign::computeBatch (extensions, nb);  return;  }
+
+    for (size_t i=0; i<nb; i+=NB_LANES)
+    {
+        size_t nbLanes = MIN (nb-i, NB_LANES);
+
+        if (nbLanes < MIN_LANES)
+        {
+            /** Not enough extensions for the lanes to be worth it. */
+            for (size_t j=i; j<i+nbLanes; j++)
+            {
+                Extension& e = extensions[j];
+                e.score = compute (e.A, e.B, e.M, e.N, &e.a_offset, &e.b_offset, e.reverse_sequence);
+            }
+        }
+        else
+        {
+            computeLanes (extensions + i, nbLanes);
+        }
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : each lane runs the recurrence of SemiGapAlign::compute for its own extension; the
+**           vectorized loop goes through the union of the windows of the lanes, and a lane
+**           only updates its state for the cells of its own window.
+*********************************************************************/
+#ifdef SEMIGAP_WITH_AVX2
+__attribute__ ((target ("avx2")))
+#endif
+void SemiGapAlignAVX2::computeLanes (Extension* extensions, size_t nb)
+{
+#ifdef SEMIGAP_WITH_AVX2
+
+    /** Define as local variable (ie. in stack). */
+    int gap_extend      = _extendGapCost;
+    int gap_open_extend = _openExtendGapCost;
+    int x_dropoff       = _Xdropoff;
+
+    /** State of each lane. */
+    u_int32_t num_extra_cells [NB_LANES];
+    u_int32_t first_b_index   [NB_LANES];
+    u_int32_t last_b_index    [NB_LANES];
+    u_int32_t b_size          [NB_LANES];
+    u_int32_t nbLetters       [NB_LANES];
+    bool      isDone          [NB_LANES];
+
+    ScoreInt laneFirst     [NB_LANES]  __attribute__ ((aligned (32)));
+    ScoreInt laneLast      [NB_LANES]  __attribute__ ((aligned (32)));
+    ScoreInt laneSize      [NB_LANES]  __attribute__ ((aligned (32)));
+    ScoreInt laneActive    [NB_LANES]  __attribute__ ((aligned (32)));
+    ScoreInt laneRow       [NB_LANES]  __attribute__ ((aligned (32)));
+    ScoreInt laneBest      [NB_LANES]  __attribute__ ((aligned (32)));
+    ScoreInt laneGapRow    [NB_LANES]  __attribute__ ((aligned (32)));
+    ScoreInt laneAOffset   [NB_LANES]  __attribute__ ((aligned (32)));
+    ScoreInt laneBOffset   [NB_LANES]  __attribute__ ((aligned (32)));
+
+    u_int32_t capacity = 1000;
+
+    for (size_t l=0; l<NB_LANES; l++)
+    {
+        isDone[l] = true;  first_b_index[l] = last_b_index[l] = b_size[l] = nbLetters[l] = 0;
+        laneBest[l] = laneAOffset[l] = laneBOffset[l] = laneRow[l] = 0;
+
+        if (l < nb)
+        {
+            const Extension& e = extensions[l];
+
+            if (gap_extend > 0)     {  num_extra_cells[l] = x_dropoff / gap_extend + 3;  }
+            else                    {  num_extra_cells[l] = e.N + 3;                     }
+
+            capacity  = MAX (capacity, num_extra_cells[l] + 100);
+            isDone[l] = (e.M == 0);
+        }
+    }
+
+    resizeLanes (capacity);
+
+    /** Initialization of the first row of each lane. */
+    for (size_t l=0; l<nb; l++)
+    {
+        const Extension& e = extensions[l];
+
+        ScoreInt score = -gap_open_extend;
+        _laneBestScore    [l] = 0;
+        _laneBestGapScore [l] = -gap_open_extend;
+
+        u_int32_t i;
+        for (i = 1; i <= e.N; i++)
+        {
+            if (score < -x_dropoff)  {   break;  }
+
+            _laneBestScore    [i*NB_LANES + l] = score;
+            _laneBestGapScore [i*NB_LANES + l] = score - gap_open_extend;
+            score -= gap_extend;
+        }
+
+        b_size[l] = i;
+    }
+
+    /** Constants. */
+    const __m256i vxdrop           = _mm256_set1_epi32 (x_dropoff);
+    const __m256i vgap_extend      = _mm256_set1_epi32 (gap_extend);
+    const __m256i vgap_open_extend = _mm256_set1_epi32 (gap_open_extend);
+    const __m256i vminint          = _mm256_set1_epi32 (MININT);
+
+    /**********************************************************************/
+    /**                             LOOP  A                               */
+    /**********************************************************************/
+    for (u_int32_t a_index = 1; ; a_index++)
+    {
+        u_int32_t bmin = ~0;
+        u_int32_t bmax =  0;
+
+        for (size_t l=0; l<NB_LANES; l++)
+        {
+            laneActive[l] = isDone[l] ? 0 : ~0;
+            laneFirst [l] = first_b_index[l];
+            laneSize  [l] = b_size[l];
+
+            if (isDone[l])  { continue; }
+
+            const Extension& e = extensions[l];
+
+            /** Offset of the profile row of the current letter of A. */
+            laneRow[l] = _rowSize * (e.reverse_sequence ? (int) e.A[e.M - a_index] : (int) e.A[a_index]);
+
+            /** We make sure that the letters of B are known for the whole window of the lane; we store for
+             *  the cell b the (b+1)th letter of B in the extension direction (the cell N has no letter). */
+            ScoreInt* letters = _laneLetters + l;
+
+            for ( ; nbLetters[l] < b_size[l]; nbLetters[l]++)
+            {
+                u_int32_t b = nbLetters[l];
+
+                if (b >= e.N)                   {  letters[b*NB_LANES] = 0;                      }
+                else if (e.reverse_sequence)    {  letters[b*NB_LANES] = (int) e.B[e.N - 1 - b]; }
+                else                            {  letters[b*NB_LANES] = (int) e.B[b + 1];       }
+            }
+
+            bmin = MIN (bmin, first_b_index[l]);
+            bmax = MAX (bmax, b_size[l]);
+        }
+
+        /** All the lanes are done. */
+        if (bmax == 0)  { break; }
+
+        __m256i vactive = _mm256_load_si256 ((__m256i*) laneActive);
+        __m256i vrow    = _mm256_load_si256 ((__m256i*) laneRow);
+        __m256i vfirst0 = _mm256_load_si256 ((__m256i*) laneFirst);
+        __m256i vsize   = _mm256_load_si256 ((__m256i*) laneSize);
+        __m256i vfirst  = vfirst0;
+        __m256i vlast   = vfirst0;
+        __m256i vbest   = _mm256_load_si256 ((__m256i*) laneBest);
+        __m256i vaoff   = _mm256_load_si256 ((__m256i*) laneAOffset);
+        __m256i vboff   = _mm256_load_si256 ((__m256i*) laneBOffset);
+        __m256i va      = _mm256_set1_epi32 (a_index);
+
+        /* initialize running-score variables */
+        __m256i vscore         = vminint;
+        __m256i vscore_gap_row = vminint;
+
+        /**********************************************************************/
+        /**                             LOOP  B                               */
+        /**********************************************************************/
+        for (u_int32_t b_index = bmin; b_index < bmax; b_index++)
+        {
+            __m256i vb = _mm256_set1_epi32 (b_index);
+
+            /** The lanes whose window holds the current cell. */
+            __m256i vcell = _mm256_and_si256 (
+                vactive,
+                _mm256_andnot_si256 (_mm256_cmpgt_epi32 (vfirst0, vb), _mm256_cmpgt_epi32 (vsize, vb))
+            );
+
+            ScoreInt* bestPtr    = _laneBestScore    + b_index*NB_LANES;
+            ScoreInt* bestGapPtr = _laneBestGapScore + b_index*NB_LANES;
+
+            __m256i vscore_gap_col = _mm256_loadu_si256 ((__m256i*) bestGapPtr);
+            __m256i vbest_arr      = _mm256_loadu_si256 ((__m256i*) bestPtr);
+            __m256i vletters       = _mm256_loadu_si256 ((__m256i*) (_laneLetters   + b_index*NB_LANES));
+
+            /** next_score = best_arr[b] + matrix[A[a]][B[b+1]]; the gather is only done for the lanes of the cell. */
+            __m256i vnext_score = _mm256_add_epi32 (
+                vbest_arr,
+                _mm256_mask_i32gather_epi32 (_mm256_setzero_si256(), (const int*) _profile, _mm256_add_epi32 (vrow, vletters), vcell, sizeof(ScoreInt))
+            );
+
+            /** score = Max (score, score_gap_col, score_gap_row) */
+            __m256i vcurrent = _mm256_max_epi32 (_mm256_max_epi32 (vscore, vscore_gap_col), vscore_gap_row);
+
+            /** X-dropoff test. */
+            __m256i vdrop = _mm256_and_si256 (_mm256_cmpgt_epi32 (_mm256_sub_epi32 (vbest, vcurrent), vxdrop), vcell);
+            __m256i vkeep = _mm256_andnot_si256 (vdrop, vcell);
+
+            /** Failure on the first cell of the window: the next rows start one cell to the right. */
+            __m256i vdropFirst = _mm256_and_si256 (vdrop, _mm256_cmpeq_epi32 (vfirst, vb));
+            vfirst    = _mm256_sub_epi32 (vfirst, vdropFirst);
+            vbest_arr = _mm256_blendv_epi8 (vbest_arr, vminint, _mm256_andnot_si256 (vdropFirst, vdrop));
+
+            /** Success: we update the best score and the gap scores. */
+            vlast = _mm256_blendv_epi8 (vlast, vb, vkeep);
+
+            __m256i vbetter = _mm256_and_si256 (_mm256_cmpgt_epi32 (vcurrent, vbest), vkeep);
+            vbest = _mm256_blendv_epi8 (vbest, vcurrent, vbetter);
+            vaoff = _mm256_blendv_epi8 (vaoff, va,       vbetter);
+            vboff = _mm256_blendv_epi8 (vboff, vb,       vbetter);
+
+            __m256i vtemp  = _mm256_sub_epi32 (vcurrent, vgap_open_extend);
+
+            vscore_gap_row = _mm256_blendv_epi8 (
+                vscore_gap_row,
+                _mm256_max_epi32 (vtemp, _mm256_sub_epi32 (vscore_gap_row, vgap_extend)),
+                vkeep
+            );
+
+            __m256i vbest_gap = _mm256_blendv_epi8 (
+                vscore_gap_col,
+                _mm256_max_epi32 (vtemp, _mm256_sub_epi32 (vscore_gap_col, vgap_extend)),
+                vkeep
+            );
+
+            vbest_arr = _mm256_blendv_epi8 (vbest_arr, vcurrent, vkeep);
+
+            _mm256_storeu_si256 ((__m256i*) bestGapPtr, vbest_gap);
+            _mm256_storeu_si256 ((__m256i*) bestPtr,    vbest_arr);
+
+            vscore = _mm256_blendv_epi8 (vscore, vnext_score, vcell);
+
+        /**********************************************************************/
+        } /* end of for (b_index =... */
+        /**********************************************************************/
+
+        _mm256_store_si256 ((__m256i*) laneFirst,   vfirst);
+        _mm256_store_si256 ((__m256i*) laneLast,    vlast);
+        _mm256_store_si256 ((__m256i*) laneBest,    vbest);
+        _mm256_store_si256 ((__m256i*) laneAOffset, vaoff);
+        _mm256_store_si256 ((__m256i*) laneBOffset, vboff);
+        _mm256_store_si256 ((__m256i*) laneGapRow,  vscore_gap_row);
+
+        /** We update the window of each lane (see SemiGapAlign::compute). */
+        for (size_t l=0; l<NB_LANES; l++)
+        {
+            if (isDone[l])  { continue; }
+
+            const Extension& e = extensions[l];
+
+            first_b_index[l] = laneFirst[l];
+            last_b_index [l] = laneLast [l];
+
+            /* Finish aligning if the best scores for all positions of B will fail the X-dropoff test */
+            if (first_b_index[l] == b_size[l])  {  isDone[l] = true;  continue;  }
+
+            /* enlarge the window for score data if necessary */
+            if (last_b_index[l] + num_extra_cells[l] + 3 >= _laneCapacity)
+            {
+                resizeLanes (MAX (last_b_index[l] + num_extra_cells[l] + 100, 2 * _laneCapacity));
+            }
+
+            if (last_b_index[l] < b_size[l] - 1)
+            {
+                b_size[l] = last_b_index[l] + 1;
+            }
+            else
+            {
+                ScoreInt score_gap_row = laneGapRow[l];
+
+                while (score_gap_row >= (laneBest[l] - x_dropoff) && b_size[l] <= e.N)
+                {
+                    _laneBestScore    [b_size[l]*NB_LANES + l] = score_gap_row;
+                    _laneBestGapScore [b_size[l]*NB_LANES + l] = score_gap_row - gap_open_extend;
+                    score_gap_row -= gap_extend;
+                    b_size[l]++;
+                }
+            }
+
+            if (b_size[l] <= e.N)
+            {
+                _laneBestScore    [b_size[l]*NB_LANES + l] = MININT;
+                _laneBestGapScore [b_size[l]*NB_LANES + l] = MININT;
+                b_size[l]++;
+            }
+
+            /** The last row of the lane has been processed. */
+            if (a_index == e.M)  {  isDone[l] = true;  }
+        }
+
+        /** When only a few lanes are still active, the vectorized loop mostly computes nothing; we
+         *  finish these lanes with the scalar code, starting from the current row of the lane. */
+        size_t nbActive = 0;
+        for (size_t l=0; l<NB_LANES; l++)  {  if (!isDone[l])  { nbActive++; }  }
+
+        if (nbActive > 0 && nbActive < MIN_LANES)
+        {
+            for (size_t l=0; l<NB_LANES; l++)
+            {
+                if (isDone[l])  { continue; }
+
+                const Extension& e = extensions[l];
+
+                resize (MAX (b_size[l] + num_extra_cells[l] + 100, _capacity));
+
+                for (u_int32_t b=first_b_index[l]; b<b_size[l]; b++)
+                {
+                    _bestScore    [b] = _laneBestScore    [b*NB_LANES + l];
+                    _bestGapScore [b] = _laneBestGapScore [b*NB_LANES + l];
+                }
+
+                u_int32_t aoff = laneAOffset[l];
+                u_int32_t boff = laneBOffset[l];
+
+                laneBest[l] = computeRows (
+                    e.A, e.B, e.M, e.N, e.reverse_sequence,
+                    a_index+1, first_b_index[l], b_size[l], laneBest[l], &aoff, &boff
+                );
+
+                laneAOffset[l] = aoff;
+                laneBOffset[l] = boff;
+                isDone[l]      = true;
+            }
+        }
+
+    /**********************************************************************/
+    } /* end of for (a_index =... */
+    /**********************************************************************/
+
+    for (size_t l=0; l<nb; l++)
+    {
+        extensions[l].score    = laneBest    [l];
+        extensions[l].a_offset = laneAOffset [l];
+        extensions[l].b_offset = laneBOffset [l];
+    }
+
+#else
+    SemiGapAlign::computeBatch (extensions, nb);
+#endif
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+int SemiGapAlignAVX2::compute (
+    const char* A,
+    const char* B,
+    u_int32_t M,
+    u_int32_t N,
+    u_int32_t* a_offset,
+    u_int32_t* b_offset,
+    bool reverse_sequence
+)
+{
+    DEBUG (("SemiGapAlignAVX2::compute:  |Q|=%3d |S|=%3d \n", M,N));
+
+    /** Define as local variable (ie. in stack). */
+    int gap_extend      = _extendGapCost;
+    int gap_open_extend = _openExtendGapCost;
+    int x_dropoff       = _Xdropoff;
+
+    u_int32_t i;
+    u_int32_t num_extra_cells;
+
+    /* do initialization and sanity-checking */
+    *a_offset = 0;
+    *b_offset = 0;
+
+    if (gap_extend > 0)     {  num_extra_cells = x_dropoff / gap_extend + 3;  }
+    else                    {  num_extra_cells = N + 3;                       }
+
+    /** We make sure that the arrays are big enough (they are kept from one call to another). */
+    resize (num_extra_cells + 100);
+
+    ScoreInt score   = -gap_open_extend;
+    _bestScore[0]    = 0;
+    _bestGapScore[0] = -gap_open_extend;
+
+    for (i = 1; i <= N; i++)
+    {
+        if (score < -x_dropoff)  {   break;  }
+
+        _bestScore[i]     = score;
+        _bestGapScore[i]  = score - gap_open_extend;
+        score            -= gap_extend;
+    }
+
+    /** We compute all the rows. */
+    return computeRows (A, B, M, N, reverse_sequence, 1, 0, i, 0, a_offset, b_offset);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the logic of the recurrence is the one of SemiGapAlign::compute
+*********************************************************************/
+int SemiGapAlignAVX2::computeRows (
+    const char* A,
+    const char* B,
+    u_int32_t   M,
+    u_int32_t   N,
+    bool        reverse_sequence,
+    u_int32_t   a_start,
+    u_int32_t   first_b_index,
+    u_int32_t   b_size,
+    ScoreInt    best_score,
+    u_int32_t*  a_offset,
+    u_int32_t*  b_offset
+)
+{
+    /** Define as local variable (ie. in stack). */
+    int gap_extend      = _extendGapCost;
+    int gap_open_extend = _openExtendGapCost;
+    int x_dropoff       = _Xdropoff;
+
+    u_int32_t a_index;
+    u_int32_t b_index;
+    u_int32_t last_b_index;
+
+    ScoreInt score         = 0;
+    ScoreInt score_gap_row = 0;
+    ScoreInt score_gap_col = 0;
+    ScoreInt next_score    = 0;
+
+    u_int32_t num_extra_cells;
+
+    if (gap_extend > 0)     {  num_extra_cells = x_dropoff / gap_extend + 3;  }
+    else                    {  num_extra_cells = N + 3;                       }
+
+    ScoreInt* bestScore    = _bestScore;
+    ScoreInt* bestGapScore = _bestGapScore;
+
+    int8_t b_increment = reverse_sequence ? -1 : 1;
+
+    /**********************************************************************/
+    /**                             LOOP  A                               */
+    /**********************************************************************/
+    for (a_index = a_start; a_index <= M; a_index++)
+    {
+        /* pick out the row of the profile appropriate for A[a_index] */
+        const ScoreInt* row = _profile + _rowSize * (reverse_sequence ? (int) A[M - a_index] : (int) A[a_index]);
+        const char*     b_ptr = reverse_sequence ? &B[N - first_b_index] : &B[first_b_index];
+
+        /* initialize running-score variables */
+        score         = MININT;
+        score_gap_row = MININT;
+        last_b_index  = first_b_index;
+
+        /**********************************************************************/
+        /**                             LOOP  B                               */
+        /**********************************************************************/
+        for (b_index = first_b_index; b_index < b_size; b_index++)
+        {
+            b_ptr        += b_increment;
+            score_gap_col = bestGapScore[b_index];
+            next_score    = bestScore[b_index] + row [(int) *b_ptr];
+
+            /** We update the score as being Max (score, score_gap_col, score_gap_row) */
+            if (score < score_gap_col)  {  score = score_gap_col;  }
+            if (score < score_gap_row)  {  score = score_gap_row;  }
+
+            if (best_score - score > x_dropoff)
+            {
+                /* the current best score failed the X-dropoff criterion (see SemiGapAlign::compute) */
+                if (b_index == first_b_index)  {  first_b_index++;              }
+                else                           {  bestScore[b_index] = MININT;  }
+            }
+
+            else
+            {
+                last_b_index = b_index;
+
+                if (score > best_score)
+                {
+                    best_score = score;
+                    *a_offset  = a_index;
+                    *b_offset  = b_index;
+                }
+
+                score_gap_row  -= gap_extend;
+                score_gap_col  -= gap_extend;
+                score_gap_row   = MAX (score - gap_open_extend, score_gap_row);
+                bestGapScore[b_index] = MAX (score - gap_open_extend, score_gap_col);
+                bestScore   [b_index] = score;
+            }
+
+            score = next_score;
+
+        /**********************************************************************/
+        } /* end of for (b_index =... */
+        /**********************************************************************/
+
+        /* Finish aligning if the best scores for all positions of B will fail the X-dropoff test */
+        if (first_b_index == b_size)  {   break;  }
+
+        /* enlarge the window for score data if necessary */
+        if (last_b_index + num_extra_cells + 3 >= _capacity)
+        {
+            resize (MAX (last_b_index + num_extra_cells + 100, 2 * _capacity));
+
+            bestScore    = _bestScore;
+            bestGapScore = _bestGapScore;
+        }
+
+        if (last_b_index < b_size - 1)
+        {
+            /* This row failed the X-dropoff test earlier than the last row did */
+            b_size = last_b_index + 1;
+        }
+        else
+        {
+            /* The inner loop finished without failing the X-dropoff test */
+            while (score_gap_row >= (best_score - x_dropoff) && b_size <= N)
+            {
+                bestScore   [b_size]  = score_gap_row;
+                bestGapScore[b_size]  = score_gap_row - gap_open_extend;
+                score_gap_row        -= gap_extend;
+                b_size++;
+            }
+        }
+
+        if (b_size <= N)
+        {
+            bestScore   [b_size] = MININT;
+            bestGapScore[b_size] = MININT;
+            b_size++;
+        }
+
+    /**********************************************************************/
+    } /* end of for (a_index =... */
+    /**********************************************************************/
+
+    DEBUG (("SemiGapAlignAVX2::computeRows:  |Q|=%3d |S|=%3d  => best=%d  aOffset=%d  bOffset=%d\n",
+        M,N, best_score, *a_offset, *b_offset
+    ));
+
+    return best_score;
+}
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,173 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+
+/** \file SemiGappedAlignAVX2.hpp
+ *  \brief Vectorized implementation of the X-drop gapped extension.
+ */
+
+#ifndef _SEMI_GAP_ALIGN_AVX2_HPP_
+#define _SEMI_GAP_ALIGN_AVX2_HPP_
+
+/********************************************************************************/
+
+#include <alignment/tools/impl/SemiGappedAlign.hpp>
+
+/********************************************************************************/
+namespace alignment {
+namespace tools     {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief X-drop gapped extension computing several extensions at the same time
+ *
+ * This implementation computes exactly the same scores and offsets as SemiGapAlign; the
+ * dynamic programming of one extension is still done row by row, since the X-drop pruning
+ * depends on the best score found so far in this order (an anti-diagonal or striped order
+ * would prune other cells and therefore could give other results). Within a row, the
+ * recurrence is sequential and the windows are short, so the vectorization is done across
+ * extensions instead:
+ *  - the substitution scores are read in a profile (one row per letter of A).
+ *  - the dynamic programming arrays belong to the instance and are only enlarged when
+ *    needed, instead of being allocated at each call. Since each thread uses its own
+ *    instance (see gapped::FullGapHitIterator), there is no need for synchronization.
+ *  - several independent extensions can be computed at the same time (computeBatch), one
+ *    per lane of the AVX2 registers, in the style of SWIPE. Each lane follows its own X-drop
+ *    window: the cells of the union of the windows are iterated and each lane only updates
+ *    its own cells, so the results are still the ones of SemiGapAlign. When only a few lanes
+ *    are still active, they are finished with the scalar code (see computeRows).
+ *
+ * The AVX2 code is compiled through the 'target' function attribute; if the running CPU
+ * doesn't support AVX2 (see isSupported), a scalar version of the same computation is used.
+ */
+class SemiGapAlignAVX2 : public SemiGapAlign
+{
+public:
+
+    /** \copydoc SemiGapAlign::SemiGapAlign */
+    SemiGapAlignAVX2 (
+        algo::core::IScoreMatrix* scoreMatrix,
+        int openGapCost,
+        int extendGapCost,
+        int Xdropoff
+    );
+
+    /** Destructor. */
+    virtual ~SemiGapAlignAVX2 ();
+
+    /** \copydoc SemiGapAlign::compute */
+    int compute (
+        const char* A,
+        const char* B,
+        u_int32_t M,
+        u_int32_t N,
+        u_int32_t* a_offset,
+        u_int32_t* b_offset,
+        bool reverse_sequence
+    );
+
+    /** \copydoc ISemiGapAlign::computeBatch
+     * The extensions are computed by groups of NB_LANES, one extension per lane of the AVX2 registers. */
+    void computeBatch (Extension* extensions, size_t nb);
+
+    /** \copydoc ISemiGapAlign::getBatchSize */
+    size_t getBatchSize ()  { return _useAVX2 ? NB_LANES : 1; }
+
+    /** Tells whether the running CPU (and OS) supports the AVX2 instructions set.
+     * \return true if the AVX2 implementation can be used.
+     */
+    static bool isSupported ();
+
+    /** Number of extensions computed at the same time by computeBatch (32 bits scores in 256 bits registers). */
+    static const size_t NB_LANES = 8;
+
+    /** Minimum number of active extensions for computeLanes; with less, the scalar code is used. */
+    static const size_t MIN_LANES = 3;
+
+protected:
+
+    /** Score type used for the dynamic programming. */
+    typedef int32_t ScoreInt;
+
+    /** Enlarge the dynamic programming arrays (their content is kept).
+     * \param[in] size : new number of cells.
+     */
+    void resize (u_int32_t size);
+
+    /** Compute the rows [a_start,M] of an extension whose previous rows have been computed
+     * in _bestScore and _bestGapScore (the window of the last computed row is [first_b_index,b_size[).
+     * \param[in] A, B, M, N, reverse_sequence : see SemiGapAlign::compute
+     * \param[in] a_start       : first row to be computed
+     * \param[in] first_b_index : first cell of the current window
+     * \param[in] b_size        : end of the current window
+     * \param[in] best_score    : best score found so far
+     * \param[in,out] a_offset, b_offset : position of the best score found so far
+     * \return the best score of the extension
+     */
+    int computeRows (
+        const char* A,
+        const char* B,
+        u_int32_t   M,
+        u_int32_t   N,
+        bool        reverse_sequence,
+        u_int32_t   a_start,
+        u_int32_t   first_b_index,
+        u_int32_t   b_size,
+        ScoreInt    best_score,
+        u_int32_t*  a_offset,
+        u_int32_t*  b_offset
+    );
+
+    /** Compute at most NB_LANES extensions at the same time.
+     * \param[in,out] extensions : extensions to be computed
+     * \param[in] nb : number of extensions (not greater than NB_LANES)
+     */
+    void computeLanes (Extension* extensions, size_t nb);
+
+    /** Enlarge the dynamic programming arrays used by computeLanes (their content is kept).
+     * \param[in] size : new number of cells per lane.
+     */
+    void resizeLanes (u_int32_t size);
+
+    /** Substitution scores; one row per letter of A. */
+    ScoreInt* _profile;
+    size_t    _rowSize;
+
+    /** Dynamic programming arrays: best score ending in a match and best score ending in a gap. */
+    ScoreInt* _bestScore;
+    ScoreInt* _bestGapScore;
+
+    /** Number of allocated cells in the dynamic programming arrays. */
+    u_int32_t _capacity;
+
+    /** Dynamic programming arrays of computeLanes (the NB_LANES values of a cell are contiguous) and
+     *  letters of B of each lane for each cell. */
+    ScoreInt* _laneBestScore;
+    ScoreInt* _laneBestGapScore;
+    ScoreInt* _laneLetters;
+
+    /** Number of allocated cells (per lane) in the arrays of computeLanes. */
+    u_int32_t _laneCapacity;
+
+    /** Tells whether AVX2 can be used. */
+    bool _useAVX2;
+};
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _SEMI_GAP_ALIGN_AVX2_HPP_ */
@@ -0,0 +1,235 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+#include <alignment/visitors/impl/BinaryOutputVisitor.hpp>
+#include <alignment/core/api/Alignment.hpp>
+
+using namespace std;
+using namespace alignment::core;
+using namespace alignment::core::impl;
+
+#include <stdio.h>
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace alignment {
+namespace visitors  {
+namespace impl      {
+/********************************************************************************/
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BinaryOutputVisitor::BinaryOutputVisitor (const std::string& uri, size_t blockSize)
+    : _file(0), _blockSize(blockSize), _currentQueryId(0), _currentSubjectId(0)
+{
+    _file = new os::impl::AsyncFileWriter (uri.c_str());
+    _file->use ();
+
+    /** We dump the header. */
+    _file->write (BinaryAlignmentReader::MAGIC, BinaryAlignmentReader::MAGIC_SIZE);
+    dumpInt (BinaryAlignmentReader::VERSION);
+    dumpInt (BinaryAlignmentReader::ORDER_MARKER);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+BinaryOutputVisitor::~BinaryOutputVisitor ()
+{
+    dumpBlock ();
+
+    _file->forget ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BinaryOutputVisitor::visitQuerySequence (const database::ISequence* seq, const misc::ProgressInfo& progress)
+{
+    if (seq != 0)  {  _currentQueryId = getId (seq->comment, seq->getLength());  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BinaryOutputVisitor::visitSubjectSequence (const database::ISequence* seq, const misc::ProgressInfo& progress)
+{
+    if (seq != 0)  {  _currentSubjectId = getId (seq->getComment().c_str(), seq->getLength());  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BinaryOutputVisitor::visitAlignment (core::Alignment* align, const misc::ProgressInfo& progress)
+{
+    _block.queryId.push_back       (_currentQueryId);
+    _block.subjectId.push_back     (_currentSubjectId);
+    _block.queryBegin.push_back    (align->getRange (Alignment::QUERY).begin);
+    _block.queryEnd.push_back      (align->getRange (Alignment::QUERY).end);
+    _block.subjectBegin.push_back  (align->getRange (Alignment::SUBJECT).begin);
+    _block.subjectEnd.push_back    (align->getRange (Alignment::SUBJECT).end);
+    _block.queryFrame.push_back    (align->getFrame (Alignment::QUERY));
+    _block.subjectFrame.push_back  (align->getFrame (Alignment::SUBJECT));
+    _block.queryNbGaps.push_back   (align->getNbGaps (Alignment::QUERY));
+    _block.subjectNbGaps.push_back (align->getNbGaps (Alignment::SUBJECT));
+    _block.length.push_back        (align->getLength());
+    _block.nbIdentities.push_back  (align->getNbIdentities());
+    _block.nbPositives.push_back   (align->getNbPositives());
+    _block.nbMisses.push_back      (align->getNbMisses());
+    _block.score.push_back         (align->getScore());
+    _block.bitScore.push_back      (align->getBitScore());
+    _block.evalue.push_back        (align->getEvalue());
+
+    if (_block.size() >= _blockSize)  { dumpBlock (); }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BinaryOutputVisitor::postVisit (core::IAlignmentContainer* result)
+{
+    dumpBlock ();
+
+    _file->flush ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int32_t BinaryOutputVisitor::getId (const char* comment, u_int32_t length)
+{
+    /** We use the same name as the tabulated output. */
+    char name[128];
+    snprintf (name, sizeof(name), "%s", comment);
+
+    char* locate = database::ISequence::searchIdSeparator (name);
+    if (locate != 0)  { *locate = 0; }
+
+    map<string,u_int32_t>::iterator lookup = _ids.find (name);
+    if (lookup != _ids.end())  { return lookup->second; }
+
+    u_int32_t id = _ids.size();
+    _ids[name] = id;
+
+    _newNames.push_back   (name);
+    _newLengths.push_back (length);
+
+    return id;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BinaryOutputVisitor::dumpBlock ()
+{
+    if (_block.size() == 0)  { return; }
+
+    DEBUG (("BinaryOutputVisitor::dumpBlock  nbAlign=%ld  nbNewNames=%ld\n", _block.size(), _newNames.size()));
+
+    /** We dump the names used for the first time by this block. */
+    dumpInt (_newNames.size());
+    for (size_t i=0; i<_newNames.size(); i++)
+    {
+        dumpInt (_newNames[i].size());
+        _file->write (_newNames[i].data(), _newNames[i].size());
+        dumpInt (_newLengths[i]);
+    }
+    _newNames.clear ();
+    _newLengths.clear ();
+
+    /** We dump the columns, in the order of the format. */
+    dumpInt (_block.size());
+    dumpInt (BinaryAlignmentBlock::NB_COLUMNS);
+
+    dumpColumn (_block.queryId);
+    dumpColumn (_block.subjectId);
+    dumpColumn (_block.queryBegin);
+    dumpColumn (_block.queryEnd);
+    dumpColumn (_block.subjectBegin);
+    dumpColumn (_block.subjectEnd);
+    dumpColumn (_block.queryFrame);
+    dumpColumn (_block.subjectFrame);
+    dumpColumn (_block.queryNbGaps);
+    dumpColumn (_block.subjectNbGaps);
+    dumpColumn (_block.length);
+    dumpColumn (_block.nbIdentities);
+    dumpColumn (_block.nbPositives);
+    dumpColumn (_block.nbMisses);
+    dumpColumn (_block.score);
+    dumpColumn (_block.bitScore);
+    dumpColumn (_block.evalue);
+
+    _block.clear ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+template<typename T> void BinaryOutputVisitor::dumpColumn (const std::vector<T>& column)
+{
+    dumpInt (column.size() * sizeof(T));
+    if (column.empty() == false)  {  _file->write ((const char*) &column[0], column.size() * sizeof(T));  }
+}
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
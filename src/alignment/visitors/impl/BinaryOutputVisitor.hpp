@@ -0,0 +1,110 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+/** \file BinaryOutputVisitor.hpp
+ *  \brief Alignments file dump in a binary columnar format.
+ */
+
+#ifndef _BINARY_OUTPUT_ALIGNMENT_CONTAINER_VISITOR_HPP_
+#define _BINARY_OUTPUT_ALIGNMENT_CONTAINER_VISITOR_HPP_
+
+/********************************************************************************/
+
+#include <alignment/visitors/impl/HierarchyAlignmentVisitor.hpp>
+#include <alignment/core/impl/BinaryAlignmentReader.hpp>
+
+#include <os/impl/AsyncFileWriter.hpp>
+
+#include <map>
+
+/********************************************************************************/
+namespace alignment {
+namespace visitors  {
+namespace impl      {
+/********************************************************************************/
+
+/** \brief Alignments file dump in a binary columnar format
+ *
+ * This visitor dumps the alignments as blocks of columns (see core::impl::BinaryAlignmentBlock
+ * for the layout). The sequences are referred by an index in a table of names (the comments
+ * truncated to the first separator, like the tabulated output); each name is dumped once,
+ * in the first block using it.
+ *
+ * Such a file can be read back without parsing through core::impl::BinaryAlignmentReader, or
+ * loaded into a container by AlignmentContainerFactory::createContainerFromUri.
+ */
+class BinaryOutputVisitor : public HierarchyAlignmentResultVisitor
+{
+public:
+
+    /** Constructor.
+     * \param[in] uri : path of the file to be created.
+     * \param[in] blockSize : number of alignments of the blocks.
+     */
+    BinaryOutputVisitor (const std::string& uri, size_t blockSize = 64*1024);
+
+    /** Destructor. */
+    virtual ~BinaryOutputVisitor ();
+
+    /** \copydoc AbstractAlignmentResultVisitor::visitQuerySequence */
+    void visitQuerySequence   (const database::ISequence* seq, const misc::ProgressInfo& progress);
+
+    /** \copydoc AbstractAlignmentResultVisitor::visitSubjectSequence */
+    void visitSubjectSequence (const database::ISequence* seq, const misc::ProgressInfo& progress);
+
+    /** \copydoc AbstractAlignmentResultVisitor::visitAlignment */
+    void visitAlignment (core::Alignment* align, const misc::ProgressInfo& progress);
+
+    /** \copydoc IAlignmentResultVisitor::finish */
+    void postVisit (core::IAlignmentContainer* result);
+
+    /** \copydoc IAlignmentResultVisitor::getPosition
+     *  Note that the alignments of the current block are counted only once the block is dumped. */
+    u_int64_t getPosition ()  { return _file->tell(); }
+
+private:
+
+    os::impl::AsyncFileWriter* _file;
+
+    /** Alignments of the current block. */
+    core::impl::BinaryAlignmentBlock _block;
+    size_t _blockSize;
+
+    /** Ids of the known names, and the names not dumped yet (with the sequences lengths). */
+    std::map<std::string,u_int32_t> _ids;
+    std::vector<std::string>        _newNames;
+    std::vector<u_int32_t>          _newLengths;
+
+    u_int32_t _currentQueryId;
+    u_int32_t _currentSubjectId;
+
+    /** Returns the id of the name of a sequence (adding it to the table if needed). */
+    u_int32_t getId (const char* comment, u_int32_t length);
+
+    /** Dumps the current block. */
+    void dumpBlock ();
+
+    /** Dumps a column of the current block. */
+    template<typename T> void dumpColumn (const std::vector<T>& column);
+
+    void dumpInt (u_int32_t value)  { _file->write ((const char*)&value, sizeof(value)); }
+};
+
+/********************************************************************************/
+}}} /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _BINARY_OUTPUT_ALIGNMENT_CONTAINER_VISITOR_HPP_ */
@@ -48,7 +48,7 @@ NucleotidConversionVisitor::NucleotidConversionVisitor (
     IAlignmentContainerVisitor* ref,
     Alignment::DbKind kind
 )
-    :  AlignmentsProxyVisitor(ref), _kind(kind), _nucleotidDb(0)
+    :  AlignmentsProxyVisitor(ref), _kind(kind), _nucleotidDb(0), _nucleotidSequence(0), _frameShift(0), _isTopFrame(true)
 {
     DEBUG (cout << "NucleotidConversionVisitor::NucleotidConversionVisitor   ref=" << ref << "  kind=" << kind << endl);
 }
@@ -79,8 +79,8 @@ void NucleotidConversionVisitor::visitAlignment  (Alignment* align, const misc::
     }
     else
     {
-        newRange.begin = _nucleotidSequence.getLength() - newRange.begin - 1 + _frameShift;
-        newRange.end   = _nucleotidSequence.getLength() - newRange.end   - 1 + _frameShift;
+        newRange.begin = _nucleotidSequence->getLength() - newRange.begin - 1 + _frameShift;
+        newRange.end   = _nucleotidSequence->getLength() - newRange.end   - 1 + _frameShift;
     }
 
     DEBUG (cout << "NucleotidConversionVisitor::visitAlignment FOUND   old=" << oldRange << "  new=" << newRange << endl);
@@ -121,16 +121,15 @@ const ISequence* NucleotidConversionVisitor::retrieveNucleotidSequence (const da
         Key key (_nucleotidDb, proteinSequence->index);
 
         map<Key,database::ISequence>::iterator look = _nucleotidSequences.find (key);
-        if (look != _nucleotidSequences.end())
+        if (look == _nucleotidSequences.end())
         {
-            _nucleotidSequence = look->second;
+            /** The sequence is retrieved directly into the cache; note that the residues of a packed
+             *  database are decoded into a buffer owned by the cached sequence, so we must not copy it. */
+            look = _nucleotidSequences.insert (make_pair (key, ISequence())).first;
+            _nucleotidDb->getSequenceByIndex (proteinSequence->index, look->second);
         }
-        else
-        {
-            _nucleotidDb->getSequenceByIndex (proteinSequence->index, _nucleotidSequence);
-            _nucleotidSequences[key] = _nucleotidSequence;
-        }
-        result = &_nucleotidSequence;
+        _nucleotidSequence = &look->second;
+        result = _nucleotidSequence;
     }
 
     else
@@ -67,12 +67,24 @@ public:
     /** \copydoc IAlignmentResultVisitor::visitAlignment */
     void visitAlignment (core::Alignment* align, const misc::ProgressInfo& progress);
 
+    /** \copydoc IAlignmentResultVisitor::postVisit
+     * The cached nucleotid sequences belong to the databases of the visited container; they are released
+     * since the databases of the next container (next block) may be allocated at the same addresses. */
+    void postVisit (core::IAlignmentContainer* result)
+    {
+        _nucleotidSequences.clear ();
+        _nucleotidDb       = 0;
+        _nucleotidSequence = 0;
+
+        _ref->postVisit (result);
+    }
+
 protected:
 
     core::Alignment::DbKind _kind;
 
     database::ISequenceDatabase* _nucleotidDb;
-    database::ISequence          _nucleotidSequence;
+    const database::ISequence*   _nucleotidSequence;
     int8_t                       _frameShift;
     bool                         _isTopFrame;
 
@@ -18,23 +18,21 @@
 #include <alignment/core/impl/AlignmentContainerFactory.hpp>
 #include <alignment/core/impl/BasicAlignmentContainer.hpp>
 
-#include <alignment/visitors/impl/TabulatedOutputVisitor.hpp>
-
 #include <algo/core/api/IAlgoEvents.hpp>
 
 #include <os/impl/DefaultOsFactory.hpp>
 
-#include <designpattern/impl/FileLineIterator.hpp>
-#include <designpattern/impl/TokenizerIterator.hpp>
-
 #include <map>
 #include <list>
 #include <set>
+#include <queue>
+#include <algorithm>
 
 #include <iostream>
-#include <fstream>
+#include <sstream>
 
 #include <stdio.h>
+#include <string.h>
 #define DEBUG(a)     //a
 #define VERBOSE(a)
 
@@ -62,6 +60,386 @@ namespace visitors  {
 namespace impl      {
 /********************************************************************************/
 
+/** Alignment as it is stored in the runs (the sequences are given by the previous items of the group).
+ * Each group of a run is its query rank (u_int64_t), the size of its content (u_int32_t) and its content:
+ * the query length and comment, then a list of items: 'S' followed by a subject length and comment, or
+ * 'H' followed by an AlignmentItem. A comment is its size (u_int32_t) followed by its characters.
+ */
+struct AlignmentItem
+{
+    u_int32_t qryBegin;
+    u_int32_t qryEnd;
+    u_int32_t sbjBegin;
+    u_int32_t sbjEnd;
+    u_int16_t qryNbGaps;
+    u_int16_t sbjNbGaps;
+    int8_t    qryFrame;
+    int8_t    sbjFrame;
+    double    evalue;
+    double    bitscore;
+    u_int32_t score;
+    u_int32_t length;
+    u_int32_t nbIdentities;
+    u_int32_t nbPositives;
+    u_int32_t nbMisses;
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+QueryRunsVisitor::QueryRunsVisitor (const std::string& uri, size_t runSize)
+    : _uri(uri), _file(0), _runSize(runSize), _queryRank(0)
+{
+    _file = new AsyncFileWriter (uri.c_str());
+    _file->use ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+QueryRunsVisitor::~QueryRunsVisitor ()
+{
+    _file->forget ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void QueryRunsVisitor::visitQuerySequence (const database::ISequence* seq, const misc::ProgressInfo& progress)
+{
+    closeGroup ();
+
+    /** We dump the buffer only between two groups, so a group is never split between two runs. */
+    if (_buffer.size() >= _runSize)  { dumpRun (); }
+
+    _groups.push_back (Group (_queryRank, _buffer.size()));
+
+    appendSequence (seq->getLength(), seq->comment);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void QueryRunsVisitor::visitSubjectSequence (const database::ISequence* seq, const misc::ProgressInfo& progress)
+{
+    append ("S", 1);
+    appendSequence (seq->getLength(), seq->getComment().c_str());
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void QueryRunsVisitor::visitAlignment (core::Alignment* a, const misc::ProgressInfo& progress)
+{
+    AlignmentItem item;
+
+    item.qryBegin     = a->getRange  (Alignment::QUERY).begin;
+    item.qryEnd       = a->getRange  (Alignment::QUERY).end;
+    item.qryNbGaps    = a->getNbGaps (Alignment::QUERY);
+    item.qryFrame     = a->getFrame  (Alignment::QUERY);
+    item.sbjBegin     = a->getRange  (Alignment::SUBJECT).begin;
+    item.sbjEnd       = a->getRange  (Alignment::SUBJECT).end;
+    item.sbjNbGaps    = a->getNbGaps (Alignment::SUBJECT);
+    item.sbjFrame     = a->getFrame  (Alignment::SUBJECT);
+    item.evalue       = a->getEvalue();
+    item.bitscore     = a->getBitScore();
+    item.score        = a->getScore();
+    item.length       = a->getLength();
+    item.nbIdentities = a->getNbIdentities();
+    item.nbPositives  = a->getNbPositives();
+    item.nbMisses     = a->getNbMisses();
+
+    append ("H", 1);
+    append (&item, sizeof(item));
+
+    /** All the alignments of a group have the same query frame. */
+    if (_groups.empty() == false)  { _groups.back().frame = item.qryFrame; }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void QueryRunsVisitor::postVisit (core::IAlignmentContainer* result)
+{
+    /** The groups of a container make a run (or more if the buffer is full). */
+    dumpRun ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+const vector<Range64>& QueryRunsVisitor::flush ()
+{
+    dumpRun ();
+
+    _file->flush ();
+
+    return _runs;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void QueryRunsVisitor::append (const void* data, size_t size)
+{
+    _buffer.insert (_buffer.end(), (const char*)data, (const char*)data + size);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void QueryRunsVisitor::appendSequence (u_int32_t length, const char* comment)
+{
+    u_int32_t size = strlen (comment);
+
+    append (&length, sizeof(length));
+    append (&size,   sizeof(size));
+    append (comment, size);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void QueryRunsVisitor::closeGroup ()
+{
+    if (_groups.empty() == false)  { _groups.back().size = _buffer.size() - _groups.back().offset; }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void QueryRunsVisitor::dumpRun ()
+{
+    closeGroup ();
+
+    if (_groups.empty() == false)
+    {
+        /** The sort must be stable: the alignments of a query (and frame) keep the order of the containers. */
+        stable_sort (_groups.begin(), _groups.end());
+
+        Range64 run (_file->tell(), 0);
+
+        for (vector<Group>::iterator it = _groups.begin(); it != _groups.end(); ++it)
+        {
+            u_int32_t size = it->size;
+
+            _file->write ((const char*) &it->rank, sizeof(it->rank));
+            _file->write ((const char*) &size,     sizeof(size));
+            _file->write (&_buffer[it->offset], size);
+        }
+
+        run.end = _file->tell();
+        _runs.push_back (run);
+
+        DEBUG (cout << "QueryRunsVisitor::dumpRun  nbGroups=" << _groups.size() << "  run=" << run << endl);
+    }
+
+    _groups.clear ();
+    _buffer.clear ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+class RunCursor
+{
+public:
+
+    /** */
+    RunCursor (const string& uri, const Range64& range, size_t index)
+        : _file(0), _position(range.begin), _end(range.end), _index(index), _rank(0)
+    {
+        _file = DefaultFactory::file().newFile (uri.c_str(), "rb");
+        _file->seeko (_position, SEEK_SET);
+    }
+
+    /** */
+    ~RunCursor ()  { delete _file; }
+
+    /** Reads the next group of the run.
+     * \return false if the run is over. */
+    bool next ()
+    {
+        if (_position >= _end)  { return false; }
+
+        u_int32_t size = 0;
+        read (&_rank, sizeof(_rank));
+        read (&size,  sizeof(size));
+
+        _content.resize (size);
+        if (size > 0)  { read (&_content[0], size); }
+
+        return true;
+    }
+
+    u_int64_t           getRank    () const  { return _rank;    }
+    size_t              getIndex   () const  { return _index;   }
+    const vector<char>& getContent () const  { return _content; }
+
+    /** Order of the merge: by rank, then by run (ie. in the order of the containers). */
+    struct Greater
+    {
+        bool operator() (const RunCursor* a, const RunCursor* b) const
+        {
+            return a->_rank > b->_rank  ||  (a->_rank == b->_rank  &&  a->_index > b->_index);
+        }
+    };
+
+private:
+
+    IFile*       _file;
+    u_int64_t    _position;
+    u_int64_t    _end;
+    size_t       _index;
+    u_int64_t    _rank;
+    vector<char> _content;
+
+    void read (void* buffer, size_t size)
+    {
+        if (_file->read (buffer, 1, size) != size)  { throw "unable to read the runs file"; }
+        _position += size;
+    }
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+class RunsMerger
+{
+public:
+
+    /** Merger of the runs [first,last) of a file. */
+    RunsMerger (const string& uri, const vector<Range64>& runs, size_t first, size_t last) : _current(0)
+    {
+        for (size_t i=first; i<last; i++)
+        {
+            RunCursor* cursor = new RunCursor (uri, runs[i], i);
+            _cursors.push_back (cursor);
+            if (cursor->next())  { _queue.push (cursor); }
+        }
+    }
+
+    /** */
+    ~RunsMerger ()
+    {
+        for (size_t i=0; i<_cursors.size(); i++)  { delete _cursors[i]; }
+    }
+
+    /** Goes to the next group (in the order of the ranks).
+     * \return false if all the runs are over. */
+    bool next ()
+    {
+        if (_current != 0  &&  _current->next())  { _queue.push (_current); }
+
+        _current = 0;
+
+        if (_queue.empty() == false)  {  _current = _queue.top();  _queue.pop();  }
+
+        return _current != 0;
+    }
+
+    /** Current group. */
+    RunCursor* current ()  { return _current; }
+
+private:
+
+    vector<RunCursor*> _cursors;
+    priority_queue<RunCursor*, vector<RunCursor*>, RunCursor::Greater> _queue;
+    RunCursor* _current;
+};
+
+/** Alignment of a query read from the runs, waiting for its insertion into the container. */
+struct PendingAlignment
+{
+    PendingAlignment (const ISequence& sbj, const AlignmentItem& it)
+        : sbjComment(sbj.comment), sbjIndex(sbj.index), sbjLength(sbj.length), item(it) {}
+    const char*   sbjComment;
+    u_int32_t     sbjIndex;
+    u_int32_t     sbjLength;
+    AlignmentItem item;
+};
+
+/** Order of insertion of the alignments of a query: by subject, then by increasing bit score, then by frames;
+ *  otherwise, we keep the order of the runs (see stable_sort). The container drops an alignment included in a
+ *  new one, so the result depends on this order: with increasing scores, an alignment can only drop alignments
+ *  that are not better than it. Note that the alignments of the reading frames of a sequence come in the
+ *  (memory) order of the frames databases, so the frames must be part of the order. */
+struct SortPendingAlignmentsFunctor  { bool operator() (const PendingAlignment& i, const PendingAlignment& j)
+{
+    if (i.sbjIndex      != j.sbjIndex)       { return i.sbjIndex      < j.sbjIndex;      }
+    if (i.item.bitscore != j.item.bitscore)  { return i.item.bitscore < j.item.bitscore; }
+    if (i.item.sbjFrame != j.item.sbjFrame)
+    {
+        return QueryRunsVisitor::getFrameOrder (i.item.sbjFrame) < QueryRunsVisitor::getFrameOrder (j.item.sbjFrame);
+    }
+    return QueryRunsVisitor::getFrameOrder (i.item.qryFrame) < QueryRunsVisitor::getFrameOrder (j.item.qryFrame);
+}};
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -114,106 +492,98 @@ public:
         _container->insertFirstLevel (&_qrySeq);
     }
 
-    /** */
-    void put (char* line)
+    /** Adds the alignments of a group of a run.
+     * \param[in] content : the content of the group.
+     * \param[in] firstGroup : false if a previous group had the same query. */
+    void put (const vector<char>& content, bool firstGroup)
     {
-        if (!line)  { return; }
-
-        char c = line[0];
+        const char* cursor = content.empty() ? 0 : &content[0];
+        const char* end    = cursor + content.size();
 
-        switch (c)
+        /** We have to reset the index of subject sequence. Note the trick: we get rid of redundant queries (just keep the first). */
+        if (firstGroup)  {  _sbjSeq.index = 0;  manageSequence (_qryIdMap, _qrySeq, _nbQrySeq, cursor);  }
+        else             {  ISequence dummy;  readSequence (dummy, cursor);                              }
 
+        while (cursor < end)
         {
-            case 'Q':
+            char c = *(cursor++);
+
+            switch (c)
             {
-                /** We have to reset the index of subject sequence. */
-                _sbjSeq.index = 0;
+                case 'S':
+                {
+                    manageSequence (_sbjIdMap, _sbjSeq, _nbSbjSeq, cursor);
+                    break;
+                }
 
-                manageSequence (c, _qryIdMap, _qrySeq, _nbQrySeq, line);
-                break;
-            }
+                case 'H':
+                {
+                    AlignmentItem item;
+                    memcpy (&item, cursor, sizeof(item));
+                    cursor += sizeof(item);
 
-            case 'S':
-            {
-                manageSequence (c, _sbjIdMap, _sbjSeq, _nbSbjSeq, line);
-                break;
+                    /** The alignment will be inserted with the other ones of the query (see insertAlignments). */
+                    _pending.push_back (PendingAlignment (_sbjSeq, item));
+
+                    break;
+                }
+
+                default:
+                {
+                    throw "bad item in the runs file";
+                }
             }
+        }
+    }
 
-            case 'H':
-            {
-                misc::Range32 qryRange;
-                u_int32_t     qryNbGaps   = 0;
-                  int32_t     qryFrame    = 0;
-                double        qryCoverage = 0;
-
-                misc::Range32 sbjRange;
-                u_int32_t     sbjNbGaps   = 0;
-                  int32_t     sbjFrame    = 0;
-                double        sbjCoverage = 0;
-
-                double    evalue   = 0;
-                double    bitscore = 0;
-                u_int32_t score    = 0;
-
-                u_int32_t length = 0;
-
-                u_int32_t nbIdentities = 0;
-                u_int32_t nbPositives  = 0;
-                u_int32_t nbMismatches = 0;
-
-                core::Alignment a;
-
-                int result = sscanf (line, "%c %d %d %d %d %lg %d %d %d %d %lg %lg %lg %d %d %d %d %d",
-					&c,
-					&(qryRange.begin), &(qryRange.end), &qryNbGaps, &qryFrame, &qryCoverage,
-					&(sbjRange.begin), &(sbjRange.end), &sbjNbGaps, &sbjFrame, &sbjCoverage,
-					&evalue, &bitscore, &score, &length,
-					&nbIdentities,&nbPositives,&nbMismatches
-                );
-				if (result != 18)  { throw "unable to parse the tmp file"; }
+    /** Inserts the alignments of the groups of the current query (see 'put'). */
+    void insertAlignments ()
+    {
+        stable_sort (_pending.begin(), _pending.end(), SortPendingAlignmentsFunctor());
 
-                qryRange = qryRange.shift (-1);
-                sbjRange = sbjRange.shift (-1);
+        for (vector<PendingAlignment>::iterator it = _pending.begin(); it != _pending.end(); ++it)
+        {
+            const AlignmentItem& item = it->item;
 
-                a.setRange  (alignment::core::Alignment::QUERY,   qryRange);
-                a.setNbGaps (alignment::core::Alignment::QUERY,   qryNbGaps);
-                a.setFrame  (alignment::core::Alignment::QUERY,   qryFrame);
+            _sbjSeq.comment = it->sbjComment;
+            _sbjSeq.index   = it->sbjIndex;
+            _sbjSeq.length  = it->sbjLength;
 
-                a.setRange  (alignment::core::Alignment::SUBJECT, sbjRange);
-                a.setNbGaps (alignment::core::Alignment::SUBJECT, sbjNbGaps);
-                a.setFrame  (alignment::core::Alignment::SUBJECT, sbjFrame);
+            core::Alignment a;
 
-                a.setEvalue   (evalue);
-                a.setBitScore (bitscore);
-                a.setScore    (score);
-                a.setLength   (length);
+            a.setRange  (alignment::core::Alignment::QUERY,   Range32 (item.qryBegin, item.qryEnd));
+            a.setNbGaps (alignment::core::Alignment::QUERY,   item.qryNbGaps);
+            a.setFrame  (alignment::core::Alignment::QUERY,   item.qryFrame);
 
-                a.setNbIdentities (nbIdentities);
-                a.setNbPositives  (nbPositives);
-                a.setNbMisses     (nbMismatches);
+            a.setRange  (alignment::core::Alignment::SUBJECT, Range32 (item.sbjBegin, item.sbjEnd));
+            a.setNbGaps (alignment::core::Alignment::SUBJECT, item.sbjNbGaps);
+            a.setFrame  (alignment::core::Alignment::SUBJECT, item.sbjFrame);
 
-                a.setSequence (alignment::core::Alignment::QUERY,   &_qrySeq);
-                a.setSequence (alignment::core::Alignment::SUBJECT, &_sbjSeq);
+            a.setEvalue   (item.evalue);
+            a.setBitScore (item.bitscore);
+            a.setScore    (item.score);
+            a.setLength   (item.length);
 
-                /** We can now insert the alignment into the container. */
-                _container->insert (a, 0);
+            a.setNbIdentities (item.nbIdentities);
+            a.setNbPositives  (item.nbPositives);
+            a.setNbMisses     (item.nbMisses);
 
-                VERBOSE (cout << "AlignmentContainerBuilderStream::put"
-                    << "  NEW ALIGNMENT, now " << _container->getAlignmentsNumber()
-                    << "  qry='" << _qrySeq.comment << "'"
-                    << "  sbj='" << _sbjSeq.comment << "'"
-                    << "  " << a.toString()
-                    << endl
-                );
+            a.setSequence (alignment::core::Alignment::QUERY,   &_qrySeq);
+            a.setSequence (alignment::core::Alignment::SUBJECT, &_sbjSeq);
 
-                break;
-            }
+            /** We can now insert the alignment into the container. */
+            _container->insert (a, 0);
 
-            default:
-            {
-                break;
-            }
+            VERBOSE (cout << "AlignmentContainerBuilderStream::insertAlignments"
+                << "  NEW ALIGNMENT, now " << _container->getAlignmentsNumber()
+                << "  qry='" << _qrySeq.comment << "'"
+                << "  sbj='" << _sbjSeq.comment << "'"
+                << "  " << a.toString()
+                << endl
+            );
         }
+
+        _pending.clear ();
     }
 
     /** */
@@ -222,6 +592,7 @@ public:
         setContainer (new BasicAlignmentContainerBis (_queryVisitor->_nbHitPerQuery, _queryVisitor->_nbAlignPerHit));
         _qryIdMap.clear ();
         _sbjIdMap.clear ();
+        _pending.clear  ();
         _qrySeq.index = _sbjSeq.index = 0;
         _nbQrySeq     = _nbSbjSeq     = 0;
     }
@@ -263,7 +634,7 @@ public:
                 );
             }
 
-            /** We reset the alignment builder for the other alignments to be parsed from the temporary file. */
+            /** We reset the alignment builder for the other alignments to be read from the runs. */
             VERBOSE (cout << "AlignmentContainerBuilderStream::dump    clearing content..." << endl);
             clear ();
         }
@@ -271,88 +642,48 @@ public:
 
 private:
 
-    /** */
-    void manageSequence (char kind, map<string,Entry>& theMap, ISequence& seq, size_t& nbSeq, char* line)
+    /** Reads the length and the comment of a sequence; the comment is kept in _commentBuffer. */
+    void readSequence (ISequence& seq, const char*& cursor)
     {
-        /** We read the first character which determines which kind of item we are going to deal with. */
-        char c;
-        char commentBuffer[4*1024];
+        u_int32_t size = 0;
 
-#if 0
-        int result = sscanf (line, "%c %d %s", &c, &seq.length, commentBuffer);
-        if (result != 3)  { throw "unable to parse the tmp file"; };
-#else
-        c = *(line);						while (*(++line) == ' ') ;
-        seq.length = misc::atoi (line);		while (*(line++) != ' ') ;
+        memcpy (&seq.length, cursor, sizeof(u_int32_t));  cursor += sizeof(u_int32_t);
+        memcpy (&size,       cursor, sizeof(u_int32_t));  cursor += sizeof(u_int32_t);
 
-        strncpy (commentBuffer, line, sizeof(commentBuffer));
-#endif
-
-        VERBOSE (cout << endl);
-
-        VERBOSE (cout << "AlignmentContainerBuilderStream::manageSequence "
-            << "  kind="    << kind
-            << "  length="  << seq.length
-            << "  buffer='" << commentBuffer << "'"
-            << endl
-        );
+        _commentBuffer.assign (cursor, size);
+        cursor += size;
+    }
 
-        char* commentBufferCursor = commentBuffer;
+    /** */
+    void manageSequence (map<string,Entry>& theMap, ISequence& seq, size_t& nbSeq, const char*& cursor)
+    {
+        readSequence (seq, cursor);
 
         /** We skip potential leading spaces. */
-        while (*commentBufferCursor==' ')  { commentBufferCursor++; }
-
-        /** We retrieve the sequence id from the full comment. */
-        char* endIdCursor = strchr (commentBufferCursor, ' ');
+        size_t first = _commentBuffer.find_first_not_of (' ');
+        if (first == string::npos)  { first = _commentBuffer.size(); }
 
-        bool transientChange = false;
+        string comment = _commentBuffer.substr (first);
 
-        if (endIdCursor != 0)
-        {
-            transientChange = true;
-            *endIdCursor = 0;
-        }
-        else
-        {
-            transientChange = false;
-            endIdCursor = commentBufferCursor;
-        }
+        /** We retrieve the sequence id from the full comment. */
+        string id = comment.substr (0, comment.find (' '));
 
         VERBOSE (cout << "AlignmentContainerBuilderStream::manageSequence "
-            << "  transient=" << transientChange
-            << "  cursor='"   << commentBufferCursor << "'"
+            << "  length="  << seq.length
+            << "  id='"     << id << "'"
             << endl
         );
 
         /** We look whether the read id is already known. */
-        map<string,Entry>::iterator lookup = theMap.find (commentBufferCursor);
-
-        if (transientChange)  { *endIdCursor = ' '; }
+        map<string,Entry>::iterator lookup = theMap.find (id);
 
-        if (lookup != theMap.end())
-        {
-            seq.comment = lookup->second.comment.c_str();
-            seq.index   = lookup->second.index;
-        }
-        else
+        if (lookup == theMap.end())
         {
-            pair<map<string,Entry>::iterator,bool> ret = theMap.insert (
-                pair<string,Entry> (
-                    commentBufferCursor,
-                    Entry(commentBufferCursor, nbSeq++)
-                )
-            );
-
-            seq.comment = ret.first->second.comment.c_str();
-            seq.index   = ret.first->second.index;
+            lookup = theMap.insert (pair<string,Entry> (id, Entry(comment, nbSeq++))).first;
         }
 
-        VERBOSE (cout << "AlignmentContainerBuilderStream::manageSequence "
-            << "  comment='" << seq.comment << "'"
-            << "  index=" << seq.index
-            << endl
-        );
-
+        seq.comment = lookup->second.comment.c_str();
+        seq.index   = lookup->second.index;
     }
 
     IAlignmentContainer* _container;
@@ -364,9 +695,14 @@ private:
     map<string,Entry> _qryIdMap;
     map<string,Entry> _sbjIdMap;
 
+    /** Alignments of the current query, not inserted yet. */
+    vector<PendingAlignment> _pending;
+
     size_t _nbQrySeq;
     size_t _nbSbjSeq;
 
+    string _commentBuffer;
+
     QueryReorderVisitor* _queryVisitor;
 };
 
@@ -382,6 +718,7 @@ QueryReorderVisitor::QueryReorderVisitor (
     algo::core::IDatabasesProvider*     databaseProvider,
     const std::string&                  outputUri,
     core::IAlignmentContainerVisitor*   realVisitor,
+    QueryRunsVisitor*                   runsVisitor,
     core::IAlignmentContainerVisitor*   finalVisitor,
     database::IDatabaseQuickReader*     qryReader,
     u_int32_t                           nbAlignmentsThreshold,
@@ -391,23 +728,21 @@ QueryReorderVisitor::QueryReorderVisitor (
     :  AlignmentsProxyVisitor(realVisitor),
        _databaseProvider(0),
        _outputUri(outputUri),
+       _runsVisitor(0),
        _finalVisitor(0),
        _qryReader(0),
-       _prevPos(0), _newPos(0),
        _nbAlignmentsThreshold(nbAlignmentsThreshold),
        _nbHitPerQuery(nbHitPerQuery),
        _nbAlignPerHit(nbAlignPerHit)
 {
     /** We keep a reference on the provided visitors. */
+    setRunsVisitor  (runsVisitor);
     setFinalVisitor (finalVisitor);
 
     /** We keep a reference on the query reader. */
     setQryReader (qryReader);
 
     setDatabasesProvider(databaseProvider);
-
-    /** We create the queries indexes file. */
-    _indexesFile.open (getIndexesFileUri().c_str(), ios::out | ios::in | ios::trunc);
 }
 
 /*********************************************************************
@@ -428,20 +763,21 @@ QueryReorderVisitor::~QueryReorderVisitor ()
 
     /** Important ! Normally, the reference should be released by the destructor of
      * the parent class (which should occur just after this destructor call).
-     * However, we need to remove the temporary file (ie. the file of the referenced
-     * visitor), and we need to have this file closed before doing the remove. A way
+     * However, we need to remove the runs file (ie. the file of the runs visitor),
+     * and we need to have this file closed before doing the remove. A way
      * to achieve this is to anticipate the setRef(0) of the parent class destructor
      * with the consequence of closing the file.
      */
+    string runsUri = _runsVisitor ? _runsVisitor->getUri() : "";
+
     setRef (0);
+    setRunsVisitor (0);
 
-    /** We close the indexes file and delete it. */
-    _indexesFile.close();
-    remove (getIndexesFileUri().c_str());
+    /** We delete the temporary files.
+     *  Note that we should be sure that they have been closed before doing this. */
+    if (runsUri.empty() == false)  { remove (runsUri.c_str()); }
 
-    /** We delete the temporary file.
-     *  Note that we should be sure that it has been closed before doing this. */
-    remove (getTmpFileUri().c_str());
+    for (size_t i=0; i<_mergeUris.size(); i++)  { remove (_mergeUris[i].c_str()); }
 }
 
 /*********************************************************************
@@ -452,19 +788,32 @@ QueryReorderVisitor::~QueryReorderVisitor ()
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-void QueryReorderVisitor::visitQuerySequence (const database::ISequence* seq, const misc::ProgressInfo& progress)
+void QueryReorderVisitor::visitQuerySequence (const database::ISequence* seq, u_int32_t block, const misc::ProgressInfo& progress)
 {
-    /** We dump the index of the previous query. */
-    dumpIndex ();
+    /** The index of the query in its database is its index in the query block. */
+    _runsVisitor->setQueryRank (getRank (block, seq->index));
 
     /** We call the delegate. */
     _ref->visitQuerySequence (seq, progress);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the query blocks of the algorithms are the ones of our query reader.
+*********************************************************************/
+core::IAlignmentContainerVisitor* QueryReorderVisitor::createBlockVisitor (const misc::Range64& queryRange)
+{
+    vector<u_int64_t>& qryOffsets = _qryReader->getOffsets();
+
+    vector<u_int64_t>::iterator lookup = lower_bound (qryOffsets.begin(), qryOffsets.end(), queryRange.begin);
 
-    /** We retrieve the query sequence identifier. */
-    if (seq)  {  seq->retrieveId (_queryId, sizeof(_queryId));  }
+    if (lookup == qryOffsets.end()  ||  *lookup != queryRange.begin)  {  throw "unknown query block for ordering the queries";  }
 
-    /** We keep the previous position. */
-    _prevPos = _newPos;
+    return new QueryBlockVisitor (this, lookup - qryOffsets.begin());
 }
 
 /*********************************************************************
@@ -475,16 +824,49 @@ void QueryReorderVisitor::visitQuerySequence (const database::ISequence* seq, co
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-void QueryReorderVisitor::dumpIndex (void)
+void QueryReorderVisitor::reduceRuns (std::string& uri, std::vector<misc::Range64>& runs)
 {
-    /** We get the new cursor location in the output stream. */
-    _newPos = _ref->getPosition ();
-
-    if (_newPos > _prevPos &&  _indexesFile.is_open())
+    while (runs.size() > MAX_MERGED_RUNS)
     {
-        char sep = ' ';
+        stringstream ss;
+        ss << getOutputFileUri() << ".tmp" << _mergeUris.size();
+        _mergeUris.push_back (ss.str());
+
+        DEBUG (cout << "QueryReorderVisitor::reduceRuns  nbRuns=" << runs.size() << "  into " << ss.str() << endl);
+
+        vector<Range64> mergedRuns;
+
+        AsyncFileWriter* file = new AsyncFileWriter (ss.str().c_str());
+        LOCAL (file);
+
+        /** We merge consecutive runs, so the order of the containers is kept for a same rank. */
+        for (size_t first=0; first<runs.size(); first+=MAX_MERGED_RUNS)
+        {
+            RunsMerger merger (uri, runs, first, min (first+MAX_MERGED_RUNS, runs.size()));
+
+            Range64 run (file->tell(), 0);
+
+            while (merger.next())
+            {
+                u_int64_t rank = merger.current()->getRank();
+                u_int32_t size = merger.current()->getContent().size();
+
+                file->write ((const char*) &rank, sizeof(rank));
+                file->write ((const char*) &size, sizeof(size));
+                if (size > 0)  { file->write (&merger.current()->getContent()[0], size); }
+            }
+
+            run.end = file->tell();
+            mergedRuns.push_back (run);
+        }
 
-        _indexesFile << _queryId << sep << _prevPos << endl;
+        file->flush ();
+
+        /** The intermediate file of the previous pass is no more needed. */
+        if (_mergeUris.size() > 1)  { remove (uri.c_str()); }
+
+        uri  = ss.str();
+        runs = mergedRuns;
     }
 }
 
@@ -500,70 +882,32 @@ void QueryReorderVisitor::finalize (void)
 {
     DEBUG (cout << "QueryReorderVisitor::finalize   uri=" << _qryReader->getUri() << endl);
 
-    /** We dump the last index. */
-    dumpIndex();
+    /** We get the sorted runs. */
+    string          uri  = _runsVisitor->getUri();
+    vector<Range64> runs = _runsVisitor->flush();
 
-    /** We force to flush the indexes file. */
-    if (_indexesFile.is_open())  { _indexesFile.flush();  }
+    /** We make sure that there are not too many runs to be merged at once. */
+    reduceRuns (uri, runs);
 
-    /** We create a file iterator on the temporary file. Note that we don't give here any range, it will be
-     *  updated during the loop over all ranges for a given query.
-     *  IMPORTANT... use a big line size since a line can be a header + a fasta comment
-     */
-    FileLineIterator lineIt (getTmpFileUri().c_str());
+    DEBUG (cout << "QueryReorderVisitor::finalize   merging " << runs.size() << " runs of " << uri << endl);
+
+    RunsMerger merger (uri, runs, 0, runs.size());
+    bool hasGroup = merger.next();
 
     /** We retrieve the partition of the query database as a vector of file offsets. */
     vector<u_int64_t>& qryOffsets = _qryReader->getOffsets();
 
-    for (size_t j=0; j<qryOffsets.size()-1; j++)
+    for (size_t j=0; j+1<qryOffsets.size(); j++)
     {
         /** We get the current range to be read in the full query database. */
         Range64 range (qryOffsets[j], qryOffsets[j+1]-1);
 
-
         /** We create the query database for the given range. Note we are interested mainly by sequences
          *  identifiers.
          */
         ISequenceDatabase* db = _databaseProvider->createDatabase (_qryReader->getUri(), range, false, 0);
         LOCAL (db);
 
-        DEBUG (cout << "-----------------------------------------------------------------------------" << endl);
-
-        /** We retrieve the set of sequences identifiers from the current query database. */
-        set<string> queriesId;
-        db->retrieveSequencesIdentifiers (queriesId);
-
-        DEBUG (cout << "QueryReorderVisitor::finalize   db created for range " << range
-            << "  nbSeq="  << db->getSequencesNumber()
-            << "  nbIds="  << queriesId.size()
-            << "  first="  << *(queriesId.begin())
-            << endl
-        );
-
-        /** We need to build a list of valid indexes ranges for the current database. */
-        map<string,list<Range64> > indexes;
-
-        /** We need to reset the index file status (for instance for clearing a EOF status from
-         *  the previous loop. */
-        _indexesFile.clear ();
-
-        /** We look for all indexes ranges for each sequence of the current query database. */
-        for (_indexesFile.seekg(0, ios::beg);  _indexesFile.eof() == false;  )
-        {
-            string    queryId;
-            Range64   range;
-
-            _indexesFile >> queryId >> range.begin; // >> range.end;
-
-            /** We look whether this index belongs to a sequence of the current database. */
-            set<string>::iterator lookup = queriesId.find (queryId);
-
-            /** We keep the entry if it matches a known sequence. */
-            if (lookup != queriesId.end())  {  (indexes[queryId]).push_back (range);  }
-        }
-
-        DEBUG (cout << "QueryReorderVisitor::finalize   " << indexes.size() << " indexes found for the current database" << endl;)
-
         AlignmentContainerBuilderStream alignStream (this);
 
         /** We loop over the sequences of the current queries database. */
@@ -575,67 +919,24 @@ void QueryReorderVisitor::finalize (void)
             /** Shortcut. */
             const ISequence* seq = seqIterator->currentItem();
 
-            /** We retrieve the sequence identifier. */
-            char id[1024];
-            size_t len = seq->retrieveId (id, sizeof(id));
-
             /** We check that we got a valid id. */
-            if (len == 0)  { continue; }
+            char id[1024];
+            if (seq->retrieveId (id, sizeof(id)) == 0)  { continue; }
 
-            /** Shortcut. */
-            list<Range64>& l = indexes[id];
+            u_int64_t currentRank = getRank (j, seq->index);
 
-            DEBUG (cout << endl);
-            DEBUG (cout << "QueryReorderVisitor::finalize   retrieveId : l.size=" << l.size() << "  id='" << id << "'" << endl);
+            /** We skip the groups of the previous ranks, if any (possible only for queries without identifier). */
+            while (hasGroup  &&  merger.current()->getRank() < currentRank)  { hasGroup = merger.next(); }
 
-            if (! l.empty())
+            if (hasGroup  &&  merger.current()->getRank() == currentRank)
             {
-                bool firstEntry = true;
-
-                for (list<Range64>::iterator entriesIt=l.begin(); entriesIt != l.end(); entriesIt++, firstEntry=false)
+                /** We add all the groups of the current query. */
+                for (bool firstGroup=true;  hasGroup && merger.current()->getRank() == currentRank;  hasGroup = merger.next(), firstGroup=false)
                 {
-                    /** We update the range to be read within the file. */
-                    lineIt.setRange (entriesIt->begin);
-
-                    DEBUG (cout <<  "QueryId=" << id
-                        << "  l.size=" << l.size()
-                        << "  range=" << (*entriesIt)
-                        << "  line=" << lineIt.currentItem()
-                        << endl
-                    );
-
-                    CHECK_BLOCK_BEGIN
-                        if (lineIt.currentItem()[0] != 'Q')  {  throw "QueryReorderVisitor::finalize => FOUND BAD CHARACTER"; }
-                    CHECK_BLOCK_END
-
-                    /** We loop each file line and parse it through an alignment builder. */
-                    bool stop = false;
-                    for (bool firstLine=true; !stop && !lineIt.isDone(); lineIt.next(), firstLine=false)
-                    {
-                        const char* current = lineIt.currentItem();
-
-                        if (*current == 'Q')
-                        {
-                            if (firstLine)
-                            {
-                                if (!firstEntry)
-                                {
-                                    /** Note the trick: we get rid of redundant 'Q' headed lines (just keep the first). */
-                                    continue;
-                                }
-                            }
-                            else
-                            {
-                                /** We got a query that is not the currently processed, which means
-                                 * that we found all required alignments for the current query. */
-                                stop=true;  continue;
-                            }
-                        }
-
-                        alignStream.put (lineIt.currentItem());
-                    }
-
-                }  /* end of for (list<Entry>::iterator entriesIt=l.begin(); */
+                    alignStream.put (merger.current()->getContent(), firstGroup);
+                }
+
+                alignStream.insertAlignments ();
             }
             else
             {
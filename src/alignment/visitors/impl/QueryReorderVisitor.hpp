@@ -27,9 +27,14 @@
 
 #include <algo/core/api/IAlgoEnvironment.hpp>
 #include <alignment/visitors/impl/ProxyVisitor.hpp>
+#include <alignment/visitors/impl/HierarchyAlignmentVisitor.hpp>
 
-#include <iostream>
-#include <fstream>
+#include <os/impl/AsyncFileWriter.hpp>
+
+#include <misc/api/types.hpp>
+
+#include <string>
+#include <vector>
 
 /********************************************************************************/
 namespace alignment {
@@ -37,19 +42,135 @@ namespace visitors  {
 namespace impl      {
 /********************************************************************************/
 
+/** \brief Visitor that dumps alignments as runs sorted by query rank
+ *
+ * The alignments are gathered by query (a query sequence, then its subjects and its
+ * alignments) in a memory buffer; each group is tagged with the rank of the query
+ * in the query database, as provided through setQueryRank (see QueryReorderVisitor::getRank).
+ *
+ * When the buffer is full or when a container has been visited, the groups are
+ * sorted by rank and query frame (keeping the visit order otherwise) and dumped in binary
+ * form at the end of the file; they make a new run. The QueryReorderVisitor then
+ * merges the runs in order to get the alignments by query rank.
+ */
+class QueryRunsVisitor : public HierarchyAlignmentResultVisitor
+{
+public:
+
+    /** Constructor.
+     * \param[in] uri : path of the file holding the runs.
+     * \param[in] runSize : size (in bytes) of the memory buffer of the runs.
+     */
+    QueryRunsVisitor (const std::string& uri, size_t runSize = 8*1024*1024);
+
+    /** Destructor. */
+    virtual ~QueryRunsVisitor ();
+
+    /** Set the rank of the query to be visited next. */
+    void setQueryRank (u_int64_t rank)  { _queryRank = rank; }
+
+    /** \copydoc AbstractAlignmentResultVisitor::visitQuerySequence */
+    void visitQuerySequence   (const database::ISequence* seq, const misc::ProgressInfo& progress);
+
+    /** \copydoc AbstractAlignmentResultVisitor::visitSubjectSequence */
+    void visitSubjectSequence (const database::ISequence* seq, const misc::ProgressInfo& progress);
+
+    /** \copydoc AbstractAlignmentResultVisitor::visitAlignment */
+    void visitAlignment (core::Alignment* align, const misc::ProgressInfo& progress);
+
+    /** \copydoc IAlignmentResultVisitor::finish */
+    void postVisit (core::IAlignmentContainer* result);
+
+    /** \copydoc IAlignmentResultVisitor::getPosition */
+    u_int64_t getPosition ()  { return _file->tell() + _buffer.size(); }
+
+    /** Dumps the pending run and waits for all the runs to be written.
+     * \return the ranges of the runs within the file. */
+    const std::vector<misc::Range64>& flush ();
+
+    /** Path of the file holding the runs. */
+    const std::string& getUri ()  { return _uri; }
+
+    /** Order of the reading frames: +1, +2, +3, then -1, -2, -3 (ie. the order of misc::ReadingFrame_e).
+     * \param[in] frame : frame of an alignment (0 if not translated).
+     * \return the rank of the frame. */
+    static int getFrameOrder (int8_t frame)  { return frame >= 0 ? frame : 3 - frame; }
+
+private:
+
+    std::string                _uri;
+    os::impl::AsyncFileWriter* _file;
+
+    /** Groups of the current run, serialized in a buffer. A container may have several groups
+     *  for a same query (one per reading frame for plastx); they are sorted by frame since the
+     *  container visits them in the (memory) order of the frames databases. */
+    struct Group
+    {
+        Group (u_int64_t r, size_t off) : rank(r), frame(0), offset(off), size(0) {}
+        u_int64_t rank;  int8_t frame;  size_t offset;  size_t size;
+        bool operator< (const Group& other) const
+        {
+            return rank < other.rank  ||  (rank == other.rank  &&  getFrameOrder (frame) < getFrameOrder (other.frame));
+        }
+    };
+    std::vector<Group> _groups;
+    std::vector<char>  _buffer;
+    size_t             _runSize;
+
+    /** Ranges of the runs already dumped. */
+    std::vector<misc::Range64> _runs;
+
+    u_int64_t _queryRank;
+
+    /** Appends data to the current group. */
+    void append (const void* data, size_t size);
+    void appendSequence (u_int32_t length, const char* comment);
+
+    /** Closes the current group. */
+    void closeGroup ();
+
+    /** Sorts the groups of the buffer and dumps them as a new run. */
+    void dumpRun ();
+};
+
 /********************************************************************************/
-/** \brief
+/** \brief Visitor that dumps alignments in the order of the query database
+ *
+ * The alignments are visited by query blocks (and subject blocks), so the queries
+ * of the output may not be in the order of the query database. This visitor gives
+ * each visited query its rank in the query database, ie. the number of its query block
+ * and its index in the block, and sends the alignments to a QueryRunsVisitor (through
+ * the 'real' visitor, which may convert the alignments).
  *
+ * The number of the query block is not known by the sequences; the algorithms
+ * give it through a QueryBlockVisitor (see createBlockVisitor).
+ *
+ * When all the alignments are found, the sorted runs are merged (a k-way merge on
+ * the query rank, with a few intermediate passes if there are too many runs) and
+ * the alignments are sent, query after query, to the final visitor. The memory used
+ * during the merge is bounded by the number of runs merged at once, not by the
+ * number of alignments.
  */
 class QueryReorderVisitor : public AlignmentsProxyVisitor
 {
 public:
 
-    /** Constructor. */
+    /** Constructor.
+     * \param[in] databaseProvider : provider of the query databases.
+     * \param[in] uri : path of the final output.
+     * \param[in] realVisitor : visitor for the alignments found; it should end with the runsVisitor.
+     * \param[in] runsVisitor : visitor that dumps the alignments as sorted runs.
+     * \param[in] finalVisitor : visitor that dumps the reordered alignments.
+     * \param[in] qryReader : reader of the query database.
+     * \param[in] nbAlignmentsThreshold : number of alignments of the containers sent to the final visitor.
+     * \param[in] nbHitPerQuery : max number of hits per query.
+     * \param[in] nbAlignPerHit : max number of alignments per hit.
+     */
     QueryReorderVisitor  (
         algo::core::IDatabasesProvider*     databaseProvider,
         const std::string&                  uri,
         core::IAlignmentContainerVisitor*   realVisitor,
+        QueryRunsVisitor*                   runsVisitor,
         core::IAlignmentContainerVisitor*   finalVisitor,
         database::IDatabaseQuickReader*     qryReader,
         u_int32_t                           nbAlignmentsThreshold,
@@ -60,8 +181,18 @@ public:
     /** Destructor. */
     virtual ~QueryReorderVisitor();
 
-    /** \copydoc AbstractAlignmentResultVisitor::visitQuerySequence */
-    void visitQuerySequence (const database::ISequence* seq, const misc::ProgressInfo& progress);
+    /** \copydoc AbstractAlignmentResultVisitor::visitQuerySequence
+     * The query is supposed to belong to the first query block. */
+    void visitQuerySequence (const database::ISequence* seq, const misc::ProgressInfo& progress)
+    {
+        visitQuerySequence (seq, 0, progress);
+    }
+
+    /** Visits a query sequence of a given query block.
+     * \param[in] seq : the query sequence, its index being its index in the query block.
+     * \param[in] block : number of the query block.
+     * \param[in] progress : progress of the iteration. */
+    void visitQuerySequence (const database::ISequence* seq, u_int32_t block, const misc::ProgressInfo& progress);
 
     /** \copydoc IAlignmentResultVisitor::visitAlignment */
     void visitAlignment (core::Alignment* align, const misc::ProgressInfo& progress)
@@ -69,17 +200,26 @@ public:
         // nothing to do here: our delegate '_realVisitor' will be called by parent class AlignmentsProxyVisitor.
     }
 
+    /** Creates a visitor that gives to this instance the alignments of a query block.
+     * \param[in] queryRange : range of the query block in the query database.
+     * \return the visitor to be used by the algorithm working on this query block. */
+    core::IAlignmentContainerVisitor* createBlockVisitor (const misc::Range64& queryRange);
+
+    /** Rank of a query in the query database: the queries are sorted by block, then by index in their block. */
+    static u_int64_t getRank (u_int32_t block, u_int32_t index)  { return ((u_int64_t)block << 32) | index; }
+
     /** \copydoc AbstractAlignmentResultVisitor::finalize */
     void finalize (void);
 
     /** */
     core::IAlignmentContainerVisitor* getFinalVisitor ()  { return _finalVisitor; }
 
+    /** Max number of runs merged at once. */
+    static const size_t MAX_MERGED_RUNS = 64;
+
 protected:
 
-    std::string getOutputFileUri  ()  { return _outputUri;                       }
-    std::string getTmpFileUri     ()  { return _outputUri + std::string(".tmp"); }
-    std::string getIndexesFileUri ()  { return _outputUri + std::string(".idx"); }
+    std::string getOutputFileUri  ()  { return _outputUri; }
 
 private:
 
@@ -90,6 +230,10 @@ private:
     /** */
     std::string _outputUri;
 
+    /** */
+    QueryRunsVisitor* _runsVisitor;
+    void setRunsVisitor (QueryRunsVisitor* runsVisitor) { SP_SETATTR(runsVisitor); }
+
     /** */
     core::IAlignmentContainerVisitor* _finalVisitor;
     void setFinalVisitor (core::IAlignmentContainerVisitor* finalVisitor) { SP_SETATTR(finalVisitor); }
@@ -98,15 +242,8 @@ private:
     database::IDatabaseQuickReader* _qryReader;
     void setQryReader (database::IDatabaseQuickReader* qryReader)  { SP_SETATTR(qryReader); }
 
-    /** We need a file for storing queries indexes. */
-    std::fstream _indexesFile;
-
-    /** */
-    char _queryId[1024];
-
-    /** */
-    int64_t _prevPos;
-    int64_t _newPos;
+    /** Files created by the intermediate merge passes. */
+    std::vector<std::string> _mergeUris;
 
     /** */
     u_int32_t _nbAlignmentsThreshold;
@@ -115,12 +252,51 @@ private:
     size_t _nbHitPerQuery;
     size_t _nbAlignPerHit;
 
-    /** */
-    void dumpIndex (void);
+    /** Merges the runs by groups of MAX_MERGED_RUNS until there are few enough runs.
+     * \param[in,out] uri : file holding the runs.
+     * \param[in,out] runs : ranges of the runs in the file. */
+    void reduceRuns (std::string& uri, std::vector<misc::Range64>& runs);
 
     friend class AlignmentContainerBuilderStream;
 };
 
+/********************************************************************************/
+/** \brief Visitor giving to a QueryReorderVisitor the number of the query block of its alignments
+ *
+ * An instance is created by QueryReorderVisitor::createBlockVisitor for each query block;
+ * the algorithm working on this block uses it as its result visitor.
+ */
+class QueryBlockVisitor : public AlignmentsProxyVisitor
+{
+public:
+
+    /** Constructor.
+     * \param[in] reorderVisitor : the visitor that reorders the alignments.
+     * \param[in] block : number of the query block.
+     */
+    QueryBlockVisitor (QueryReorderVisitor* reorderVisitor, u_int32_t block)
+        : AlignmentsProxyVisitor(reorderVisitor), _reorderVisitor(reorderVisitor), _block(block)  {}
+
+    /** \copydoc AbstractAlignmentResultVisitor::visitQuerySequence */
+    void visitQuerySequence (const database::ISequence* seq, const misc::ProgressInfo& progress)
+    {
+        _reorderVisitor->visitQuerySequence (seq, _block, progress);
+    }
+
+    /** \copydoc IAlignmentResultVisitor::visitAlignment */
+    void visitAlignment (core::Alignment* align, const misc::ProgressInfo& progress)
+    {
+        // nothing to do here: the alignments list is given to the reorder visitor by AlignmentsProxyVisitor.
+    }
+
+private:
+
+    /** Same instance as the delegate of the proxy. */
+    QueryReorderVisitor* _reorderVisitor;
+
+    u_int32_t _block;
+};
+
 /********************************************************************************/
 }}} /* end of namespaces. */
 /********************************************************************************/
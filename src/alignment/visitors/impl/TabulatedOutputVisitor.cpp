@@ -40,7 +40,11 @@ namespace impl      {
 TabulatedOutputVisitor::TabulatedOutputVisitor (const std::string& uri)
     : _file(0), _currentQuery(0), _currentSubject(0), _sep('\t')
 {
-    _file = fopen (uri.c_str(), "w");
+    _file = new os::impl::AsyncFileWriter (uri.c_str());
+    _file->use ();
+
+    _queryName[0]   = 0;
+    _subjectName[0] = 0;
 }
 
 /*********************************************************************
@@ -53,7 +57,49 @@ TabulatedOutputVisitor::TabulatedOutputVisitor (const std::string& uri)
 *********************************************************************/
 TabulatedOutputVisitor::~TabulatedOutputVisitor ()
 {
-    if (_file)  { fclose (_file); }
+    if (_file)  { _file->forget (); }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void TabulatedOutputVisitor::visitQuerySequence (const database::ISequence* seq, const misc::ProgressInfo& progress)
+{
+    _currentQuery = seq;
+
+    if (seq != 0)
+    {
+        snprintf (_queryName, sizeof(_queryName), "%s", seq->comment);
+
+        char* locate = database::ISequence::searchIdSeparator (_queryName);
+        if (locate != 0)  { *locate = 0; }
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void TabulatedOutputVisitor::visitSubjectSequence (const database::ISequence* seq, const misc::ProgressInfo& progress)
+{
+    _currentSubject = seq;
+
+    if (seq != 0)
+    {
+        snprintf (_subjectName, sizeof(_subjectName), "%s", seq->getComment().c_str());
+
+        char* locate = database::ISequence::searchIdSeparator (_subjectName);
+        if (locate != 0)  { *locate = 0; }
+    }
 }
 
 /*********************************************************************
@@ -72,7 +118,7 @@ void TabulatedOutputVisitor::visitAlignment (Alignment* align, const misc::Progr
     dumpLine (align);
 
     /** We add a return line. */
-    fprintf (_file, "\n");
+    _file->write ('\n');
 }
 
 /*********************************************************************
@@ -81,51 +127,38 @@ void TabulatedOutputVisitor::visitAlignment (Alignment* align, const misc::Progr
 ** INPUT   :
 ** OUTPUT  :
 ** RETURN  :
-** REMARKS :
+** REMARKS : the output is the same as the printf formats
+**      "%s\t%s\t%.2f\t%d\t%d\t%d\t%d\t%d\t%d\t%d\t%s\t%.1lf"
+**      with the evalue formatted according to its magnitude.
 *********************************************************************/
 void TabulatedOutputVisitor::dumpLine (core::Alignment* align)
 {
-    char* locate = 0;  // used for truncating comments to the first space character.
-
     DEBUG (("TabulatedOutputVisitor::dumpLine  align=%p\n", align));
 
-    const size_t queryNameMaxSize = 128;
-    char queryName[queryNameMaxSize];
-
-    snprintf (queryName, queryNameMaxSize, "%s", _currentQuery->comment);
-    if ( (locate = database::ISequence::searchIdSeparator (queryName)) != 0)  { *locate = 0; }
+    os::impl::AsyncFileWriter& out = *_file;
 
-    char subjectName[128] = "";
-    //snprintf (subjectName, sizeof(subjectName), "%s", _currentSubject->comment);
-    //snprintf (subjectName, sizeof(subjectName), "TEST");
-    snprintf (subjectName, sizeof(subjectName), "%s", _currentSubject->getComment().c_str());
+    out.write (_queryName);                                             out.write (_sep);
+    out.write (_subjectName);                                           out.write (_sep);
+    out.writeFixed   (100.0* align->getPercentIdentities(), 2);         out.write (_sep);
+    out.writeInteger (align->getLength());                              out.write (_sep);
+    out.writeInteger (align->getNbMisses());                            out.write (_sep);
+    out.writeInteger (align->getNbGaps());                              out.write (_sep);
+    out.writeInteger (align->getRange(Alignment::QUERY).begin   + 1);   out.write (_sep);  // add +1 because real people count from 1...
+    out.writeInteger (align->getRange(Alignment::QUERY).end     + 1);   out.write (_sep);
+    out.writeInteger (align->getRange(Alignment::SUBJECT).begin + 1);   out.write (_sep);
+    out.writeInteger (align->getRange(Alignment::SUBJECT).end   + 1);   out.write (_sep);
 
-    if ( (locate = database::ISequence::searchIdSeparator (subjectName)) != 0)  { *locate = 0; }
-
-    char evalueStr[32];
     double ev = align->getEvalue();
 
-         if (ev < 1.0e-99)  {   sprintf (evalueStr, "%2.0le", ev);  }
-    else if (ev < 0.0009)   {   sprintf (evalueStr, "%3.0le", ev);  }
-    else if (ev < 0.1)      {   sprintf (evalueStr, "%4.3lf", ev);  }
-    else if (ev < 1.0)      {   sprintf (evalueStr, "%2.1lf", ev);  }
-    else if (ev < 10.0)     {   sprintf (evalueStr, "%2.1lf", ev);  }
-    else                    {   sprintf (evalueStr, "%5.0lf", ev);  }
-
-    fprintf (_file,  "%s%c%s%c%.2f%c%d%c%d%c%d%c%d%c%d%c%d%c%d%c%s%c%.1lf",
-        queryName,                              _sep,
-        subjectName,                            _sep,
-        (100.0* align->getPercentIdentities()), _sep,
-        align->getLength(),                     _sep,
-        align->getNbMisses(),                   _sep,
-        align->getNbGaps(),                     _sep,
-        align->getRange(Alignment::QUERY).begin   + 1,     _sep,  // add +1 because real people count from 1...
-        align->getRange(Alignment::QUERY).end     + 1,     _sep,
-        align->getRange(Alignment::SUBJECT).begin + 1,     _sep,
-        align->getRange(Alignment::SUBJECT).end   + 1,     _sep,
-        evalueStr,                              _sep,
-        align->getBitScore()
-    );
+         if (ev < 1.0e-99)  {   out.writeExponent (ev, 0, 2);  }
+    else if (ev < 0.0009)   {   out.writeExponent (ev, 0, 3);  }
+    else if (ev < 0.1)      {   out.writeFixed    (ev, 3, 4);  }
+    else if (ev < 1.0)      {   out.writeFixed    (ev, 1, 2);  }
+    else if (ev < 10.0)     {   out.writeFixed    (ev, 1, 2);  }
+    else                    {   out.writeFixed    (ev, 0, 5);  }
+
+    out.write (_sep);
+    out.writeFixed (align->getBitScore(), 1);
 }
 
 /*********************************************************************
@@ -141,22 +174,21 @@ void TabulatedOutputExtendedVisitor::dumpLine (core::Alignment* align)
     /** We first call the parent method. */
     TabulatedOutputVisitor::dumpLine (align);
 
-    fprintf (_file, "%c%d %c%d%c%d%c%d%c%.1f%c%d %c%d%c%d%c%d%c%.1f%c%d",
+    os::impl::AsyncFileWriter& out = *_file;
 
-        _sep,  align->getNbPositives(),
+    out.write (_sep);  out.writeInteger (align->getNbPositives());  out.write (' ');
 
-        _sep,  align->getSequence (Alignment::QUERY)->getLength(),
-        _sep,  align->getFrame    (Alignment::QUERY),
-        _sep,  align->isTranslated(Alignment::QUERY) ? 1 : 0,
-        _sep,  align->getCoverage (Alignment::QUERY)*100.0,
-        _sep,  align->getNbGaps   (Alignment::QUERY),
+    out.write (_sep);  out.writeInteger (align->getSequence (Alignment::QUERY)->getLength());
+    out.write (_sep);  out.writeInteger (align->getFrame    (Alignment::QUERY));
+    out.write (_sep);  out.writeInteger (align->isTranslated(Alignment::QUERY) ? 1 : 0);
+    out.write (_sep);  out.writeFixed   (align->getCoverage (Alignment::QUERY)*100.0, 1);
+    out.write (_sep);  out.writeInteger (align->getNbGaps   (Alignment::QUERY));  out.write (' ');
 
-        _sep,  align->getSequence (Alignment::SUBJECT)->getLength(),
-        _sep,  align->getFrame    (Alignment::SUBJECT),
-        _sep,  align->isTranslated(Alignment::SUBJECT) ? 1 : 0,
-        _sep,  align->getCoverage (Alignment::QUERY)*100.0,
-        _sep,  align->getNbGaps   (Alignment::SUBJECT)
-    );
+    out.write (_sep);  out.writeInteger (align->getSequence (Alignment::SUBJECT)->getLength());
+    out.write (_sep);  out.writeInteger (align->getFrame    (Alignment::SUBJECT));
+    out.write (_sep);  out.writeInteger (align->isTranslated(Alignment::SUBJECT) ? 1 : 0);
+    out.write (_sep);  out.writeFixed   (align->getCoverage (Alignment::QUERY)*100.0, 1);
+    out.write (_sep);  out.writeInteger (align->getNbGaps   (Alignment::SUBJECT));
 }
 
 /********************************************************************************/
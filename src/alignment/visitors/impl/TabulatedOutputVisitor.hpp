@@ -27,6 +27,8 @@
 
 #include <alignment/visitors/impl/HierarchyAlignmentVisitor.hpp>
 
+#include <os/impl/AsyncFileWriter.hpp>
+
 /********************************************************************************/
 namespace alignment {
 namespace visitors  {
@@ -59,6 +61,9 @@ namespace impl      {
  * ENSTTRP00000007202  sp|P93207|14310_SOLLC   60.08   238  95    4   3     235   9     246   7e-75   280.4
  * ENSTTRP00000001033  sp|P29673|APTE_DROME    28.40   81   58    0   313   393   369   449   0.018   40.8
  * \endcode
+ *
+ * The lines are formatted without printf into the buffers of an os::impl::AsyncFileWriter, which
+ * writes them in its own thread; the query and subject names are computed once per sequence.
  */
 class TabulatedOutputVisitor : public HierarchyAlignmentResultVisitor
 {
@@ -71,12 +76,10 @@ public:
     virtual ~TabulatedOutputVisitor ();
 
     /** \copydoc AbstractAlignmentResultVisitor::visitQuerySequence */
-    void visitQuerySequence   (const database::ISequence* seq, const misc::ProgressInfo& progress)
-    { _currentQuery   = seq;  }
+    void visitQuerySequence   (const database::ISequence* seq, const misc::ProgressInfo& progress);
 
     /** \copydoc AbstractAlignmentResultVisitor::visitSubjectSequence */
-    void visitSubjectSequence (const database::ISequence* seq, const misc::ProgressInfo& progress)
-    { _currentSubject = seq;  }
+    void visitSubjectSequence (const database::ISequence* seq, const misc::ProgressInfo& progress);
 
     /** \copydoc AbstractAlignmentResultVisitor::visitAlignment */
     void visitAlignment (core::Alignment* align, const misc::ProgressInfo& progress);
@@ -85,20 +88,24 @@ public:
     void postVisit (core::IAlignmentContainer* result)
     {
         /** We should flush the stream. */
-        fflush (_file);
+        _file->flush ();
     }
 
     /** \copydoc IAlignmentResultVisitor::getPosition */
-    u_int64_t getPosition ()  { return ftell (_file); }
+    u_int64_t getPosition ()  { return _file->tell(); }
 
 protected:
 
-    FILE* _file;
+    os::impl::AsyncFileWriter* _file;
 
     const database::ISequence* _currentQuery;
     const database::ISequence* _currentSubject;
     char _sep;
 
+    /** Names of the current query and subject (comments truncated to the first separator). */
+    char _queryName   [128];
+    char _subjectName [128];
+
     virtual void dumpLine (core::Alignment* align);
 };
 
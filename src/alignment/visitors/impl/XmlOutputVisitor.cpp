@@ -41,7 +41,7 @@ namespace impl      {
 ** REMARKS :
 *********************************************************************/
 XmlOutputVisitor::XmlOutputVisitor (std::ostream* ostream)
-    : OstreamVisitor(ostream), _nbQuery (0), _nbSubject (0), _nbAlign(0)
+    : OstreamVisitor(ostream), _nbQuery (0), _nbSubject (0), _nbAlign(0), _writer(0)
 {
     printline (0, "<?xml version=\"1.0\" ?>");
     printline (0, "<BlastOutput>");
@@ -57,8 +57,10 @@ XmlOutputVisitor::XmlOutputVisitor (std::ostream* ostream)
 ** REMARKS :
 *********************************************************************/
 XmlOutputVisitor::XmlOutputVisitor (const std::string& uri)
-    : OstreamVisitor(uri), _nbQuery (0), _nbSubject (0), _nbAlign(0)
+    : OstreamVisitor((std::ostream*)0), _nbQuery (0), _nbSubject (0), _nbAlign(0), _writer(0)
 {
+    setWriter (new os::impl::AsyncFileWriter (uri.c_str()));
+
     printline (0, "<?xml version=\"1.0\" ?>");
     printline (0, "<BlastOutput>");
     printline (1, "<BlastOutput_iterations>");
@@ -88,6 +90,9 @@ XmlOutputVisitor::~XmlOutputVisitor ()
 
     printline (1, "</BlastOutput_iterations>");
     printline (0, "</BlastOutput>");
+
+    /** The writer dumps its last buffers when released. */
+    setWriter (0);
 }
 
 /*********************************************************************
@@ -187,6 +192,33 @@ void XmlOutputVisitor::visitAlignment (
     printline (6, "</Hsp>");
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void XmlOutputVisitor::postVisit (core::IAlignmentContainer* result)
+{
+    if (_writer != 0)  { _writer->flush ();  }
+    else               { OstreamVisitor::postVisit (result);  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+u_int64_t XmlOutputVisitor::getPosition ()
+{
+    return (_writer != 0 ? _writer->tell() : OstreamVisitor::getPosition());
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -197,6 +229,19 @@ void XmlOutputVisitor::visitAlignment (
 *********************************************************************/
 void XmlOutputVisitor::printline (size_t depth, const char* format, ...)
 {
+    if (_writer != 0)
+    {
+        for (size_t i=0; i<depth; i++)   { _writer->write ("    ", 4);  }
+
+        va_list va;
+        va_start (va, format);
+        _writer->vprint (format, va);
+        va_end (va);
+
+        _writer->write ('\n');
+        return;
+    }
+
     /** We dump the indentation. */
     for (size_t i=0; i<depth; i++)   { getStream() << "    ";  }
 
@@ -27,6 +27,8 @@
 
 #include <alignment/visitors/impl/OstreamVisitor.hpp>
 
+#include <os/impl/AsyncFileWriter.hpp>
+
 /********************************************************************************/
 namespace alignment {
 namespace visitors  {
@@ -36,6 +38,9 @@ namespace impl      {
 /** \brief Alignments file dump in XML format
  *
  * This visitor dumps alignments into a file in XML format.
+ *
+ * When created with a file path, the lines are formatted into the buffers of an
+ * os::impl::AsyncFileWriter and written in its own thread.
  */
 class XmlOutputVisitor : public OstreamVisitor
 {
@@ -59,6 +64,12 @@ public:
     /** \copydoc AbstractAlignmentResultVisitor::visitAlignment */
     void visitAlignment (core::Alignment* align, const misc::ProgressInfo& progress);
 
+    /** \copydoc IAlignmentResultVisitor::finish */
+    void postVisit (core::IAlignmentContainer* result);
+
+    /** \copydoc IAlignmentResultVisitor::getPosition */
+    u_int64_t getPosition ();
+
 private:
     void printline (size_t depth, const char* format, ...);
 
@@ -68,6 +79,10 @@ private:
     u_int32_t _nbQuery;
     u_int32_t _nbSubject;
     u_int32_t _nbAlign;
+
+    /** Writer of the file (null when the visitor dumps into a provided stream). */
+    os::impl::AsyncFileWriter* _writer;
+    void setWriter (os::impl::AsyncFileWriter* writer)  { SP_SETATTR(writer); }
 };
 
 /********************************************************************************/
@@ -30,6 +30,7 @@
 
 #include <designpattern/api/SmartPointer.hpp>
 #include <misc/api/Vector.hpp>
+#include <database/api/PackedResidues.hpp>
 
 /********************************************************************************/
 /** \brief Definition of concepts related to genomic databases. */
@@ -42,6 +43,10 @@ namespace database {
  *     - all sequences comments are contained in a vector
  *     - the whole sequences data are concatenated in a single table
  *     - an array of offsets allows to find the start of a sequence in the whole sequences data table.
+ *
+ *  The sequences data may be packed (see pack) when the cache is kept in memory without being
+ *  read through the 'database' table; the residues can then be read through 'packedData', or the
+ *  table can be restored with 'unpack'.
  */
 class ISequenceCache : public dp::SmartPointer
 {
@@ -96,9 +101,40 @@ public:
     /** Vector that stores the comments. */
     std::vector<std::string> comments;
 
+    /** Sequences data (including the shift) in a compact form; meaningful only if isPacked. */
+    PackedResidues packedData;
+
+    /** Tells whether the sequences data are packed; in such a case, 'database' is not usable. */
+    bool isPacked () const  { return packedData.getSize() > 0; }
+
+    /** Pack the sequences data into 'packedData' and release the 'database' table. */
+    void pack ()
+    {
+        if (isPacked() == false && database.size > 0)
+        {
+            packedData.pack (database.data, database.size);
+
+            /** Note that the allocator doesn't accept a null size. */
+            database.resize (1);
+        }
+    }
+
+    /** Restore the 'database' table from the packed sequences data. */
+    void unpack ()
+    {
+        if (isPacked() == true)
+        {
+            database.resize (packedData.getSize());
+            packedData.decode (0, packedData.getSize(), database.data);
+            packedData.clear ();
+        }
+    }
+
     /** We reverse the data to the other strand (only for nucl. requests). */
     void reverse ()
     {
+        unpack ();
+
         /** 1) We reorder the residues for each sequence. */
         for (size_t i=0; i<nbSequences; i++)
         {
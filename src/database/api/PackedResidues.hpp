@@ -0,0 +1,220 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+
+/** \file PackedResidues.hpp
+ *  \brief Compact storage of residues with 2, 4 or 5 bits per letter.
+ */
+
+#ifndef _PACKED_RESIDUES_HPP_
+#define _PACKED_RESIDUES_HPP_
+
+/********************************************************************************/
+
+#include <database/api/IAlphabet.hpp>
+#include <misc/api/types.hpp>
+
+#include <vector>
+#include <algorithm>
+
+/********************************************************************************/
+namespace database {
+/********************************************************************************/
+
+/** \brief Compact storage of a residues table.
+ *
+ *  The residues are stored with a few bits per letter: each code of 'nbBits' bits refers to one
+ *  of the most frequent letters of the table. The other letters (ambiguous nucleotides like N
+ *  for instance) are stored apart as a sorted list of (offset,letter) exceptions.
+ *
+ *  The number of bits is chosen for having the smallest storage: typically 2 bits for nucleotides
+ *  with a few ambiguous letters, 5 bits for amino acids. If no packing is smaller than one byte per
+ *  letter, the table is kept as is (nbBits==8).
+ *
+ *  The residues can be read one by one (getLetter) or by ranges (decode), so a neighbourhood can be
+ *  extracted without unpacking the whole table.
+ *
+ *  \code
+ *  void sample (const LETTER* data, size_t size)
+ *  {
+ *      PackedResidues packed;
+ *      packed.pack (data, size);
+ *
+ *      LETTER buffer[64];
+ *      packed.decode (10, 74, buffer);
+ *  }
+ *  \endcode
+ */
+class PackedResidues
+{
+public:
+
+    /** Constructor. */
+    PackedResidues () : _size(0), _nbBits(8), _mask(0xFF)  {}
+
+    /** Number of residues. */
+    Offset getSize () const  { return _size; }
+
+    /** Number of bits per residue (8 means no packing). */
+    size_t getNbBits () const  { return _nbBits; }
+
+    /** Memory used by the packed residues, in bytes. */
+    size_t getMemorySize () const
+    {
+        return _words.size()*sizeof(u_int64_t) + _exceptionsOffsets.size()*(sizeof(Offset)+sizeof(LETTER));
+    }
+
+    /** Pack a residues table.
+     * \param[in] data : the residues to be packed
+     * \param[in] size : number of residues
+     */
+    void pack (const LETTER* data, Offset size)
+    {
+        clear ();
+
+        _size = size;
+
+        /** We sort the letters by decreasing frequency. */
+        Offset counts[256];
+        for (size_t i=0; i<256; i++)  { counts[i] = 0; }
+        for (Offset i=0; i<size; i++)  { counts[(u_int8_t)data[i]]++; }
+
+        std::vector<std::pair<Offset,size_t> > letters;
+        for (size_t i=0; i<256; i++)  {  if (counts[i] > 0)  { letters.push_back (std::pair<Offset,size_t> (counts[i], i)); }  }
+        std::sort (letters.rbegin(), letters.rend());
+
+        /** We choose the number of bits giving the smallest storage (an exception costs an offset and a letter). */
+        size_t nbBitsTable[] = { 2, 4, 5 };
+        u_int64_t bestCost   = size;
+
+        for (size_t k=0; k<sizeof(nbBitsTable)/sizeof(nbBitsTable[0]); k++)
+        {
+            size_t    nbCodes      = (size_t)1 << nbBitsTable[k];
+            u_int64_t nbExceptions = 0;
+            for (size_t i=nbCodes; i<letters.size(); i++)  { nbExceptions += letters[i].first; }
+
+            u_int64_t cost = (size*nbBitsTable[k] + 63) / 64 * sizeof(u_int64_t) + nbExceptions * (sizeof(Offset)+sizeof(LETTER));
+
+            if (cost < bestCost)  {  bestCost = cost;  _nbBits = nbBitsTable[k];  }
+        }
+
+        _mask = ((u_int64_t)1 << _nbBits) - 1;
+
+        /** We build the codes table; unknown letters get the code 0 and are stored as exceptions.
+         *  Without packing, the codes are the letters themselves. */
+        u_int8_t codes[256];
+        bool     known[256];
+        for (size_t i=0; i<256; i++)  { codes[i] = (_nbBits==8 ? i : 0);  known[i] = (_nbBits==8);  _symbols[i] = (LETTER) i; }
+        for (size_t i=0; _nbBits<8 && i<letters.size() && i<=_mask; i++)
+        {
+            codes [letters[i].second] = i;
+            known [letters[i].second] = true;
+            _symbols[i] = (LETTER) letters[i].second;
+        }
+
+        _words.resize ((size*_nbBits + 63) / 64 + 1, 0);
+
+        for (Offset i=0; i<size; i++)
+        {
+            u_int8_t l = (u_int8_t) data[i];
+
+            if (known[l] == false)
+            {
+                _exceptionsOffsets.push_back (i);
+                _exceptionsLetters.push_back (data[i]);
+            }
+
+            u_int64_t pos   = i * _nbBits;
+            size_t    shift = pos & 63;
+            u_int64_t code  = codes[l];
+
+            _words [pos>>6] |= code << shift;
+            if (shift + _nbBits > 64)  {  _words [(pos>>6) + 1] |= code >> (64 - shift);  }
+        }
+    }
+
+    /** Get a residue.
+     * \param[in] i : offset of the residue
+     * \return the residue.
+     */
+    LETTER getLetter (Offset i) const
+    {
+        std::vector<Offset>::const_iterator look = std::lower_bound (_exceptionsOffsets.begin(), _exceptionsOffsets.end(), i);
+        if (look != _exceptionsOffsets.end() && *look == i)  { return _exceptionsLetters [look - _exceptionsOffsets.begin()]; }
+
+        return _symbols [getCode (i)];
+    }
+
+    /** Decode a range of residues.
+     * \param[in]  begin : offset of the first residue
+     * \param[in]  end   : offset after the last residue
+     * \param[out] out   : buffer receiving the end-begin residues.
+     */
+    void decode (Offset begin, Offset end, LETTER* out) const
+    {
+        for (Offset i=begin; i<end; i++)  {  out[i-begin] = _symbols [getCode (i)];  }
+
+        /** We patch the exceptions of the range. */
+        size_t k = std::lower_bound (_exceptionsOffsets.begin(), _exceptionsOffsets.end(), begin) - _exceptionsOffsets.begin();
+        for ( ; k<_exceptionsOffsets.size() && _exceptionsOffsets[k] < end; k++)
+        {
+            out [_exceptionsOffsets[k] - begin] = _exceptionsLetters[k];
+        }
+    }
+
+    /** Release the packed residues. */
+    void clear ()
+    {
+        std::vector<u_int64_t> ().swap (_words);
+        std::vector<Offset>    ().swap (_exceptionsOffsets);
+        std::vector<LETTER>    ().swap (_exceptionsLetters);
+        _size = 0;
+    }
+
+private:
+
+    Offset    _size;
+    size_t    _nbBits;
+    u_int64_t _mask;
+
+    /** Letters of the codes. */
+    LETTER _symbols[256];
+
+    /** Codes of the residues. */
+    std::vector<u_int64_t> _words;
+
+    /** Residues that have no code, sorted by offset. */
+    std::vector<Offset> _exceptionsOffsets;
+    std::vector<LETTER> _exceptionsLetters;
+
+    /** Get the code of a residue; it may be split over two words. */
+    size_t getCode (Offset i) const
+    {
+        u_int64_t pos   = i * _nbBits;
+        size_t    shift = pos & 63;
+        u_int64_t code  = _words [pos>>6] >> shift;
+
+        if (shift + _nbBits > 64)  {  code |= _words [(pos>>6) + 1] << (64 - shift);  }
+
+        return code & _mask;
+    }
+};
+
+/********************************************************************************/
+} /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _PACKED_RESIDUES_HPP_ */
@@ -63,15 +63,25 @@ public:
     /** Destructor. */
     virtual ~BufferedCachedSequenceDatabase ();
 
-    /** \copydoc BufferedSequenceDatabase::getSequenceRefByIndex */
+    /** \copydoc BufferedSequenceDatabase::getSequenceRefByIndex
+     * Note that for a packed database, the ISequence vector holds decoded copies of all the sequences,
+     * so packing is meant for databases that are not read through this method. */
     ISequence* getSequenceRefByIndex (size_t index)
     {
+        buildSequencesCache ();
         return (index < _sequences.size() ? & _sequences[index] : NULL);
     }
 
     /** \copydoc ISequenceDatabase::createSequenceIterator
-     * The cache is supposed to be already built. */
-    ISequenceIterator* createSequenceIterator () { return new BufferedCachedSequenceIterator (this, _firstIdx, _lastIdx); }
+     * The cache is supposed to be already built. For a packed database, the sequences are decoded
+     * one by one by the iterator instead of building the ISequence vector. */
+    ISequenceIterator* createSequenceIterator ()
+    {
+        if (isPacked())  {  return BufferedSequenceDatabase::createSequenceIterator ();  }
+
+        buildSequencesCache ();
+        return new BufferedCachedSequenceIterator (this, _firstIdx, _lastIdx);
+    }
 
     void reverse ()
     {
@@ -80,6 +90,15 @@ public:
         buildSequencesCache();
     }
 
+    /** \copydoc BufferedSequenceDatabase::pack
+     * The ISequence vector refers to the unpacked residues, so it is released; it will be built again if needed. */
+    void pack ()
+    {
+        BufferedSequenceDatabase::pack ();
+        std::vector<ISequence>().swap (_sequences);
+        _isBuilt = false;
+    }
+
 private:
 
     /** Boolean telling whether the ISequence vector has been built or not. */
@@ -33,6 +33,7 @@ using namespace os;
 using namespace os::impl;
 
 extern "C" void seg_filterSequence  (char* sequence, int length);
+extern "C" void seg_releaseContext  (void);
 extern "C" void dust_filterSequence (char* sequence, int length);
 extern "C" void DustMasker_filterSequence (char* s, int len);
 
@@ -148,9 +149,7 @@ ISequenceCache* BufferedSequenceDatabase::buildCache (ISequenceIterator* refIter
     result = new ISequenceCache (10*1024);
 
     /** We change the sequence builder. We initialize it with the vectors of the cache to be filled during iteration. */
-    ISequenceBuilder* builder = 0;
-    if (_filterLowComplexity == 0)   { builder = new BufferedSequenceBuilder        (result);                        }
-    else                             { builder = new BufferedSegmentSequenceBuilder (result, _filterLowComplexity);  }
+    ISequenceBuilder* builder = createCacheBuilder (result);
     refIterator->setBuilder (builder);
 
     /** We just loop through the ref iterator => the builder will fill the cache vectors. */
@@ -160,6 +159,33 @@ ISequenceCache* BufferedSequenceDatabase::buildCache (ISequenceIterator* refIter
         result->dataSize, result->nbSequences
     ));
 
+    return completeCache (result, builder);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ISequenceBuilder* BufferedSequenceDatabase::createCacheBuilder (ISequenceCache* cache)
+{
+    if (_filterLowComplexity == 0)   { return new BufferedSequenceBuilder        (cache);                        }
+    else                             { return new BufferedSegmentSequenceBuilder (cache, _filterLowComplexity);  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ISequenceCache* BufferedSequenceDatabase::completeCache (ISequenceCache* result, ISequenceBuilder* builder)
+{
     /** We may have no result; just return. */
     if (result->dataSize == 0)  { return result; }
 
@@ -267,10 +293,53 @@ void BufferedSequenceDatabase::updateSequence (size_t idx, ISequence& sequence)
     sequence.comment  = cache->comments[idx].c_str();
 
     /** We get a pointer to the data of the current sequence. */
-    sequence.data.setReference (
-            cache->offsets.data[idx+1] - currentOffset,
-        (LETTER*) (cache->database.data + currentOffset)
-    );
+    setSequenceData (cache, idx, sequence);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : for a packed cache, the buffer of the sequence is reused from one
+**           call to another, so nothing is kept by the database.
+*********************************************************************/
+void BufferedSequenceDatabase::setSequenceData (ISequenceCache* cache, size_t idx, ISequence& sequence)
+{
+    Offset begin = cache->offsets.data[idx];
+    Size   size  = cache->offsets.data[idx+1] - begin;
+
+    if (cache->isPacked() == false)
+    {
+        sequence.data.setReference (size, cache->database.data + begin);
+    }
+    else
+    {
+        /** We also decode the letters following the sequence, since the algorithms may look at them (see ISequenceCache::shift). */
+        Offset end = MIN (cache->offsets.data[idx+1] + cache->shift, cache->packedData.getSize());
+
+        misc::Vector<LETTER>& letters = sequence.data.letters;
+
+        letters.resize (end - begin + 1);
+        cache->packedData.decode (begin, end, letters.data);
+
+        /** The vector keeps its buffer, but its size is the one of the sequence. */
+        letters.size = size;
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void BufferedSequenceDatabase::pack ()
+{
+    getCache()->pack ();
 }
 
 /*********************************************************************
@@ -386,10 +455,7 @@ bool BufferedSequenceDatabase::getSequenceByOffset (
     sequence.comment  = cache->comments[idx].c_str();
 
     /** We get a pointer to the data of the current sequence. */
-    sequence.data.setReference (
-        offsets[idx+1] - off0,
-        (LETTER*) (cache->database.data + off0)
-    );
+    setSequenceData (cache, idx, sequence);
 
     sequence.index = idx;
 
@@ -497,11 +563,8 @@ void BufferedSequenceDatabase::BufferedSequenceIterator::updateItem()
     /** We set the index. */
     _item.index = _currentIdx;
 
-    /** We get a pointer to the data of the current sequence. */
-    _item.data.setReference (
-        _cache->offsets.data[_currentIdx+1] - currentOffset,
-        (LETTER*) (_cache->database.data + currentOffset)
-    );
+    /** We get a pointer to the data of the current sequence (or decode it in the item). */
+    BufferedSequenceDatabase::setSequenceData (_cache, _currentIdx, _item);
 }
 
 /*********************************************************************
@@ -682,6 +745,7 @@ void BufferedSequenceBuilder::resetData (void)
 BufferedSegmentSequenceBuilder::BufferedSegmentSequenceBuilder (ISequenceCache* cache, int segMinSize)
     : BufferedSequenceBuilder (cache),
       _filterSequenceCallback (seg_filterSequence),
+      _releaseCallback (seg_releaseContext),
       _segMinSize(segMinSize)
 {
 
@@ -691,6 +755,7 @@ BufferedSegmentSequenceBuilder::BufferedSegmentSequenceBuilder (ISequenceCache*
     if (EncodingManager::singleton().getKind () == EncodingManager::ALPHABET_NUCLEOTID)
     {
         _filterSequenceCallback = DustMasker_filterSequence;
+        _releaseCallback        = 0;
     }
 
     _destEncoding = ASCII;
@@ -713,15 +778,20 @@ struct FilterParams
 class FilterSequenceCmd : public dp::ICommand
 {
 public:
-    FilterSequenceCmd (void (*cbk) (char* seq, int len), list<FilterParams>& params) : cbk(cbk), params(params) {}
+    FilterSequenceCmd (void (*cbk) (char* seq, int len), void (*release) (void), list<FilterParams>& params)
+        : cbk(cbk), release(release), params(params) {}
 
     void execute ()
     {
         for (list<FilterParams>::iterator it = params.begin(); it != params.end(); ++it)  {  cbk (it->seq, it->len);  }
+
+        /** The filter may keep some working data for the current thread. */
+        if (release != 0)  { release (); }
     }
 
 private:
     void (*cbk) (char* seq, int len);
+    void (*release) (void);
     list<FilterParams>& params;
 };
 
@@ -735,10 +805,8 @@ void BufferedSegmentSequenceBuilder::postTreamtment (void)
     //for (size_t i=0; i<_cache->dataSize; i++)  {  printf ("%c", data[i]); }  printf("\n");
 
 #if 1
-    size_t nbCores = 1;
-
-    /** Right now, 'seg' is not parallelizable, so do it just for 'dust'. */
-    if (_filterSequenceCallback == DustMasker_filterSequence)  { nbCores = DefaultFactory::thread().getNbCores(); }
+    /** Both 'seg' and 'dust' are reentrant ('seg' uses a working context per thread). */
+    size_t nbCores = DefaultFactory::thread().getNbCores();
 
     vector<list<FilterParams> > paramsVector (nbCores);
 
@@ -755,7 +823,7 @@ void BufferedSegmentSequenceBuilder::postTreamtment (void)
 
     /** We build as many commands as wanted and execute them through a dispatcher. */
     list<ICommand*> commands;
-    for (size_t i=0; i<nbCores; i++)  {  commands.push_back (new FilterSequenceCmd (_filterSequenceCallback, paramsVector[i]));  }
+    for (size_t i=0; i<nbCores; i++)  {  commands.push_back (new FilterSequenceCmd (_filterSequenceCallback, _releaseCallback, paramsVector[i]));  }
     ParallelCommandDispatcher(nbCores).dispatchCommands (commands);
 
 #else
@@ -769,6 +837,8 @@ void BufferedSegmentSequenceBuilder::postTreamtment (void)
         /** We launch the algorithm only for big enough sequences. */
         if (len >= _segMinSize &&  _filterSequenceCallback != 0)  {  _filterSequenceCallback (data + _cache->offsets.data[i], len);   }
     }
+
+    if (_releaseCallback != 0)  { _releaseCallback (); }
 #endif
 
     const LETTER* convert = EncodingManager::singleton().getEncodingConversion (ASCII, SUBSEED);
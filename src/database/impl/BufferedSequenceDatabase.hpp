@@ -156,6 +156,16 @@ public:
     /** Change the strand of the sequences (meaningful only for nucleotides databases). */
     void reverse ();
 
+    /** Pack the residues of the cache (see ISequenceCache::pack). This is useful for a database kept
+     *  in memory but seldom read: the residues of a sequence provided afterwards are decoded into the
+     *  ISequence instance itself (so they stay valid as long as this instance, whatever the database).
+     */
+    virtual void pack ();
+
+    /** Tells whether the residues of the cache are packed.
+     * \return true if pack has been called. */
+    bool isPacked ()  { return getCache()->isPacked(); }
+
     /** \copydoc ISequenceDatabase::accept */
     void accept (DatabaseVisitor& v)
     {
@@ -204,6 +214,19 @@ protected:
      */
     ISequenceCache* buildCache (ISequenceIterator* refIterator);
 
+    /** Creates the builder filling a cache during the iteration of the sequences (according to the filtering).
+     * \param[in] cache : the cache to be filled.
+     * \return the builder.
+     */
+    ISequenceBuilder* createCacheBuilder (ISequenceCache* cache);
+
+    /** Completes a cache filled by a builder of createCacheBuilder; the database then iterates the whole cache.
+     * \param[in] cache : the filled cache.
+     * \param[in] builder : the builder that filled the cache.
+     * \return the completed cache.
+     */
+    ISequenceCache* completeCache (ISequenceCache* cache, ISequenceBuilder* builder);
+
     /** First index to be used in the cache. */
     size_t _firstIdx;
 
@@ -216,6 +239,14 @@ protected:
      */
     void updateSequence (size_t idx, ISequence& sequence);
 
+    /** Set the residues of a sequence: a reference on the cache data, or a copy decoded into
+     *  the sequence itself if the cache is packed.
+     * \param[in] cache : the cache holding the sequence
+     * \param[in] idx : index of the sequence in the cache
+     * \param[in] sequence : sequence to be filled.
+     */
+    static void setSequenceData (ISequenceCache* cache, size_t idx, ISequence& sequence);
+
     /** Tells whether the sequence have to be filtered out (ie. removing low informative regions).
      *  O means no filtering.*/
     int _filterLowComplexity;
@@ -574,6 +605,9 @@ private:
     /** We may remove low informative region (seg or dust algorithm). */
     void (*_filterSequenceCallback) (char* seq, int len);
 
+    /** Releases the working data of the filter algorithm in the calling thread (may be null). */
+    void (*_releaseCallback) (void);
+
     /** Theshold size of a sequence for launching the 'seg' algorithm. */
     int _segMinSize;
 };
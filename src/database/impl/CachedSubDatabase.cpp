@@ -14,20 +14,36 @@ CachedSubDatabase::CachedSubDatabase(ISequenceIterator* refIterator, std::set<u_
       _direction(ISequenceDatabase::PLUS)
 {
     setSequenceIterator(refIterator);
-    initializeCache();
+    initializeCache(refIterator);
     setId(refIterator->getId());
 }
 
+CachedSubDatabase::CachedSubDatabase(CachedSubDatabase* refDatabase, std::set<u_int64_t>* blacklist)
+    : _sequenceIterator(0),
+      _blacklist(blacklist),
+      _size(0),
+      _direction(refDatabase->getDirection())
+{
+    // We keep the source iterator since it owns the data of the sequences.
+    setSequenceIterator(refDatabase->_sequenceIterator);
+
+    ISequenceIterator* iterator = refDatabase->createSequenceIterator();
+    LOCAL(iterator);
+    initializeCache(iterator);
+
+    setId(refDatabase->getId());
+}
+
 CachedSubDatabase::~CachedSubDatabase() {
     setSequenceIterator(0);
 }
 
-void CachedSubDatabase::initializeCache()
+void CachedSubDatabase::initializeCache(ISequenceIterator* iterator)
 {
     int i = 0;
     _size = 0;
-    for (_sequenceIterator->first(); !_sequenceIterator->isDone(); _sequenceIterator->next()) {
-        _sequences.push_back(*_sequenceIterator->currentItem());
+    for (iterator->first(); !iterator->isDone(); iterator->next()) {
+        _sequences.push_back(*iterator->currentItem());
         ISequence& currentSequence = _sequences[_sequences.size() - 1];
         currentSequence.database = this;
 
@@ -26,6 +26,13 @@ class CachedSubDatabase : public ISequenceDatabase
 public:
     CachedSubDatabase(ISequenceIterator* refIterator, std::set<u_int64_t>* blacklist = NULL);
 
+    /**
+     * Creates a view of another CachedSubDatabase, filtered by the provided
+     * blacklist. The data of the sequences is shared with the referenced
+     * database (which should therefore not be reversed while the view is used).
+     */
+    CachedSubDatabase(CachedSubDatabase* refDatabase, std::set<u_int64_t>* blacklist);
+
     /** Destructor. */
     virtual ~CachedSubDatabase ();
 
@@ -143,9 +150,9 @@ private:
     StrandId_e _direction;
 
     /**
-     * Read and memorize the sequences from the database in _sequences.
+     * Read and memorize the sequences from the iterator in _sequences.
      */
-    void initializeCache();
+    void initializeCache(ISequenceIterator* iterator);
 
     /** Reverse a sequence
      *
@@ -18,12 +18,16 @@
 #include <misc/api/macros.hpp>
 #include <designpattern/impl/Property.hpp>
 #include <designpattern/impl/TokenizerIterator.hpp>
+#include <designpattern/impl/CommandDispatcher.hpp>
+#include <os/impl/DefaultOsFactory.hpp>
 #include <libgen.h>
 
 #define DEBUG(a)  //printf a
 
+using namespace std;
 using namespace dp;
 using namespace dp::impl;
+using namespace os::impl;
 
 /********************************************************************************/
 namespace database { namespace impl {
@@ -63,7 +67,8 @@ FastaDatabaseQuickReader::FastaDatabaseQuickReader (const std::string& uri, bool
       _nbNucleotids(0), _nbAminoAcids(0),
       _dbKind (ENUM_UNKNOWN), 
       _maxblocksize(0),
-      _getOnlyType (getOnlyType)
+      _getOnlyType (getOnlyType),
+      _nbThreads (0), _minChunkSize (MIN_CHUNK_SIZE)
 {
 }
 
@@ -89,9 +94,6 @@ FastaDatabaseQuickReader::~FastaDatabaseQuickReader  ()
 *********************************************************************/
 void FastaDatabaseQuickReader::read (u_int64_t  maxblocksize)
 {
-    size_t oldIdx     = ~0;
-    size_t currentIdx =  0;
-
     DEBUG (("FastaDatabaseQuickReader::read  maxblocksize=%ld  _getOnlyType=%d  _readThreshold=%d \n",
         maxblocksize, _getOnlyType, _readThreshold
     ));
@@ -103,12 +105,29 @@ void FastaDatabaseQuickReader::read (u_int64_t  maxblocksize)
     _maxblocksize = maxblocksize;
     _offsets.clear ();
 
-    for (_iterator.first(); !_iterator.isDone(); _iterator.next())
+    /** We compute how many threads can share the parsing; if we only want the type, a few
+     *  sequences are enough, so there is no need for threads. */
+    size_t nbThreads = (_nbThreads > 0 ? _nbThreads : DefaultFactory::thread().getNbCores());
+    size_t nbChunks  = (_minChunkSize > 0 ? _iterator.getTotalSize() / _minChunkSize : 1);
+
+    nbChunks = MIN (nbChunks, nbThreads);
+
+    if (_getOnlyType == false && nbChunks > 1)
     {
-        char* buffer = _iterator.currentItem();
+        readParallel (nbChunks);
+    }
+    else
+    {
+        size_t oldIdx     = ~0;
+        size_t currentIdx =  0;
 
-        if (*buffer == '>')
+        for (_iterator.first(); !_iterator.isDone(); _iterator.next())
         {
+            FastaEntry* entry = _iterator.currentItem();
+
+            /** We get the position of the comment in the stream. */
+            _totalSize = entry->offset;
+
             /** This is a new sequence, so we increase the number of found sequences. */
             _nbSequences ++;
 
@@ -122,47 +141,29 @@ void FastaDatabaseQuickReader::read (u_int64_t  maxblocksize)
                     oldIdx = currentIdx;
                 }
             }
-        }
-
-        else
-        {
-            if (_readThreshold > 0)
-            {
-                /** We read at most 20 characters in the current buffer. */
-                size_t imax = MIN (_iterator.getLineSize(), 10);
-                for (size_t i=0; i<imax; i++)
-                {
-                    char c = buffer[i];
-
-                    bool isNucleotid =
-                        (c=='A') || (c=='C') || (c=='G') || (c=='T') || (c=='N') || (c=='U') ||
-                        (c=='a') || (c=='c') || (c=='g') || (c=='t') || (c=='n') || (c=='u');
 
-                    if (isNucleotid)  { _nbNucleotids++;  }
-                    else              { _nbAminoAcids++;  }
+            const char* dataEnd = entry->data + entry->dataSize;
 
-                }
-
-                /** We are interested only in the type; we can break since we should have got enough residues. */
-                if (_getOnlyType)  { break; }
+            /** We look at the first lines of data for inferring the kind of database. */
+            bool hasLines = inferType (entry->data, dataEnd);
 
-                _readThreshold -= imax;
-            }
+            if (_getOnlyType && hasLines)  { break; }
 
-            /** This is pure data, we increase the total data size with the current read line. */
-            _dataSize += _iterator.getLineSize();
+            /** This is pure data, we increase the total data size with the lines of the sequence. */
+            _dataSize += entry->dataSize - FastaMappedIterator::countEndOfLines (entry->data, dataEnd);
         }
 
-        /** We get the position in the stream. */
-        _totalSize = _iterator.tell ();
+        /** We get the position at the end of the stream. */
+        if (!_iterator.isDone())  { _totalSize = _iterator.currentItem()->offset; }
+        else                      { _totalSize = _iterator.getTotalSize();        }
+
+        _offsets.push_back (_totalSize);
     }
 
     DEBUG (("FastaDatabaseQuickReader::read  _nbSequences=%d  _nbNucleotids=%d  _nbAminoAcids=%d\n",
         _nbSequences, _nbNucleotids, _nbAminoAcids
     ));
 
-    _offsets.push_back (_totalSize);
-
     /** We set the kind of bank. */
     if (_nbAminoAcids>0 || _nbNucleotids>0)
     {
@@ -180,6 +181,173 @@ void FastaDatabaseQuickReader::read (u_int64_t  maxblocksize)
     ));
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool FastaDatabaseQuickReader::inferType (const char* data, const char* dataEnd)
+{
+    bool hasLines = false;
+
+    while (_readThreshold > 0 && data < dataEnd)
+    {
+        hasLines = true;
+
+        const char* eol = (const char*) memchr (data, '\n', dataEnd - data);
+        if (eol == 0)  { eol = dataEnd; }
+
+        /** We remove the unwanted ending characters. */
+        const char* lineEnd = eol;
+        while (lineEnd > data && lineEnd[-1] == '\r')  { lineEnd--; }
+
+        /** We read at most 10 characters in the current line. */
+        size_t imax = MIN (lineEnd - data, 10);
+        for (size_t i=0; i<imax; i++)
+        {
+            char c = data[i];
+
+            bool isNucleotid =
+                (c=='A') || (c=='C') || (c=='G') || (c=='T') || (c=='N') || (c=='U') ||
+                (c=='a') || (c=='c') || (c=='g') || (c=='t') || (c=='n') || (c=='u');
+
+            if (isNucleotid)  { _nbNucleotids++;  }
+            else              { _nbAminoAcids++;  }
+        }
+
+        /** We are interested only in the type; we can stop since we should have got enough residues. */
+        if (_getOnlyType)  { break; }
+
+        _readThreshold -= imax;
+
+        data = (eol < dataEnd ? eol + 1 : dataEnd);
+    }
+
+    return hasLines;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+struct QuickReadChunk
+{
+    QuickReadChunk () : begin(0), end(0), nbSequences(0), dataSize(0), error(0) {}
+
+    u_int64_t         begin;
+    u_int64_t         end;
+    u_int32_t         nbSequences;
+    u_int64_t         dataSize;
+    vector<u_int64_t> offsets;
+    const char*       error;
+};
+
+class QuickReadChunkCmd : public ICommand
+{
+public:
+    QuickReadChunkCmd (const string& uri, u_int64_t maxblocksize, QuickReadChunk& chunk)
+        : _uri(uri), _maxblocksize(maxblocksize), _chunk(chunk)  {}
+
+    void execute ()
+    {
+        try
+        {
+            /** Each thread has its own mapping of the file(s); the range holds whole sequences. */
+            FastaMappedIterator it (_uri.c_str(), _chunk.begin, _chunk.end - 1);
+
+            size_t oldIdx = ~0;
+
+            for (it.first(); !it.isDone() && it.currentItem()->offset < _chunk.end; it.next())
+            {
+                FastaEntry* entry = it.currentItem();
+
+                _chunk.nbSequences ++;
+
+                if (_maxblocksize > 0 && entry->offset / _maxblocksize != oldIdx)
+                {
+                    oldIdx = entry->offset / _maxblocksize;
+                    _chunk.offsets.push_back (entry->offset);
+                }
+
+                _chunk.dataSize += entry->dataSize - FastaMappedIterator::countEndOfLines (entry->data, entry->data + entry->dataSize);
+            }
+        }
+        catch (const char* error)  {  _chunk.error = error;  }
+    }
+
+private:
+    string          _uri;
+    u_int64_t       _maxblocksize;
+    QuickReadChunk& _chunk;
+};
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the ranges begin with a comment, so each sequence is
+**           parsed by exactly one thread.
+*********************************************************************/
+void FastaDatabaseQuickReader::readParallel (size_t nbChunks)
+{
+    u_int64_t total = _iterator.getTotalSize();
+
+    /** The kind of bank is inferred from the first sequences, so we do it first. */
+    for (_iterator.first(); _readThreshold > 0 && !_iterator.isDone(); _iterator.next())
+    {
+        FastaEntry* entry = _iterator.currentItem();
+        inferType (entry->data, entry->data + entry->dataSize);
+    }
+
+    /** We split the file into ranges and move each bound to the next comment. */
+    vector<QuickReadChunk> chunks (nbChunks);
+    for (size_t i=0; i<nbChunks; i++)
+    {
+        u_int64_t bound = (i+1==nbChunks ? total : _iterator.findCommentOffset ((i+1) * (total / nbChunks)));
+
+        chunks[i].begin = (i==0 ? 0 : chunks[i-1].end);
+        chunks[i].end   = MAX (chunks[i].begin, bound);
+    }
+
+    /** We parse the ranges in parallel. */
+    list<ICommand*> commands;
+    for (size_t i=0; i<nbChunks; i++)
+    {
+        if (chunks[i].begin < chunks[i].end)  { commands.push_back (new QuickReadChunkCmd (_uri, _maxblocksize, chunks[i])); }
+    }
+    ParallelCommandDispatcher(commands.size()).dispatchCommands (commands);
+
+    /** We concatenate the results; a block may begin in a range and go on in the next ones, so we
+     *  keep only the first offset of each block. */
+    for (size_t i=0; i<nbChunks; i++)
+    {
+        if (chunks[i].error != 0)  { throw chunks[i].error; }
+
+        _nbSequences += chunks[i].nbSequences;
+        _dataSize    += chunks[i].dataSize;
+
+        for (size_t j=0; j<chunks[i].offsets.size(); j++)
+        {
+            u_int64_t offset = chunks[i].offsets[j];
+
+            if (_offsets.empty() || _offsets.back() / _maxblocksize != offset / _maxblocksize)  {  _offsets.push_back (offset);  }
+        }
+    }
+
+    _totalSize = total;
+
+    _offsets.push_back (_totalSize);
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -28,7 +28,7 @@
 /********************************************************************************/
 
 #include <database/api/IDatabaseQuickReader.hpp>
-#include <designpattern/impl/FileLineIterator.hpp>
+#include <database/impl/FastaMappedIterator.hpp>
 
 /********************************************************************************/
 namespace database {
@@ -46,6 +46,11 @@ namespace impl {
  *  the kind of algorithm (protein/protein, ADN/protein...) only by analyzing subject
  *  and query databases contents.
  *
+ *  Big files are parsed by several threads (see setNbThreads): the file is split into ranges
+ *  whose bounds are moved to the next comment, each thread counts the sequences and residues
+ *  of its range, and the partial results are concatenated in the ranges order. The result is
+ *  the same as the one of a serial parsing.
+ *
  *  The following sample shows how to read a FASTA database with a quick reader by blocks
  *  of 10 MBytes, then creating FASTA iterators for each found ranges of blocks (about)
  *  10 MBytes.
@@ -118,6 +123,19 @@ public:
     /** Max block size of a bank. */
     u_int64_t  getMaxBlockSize()  { return _maxblocksize; }
 
+    /** Set the number of threads used by 'read' for parsing the file; the file is split into
+     * ranges of at least 'minChunkSize' bytes (so small files are still read by one thread).
+     * \param[in] nbThreads    : number of threads (0 means the number of cores)
+     * \param[in] minChunkSize : minimum size of the range parsed by one thread.
+     */
+    void setNbThreads (size_t nbThreads, u_int64_t minChunkSize=MIN_CHUNK_SIZE)
+    {
+        _nbThreads = nbThreads;  _minChunkSize = minChunkSize;
+    }
+
+    /** Default minimum size of the range parsed by one thread (see setNbThreads). */
+    static const u_int64_t MIN_CHUNK_SIZE = 4*1024*1024;
+
     /** */
     dp::IProperties* getProperties ();
 
@@ -129,8 +147,8 @@ public:
 
 private:
 
-    /** File iterator for reading the file line by line. */
-    dp::impl::FileLineIterator _iterator;
+    /** Iterator over the sequences of the mapped file. */
+    FastaMappedIterator _iterator;
 
     /** Uri of the file to be read. */
     std::string _uri;
@@ -166,6 +184,24 @@ private:
 
     /** */
     bool _getOnlyType;
+
+    /** Number of threads used by 'read' and minimum size of the range parsed by one thread. */
+    size_t    _nbThreads;
+    u_int64_t _minChunkSize;
+
+    /** Count the residues kinds of the first lines of some sequence data, in order to infer the kind of bank.
+     * \param[in] data    : beginning of the sequence data
+     * \param[in] dataEnd : end of the sequence data
+     * \return true if the data has at least one line.
+     */
+    bool inferType (const char* data, const char* dataEnd);
+
+    /** Parse the file with several threads (see 'read'); each thread parses a range of whole
+     * sequences and the partial results are concatenated, so we get the same result as a
+     * serial parsing.
+     * \param[in] nbChunks : number of ranges to be parsed
+     */
+    void readParallel (size_t nbChunks);
 };
 
 /********************************************************************************/
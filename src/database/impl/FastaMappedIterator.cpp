@@ -0,0 +1,294 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+
+#include <database/impl/FastaMappedIterator.hpp>
+#include <designpattern/impl/TokenizerIterator.hpp>
+#include <os/impl/DefaultOsFactory.hpp>
+#include <misc/api/macros.hpp>
+
+#include <string.h>
+#include <stdio.h>
+
+#if __SSE2__
+    #include <emmintrin.h>
+#endif
+
+#define DEBUG(a)  //printf a
+
+using namespace std;
+using namespace dp;
+using namespace dp::impl;
+using namespace os;
+using namespace os::impl;
+
+/********************************************************************************/
+namespace database { namespace impl {
+/********************************************************************************/
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+FastaMappedIterator::FastaMappedIterator (const char* filename, u_int64_t offset0, u_int64_t offset1)
+    : _totalSize(0), _begin(offset0), _end(0), _fileIdx(0), _current(0), _last(0), _isDone(true)
+{
+    DEBUG (("FastaMappedIterator::FastaMappedIterator: filename='%s'  range=[%lld,%lld]\n", filename, offset0, offset1));
+
+    /** The provided filename may be a (comma separated) list of uri. */
+    TokenizerIterator tokenizer (filename, ",");
+    for (tokenizer.first (); !tokenizer.isDone(); tokenizer.next())
+    {
+        MappedFile mapped;
+        mapped.path   = tokenizer.currentItem();
+        mapped.file   = DefaultFactory::fileMem().newFile (mapped.path.c_str(), true);
+        mapped.offset = _totalSize;
+        mapped.size   = (mapped.file != 0 && mapped.file->getData() != 0) ? mapped.file->getSize() : 0;
+
+        _files.push_back (mapped);
+
+        _totalSize += mapped.size;
+    }
+
+    /** As for FileLineIterator, the range is used only if not empty. */
+    _end = (offset0 < offset1) ? MIN (offset1 + 1, _totalSize) : _totalSize;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+FastaMappedIterator::~FastaMappedIterator ()
+{
+    for (size_t i=0; i<_files.size(); i++)  {  delete _files[i].file;  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void FastaMappedIterator::first ()
+{
+    _isDone = true;
+
+    /** We have to find the file that matches the provided beginning offset. */
+    for (size_t i=0; i<_files.size(); i++)
+    {
+        if (_files[i].offset + _files[i].size >= _begin)
+        {
+            _isDone = (setFile (i, _begin) == false);
+            break;
+        }
+    }
+
+    /** We look for the first sequence. */
+    if (!_isDone)  {  next ();  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+dp::IteratorStatus FastaMappedIterator::next ()
+{
+    while (!_isDone)
+    {
+        /** We look for the next comment in the current file. */
+        const char* comment = findComment (_current, _last);
+
+        if (comment == _last)
+        {
+            /** No more sequence in this file, we go to the next one. */
+            if (_fileIdx+1 >= _files.size() || setFile (_fileIdx+1, _files[_fileIdx+1].offset) == false)  {  _isDone = true;  }
+            continue;
+        }
+
+        /** We get the end of the comment line. */
+        const char* eol = (const char*) memchr (comment, '\n', _last - comment);
+        if (eol == 0)  { eol = _last; }
+
+        /** We skip the space characters between the '>' and the actual comment, and the end of line characters. */
+        const char* commentBegin = comment + 1;
+        const char* commentEnd   = eol;
+        while (commentBegin < commentEnd && *commentBegin == ' ')  { commentBegin++; }
+        while (commentEnd > commentBegin && (commentEnd[-1] == '\r' || commentEnd[-1] == '\n'))  { commentEnd--; }
+
+        /** The data lines go up to the next comment. */
+        const char* data = (eol < _last ? eol + 1 : _last);
+        const char* nextComment = findComment (data, _last);
+
+        _entry.offset      = _files[_fileIdx].offset + (comment - _files[_fileIdx].file->getData());
+        _entry.comment     = commentBegin;
+        _entry.commentSize = commentEnd - commentBegin;
+        _entry.data        = data;
+        _entry.dataSize    = nextComment - data;
+
+        _current = nextComment;
+
+        break;
+    }
+
+    return dp::ITER_UNKNOWN;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool FastaMappedIterator::setFile (size_t idx, u_int64_t offset)
+{
+    MappedFile& mapped = _files[idx];
+
+    /** The file may be beyond the range. */
+    if (mapped.offset >= _end && mapped.size > 0)  { return false; }
+
+    /** A file that can't be mapped is either an empty file or a bad file. */
+    if (mapped.size == 0)
+    {
+        FILE* file = fopen (mapped.path.c_str(), "rb");
+        if (file == 0)  { throw "Bad input file"; }
+        fclose (file);
+    }
+
+    _fileIdx = idx;
+
+    const char* data = (mapped.size > 0 ? mapped.file->getData() : 0);
+
+    u_int64_t from = offset - mapped.offset;
+    u_int64_t to   = MIN (mapped.size, _end - mapped.offset);
+
+    _current = data + MIN (from, to);
+    _last    = data + to;
+
+    return true;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : memchr is vectorized by the C library; the '>' characters
+**           inside the sequences data are rare (none for a valid file).
+*********************************************************************/
+const char* FastaMappedIterator::findComment (const char* begin, const char* end)
+{
+    if (begin < end && *begin == '>')  { return begin; }
+
+    for (const char* p = begin; p < end; p++)
+    {
+        p = (const char*) memchr (p, '>', end - p);
+        if (p == 0)  { break; }
+
+        /** Only a '>' at the beginning of a line starts a comment. */
+        if (p[-1] == '\n')  { return p; }
+    }
+
+    return end;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+size_t FastaMappedIterator::countEndOfLines (const char* begin, const char* end)
+{
+    size_t result = 0;
+
+    const char* p = begin;
+
+#if __SSE2__
+    /** We compare 16 characters at once; the comparisons masks are counted through their bits. */
+    const __m128i lf = _mm_set1_epi8 ('\n');
+    const __m128i cr = _mm_set1_epi8 ('\r');
+
+    for ( ; p + 16 <= end; p += 16)
+    {
+        __m128i v    = _mm_loadu_si128 ((const __m128i*) p);
+        __m128i mask = _mm_or_si128 (_mm_cmpeq_epi8 (v, lf), _mm_cmpeq_epi8 (v, cr));
+
+        result += __builtin_popcount (_mm_movemask_epi8 (mask));
+    }
+#endif
+
+    for ( ; p < end; p++)  {  if (*p == '\n' || *p == '\r')  { result++; }  }
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : a '>' is a comment only at the beginning of a line, so if
+**           the offset is inside a line, we start from the next one.
+*********************************************************************/
+u_int64_t FastaMappedIterator::findCommentOffset (u_int64_t offset)
+{
+    for (size_t i=0; i<_files.size(); i++)
+    {
+        MappedFile& mapped = _files[i];
+
+        if (mapped.size == 0 || mapped.offset + mapped.size <= offset)  { continue; }
+
+        const char* data = mapped.file->getData();
+        const char* end  = data + mapped.size;
+        const char* p    = data + (offset > mapped.offset ? offset - mapped.offset : 0);
+
+        if (p > data && p[-1] != '\n')
+        {
+            p = (const char*) memchr (p, '\n', end - p);
+            p = (p != 0 ? p + 1 : end);
+        }
+
+        const char* comment = findComment (p, end);
+
+        if (comment < end)  { return mapped.offset + (comment - data); }
+    }
+
+    return _totalSize;
+}
+
+/********************************************************************************/
+} } /* end of namespaces. */
+/********************************************************************************/
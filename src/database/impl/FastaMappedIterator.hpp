@@ -0,0 +1,183 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+
+/** \file FastaMappedIterator.hpp
+ *  \brief Iterator over the sequences of memory mapped FASTA files
+ */
+
+#ifndef _FASTA_MAPPED_ITERATOR_HPP_
+#define _FASTA_MAPPED_ITERATOR_HPP_
+
+/********************************************************************************/
+
+#include <designpattern/api/Iterator.hpp>
+#include <os/api/IMemoryFile.hpp>
+#include <misc/api/types.hpp>
+
+#include <vector>
+#include <string>
+
+/********************************************************************************/
+namespace database {
+/** \brief Implementation of concepts related to genomic databases. */
+namespace impl {
+/********************************************************************************/
+
+/** \brief Raw information about a sequence of a FASTA file.
+ *
+ * The pointers refer to the memory mapped file, so they are valid as long as the
+ * FastaMappedIterator that provided them is alive.
+ */
+struct FastaEntry
+{
+    /** Offset of the '>' character of the comment (the offsets of the files of a list are cumulated). */
+    u_int64_t   offset;
+
+    /** Comment, without the '>' character, the leading spaces and the end of line characters. */
+    const char* comment;
+    size_t      commentSize;
+
+    /** Sequence data: all the lines between the comment and the next comment (end of lines included). */
+    const char* data;
+    size_t      dataSize;
+};
+
+/********************************************************************************/
+
+/** \brief Iterator over the sequences of memory mapped FASTA files
+ *
+ *  This iterator provides the same sequences as a FileLineIterator based parsing, but the files
+ *  are memory mapped instead of being read line by line through 'fgets':
+ *      - there is no copy of the lines into an intermediate buffer, and no limit for the lines size.
+ *      - the sequence data is not split into lines: the lines of a sequence are provided as a single
+ *        block, so a sequence builder can encode the whole sequence in one call (the end of line
+ *        characters are not letters, so they are skipped by the builders).
+ *      - the comments are found with 'memchr' (vectorized by the C library) instead of testing the
+ *        first character of each line.
+ *
+ *  As for FileLineIterator, the filename may be a comma separated list of files, and a range [begin,end]
+ *  of offsets may be provided for reading only a part of the files; such a range is likely to have been
+ *  computed by FastaDatabaseQuickReader, so 'begin' is the offset of a comment and 'end+1' is either the
+ *  offset of a comment or the end of the files.
+ *
+ *  \code
+ *  void sample ()
+ *  {
+ *      FastaMappedIterator it ("/tmp/db.fa");
+ *      for (it.first(); !it.isDone(); it.next())
+ *      {
+ *          FastaEntry* entry = it.currentItem ();
+ *      }
+ *  }
+ *  \endcode
+ */
+class FastaMappedIterator : public dp::Iterator<FastaEntry*>
+{
+public:
+
+    /** Constructor.
+     * \param[in]  filename : file name of the file to be iterated; can be a list of filenames separated by a comma
+     * \param[in]  offset0  : if not 0, provides the first character offset to be read in the file
+     * \param[in]  offset1  : if not 0, provides the last character offset to be read in the file
+     */
+    FastaMappedIterator (const char* filename, u_int64_t offset0=0, u_int64_t offset1=0);
+
+    /** Destructor. */
+    virtual ~FastaMappedIterator ();
+
+    /** \copydoc dp::Iterator::first */
+    void first ();
+
+    /** \copydoc dp::Iterator::next */
+    dp::IteratorStatus next ();
+
+    /** \copydoc dp::Iterator::isDone */
+    bool isDone ()  { return _isDone; }
+
+    /** \copydoc dp::Iterator::currentItem */
+    FastaEntry* currentItem ()  { return &_entry; }
+
+    /** Returns the cumulated size of the files.
+     * \return the size. */
+    u_int64_t getTotalSize ()  { return _totalSize; }
+
+    /** Look for the next comment, ie. a '>' character at the beginning of a line.
+     * \param[in] begin : beginning of the buffer, supposed to be the beginning of a line
+     * \param[in] end   : end of the buffer
+     * \return the found '>' character, 'end' otherwise.
+     */
+    static const char* findComment (const char* begin, const char* end);
+
+    /** Count the end of line characters (code 0x10 and 0x13) of a buffer.
+     * \param[in] begin : beginning of the buffer
+     * \param[in] end   : end of the buffer
+     * \return the number of end of line characters.
+     */
+    static size_t countEndOfLines (const char* begin, const char* end);
+
+    /** Look for the first comment starting at or after some offset; the offset may be anywhere
+     * in a line, so this can be used for splitting the files into ranges of whole sequences.
+     * \param[in] offset : offset (in the cumulated files) where to start the search
+     * \return the offset of the found comment, the total size of the files otherwise.
+     */
+    u_int64_t findCommentOffset (u_int64_t offset);
+
+private:
+
+    /** A mapped file and its offset in the list of files. */
+    struct MappedFile
+    {
+        os::IMemoryFile* file;
+        std::string      path;
+        u_int64_t        offset;
+        u_int64_t        size;
+    };
+
+    /** The files to be iterated. */
+    std::vector<MappedFile> _files;
+
+    /** Cumulated size of the files. */
+    u_int64_t _totalSize;
+
+    /** Range to be iterated, as [_begin,_end[ in the cumulated files. */
+    u_int64_t _begin;
+    u_int64_t _end;
+
+    /** Index of the current file, and the part of this file still to be iterated. */
+    size_t      _fileIdx;
+    const char* _current;
+    const char* _last;
+
+    /** Set the current file.
+     * \param[in] idx : index of the file
+     * \param[in] offset : offset (in the cumulated files) where to start in the file
+     * \return false if the file is beyond the range to be iterated.
+     */
+    bool setFile (size_t idx, u_int64_t offset);
+
+    /** The current sequence. */
+    FastaEntry _entry;
+
+    /** Tells whether the iteration is finished or not. */
+    bool _isDone;
+};
+
+/********************************************************************************/
+} } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* _FASTA_MAPPED_ITERATOR_HPP_ */
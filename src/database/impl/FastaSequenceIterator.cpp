@@ -49,7 +49,7 @@ FastaSequenceIterator::FastaSequenceIterator (
     u_int64_t offset0,
     u_int64_t offset1
 )
-    : _commentMaxSize(commentMaxSize),  _fileIterator (filename, commentMaxSize, offset0, offset1), _isDone(false)
+    : _commentMaxSize(commentMaxSize),  _fileIterator (filename, offset0, offset1), _isDone(false)
 {
     DEBUG (("FastaSequenceIterator::FastaSequenceIterator:  filename='%s'  range=[%ld,%ld] \n",
         filename, offset0, offset1
@@ -86,11 +86,9 @@ FastaSequenceIterator::~FastaSequenceIterator ()
 *********************************************************************/
 void FastaSequenceIterator::first()
 {
-    _isDone = false;
-
     _fileIterator.first ();
 
-    next ();
+    buildSequence ();
 }
 
 /*********************************************************************
@@ -103,55 +101,42 @@ void FastaSequenceIterator::first()
 *********************************************************************/
 dp::IteratorStatus FastaSequenceIterator::next()
 {
-    char* buffer = 0;
+    _fileIterator.next ();
+
+    buildSequence ();
+
+    return dp::ITER_UNKNOWN;
+}
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the end of line characters of the data are skipped by the
+**           builder (only letters are kept for the ASCII encoding).
+*********************************************************************/
+void FastaSequenceIterator::buildSequence ()
+{
     /** We retrieve the builder => shortcut and optimization (avoid method call) */
     ISequenceBuilder* builder = getBuilder();
 
     /** We set the isDone status. */
     _isDone = _fileIterator.isDone();
 
-    /** We look for a comment. */
-    for ( ; !_fileIterator.isDone(); _fileIterator.next())
-    {
-        /** We retrieve the current file line. */
-        buffer = _fileIterator.currentItem();
-
-        if  (buffer && buffer[0]=='>')  { break; }
-    }
-
-    /** We may have found a comment. */
-    if (buffer != 0)
+    if (!_isDone && builder)
     {
-        if (builder)
-        {
-            /** We may have to skip space characters between the '>' and the actual comment. */
-            while (*(++buffer) == ' ')   {}
-
-            size_t len = strlen (buffer);
+        FastaEntry* entry = _fileIterator.currentItem();
 
-            builder->setComment (buffer, MIN (len, _commentMaxSize) );
+        builder->setComment (entry->comment, MIN (entry->commentSize, _commentMaxSize));
 
-            /** We reset the data size. */
-            builder->resetData ();
-        }
+        /** We reset the data size. */
+        builder->resetData ();
 
-        /** We read the next line (the current one still points to the comment line). */
-        _fileIterator.next();
-
-        for ( ; !_fileIterator.isDone(); _fileIterator.next())
-        {
-            /** We retrieve the current file line. */
-            buffer = _fileIterator.currentItem();
-
-            if (buffer && buffer[0]=='>')  { break; }
-
-            /** We add the character to the sequence buffer. */
-            if (builder)  {  builder->addData ((LETTER*)buffer, strlen(buffer), ASCII);  }
-        }
+        /** We add all the lines of the sequence at once. */
+        builder->addData ((const LETTER*)entry->data, entry->dataSize, ASCII);
     }
-
-    return dp::ITER_UNKNOWN;
 }
 
 ISequenceIterator* FastaSequenceIteratorFactory::createSequenceIterator (const std::string& uri, const misc::Range64& range)
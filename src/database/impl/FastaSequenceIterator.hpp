@@ -26,6 +26,7 @@
 /********************************************************************************/
 
 #include <database/impl/AbstractSequenceIterator.hpp>
+#include <database/impl/FastaMappedIterator.hpp>
 #include <designpattern/impl/FileLineIterator.hpp>
 #include <algo/core/api/IAlgoParameters.hpp>
 #include <misc/api/types.hpp>
@@ -47,6 +48,10 @@ namespace impl {
  *  by two offsets (begin, end); such offsets may have been computed through the
  *  IDatabaseQuickReader::getOffsets method. If (0,0) is provided, the full file is read.
  *
+ *  The file is memory mapped (see FastaMappedIterator), and the data lines of a sequence are
+ *  given to the sequence builder in a single call, so the residues are directly encoded from
+ *  the mapped file into the builder buffer (a cache of a BufferedSequenceDatabase for instance).
+ *
  *  \code
  *  void foo ()
  *  {
@@ -101,8 +106,11 @@ private:
     /** Maximum size of a sequence comment. */
     size_t _commentMaxSize;
 
-    /** File line iterator for reading the file line by line. */
-    dp::impl::FileLineIterator _fileIterator;
+    /** Iterator over the sequences of the mapped file. */
+    FastaMappedIterator _fileIterator;
+
+    /** Gives the current sequence of the mapped file to the builder. */
+    void buildSequence ();
 
     /** Tells whether the iteration is finished or not. */
     bool _isDone;
@@ -15,12 +15,16 @@
  *****************************************************************************/
 
 #include <database/impl/ReadingFrameSequenceDatabase.hpp>
+#include <database/api/IAlphabet.hpp>
+
+#include <string.h>
 
 #include <stdio.h>
 #define DEBUG(a)  //printf a
 
 using namespace std;
 using namespace misc;
+using namespace os;
 
 /********************************************************************************/
 namespace database { namespace impl  {
@@ -79,6 +83,110 @@ string ReadingFrameSequenceDatabase::getId ()
     return ss.str();
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the frames of a strand must have the same filtering, like
+**           the databases created by ReadingFrameSequenceCommand.
+*********************************************************************/
+void ReadingFrameSequenceDatabase::buildCaches (const list<ISequenceDatabase*>& databases)
+{
+    /** We keep the frame databases whose cache is not built yet. */
+    list<ReadingFrameSequenceDatabase*> remaining;
+    for (list<ISequenceDatabase*>::const_iterator it = databases.begin(); it != databases.end(); it++)
+    {
+        ReadingFrameSequenceDatabase* db = dynamic_cast<ReadingFrameSequenceDatabase*> (*it);
+        if (db != 0  &&  db->_cache == 0)  { remaining.push_back (db); }
+    }
+
+    /** We gather the frames of the same strand of the same nucleotide database. */
+    while (remaining.empty() == false)
+    {
+        ReadingFrameSequenceDatabase* first = remaining.front();
+
+        vector<ReadingFrameSequenceDatabase*> strand;
+        for (list<ReadingFrameSequenceDatabase*>::iterator it = remaining.begin(); it != remaining.end(); )
+        {
+            if ((*it)->_nucleotidDatabase == first->_nucleotidDatabase  &&  (*it)->isTopFrame() == first->isTopFrame())
+            {
+                strand.push_back (*it);
+                it = remaining.erase (it);
+            }
+            else  { it++; }
+        }
+
+        buildStrandCaches (strand);
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ReadingFrameSequenceDatabase::buildStrandCaches (const vector<ReadingFrameSequenceDatabase*>& frames)
+{
+    DEBUG (("ReadingFrameSequenceDatabase::buildStrandCaches  nbFrames=%ld\n", frames.size()));
+
+    int    direction  = frames[0]->isTopFrame() ? 1 : -1;
+    bool   vectorized = ReadingFrameSequenceIterator::isVectorSupported();
+    LETTER any        = EncodingManager::singleton().getAlphabet(SUBSEED)->any;
+
+    /** We fill one cache per frame, as BufferedSequenceDatabase::buildCache does through the frame iterator. */
+    vector<ISequenceCache*>   caches   (frames.size());
+    vector<ISequenceBuilder*> builders (frames.size());
+    for (size_t k=0; k<frames.size(); k++)
+    {
+        caches[k]   = new ISequenceCache (10*1024);
+        builders[k] = frames[k]->createCacheBuilder (caches[k]);
+        builders[k]->use ();
+    }
+
+    vector<LETTER> codons;
+    vector<LETTER> acids;
+
+    ISequenceIterator* nucleotidIt = frames[0]->_nucleotidDatabase->createSequenceIterator();
+    LOCAL (nucleotidIt);
+
+    for (nucleotidIt->first(); !nucleotidIt->isDone(); nucleotidIt->next())
+    {
+        const ISequence* seq  = nucleotidIt->currentItem();
+        size_t           size = seq->data.letters.size;
+
+        /** The codons of the strand are translated once for all its frames. */
+        if (size >= 3)
+        {
+            if (codons.size() < size)  { codons.resize (size); }
+            ReadingFrameSequenceIterator::translateCodons (seq->data.letters.data, size, direction, &codons[0], vectorized);
+        }
+
+        if (acids.size() <= size/3)  { acids.resize (size/3 + 1); }
+
+        for (size_t k=0; k<frames.size(); k++)
+        {
+            size_t nbAminoAcids = ReadingFrameSequenceIterator::getFrameLetters (
+                size >= 3 ? &codons[0] : 0, size, frames[k]->_frame, any, &acids[0]
+            );
+
+            builders[k]->setComment (seq->comment, strlen (seq->comment));
+            builders[k]->resetData ();
+            builders[k]->addData (&acids[0], nbAminoAcids, SUBSEED);
+        }
+    }
+
+    for (size_t k=0; k<frames.size(); k++)
+    {
+        frames[k]->setCache (frames[k]->completeCache (caches[k], builders[k]));
+        builders[k]->forget ();
+    }
+}
+
 /********************************************************************************/
 } } /* end of namespaces. */
 /********************************************************************************/
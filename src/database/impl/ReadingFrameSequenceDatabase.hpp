@@ -33,6 +33,9 @@
 #include <database/impl/BufferedSequenceDatabase.hpp>
 #include <database/impl/ReadingFrameSequenceIterator.hpp>
 
+#include <list>
+#include <vector>
+
 /********************************************************************************/
 namespace database {
 /** \brief Implementation of concepts related to genomic databases. */
@@ -56,6 +59,8 @@ namespace impl {
  *
  *  The actual building of the amino acid sequences is done by providing (during construction) a
  *  ReadingFrameSequenceIterator instance to the base class BufferedSequenceDatabase constructor.
+ *  When several frames of a nucleotide database are needed, buildCaches builds them at once: the
+ *  codons of a strand are translated once and shared by the frames of this strand.
  *
  *  Code sample:
  *  \code
@@ -116,6 +121,13 @@ public:
     /** \copydoc BufferedSequenceDatabase::getId */
     std::string getId ();
 
+    /** Builds the caches of some reading frame databases (the other databases of the list are ignored).
+     *  Each strand of a nucleotide database is read only once: the codons at each position of a
+     *  nucleotide sequence are translated once, then split into the frames of the strand.
+     * \param[in] databases : the databases whose cache is to be built.
+     */
+    static void buildCaches (const std::list<ISequenceDatabase*>& databases);
+
 protected:
 
     /** The nucleotide database. */
@@ -126,6 +138,10 @@ protected:
 
     /** Smart setter for _frame attribute. */
     void setNucleotidDatabase (ISequenceDatabase* nucleotidDatabase)  { SP_SETATTR (nucleotidDatabase); }
+
+    /** Builds the caches of frames of a same strand of a same nucleotide database.
+     * \param[in] frames : the databases of the frames. */
+    static void buildStrandCaches (const std::vector<ReadingFrameSequenceDatabase*>& frames);
 };
 
 /********************************************************************************/
@@ -195,9 +211,8 @@ public:
     /** \copydoc dp::ICommand::execute */
     void execute ()
     {
+        /** The cache is built lazily, or by ReadingFrameSequenceDatabase::buildCaches for several frames at once. */
         _resultDatabase = new ReadingFrameSequenceDatabase (_frame, _nucleotidDatabase, _filtering);
-        /* remove the getSize because of multi thread concurrence access */
-        //_resultDatabase->getSize();
     }
 
     /** Return the (amino acid) resulting database.
@@ -20,6 +20,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+/** The SSSE3 code is compiled through the 'target' function attribute, so we don't need
+ *  specific compilation flags; this is only available with GCC (or compatible) on x86. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define FRAME_WITH_SSSE3  1
+    #include <tmmintrin.h>
+#endif
+
 #include <stdio.h>
 #define DEBUG(a)  //printf a
 
@@ -59,6 +66,196 @@ static LETTER nucleotid2acid [4][4][4] =
     }
 };
 
+/** Number of codons translated at once (their codes are kept on the stack). */
+static const size_t CODONS_BLOCK_SIZE = 256;
+
+#ifdef FRAME_WITH_SSSE3
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : computes the 2 bits codes of the letters of a strand, 16 at once
+** INPUT   : the letters of the sequence, the position (on the strand) and the
+**           number of letters to be coded, the [A,C,G,T] letters and their codes
+** OUTPUT  : codes
+** RETURN  : the number of letters coded (a multiple of 16)
+** REMARKS :
+*********************************************************************/
+__attribute__((target("ssse3")))
+static size_t fillCodesSSSE3 (
+    const LETTER* nucleotids, size_t size, int direction, size_t pos, size_t nb,
+    const LETTER letters[4], const LETTER codes[4], LETTER* result
+)
+{
+    const __m128i reverse = _mm_set_epi8 (0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15);
+
+    __m128i letter[4], code[4];
+    for (size_t k=0; k<4; k++)  {  letter[k] = _mm_set1_epi8 (letters[k]);  code[k] = _mm_set1_epi8 (codes[k]);  }
+
+    size_t j = 0;
+    for ( ; j+16 <= nb; j += 16)
+    {
+        __m128i v;
+
+        /** On the reverse strand, we read the 16 letters backwards from the end of the sequence. */
+        if (direction > 0)  {  v = _mm_loadu_si128 ((const __m128i*) (nucleotids + pos + j));                                  }
+        else                {  v = _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i*) (nucleotids + size - pos - j - 16)), reverse);  }
+
+        __m128i c = _mm_setzero_si128 ();
+        for (size_t k=0; k<4; k++)  {  c = _mm_or_si128 (c, _mm_and_si128 (_mm_cmpeq_epi8 (v, letter[k]), code[k]));  }
+
+        _mm_storeu_si128 ((__m128i*) (result + j), c);
+    }
+
+    return j;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE : translates the codons starting at each position, 16 at once
+** INPUT   : the codes of nb+2 letters, the 64 entries translation table
+** OUTPUT  : acids
+** RETURN  : the number of codons translated (a multiple of 16)
+** REMARKS : the table is split in 4 tables of 16 entries used by shuffles,
+**           the right one being selected by the first letter of the codon.
+*********************************************************************/
+__attribute__((target("ssse3")))
+static size_t lookupCodonsSSSE3 (const LETTER* codes, size_t nb, const LETTER* table, LETTER* acids)
+{
+    __m128i tables[4], selectors[4];
+    for (size_t k=0; k<4; k++)
+    {
+        tables[k]    = _mm_loadu_si128 ((const __m128i*) (table + 16*k));
+        selectors[k] = _mm_set1_epi8 (k);
+    }
+
+    size_t i = 0;
+    for ( ; i+16 <= nb; i += 16)
+    {
+        __m128i c1 = _mm_loadu_si128 ((const __m128i*) (codes + i + 0));
+        __m128i c2 = _mm_loadu_si128 ((const __m128i*) (codes + i + 1));
+        __m128i c3 = _mm_loadu_si128 ((const __m128i*) (codes + i + 2));
+
+        /** Index in the table of the second and third letters (the codes are small, so the 16 bits shifts don't overflow). */
+        __m128i low = _mm_or_si128 (_mm_slli_epi16 (c2, 2), c3);
+
+        __m128i a = _mm_setzero_si128 ();
+        for (size_t k=0; k<4; k++)
+        {
+            a = _mm_or_si128 (a, _mm_and_si128 (_mm_cmpeq_epi8 (c1, selectors[k]), _mm_shuffle_epi8 (tables[k], low)));
+        }
+
+        _mm_storeu_si128 ((__m128i*) (acids + i), a);
+    }
+
+    return i;
+}
+
+#endif
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool ReadingFrameSequenceIterator::isVectorSupported ()
+{
+#ifdef FRAME_WITH_SSSE3
+    __builtin_cpu_init ();
+    return __builtin_cpu_supports ("ssse3");
+#else
+    return false;
+#endif
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ReadingFrameSequenceIterator::translateCodons (const LETTER* nucleotids, size_t size, int direction, LETTER* acids, bool vectorized)
+{
+    if (size < 3)  { return; }
+
+    IAlphabet* alphabet = EncodingManager::singleton().getAlphabet (SUBSEED);
+
+    /** The letters [A,C,G,T] according to the current encoding, and their codes in the translation table.
+     *  On the reverse strand, the letters are complemented. The other letters are coded as 0. */
+    const LETTER letters[4] = {
+        alphabet->letters[CODE_A], alphabet->letters[CODE_C], alphabet->letters[CODE_G], alphabet->letters[CODE_T]
+    };
+    const LETTER direct[4]  = { 0, 1, 2, 3 };
+    const LETTER reverse[4] = { 3, 2, 1, 0 };
+    const LETTER* codes = (direction > 0 ? direct : reverse);
+
+    const LETTER* table = &nucleotid2acid[0][0][0];
+
+    LETTER blockCodes [CODONS_BLOCK_SIZE + 2];
+
+    size_t nbCodons = size - 2;
+
+    for (size_t pos=0; pos<nbCodons; pos += CODONS_BLOCK_SIZE)
+    {
+        size_t nb = MIN (CODONS_BLOCK_SIZE, nbCodons - pos);
+
+        size_t j = 0;
+        size_t i = 0;
+
+#ifdef FRAME_WITH_SSSE3
+        if (vectorized)  {  j = fillCodesSSSE3 (nucleotids, size, direction, pos, nb+2, letters, codes, blockCodes);  }
+#endif
+
+        /** We get the codes of the remaining letters of the block (the codons need 2 more letters). */
+        for ( ; j<nb+2; j++)
+        {
+            LETTER l = (direction > 0 ? nucleotids [pos + j] : nucleotids [size - 1 - pos - j]);
+
+                 if (l==letters[0])  { blockCodes[j] = codes[0]; }
+            else if (l==letters[1])  { blockCodes[j] = codes[1]; }
+            else if (l==letters[2])  { blockCodes[j] = codes[2]; }
+            else if (l==letters[3])  { blockCodes[j] = codes[3]; }
+            else                     { blockCodes[j] = 0;        }
+        }
+
+#ifdef FRAME_WITH_SSSE3
+        if (vectorized)  {  i = lookupCodonsSSSE3 (blockCodes, nb, table, acids + pos);  }
+#endif
+
+        for ( ; i<nb; i++)
+        {
+            acids [pos + i] = table [16*blockCodes[i] + 4*blockCodes[i+1] + blockCodes[i+2]];
+        }
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+size_t ReadingFrameSequenceIterator::getFrameLetters (const LETTER* codons, size_t size, ReadingFrame_e frame, LETTER any, LETTER* acids)
+{
+    /** The frame reads one codon every 3 positions, from its first position on the strand. */
+    size_t i = (frame <= FRAME_3 ? frame : frame - 3);
+
+    size_t nbAminoAcids = 0;
+    for ( ; i+3 <= size; i += 3)  {  acids [nbAminoAcids++] = codons[i];  }
+
+    /** We may have to add an extra 'any' letter because we had less than 3 nucleotids at the end of the loop. */
+    // TO BE CONFIRMED...
+    if (i < size)  {  acids [nbAminoAcids++] = any;  }
+
+    return nbAminoAcids;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -68,7 +265,7 @@ static LETTER nucleotid2acid [4][4][4] =
 ** REMARKS :
 *********************************************************************/
 ReadingFrameSequenceIterator::ReadingFrameSequenceIterator (ReadingFrame_e frame, ISequenceIterator* nucleotidIter)
-    : _frame(frame), _nucleotidIter (0), _data (10*1024)
+    : _frame(frame), _nucleotidIter (0), _data (10*1024), _vectorized (isVectorSupported())
 {
     DEBUG (("ReadingFrameSequenceIterator::ReadingFrameSequenceIterator  frame=%d  iter=%p\n", frame, nucleotidIter));
 
@@ -76,12 +273,6 @@ ReadingFrameSequenceIterator::ReadingFrameSequenceIterator (ReadingFrame_e frame
 
     _alphabet = EncodingManager::singleton().getAlphabet(SUBSEED);
 
-    /** We set the shortcuts for letters. */
-    A = _alphabet->letters[CODE_A];
-    C = _alphabet->letters[CODE_C];
-    G = _alphabet->letters[CODE_G];
-    T = _alphabet->letters[CODE_T];
-
     _sequence.data.encoding = SUBSEED;
 }
 
@@ -165,63 +356,18 @@ void ReadingFrameSequenceIterator::udpateItem ()
 
     /** We parse the current data of the reference sequence. */
     const IWord& refData = refSeq->data;
+    size_t       size    = refData.letters.size;
 
-    char direction = getDirection();
-    size_t i0, i1, offset;
-
-    /** We determine parameters according to the frame. */
-    if (direction == 1)
-    {
-        i0     = _frame;
-        i1     = refData.letters.size - 3;
-        offset = 0;
-    }
-    else
+    /** We translate the codons at all the positions of the strand of the frame. */
+    if (size >= 3)
     {
-        i0     = _frame - 3;
-        i1     = refData.letters.size - 3;
-        offset = refData.letters.size - 1;
+        if (_codons.size() < size)  { _codons.resize (size); }
+        translateCodons (refData.letters.data, size, getDirection(), &_codons[0], _vectorized);
     }
 
-    size_t nbAminoAcids = 0;
-    size_t i = 0;
-    for (i=i0; i<=i1; i += 3)
-    {
-        char c1, c2, c3;
-
-        /** We get the codes of the three amino acids. */
-        getCodes (
-            direction,
-            refData.letters.data[offset + direction*(i+0)],
-            refData.letters.data[offset + direction*(i+1)],
-            refData.letters.data[offset + direction*(i+2)],
-            c1,c2,c3
-        );
-
-        if (c1!=BAD_CODE && c2!=BAD_CODE && c3!=BAD_CODE)
-        {
-            /** We compute the acid from the codon. */
-            LETTER acid = nucleotid2acid [(int)c1][(int)c2][(int)c3];
-
-            //DEBUG (("(%d %d %d => acid=%d  (direction=%d)) \n", c1,c2,c3, acid, direction));
-
-            if (_data.letters.size <= nbAminoAcids)
-            {
-                _data.letters.resize (2*_data.letters.size);
-            }
+    if (_data.letters.size <= size/3)  { _data.letters.resize (size/3 + 1); }
 
-            _data.letters.data [nbAminoAcids++] = acid;
-        }
-        else
-        {
-            /** We found a bad code. */
-            //printf ("FOUND BAD CODE\n");
-        }
-    }
-
-    /** We may have to add an extra 'any' letter because we had less than 3 nucleotids at the end of the loop. */
-    // TO BE CONFIRMED...
-    if (i < refData.letters.size)  {  _data.letters.data [nbAminoAcids++] = _alphabet->any;  }
+    size_t nbAminoAcids = getFrameLetters (size >= 3 ? &_codons[0] : 0, size, _frame, _alphabet->any, _data.letters.data);
 
     _sequence.data.letters.setReference (nbAminoAcids, _data.letters.data);
 
@@ -242,35 +388,6 @@ void ReadingFrameSequenceIterator::udpateItem ()
     DEBUG (("ReadingFrameSequenceIterator::udpateItem: outputSeq='%s'\n", _sequence.data.toString().c_str() ));
 }
 
-/*********************************************************************
-** METHOD  :
-** PURPOSE :
-** INPUT   :
-** OUTPUT  :
-** RETURN  :
-** REMARKS :
-*********************************************************************/
-void ReadingFrameSequenceIterator::getCodes (int direction, LETTER l1, LETTER l2, LETTER l3, char& c1, char& c2, char& c3)
-{
-    /** We duplicate code for optimization => less calls to the method (we get the 3 codes in a single call). */
-
-#define DEFAULT_CODE  0
-//#define DEFAULT_CODE  ((rand() & 3))
-
-    if (direction > 0)
-    {
-         if (l1==A)  c1=0;  else if (l1==C)  c1=1;  else if (l1==G)  c1=2;  else if (l1==T)  c1=3;  else c1=DEFAULT_CODE;
-         if (l2==A)  c2=0;  else if (l2==C)  c2=1;  else if (l2==G)  c2=2;  else if (l2==T)  c2=3;  else c2=DEFAULT_CODE;
-         if (l3==A)  c3=0;  else if (l3==C)  c3=1;  else if (l3==G)  c3=2;  else if (l3==T)  c3=3;  else c3=DEFAULT_CODE;
-    }
-    else
-    {
-        if (l1==A)   c1=3;  else if (l1==C)  c1=2;  else if (l1==G)  c1=1;  else if (l1==T)  c1=0;  else c1=DEFAULT_CODE;
-        if (l2==A)   c2=3;  else if (l2==C)  c2=2;  else if (l2==G)  c2=1;  else if (l2==T)  c2=0;  else c2=DEFAULT_CODE;
-        if (l3==A)   c3=3;  else if (l3==C)  c3=2;  else if (l3==G)  c3=1;  else if (l3==T)  c3=0;  else c3=DEFAULT_CODE;
-    }
-}
-
 /********************************************************************************/
 } } /* end of namespaces. */
 /********************************************************************************/
@@ -95,6 +95,37 @@ public:
     /** \copydoc AbstractSequenceIterator::clone */
     ISequenceIterator* clone () { return new ReadingFrameSequenceIterator (_frame, _nucleotidIter); }
 
+    /** Translates the codons starting at each position of a strand of a nucleotide sequence (SUBSEED encoding).
+     *  The amino acid of the codon starting at position i of the strand is written in acids[i]; for the
+     *  reverse strand, the positions are counted from the end of the sequence and the nucleotides are
+     *  complemented. So the 3 frames of the strand are acids[0], acids[1] and acids[2], then one letter
+     *  every 3 letters. Letters other than A,C,G,T are read as A for the direct strand (T for the reverse one).
+     *
+     *  The vectorized version (SSSE3) builds 16 codons at once and translates them through shuffles
+     *  on the 64 entries translation table.
+     *
+     * \param[in]  nucleotids : letters of the nucleotide sequence
+     * \param[in]  size       : number of letters
+     * \param[in]  direction  : 1 for the direct strand, -1 for the reverse strand
+     * \param[out] acids      : the size-2 amino acids (none if size<3)
+     * \param[in]  vectorized : false for using only the scalar code
+     */
+    static void translateCodons (const LETTER* nucleotids, size_t size, int direction, LETTER* acids, bool vectorized=true);
+
+    /** Gets the amino acids of a frame from the codons of its strand (see translateCodons).
+     * \param[in]  codons : the codons at each position of the strand of the frame
+     * \param[in]  size   : number of letters of the nucleotide sequence
+     * \param[in]  frame  : the frame
+     * \param[in]  any    : letter added when the frame ends with an incomplete codon
+     * \param[out] acids  : the amino acids of the frame (at most size/3+1)
+     * \return the number of amino acids
+     */
+    static size_t getFrameLetters (const LETTER* codons, size_t size, misc::ReadingFrame_e frame, LETTER any, LETTER* acids);
+
+    /** Tells whether the running CPU can use the vectorized translation.
+     * \return true if SSSE3 is supported. */
+    static bool isVectorSupported ();
+
 private:
 
     /** The reading frame used for conversion. */
@@ -112,20 +143,18 @@ private:
     /** Update the current item of the iteration. */
     void udpateItem ();
 
-    /** Conversion. */
-    void getCodes (int direction, LETTER l1, LETTER l2, LETTER l3, char& c1, char& c2, char& c3);
-
-    static const char BAD_CODE = -1;
-
     /** Alphabet to be used. */
     IAlphabet* _alphabet;
 
-    /** Define shortcuts for [A,C,G,T] according to the current encoding. */
-    LETTER A, C, G, T;
-
     /** Data for storing the currently built protein from amino acids. */
     IWord _data;
 
+    /** Amino acids of the codons at each position of the current strand. */
+    std::vector<LETTER> _codons;
+
+    /** Tells whether we use the vectorized translation. */
+    bool _vectorized;
+
     /** Returns the direction of the current frame.
      * \return 1 for strands 1,2,3 and -1 for strands 4,5,6
      */
@@ -201,6 +201,240 @@ ICommandInvoker* ParallelCommandDispatcher::newCommandInvoker ()
     return new DefaultCommandInvoker (& DefaultFactory::thread());
 }
 
+/** Pool owning the current thread (if the current thread is a worker of some pool). */
+static __thread void* currentPool = 0;
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ThreadPoolCommandDispatcher::ThreadPoolCommandDispatcher (size_t nbUnits, bool pinThreads)
+    : _nbUnits(nbUnits), _available(0), _nextWorker(0), _stop(false), _nbStolen(0)
+{
+    /** If the default value was provided, we try to guess the number of cores. */
+    if (_nbUnits == 0)  {  _nbUnits = DefaultFactory::thread().getNbCores();  }
+
+    _available = DefaultFactory::thread().newSemaphore (0);
+
+    /** We create the workers; they will wait for tasks until the dispatcher is destroyed. */
+    for (size_t i=0; i<_nbUnits; i++)
+    {
+        Worker* worker  = new Worker ();
+        worker->pool    = this;
+        worker->idx     = i;
+        worker->synchro = DefaultFactory::thread().newSynchronizer();
+        worker->thread  = 0;
+        _workers.push_back (worker);
+    }
+
+    for (size_t i=0; i<_nbUnits; i++)
+    {
+        _workers[i]->thread = DefaultFactory::thread().newThread (mainloop, _workers[i]);
+
+        if (pinThreads)  {  _workers[i]->thread->setAffinity (i);  }
+    }
+
+    DEBUG (("ThreadPoolCommandDispatcher::ThreadPoolCommandDispatcher  %ld workers\n", _nbUnits));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ThreadPoolCommandDispatcher::~ThreadPoolCommandDispatcher ()
+{
+    /** We wake up all the workers and tell them to stop. */
+    _stop = true;
+    for (size_t i=0; i<_workers.size(); i++)  {  _available->post();  }
+
+    for (size_t i=0; i<_workers.size(); i++)
+    {
+        _workers[i]->thread->join ();
+
+        delete _workers[i]->thread;
+        delete _workers[i]->synchro;
+        delete _workers[i];
+    }
+
+    delete _available;
+
+    DEBUG (("ThreadPoolCommandDispatcher::~ThreadPoolCommandDispatcher  stolen=%ld\n", _nbStolen));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ThreadPoolCommandDispatcher::dispatchCommands (list<ICommand*> commands, ICommand* postTreatment)
+{
+    DEBUG (("ThreadPoolCommandDispatcher::dispatchCommands  START (%ld commands)\n", commands.size()));
+
+    /** A command executed by one of our workers may dispatch commands through us; the workers
+     *  may all be busy, so we execute the commands in the current thread. */
+    if (currentPool == this)
+    {
+        for (list<ICommand*>::iterator it = commands.begin(); it != commands.end(); it++)  {  execute (*it);  }
+    }
+    else if (commands.empty() == false)
+    {
+        os::ISemaphore* done = DefaultFactory::thread().newSemaphore (0);
+        Batch batch (commands.size(), done);
+
+        /** We distribute the commands over the workers deques. Note that each command put in a
+         *  deque is paired with a token of the '_available' semaphore. */
+        for (list<ICommand*>::iterator it = commands.begin(); it != commands.end(); it++)
+        {
+            Worker* worker = _workers [__sync_fetch_and_add (&_nextWorker, 1) % _nbUnits];
+
+            worker->synchro->lock ();
+            worker->tasks.push_back (Task (*it, &batch));
+            worker->synchro->unlock ();
+
+            _available->post ();
+        }
+
+        DEBUG (("ThreadPoolCommandDispatcher::dispatchCommands  COMMANDS LAUNCHED\n"));
+
+        /** We wait until the last command of the batch is done. */
+        done->wait ();
+        delete done;
+
+        DEBUG (("ThreadPoolCommandDispatcher::dispatchCommands  COMMANDS DONE\n"));
+
+        /** A command may have failed in a worker; we throw the error in the dispatching thread. */
+        if (batch.failed)
+        {
+            if (batch.memoryFailure)  {  throw MemoryFailure (batch.message.c_str());  }
+            throw batch.error;
+        }
+    }
+
+    /** We may have to do some post treatment. Note that we do it in the current thread. */
+    DefaultCommandInvoker invoker (& SerialThreadFactory::singleton());
+    invoker.executeCommand (postTreatment);
+
+    DEBUG (("ThreadPoolCommandDispatcher::dispatchCommands  FINISHED\n"));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool ThreadPoolCommandDispatcher::retrieve (size_t idx, Task& task)
+{
+    /** We first look in our own deque, from the front (ie. dispatching order). */
+    {
+        Worker* worker = _workers[idx];
+        LocalSynchronizer sync (worker->synchro);
+        if (worker->tasks.empty() == false)
+        {
+            task = worker->tasks.front();
+            worker->tasks.pop_front();
+            return true;
+        }
+    }
+
+    /** Our deque is empty, we steal from the back of the other ones. */
+    for (size_t i=1; i<_nbUnits; i++)
+    {
+        Worker* victim = _workers[(idx+i) % _nbUnits];
+        LocalSynchronizer sync (victim->synchro);
+        if (victim->tasks.empty() == false)
+        {
+            task = victim->tasks.back();
+            victim->tasks.pop_back();
+            __sync_fetch_and_add (&_nbStolen, 1);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ThreadPoolCommandDispatcher::execute (ICommand* command)
+{
+    if (CHECKPTR(command))
+    {
+        command->use ();
+
+        try  {  command->execute ();  }
+        catch (...)  {  command->forget ();  throw;  }
+
+        command->forget ();
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void* ThreadPoolCommandDispatcher::mainloop (void* data)
+{
+    /** We recover the worker. */
+    Worker* worker = (Worker*) data;
+    ThreadPoolCommandDispatcher* THIS = worker->pool;
+
+    currentPool = THIS;
+
+    while (true)
+    {
+        /** We wait for a token; each token matches a task put in one of the deques. */
+        THIS->_available->wait ();
+
+        if (THIS->_stop)  { break; }
+
+        /** We are sure that a task is available for us, but another worker may have taken the
+         *  one we could see during our first look, so we may have to look again. In such a case,
+         *  we let the other threads run before looking again. */
+        Task task;
+        while (THIS->retrieve (worker->idx, task) == false)  {  DefaultFactory::thread().yield ();  }
+
+        /** An error must not kill the worker nor leave the dispatching thread waiting forever. */
+        try
+        {
+            execute (task.command);
+        }
+        catch (const char* error)  {  task.batch->setError (error,          false);  }
+        catch (MemoryFailure& e)   {  task.batch->setError (e.getMessage(), true);   }
+        catch (...)                {  task.batch->setError ("error during the execution of a command", false);  }
+
+        /** The last finished task of a batch wakes up the dispatching thread. */
+        if (__sync_sub_and_fetch (&task.batch->remaining, 1) == 0)  {  task.batch->done->post();  }
+    }
+
+    currentPool = 0;
+
+    return NULL;
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -22,9 +22,10 @@
  *   Define a default command invoker that uses some OS thread factory for
  *   creating threads in which commands will be executed.
  *
- *   Two implementations of the ICommandDispatcher interface:
+ *   Three implementations of the ICommandDispatcher interface:
  *      - parallel: use ICommandInvoker for parallelization
  *          (use a CommandInvoker factory)
+ *      - thread pool: use a fixed set of threads living as long as the dispatcher
  *      - serial:   just launch one command after the other
  */
 
@@ -36,6 +37,10 @@
 #include <designpattern/api/ICommand.hpp>
 #include <os/api/IThread.hpp>
 
+#include <vector>
+#include <deque>
+#include <string>
+
 /********************************************************************************/
 namespace dp {
 /** \brief Implementation of Design Pattern tools (Observer, SmartPointer, Command...) */
@@ -138,6 +143,135 @@ private:
 
 /********************************************************************************/
 
+/** \brief Launches commands in a pool of persistent threads
+ *
+ *  ParallelCommandDispatcher creates (and joins) one thread per command for each call to
+ *  dispatchCommands. When the same dispatcher is used for many subject/query blocks, these
+ *  thread creations can become noticeable.
+ *
+ *  This implementation creates its threads once (in the constructor) and keeps them until
+ *  the dispatcher is destroyed. Each worker thread owns a deque of commands; dispatchCommands
+ *  distributes the commands over these deques and each worker first consumes its own deque,
+ *  then steals commands from the other deques once its own one is empty. So a slow command
+ *  doesn't leave the other workers idle as long as there are commands left somewhere.
+ *
+ *  Worker threads may be bound to the available cores on request (see IThread::setAffinity).
+ *
+ *  An exception thrown by a command doesn't stop its worker thread: it is kept and thrown
+ *  again by dispatchCommands once all the commands of the call are done.
+ *
+ *  Note that dispatchCommands can be called from one of the worker threads (ie. a command
+ *  dispatching other commands through the same dispatcher); in such a case, the commands
+ *  are executed in the calling thread in order to avoid a dead lock.
+ */
+class ThreadPoolCommandDispatcher : public ICommandDispatcher
+{
+public:
+
+    /** Constructor.
+     * \param[in] nbUnits    : number of threads to be used. If 0 is provided, one tries to guess the number of available cores.
+     * \param[in] pinThreads : tells whether the worker threads have to be bound to cores (off by default, since
+     *                         other processes may use the same cores).
+     */
+    ThreadPoolCommandDispatcher (size_t nbUnits=0, bool pinThreads=false);
+
+    /** Destructor. Stops and joins the worker threads. */
+    virtual ~ThreadPoolCommandDispatcher();
+
+    /** \copydoc ICommandDispatcher::dispatchCommands */
+    void dispatchCommands (std::list<ICommand*> commands, ICommand* postTreatment=0);
+
+    /** \copydoc ICommandDispatcher::getExecutionUnitsNumber */
+    size_t getExecutionUnitsNumber () { return _nbUnits; }
+
+    /** Returns the number of commands a worker took from the deque of another worker.
+     * \return the number of stolen commands since the dispatcher creation. */
+    u_int64_t getStolenNumber ()  { return _nbStolen; }
+
+protected:
+
+    /** \copydoc ICommandDispatcher::newCommandInvoker */
+    ICommandInvoker* newCommandInvoker ()  { return 0; }
+
+private:
+
+    /** Completion information of one call to dispatchCommands. The first error raised by a
+     *  command of the batch is kept here and thrown again in the dispatching thread. */
+    struct Batch
+    {
+        Batch (size_t nb, os::ISemaphore* sem)
+            : remaining(nb), done(sem), failed(0), error(0), memoryFailure(false)  {}
+
+        /** Keeps the error if it is the first one of the batch. */
+        void setError (const char* msg, bool isMemoryFailure)
+        {
+            if (__sync_bool_compare_and_swap (&failed, 0, 1))
+            {
+                error         = msg;
+                memoryFailure = isMemoryFailure;
+                if (memoryFailure)  {  message.assign (msg);  }
+            }
+        }
+
+        volatile size_t  remaining;
+        os::ISemaphore*  done;
+        volatile int     failed;
+        const char*      error;
+        bool             memoryFailure;
+        std::string      message;
+    };
+
+    /** A command waiting for execution, with the batch it belongs to. */
+    struct Task
+    {
+        Task (ICommand* c=0, Batch* b=0) : command(c), batch(b) {}
+        ICommand* command;
+        Batch*    batch;
+    };
+
+    /** A worker thread with its own deque of tasks. */
+    struct Worker
+    {
+        ThreadPoolCommandDispatcher* pool;
+        size_t                       idx;
+        os::IThread*                 thread;
+        os::ISynchronizer*           synchro;
+        std::deque<Task>             tasks;
+    };
+
+    /** Number of worker threads. */
+    size_t _nbUnits;
+
+    /** The worker threads. */
+    std::vector<Worker*> _workers;
+
+    /** Counts the tasks available in the deques; the workers sleep on it. */
+    os::ISemaphore* _available;
+
+    /** Worker receiving the next dispatched task. */
+    size_t _nextWorker;
+
+    /** Set to true for stopping the workers. */
+    volatile bool _stop;
+
+    /** Number of stolen tasks. */
+    volatile u_int64_t _nbStolen;
+
+    /** Retrieves a task for the given worker: from its own deque, otherwise from another one.
+     * \param[in]  idx  : index of the worker
+     * \param[out] task : the retrieved task
+     * \return true if a task has been found. */
+    bool retrieve (size_t idx, Task& task);
+
+    /** Execute a command (with use/forget protocol). */
+    static void execute (ICommand* command);
+
+    /** Mainloop of the worker threads. */
+    static void* mainloop (void* data);
+};
+
+/********************************************************************************/
+
 /** \brief Launches commands in current thread
  *
  * A dispatcher that uses the calling thread, so no parallelization.
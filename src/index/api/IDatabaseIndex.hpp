@@ -169,6 +169,22 @@ public:
         size_t blockSize
     ) = 0;
 
+    /** Creates an iterator on occurrences (retrieved by blocks) for a given seed key, restricted
+     * to a range of the occurrences of this seed. This allows to cut the occurrences of a seed
+     * into several parts that can be processed independently (by different threads for instance).
+     * \param[in] seed : the seed we want to iterate occurrences
+     * \param[in] neighbourhoodSize : size (in characters) of the left and right neighbourhoods
+     * \param[in] blockSize : number of occurrences retrieved at each iteration step
+     * \param[in] occurRange : indexes of the first and last (included) occurrences to be iterated
+     * \see ISeedOccurrence
+     */
+    virtual IOccurrenceBlockIterator* createOccurrenceBlockIterator (
+        const seed::ISeed* seed,
+        size_t neighbourhoodSize,
+        size_t blockSize,
+        const misc::Range<size_t>& occurRange
+    ) = 0;
+
     /** Returns the entries for a given seed.
      * param[in] seed : the seed for which we want to know the occurrences number
      * \return the entries
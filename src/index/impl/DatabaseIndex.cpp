@@ -17,9 +17,20 @@
 #include <index/impl/DatabaseIndex.hpp>
 #include <misc/api/macros.hpp>
 #include <misc/api/PlastStrings.hpp>
+#include <os/impl/ArenaMemory.hpp>
+#include <designpattern/impl/CommandDispatcher.hpp>
+
+#include <os/impl/DefaultOsFactory.hpp>
+
+#include <new>
+#include <stdio.h>
+#include <string.h>
 
 using namespace std;
+using namespace os;
+using namespace os::impl;
 using namespace dp;
+using namespace dp::impl;
 using namespace database;
 using namespace seed;
 
@@ -40,7 +51,8 @@ namespace indexation { namespace impl {
 ** REMARKS :
 *********************************************************************/
 DatabaseIndex::DatabaseIndex (ISequenceDatabase* database, ISeedModel* model)
-    : AbstractDatabaseIndex (database, model), _currentSequence(0), _span(0), _alphabetSize(0), _sequenceOffset(0)
+    : AbstractDatabaseIndex (database, model), _mappedFile(0), _offsetsTable(0), _occurrencesTable(0),
+      _span(0), _alphabetSize(0)
 {
     DEBUG (("DatabaseIndex::DatabaseIndex: _maxSeedsNumber=%ld\n", _maxSeedsNumber));
 
@@ -50,8 +62,10 @@ DatabaseIndex::DatabaseIndex (ISequenceDatabase* database, ISeedModel* model)
     _maxSeedsNumber = 1;
     for (size_t i=1; i<=_span; i++)  { _maxSeedsNumber *= _alphabetSize; }
 
-    /** We set the size of the index. */
-    _index.resize (_maxSeedsNumber);
+    /** We set the size of the index; it has no occurrence until it is built. */
+    _offsets.resize (_maxSeedsNumber + 1, 0);
+
+    useBuiltTables ();
 }
 
 /*********************************************************************
@@ -64,6 +78,7 @@ DatabaseIndex::DatabaseIndex (ISequenceDatabase* database, ISeedModel* model)
 *********************************************************************/
 DatabaseIndex::~DatabaseIndex ()
 {
+    if (_mappedFile != 0)  {  delete _mappedFile;  }
 }
 
 /*********************************************************************
@@ -74,41 +89,16 @@ DatabaseIndex::~DatabaseIndex ()
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-void DatabaseIndex::iterateSeed (const ISeed* seed)
+void DatabaseIndex::useBuiltTables ()
 {
-    /** We compute the hashcode for the current kmer. */
-    SeedHashCode hashCode = seed->code;
-
-    /** It may happen that the SeedModel doesn't compute a hash code, so we do it now. */
-    if (hashCode == BAD_SEED_HASH_CODE)
+    if (_mappedFile != 0)
     {
-        LETTER* word = seed->kmer.letters.data;
-
-        /** Optimization: direct computation according to the span size, full loop otherwise. */
-             if (_span == 4)  { hashCode = word[0] + _alphabetSize*(word[1] + _alphabetSize*(word[2] + _alphabetSize*word[3])); }
-        else if (_span == 3)  { hashCode = word[0] + _alphabetSize*(word[1] + _alphabetSize*word[2]); }
-        else if (_span == 2)  { hashCode = word[0] + _alphabetSize*word[1]; }
-        else
-        {
-            hashCode = word[_span-1];
-            for (int i=_span-2; i>=0; i--)  {  hashCode = _alphabetSize * hashCode + word[i];  }
-        }
+        delete _mappedFile;
+        _mappedFile = 0;
     }
 
-    if (hashCode != BAD_SEED_HASH_CODE)
-    {
-        /** We retrieve the index corresponding to the seed. */
-        IndexEntry& entry = _index[hashCode];
-
-        VERBOSE (("DatabaseIndex::iterateSeed: this=%p  seed='%s' (code=%ld) => offset=%ld\n",  this,
-            seed->kmer.toString().c_str(),
-            seed->code,
-            _sequenceOffset + seed->offset
-        ));
-
-        /** We add the offset in the database for the current seed. */
-        entry.push_back (SeedOccurrenceProt (_sequenceOffset + seed->offset, _currentSequence->index));
-    }
+    _offsetsTable     = &_offsets[0];
+    _occurrencesTable = _occurrences.empty() ? 0 : &_occurrences[0];
 }
 
 /*********************************************************************
@@ -133,48 +123,184 @@ ISeedIterator* DatabaseIndex::createSeedsIterator (const database::IWord& data)
 ** REMARKS :
 *********************************************************************/
 void DatabaseIndex::build ()
+{
+    /** The whole database is processed in the current thread. */
+    SerialCommandDispatcher* dispatcher = new SerialCommandDispatcher ();
+    LOCAL (dispatcher);
+
+    build (dispatcher);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void DatabaseIndex::build (ICommandDispatcher* dispatcher)
 {
     DEBUG (("DatabaseIndex::build : START ! \n"));
 
-    /** The intent of this method is to fill the _index attribute; this attribute is designed to hold (for each possible seed
-     *  of the seeds model) the vector of offset occurrences. These offsets are relative to the provided sequences iterator.
-     */
+    /** We split the database in as many parts as execution units. */
+    size_t nbSplits = dispatcher->getExecutionUnitsNumber();
+
+    vector<ISequenceDatabase*> splits;
+    if (nbSplits > 1)  {  splits = getDatabase()->split (nbSplits);  }
+    if (splits.empty())  {  splits.push_back (getDatabase());  }
+
+    /** The parts are in the order of the database, so we get their offsets by summing their sizes. */
+    vector<BuildPart> parts (splits.size());
+    u_int64_t databaseOffset = 0;
+
+    for (size_t i=0; i<splits.size(); i++)
+    {
+        parts[i].database       = splits[i];
+        parts[i].databaseOffset = databaseOffset;
+        parts[i].database->use ();
+
+        databaseOffset += splits[i]->getSize();
+    }
+
+    buildParts (parts, dispatcher);
+
+    for (size_t i=0; i<parts.size(); i++)  {  parts[i].database->forget ();  }
+
+    DEBUG (("DatabaseIndex::build : %ld parts, %lld occurrences\n", parts.size(), getTotalOccurrenceNumber()));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void DatabaseIndex::buildParts (std::vector<BuildPart>& parts, ICommandDispatcher* dispatcher)
+{
+    /** First pass: each part counts the occurrences of each seed. */
+    list<ICommand*> countCommands;
+    for (size_t i=0; i<parts.size(); i++)
+    {
+        parts[i].cursors.assign (_maxSeedsNumber, 0);
+        countCommands.push_back (new PartBuilder (this, parts[i], false));
+    }
+    dispatcher->dispatchCommands (countCommands, 0);
+
+    /** We compute the offsets table. The occurrences of a seed are stored part after part, so they
+     *  are sorted by offset in the database; the cursors of a part are set on the first place of its
+     *  occurrences for each seed. */
+    _offsets.resize (_maxSeedsNumber + 1);
+
+    u_int64_t nbOccurrences = 0;
+    for (size_t code=0; code<_maxSeedsNumber; code++)
+    {
+        _offsets[code] = nbOccurrences;
+
+        for (size_t i=0; i<parts.size(); i++)
+        {
+            u_int32_t nb = parts[i].cursors[code];
+            parts[i].cursors[code] = nbOccurrences;
+            nbOccurrences += nb;
+        }
+    }
+    _offsets[_maxSeedsNumber] = nbOccurrences;
+
+    vector<SeedOccurrenceProt> (nbOccurrences).swap (_occurrences);
 
-    /** We create a sequence iterator that iterates the database. */
-    ISequenceIterator* seqIter = getDatabase()->createSequenceIterator();
-    LOCAL(seqIter);
+    useBuiltTables ();
 
-    size_t nbSequences   = 0;
+    /** Second pass: each part writes its occurrences at their final place. */
+    list<ICommand*> fillCommands;
+    for (size_t i=0; i<parts.size(); i++)  {  fillCommands.push_back (new PartBuilder (this, parts[i], true));  }
+    dispatcher->dispatchCommands (fillCommands, 0);
 
-    _sequenceOffset = 0;
+    /** We release the cursors. */
+    for (size_t i=0; i<parts.size(); i++)  {  vector<u_int32_t>().swap (parts[i].cursors);  }
+}
 
-    DEBUG (("DatabaseIndex::build : BEGIN SEQUENCES LOOP\n"));
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void DatabaseIndex::PartBuilder::execute ()
+{
+    /** In the second pass, we write directly in the occurrences table. */
+    _occurrences = _index->_occurrences.empty() ? 0 : &_index->_occurrences[0];
+
+    Iterator<const ISeed*>::Method callback = _fill ?
+        (Iterator<const ISeed*>::Method) &PartBuilder::fillSeed :
+        (Iterator<const ISeed*>::Method) &PartBuilder::countSeed;
+
+    /** We create a sequence iterator that iterates the part. */
+    ISequenceIterator* seqIter = _part.database->createSequenceIterator();
+    LOCAL (seqIter);
+
+    _sequenceOffset = _part.databaseOffset;
 
     /** We loop over all the sequences. */
     for (seqIter->first(); !seqIter->isDone(); seqIter->next())
     {
         /** A little shortcut for the currently iterated sequence. */
-        _currentSequence  = seqIter->currentItem();
+        _sequence = seqIter->currentItem();
 
-        VERBOSE (("DatabaseIndex::build : current sequence '%s'\n", _currentSequence->data.toString().c_str()));
+        VERBOSE (("DatabaseIndex::PartBuilder::execute : current sequence '%s'\n", _sequence->data.toString().c_str()));
 
-        /** We create a seed iterator. */
-        ISeedIterator* itSeed = createSeedsIterator (_currentSequence->data);
+        /** We iterate the seeds of the sequence. */
+        ISeedIterator* itSeed = _index->createSeedsIterator (_sequence->data);
         LOCAL (itSeed);
 
-        /** We iterate the seed iterator. */
-        itSeed->iterate (this, (Iterator<const ISeed*>::Method) &DatabaseIndex::iterateSeed);
+        itSeed->iterate (this, callback);
 
         /** We update the current sequence offset (ie offset in the whole database). */
-        _sequenceOffset += _currentSequence->data.letters.size;
-
-        /** We increase the number of found sequences. */
-        nbSequences++;
+        _sequenceOffset += _sequence->data.letters.size;
     }
+}
 
-    DEBUG (("DatabaseIndex::build : END SEQUENCES LOOP\n"));
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void DatabaseIndex::PartBuilder::countSeed (const ISeed* seed)
+{
+    SeedHashCode hashCode = _index->getSeedCode (seed);
 
-    DEBUG (("DatabaseIndex::build : %ld sequences\n", nbSequences));
+    if (hashCode != BAD_SEED_HASH_CODE)  {  _part.cursors[hashCode] ++;  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void DatabaseIndex::PartBuilder::fillSeed (const ISeed* seed)
+{
+    SeedHashCode hashCode = _index->getSeedCode (seed);
+
+    if (hashCode != BAD_SEED_HASH_CODE)
+    {
+        VERBOSE (("DatabaseIndex::PartBuilder::fillSeed: seed='%s' (code=%ld) => offset=%ld\n",
+            seed->kmer.toString().c_str(),
+            seed->code,
+            _sequenceOffset + seed->offset
+        ));
+
+        /** We add the offset in the database for the current seed. */
+        _occurrences [_part.cursors[hashCode]++] = SeedOccurrenceProt (_sequenceOffset + seed->offset, _sequence->index);
+    }
 }
 
 /*********************************************************************
@@ -221,13 +347,14 @@ IOccurrenceIterator* DatabaseIndex::createOccurrenceIterator (const ISeed* seed,
 {
     SeedHashCode code = (seed->code != BAD_SEED_HASH_CODE ? seed->code : getHashCode (seed->kmer));
 
-    if (code >= _index.size())  {  throw MSG_INDEXATION_MSG1;  }
+    if (code >= _maxSeedsNumber)  {  throw MSG_INDEXATION_MSG1;  }
 
     /** A little shortcut. */
-	IndexEntry& offsets = _index[code];
+    size_t nbOffsets = 0;
+    const SeedOccurrenceProt* offsets = getOccurrences (code, nbOffsets);
 
-    return (offsets.size() > 0 ?
-        new DatabaseOccurrenceIterator (getDatabase(), _span, &offsets, neighbourhoodSize)
+    return (nbOffsets > 0 ?
+        new DatabaseOccurrenceIterator (getDatabase(), _span, offsets, nbOffsets, neighbourhoodSize)
         :
         (IOccurrenceIterator*)  new NullIterator<const ISeedOccurrence*> ()
     );
@@ -246,25 +373,46 @@ IOccurrenceBlockIterator* DatabaseIndex::createOccurrenceBlockIterator (
     size_t neighbourhoodSize,
     size_t blockSize
 )
+{
+    /** We iterate all the occurrences of the seed. */
+    return createOccurrenceBlockIterator (seed, neighbourhoodSize, blockSize, misc::Range<size_t> (0, ~((size_t)0) - 1));
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+IOccurrenceBlockIterator* DatabaseIndex::createOccurrenceBlockIterator (
+    const seed::ISeed* seed,
+    size_t neighbourhoodSize,
+    size_t blockSize,
+    const misc::Range<size_t>& occurRange
+)
 {
     IOccurrenceBlockIterator* result = 0;
 
     SeedHashCode code = (seed->code != BAD_SEED_HASH_CODE ? seed->code : getHashCode (seed->kmer));
 
-    if (code >= _index.size())  {  throw MSG_INDEXATION_MSG1;  }
+    if (code >= _maxSeedsNumber)  {  throw MSG_INDEXATION_MSG1;  }
     else
     {
     	/** A little shortcut. */
-		IndexEntry& offsets = _index[code];
+        size_t nbOffsets = 0;
+        const SeedOccurrenceProt* offsets = getOccurrences (code, nbOffsets);
 
-        if (offsets.size() > 0)
+        if (nbOffsets > occurRange.begin)
         {
             result = new DatabaseOccurrenceBlockIterator (
                 getDatabase(),
                 _span,
-                &offsets,
+                offsets,
                 neighbourhoodSize,
-                blockSize
+                blockSize,
+                misc::Range<size_t> (occurRange.begin, MIN (occurRange.end, nbOffsets-1))
             );
         }
     }
@@ -282,13 +430,9 @@ IOccurrenceBlockIterator* DatabaseIndex::createOccurrenceBlockIterator (
 *********************************************************************/
 IDatabaseIndex::IndexEntry& DatabaseIndex::getEntry (const seed::ISeed* seed)
 {
-    SeedHashCode code = (seed->code != BAD_SEED_HASH_CODE ? seed->code : getHashCode (seed->kmer));
-
-    if (code >= _index.size())  {  throw MSG_INDEXATION_MSG1;  }
-    else
-    {
-        return (IDatabaseIndex::IndexEntry&)_index[code];
-    }
+    /** The occurrences are not stored as IndexEntry instances; they are available through
+     *  getOccurrenceNumber and the occurrences iterators. */
+    throw "DatabaseIndex::getEntry is not supported, use the occurrences iterators";
 }
 
 /*********************************************************************
@@ -303,10 +447,12 @@ size_t DatabaseIndex::getOccurrenceNumber (const seed::ISeed* seed)
 {
     SeedHashCode code = (seed->code != BAD_SEED_HASH_CODE ? seed->code : getHashCode (seed->kmer));
 
-    if (code >= _index.size())  {  throw MSG_INDEXATION_MSG1;  }
+    if (code >= _maxSeedsNumber)  {  throw MSG_INDEXATION_MSG1;  }
     else
     {
-        return _index[code].size();
+        size_t nbOffsets = 0;
+        getOccurrences (code, nbOffsets);
+        return nbOffsets;
     }
 }
 
@@ -320,14 +466,8 @@ size_t DatabaseIndex::getOccurrenceNumber (const seed::ISeed* seed)
 *********************************************************************/
 u_int64_t DatabaseIndex::getTotalOccurrenceNumber ()
 {
-    u_int64_t result = 0;
-
-    for (size_t i=0; i<_index.size(); i++)
-    {
-        result += _index[i].size();
-    }
-
-    return result;
+    /** The last item of the offsets table is the total number of occurrences. */
+    return _offsetsTable [_maxSeedsNumber];
 }
 
 /*********************************************************************
@@ -342,71 +482,267 @@ void DatabaseIndex::merge (void)
 {
     DEBUG (("DatabaseIndex::merge : BEGIN (nbChildren=%ld) \n", _children.size() ));
 
-    /** We loop over children indexes. */
+    /** We retrieve the children and the shifts of their offsets in the merged index. */
+    vector<DatabaseIndex*> children;
+    vector<u_int64_t>      shifts;
+    u_int64_t              databasesSize = 0;
+
     for (std::list<IDatabaseIndex*>::iterator it=_children.begin(); it != _children.end(); it++)
     {
-        DEBUG (("child=%p  dbSize=%ld  nbSeq=%ld \n",
-            *it, (*it)->getDatabase()->getSize(), (*it)->getDatabase()->getSequencesNumber()
-        ));
+        /** A little shortcut. */
+        DatabaseIndex* child = dynamic_cast<DatabaseIndex*> (*it);
+
+        if (CHECKPTR(child))
+        {
+            children.push_back (child);
+            shifts.push_back   (databasesSize);
+
+            /** We increase the sum of the databases sizes. */
+            databasesSize += child->getDatabase()->getSize();
+        }
     }
 
-    /** We create an iterator that loops all seeds of the model. */
+    /** We compute the offsets table: the occurrences of a seed are the ones of the children, in the children order. */
+    vector<u_int64_t> offsets (_maxSeedsNumber + 1);
+
+    u_int64_t nbOccurrences = 0;
+    for (size_t code=0; code<_maxSeedsNumber; code++)
+    {
+        offsets[code] = nbOccurrences;
+        for (size_t i=0; i<children.size(); i++)
+        {
+            size_t nb = 0;
+            children[i]->getOccurrences (code, nb);
+            nbOccurrences += nb;
+        }
+    }
+    offsets[_maxSeedsNumber] = nbOccurrences;
+
+    /** We copy the occurrences of the children, with aligned offsets. */
+    vector<SeedOccurrenceProt> occurrences (nbOccurrences);
+
+    for (size_t code=0; code<_maxSeedsNumber; code++)
+    {
+        SeedOccurrenceProt* globalOccur = nbOccurrences > 0 ? &occurrences[offsets[code]] : 0;
+
+        for (size_t i=0; i<children.size(); i++)
+        {
+            size_t nb = 0;
+            const SeedOccurrenceProt* childOccur = children[i]->getOccurrences (code, nb);
+
+            for (size_t j=0; j<nb; j++, globalOccur++)
+            {
+                *globalOccur = childOccur[j];
+                globalOccur->offsetInDatabase += shifts[i];
+            }
+        }
+    }
+
+    _offsets.swap     (offsets);
+    _occurrences.swap (occurrences);
+
+    useBuiltTables ();
+
+    DEBUG (("DatabaseIndex::merge : nbOccurs=%lld \n", nbOccurrences));
+}
+
+/** Header of an index file (see DatabaseIndex::save). The integers are saved with the native endianness;
+ *  an index file built on a machine with another endianness will be rejected by the magic check. */
+struct IndexFileHeader
+{
+    char      magic[8];
+    u_int32_t version;
+    u_int32_t span;
+    u_int32_t alphabetSize;
+    u_int32_t reserved;
+    u_int64_t signature;
+    u_int64_t nbSeeds;
+    u_int64_t nbOccurrences;
+    u_int64_t databaseSize;
+    u_int64_t nbSequences;
+};
+
+static const char      INDEX_FILE_MAGIC[8]  = { 'P','L','A','S','T','I','D','X' };
+static const u_int32_t INDEX_FILE_VERSION   = 1;
+
+/** Hash accumulation used for the index signature. */
+static inline u_int64_t hashMix (u_int64_t h, u_int64_t value)
+{
+    h ^= value + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    h *= 0xff51afd7ed558ccdULL;
+    return h ^ (h >> 33);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the whole database content is read, which is much quicker
+**           than building the index.
+*********************************************************************/
+u_int64_t DatabaseIndex::getSignature ()
+{
+    u_int64_t h = 0xcbf29ce484222325ULL;
+
+    /** The kind of index and the seed model. */
+    h = hashMix (h, INDEX_FILE_VERSION);
+    h = hashMix (h, _span);
+    h = hashMix (h, _alphabetSize);
+    h = hashMix (h, _maxSeedsNumber);
+    h = hashMix (h, getParametersKey());
+
     ISeedIterator* itSeed = _model->createAllSeedsIterator();
     LOCAL (itSeed);
 
-    /** We loop over all possible seeds for the given model. */
     for (itSeed->first(); !itSeed->isDone(); itSeed->next())
     {
-        /** */
         const ISeed* seed = itSeed->currentItem();
 
-        SeedHashCode code = (seed->code != BAD_SEED_HASH_CODE ? seed->code : getHashCode (seed->kmer));
-        if (code >= _index.size())  {  throw MSG_INDEXATION_MSG1;  }
+        h = hashMix (h, seed->code);
+        for (size_t i=0; i<seed->kmer.letters.size; i++)  {  h = hashMix (h, seed->kmer.letters.data[i]);  }
+    }
 
-        /** A little shortcut. */
-        IndexEntry& globalOccur = _index[code];
+    /** The database content: letters and lengths of the sequences. */
+    h = hashMix (h, getDatabase()->getSize());
+    h = hashMix (h, getDatabase()->getSequencesNumber());
 
-        /** We clear the occurrences vector of the 'this' instance for the current seed. */
-        globalOccur.clear();
+    ISequenceIterator* itSeq = getDatabase()->createSequenceIterator();
+    LOCAL (itSeq);
 
-        /** We need to sum the sizes of the database for shifting the offsets in the merged index. */
-        u_int64_t databasesSize = 0;
+    for (itSeq->first(); !itSeq->isDone(); itSeq->next())
+    {
+        const ISequence* seq  = itSeq->currentItem();
+        const LETTER*    data = seq->data.letters.data;
+        size_t           size = seq->data.letters.size;
 
-        /** We loop over children indexes. */
-        for (std::list<IDatabaseIndex*>::iterator it=_children.begin(); it != _children.end(); it++)
+        h = hashMix (h, size);
+
+        /** We hash the letters by words of 8 bytes. */
+        size_t i = 0;
+        for ( ; i+8 <= size; i+=8)
         {
-            /** A little shortcut. */
-            DatabaseIndex* child = dynamic_cast<DatabaseIndex*> (*it);
+            u_int64_t word;
+            memcpy (&word, data+i, sizeof(word));
+            h = hashMix (h, word);
+        }
+        for ( ; i<size; i++)  {  h = hashMix (h, data[i]);  }
+    }
 
-            if (CHECKPTR(child))
-            {
-            	IndexEntry& childOccur =  child->_index [code];
+    DEBUG (("DatabaseIndex::getSignature : signature=%llx\n", (long long unsigned) h));
 
-                /** We have to align the offsets. */
-                for (IndexEntry::iterator it = childOccur.begin(); it != childOccur.end(); it++)
-                {
-                    it->offsetInDatabase += databasesSize;
-                }
+    return h;
+}
 
-                /** We add the child index into the parent index. */
-                globalOccur.insert (globalOccur.end(), childOccur.begin(), childOccur.end());
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the file is first written with a temporary name and then
+**           renamed, so a concurrent execution never sees a partial file.
+*********************************************************************/
+bool DatabaseIndex::save (const std::string& uri, u_int64_t signature)
+{
+    std::string tmpUri = uri + ".tmp";
 
-                /** We increase the sum of the databases sizes. */
-                databasesSize += child->getDatabase()->getSize();
-            }
-        }
+    FILE* file = fopen (tmpUri.c_str(), "wb");
+    if (file == 0)  { return false; }
+
+    IndexFileHeader header;
+    memset (&header, 0, sizeof(header));
+    memcpy (header.magic, INDEX_FILE_MAGIC, sizeof(header.magic));
+    header.version       = INDEX_FILE_VERSION;
+    header.span          = _span;
+    header.alphabetSize  = _alphabetSize;
+    header.signature     = signature;
+    header.nbSeeds       = _maxSeedsNumber;
+    header.nbOccurrences = getTotalOccurrenceNumber();
+    header.databaseSize  = getDatabase()->getSize();
+    header.nbSequences   = getDatabase()->getSequencesNumber();
+
+    bool ok = fwrite (&header, sizeof(header), 1, file) == 1;
+
+    /** The offsets table and the occurrences table have the same layout in memory and in the file. */
+    size_t nbOffsets = _maxSeedsNumber + 1;
+    ok = ok && fwrite (_offsetsTable, sizeof(u_int64_t), nbOffsets, file) == nbOffsets;
+
+    size_t nbOccurrences = header.nbOccurrences;
+    if (nbOccurrences > 0)  {  ok = ok && fwrite (_occurrencesTable, sizeof(SeedOccurrenceProt), nbOccurrences, file) == nbOccurrences;  }
+
+    ok = (fclose (file) == 0) && ok;
+
+    if (ok)  {  ok = ::rename (tmpUri.c_str(), uri.c_str()) == 0;  }
+    if (!ok) {  ::remove (tmpUri.c_str());  }
+
+    DEBUG (("DatabaseIndex::save : uri='%s'  nbOccurs=%ld  ok=%d\n", uri.c_str(), nbOccurrences, ok));
+
+    return ok;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool DatabaseIndex::load (const std::string& uri, u_int64_t signature)
+{
+    IMemoryFile* file = DefaultFactory::fileMem().newFile (uri.c_str(), true);
+    if (file == 0)  { return false; }
+
+    const char* data = file->getData();
+    u_int64_t   size = file->getSize();
+
+    /** We check that the file matches the current index. */
+    bool ok = (data != 0) && (size >= sizeof(IndexFileHeader));
+
+    IndexFileHeader header;
+    if (ok)
+    {
+        memcpy (&header, data, sizeof(header));
+
+        ok = memcmp (header.magic, INDEX_FILE_MAGIC, sizeof(header.magic)) == 0
+            && header.version      == INDEX_FILE_VERSION
+            && header.span         == _span
+            && header.alphabetSize == _alphabetSize
+            && header.nbSeeds      == _maxSeedsNumber
+            && header.databaseSize == getDatabase()->getSize()
+            && header.nbSequences  == getDatabase()->getSequencesNumber()
+            && size == sizeof(IndexFileHeader)
+                     + (header.nbSeeds+1)      * sizeof(u_int64_t)
+                     + header.nbOccurrences    * sizeof(SeedOccurrenceProt);
     }
 
-    size_t nbSeeds  = 0;
-    size_t nbOccurs = 0;
-    for (size_t i=0; i<_index.size(); i++)  {
-        if (_index[i].size() > 0)
-        {
-            nbSeeds ++;
-            nbOccurs += _index[i].size();
-        }
+    const u_int64_t* offsets = ok ? (const u_int64_t*) (data + sizeof(IndexFileHeader)) : 0;
+
+    ok = ok && offsets[0] == 0 && offsets[header.nbSeeds] == header.nbOccurrences;
+
+    ok = ok && header.signature == signature;
+
+    if (!ok)
+    {
+        delete file;
+        return false;
     }
-    DEBUG (("DatabaseIndex::merge : nbSeeds=%ld  nbOccurs=%ld \n",nbSeeds, nbOccurs));
+
+    /** We use the mapped tables; the built index is no more needed. */
+    vector<u_int64_t>().swap          (_offsets);
+    vector<SeedOccurrenceProt>().swap (_occurrences);
+
+    if (_mappedFile != 0)  {  delete _mappedFile;  }
+
+    _mappedFile       = file;
+    _offsetsTable     = offsets;
+    _occurrencesTable = (const SeedOccurrenceProt*) (offsets + header.nbSeeds + 1);
+
+    DEBUG (("DatabaseIndex::load : uri='%s'  nbOccurs=%lld\n", uri.c_str(), header.nbOccurrences));
+
+    return true;
 }
 
 /*********************************************************************
@@ -421,7 +757,7 @@ void DatabaseIndex::DatabaseOccurrenceIterator::updateItem ()
 {
     /** We retrieve other information: sequence and offset in sequence. */
     _database->getSequenceByOffset (
-        (*_offsets)[_currentIdx].offsetInDatabase,
+        _offsets[_currentIdx].offsetInDatabase,
         _item.sequence,
         _item.offsetInSequence,
         _item.offsetInDatabase
@@ -476,16 +812,19 @@ void DatabaseIndex::DatabaseOccurrenceIterator::updateItem ()
 DatabaseIndex::DatabaseOccurrenceBlockIterator::DatabaseOccurrenceBlockIterator (
     database::ISequenceDatabase* database,
     size_t span,
-    IndexEntry* offsets,
+    const SeedOccurrenceProt* offsets,
     size_t neighbourSize,
-    size_t nbSeedOccurPerIteration
+    size_t nbSeedOccurPerIteration,
+    const misc::Range<size_t>& occurRange
 )
     : _database(database),
       _span(span),
       _offsets(offsets),
       _neighbourSize(neighbourSize),
       _nbSeedOccurPerIteration (nbSeedOccurPerIteration),
-      _table (0), _neighbourhoods(0), _isDone(true)
+      _memory (os::impl::ArenaMemoryAllocator::local()),
+      _table (0), _tableSize(0), _neighbourhoods(0), _isDone(true),
+      _occurRange (occurRange)
 {
     /** We compute the size of a complete neighbourhood (seed + left + right). */
     _neighbourTotalSize = (_span + 2*_neighbourSize);
@@ -501,8 +840,27 @@ DatabaseIndex::DatabaseOccurrenceBlockIterator::DatabaseOccurrenceBlockIterator
 *********************************************************************/
 DatabaseIndex::DatabaseOccurrenceBlockIterator::~DatabaseOccurrenceBlockIterator ()
 {
-    if (_table)             { delete[] _table;          }
-    if (_neighbourhoods)    { delete[] _neighbourhoods; }
+    /** We release the buffers in the reverse order of their allocation, so the arena can reuse
+     *  the memory right now. */
+    _memory.free (_neighbourhoods);
+    releaseTable ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void DatabaseIndex::DatabaseOccurrenceBlockIterator::releaseTable ()
+{
+    for (size_t i=0; i<_tableSize; i++)  {  _table[i].~ISeedOccurrence();  }
+    _memory.free (_table);
+
+    _table     = 0;
+    _tableSize = 0;
 }
 
 /*********************************************************************
@@ -515,11 +873,11 @@ DatabaseIndex::DatabaseOccurrenceBlockIterator::~DatabaseOccurrenceBlockIterator
 *********************************************************************/
 void DatabaseIndex::DatabaseOccurrenceBlockIterator::first ()
 {
-    if (_offsets && _offsets->size() > 0 &&  _nbSeedOccurPerIteration > 0)
+    if (_offsets && _occurRange.begin <= _occurRange.end &&  _nbSeedOccurPerIteration > 0)
     {
         /** We initialize the range to be iterated. */
-        _range.begin = 0;
-        _range.end   = MIN (_nbSeedOccurPerIteration, _offsets->size()) - 1;
+        _range.begin = _occurRange.begin;
+        _range.end   = MIN (_occurRange.begin + _nbSeedOccurPerIteration - 1, _occurRange.end);
 
         /** We update the isdone attribute. */
         _isDone = false;
@@ -544,12 +902,12 @@ dp::IteratorStatus DatabaseIndex::DatabaseOccurrenceBlockIterator::next()
     _range.end   += _nbSeedOccurPerIteration;
 
     /** We update the isdone attribute. */
-    _isDone = _range.begin >= _offsets->size();
+    _isDone = _range.begin > _occurRange.end;
 
     if (!_isDone)
     {
-        /** We have to check that the end doesn't exceed the offsets size. */
-        if (_range.end >= _offsets->size())    {  _range.end = _offsets->size() - 1;  }
+        /** We have to check that the end doesn't exceed the occurrences range. */
+        if (_range.end > _occurRange.end)    {  _range.end = _occurRange.end;  }
 
         /** We reconfigure with the new range. */
         configure ();
@@ -575,12 +933,13 @@ void DatabaseIndex::DatabaseOccurrenceBlockIterator::configure ()
     _seedOccurVector.resize (nb);
 
     /** We create a table holding all the wanted occurrences. */
-    if (_table)  { delete[] _table;  }
-    _table = new ISeedOccurrence [nb];
+    releaseTable ();
+    _table = (ISeedOccurrence*) _memory.malloc (nb * sizeof(ISeedOccurrence));
+    for (_tableSize=0; _tableSize<nb; _tableSize++)  {  new (_table + _tableSize) ISeedOccurrence ();  }
 
     /** We create a buffer holding all neighbourhoods for the occurrences. Note that we
      *  allocate this array only at first call. */
-    if (_neighbourhoods == 0)  {  _neighbourhoods = new LETTER [nb * _neighbourTotalSize];  }
+    if (_neighbourhoods == 0)  {  _neighbourhoods = (LETTER*) _memory.malloc (nb * _neighbourTotalSize);  }
     memset (_neighbourhoods, CODE_X, nb * _neighbourTotalSize);
 
     /** We need a cursor for iterating this buffer. */
@@ -607,7 +966,7 @@ void DatabaseIndex::DatabaseOccurrenceBlockIterator::configure ()
 
         /** We retrieve other information: sequence and offsets in sequence and db. */
         _database->getSequenceByOffset (
-            (*_offsets)[_range.begin + currentIdx].offsetInDatabase,
+            _offsets[_range.begin + currentIdx].offsetInDatabase,
             occur->sequence,
             occur->offsetInSequence,
             occur->offsetInDatabase
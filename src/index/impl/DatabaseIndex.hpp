@@ -28,6 +28,7 @@
 #include <index/impl/AbstractDatabaseIndex.hpp>
 #include <seed/api/ISeed.hpp>
 #include <misc/api/Vector.hpp>
+#include <os/api/IMemoryFile.hpp>
 
 #include <list>
 #include <map>
@@ -44,10 +45,15 @@ namespace impl {
  * This implementation is based on seeds hash code, ie. an integer that identifies
  * a seed.
  *
- * Such an integer is used as a key of a vector whose values are the lists of occurrences
- * (in the database) for a given seed.
+ * Such an integer is used as a key of an offsets table, that gives for each seed the range
+ * of its occurrences (in the database) in a single occurrences table.
  *
- * So, the index data is a vector of vectors.
+ * So, the index data is made of two arrays (a compressed sparse row layout); the occurrences
+ * of a seed are sorted by offset in the database.
+ *
+ * The index is built in two passes: the occurrences of each seed are first counted, which gives
+ * the offsets table, then they are written at their final place. Each pass can be split over
+ * several parts of the database processed in parallel (see build(dp::ICommandDispatcher*)).
  *
  * The size of this data is:
  *    - proportional to the number of seeds found in the database (roughly the size of the database itself)
@@ -78,6 +84,14 @@ public:
     /** \copydoc AbstractDatabaseIndex::build */
     void build ();
 
+    /** Builds the index with commands run by a dispatcher. The database is split in as many parts as
+     *  the dispatcher has execution units; the occurrences of each part are counted in parallel, then
+     *  written in parallel at their final place in the occurrences table. No merge is needed, and the
+     *  index is the same as the one built by build().
+     * \param[in] dispatcher : dispatcher of the commands of both passes.
+     */
+    void build (dp::ICommandDispatcher* dispatcher);
+
     /** \copydoc AbstractDatabaseIndex::createOccurrenceIterator */
     IOccurrenceIterator* createOccurrenceIterator (const seed::ISeed* seed, size_t neighbourhoodSize=0);
 
@@ -88,6 +102,14 @@ public:
         size_t blockSize
     );
 
+    /** \copydoc AbstractDatabaseIndex::createOccurrenceBlockIterator(const seed::ISeed*,size_t,size_t,const misc::Range<size_t>&) */
+    IOccurrenceBlockIterator* createOccurrenceBlockIterator (
+        const seed::ISeed* seed,
+        size_t neighbourhoodSize,
+        size_t blockSize,
+        const misc::Range<size_t>& occurRange
+    );
+
     /** \copydoc AbstractDatabaseIndex::getEntry */
     IndexEntry& getEntry (const seed::ISeed* seed);
 
@@ -97,20 +119,69 @@ public:
     /** \copydoc AbstractDatabaseIndex::getTotalOccurrenceNumber */
     u_int64_t getTotalOccurrenceNumber ();
 
-    /** \copydoc AbstractDatabaseIndex::merge */
+    /** \copydoc AbstractDatabaseIndex::merge
+     *  Note that build(dp::ICommandDispatcher*) builds an index in parallel without needing children. */
     void merge (void);
 
-protected:
+    /** Returns a signature of the index content: it depends on the database data, on the seed model
+     *  and on the kind of index. Two indexes having the same signature have the same content, so an
+     *  index file (see save) can be shared by different executions using the same database.
+     * \return the signature
+     */
+    u_int64_t getSignature ();
+
+    /** Save the index into a file, which can be loaded later by the 'load' method. The file is made of
+     *  a header, the offsets table (for each seed code, index of its first occurrence in the occurrences
+     *  table; one more item gives the total number of occurrences) and the occurrences table.
+     * \param[in] uri       : path of the index file.
+     * \param[in] signature : signature of the index (see getSignature), computed once by the caller.
+     * \return true if the file could be written.
+     */
+    bool save (const std::string& uri, u_int64_t signature);
 
-	/** Shortcut. */
-    typedef std::vector<SeedOccurrenceProt> IndexEntry;
+    /** Load the index from a file created by the 'save' method. The file is memory mapped, so the
+     *  loading is almost immediate; the index built by 'build' or 'merge' is no more used.
+     * \param[in] uri       : path of the index file.
+     * \param[in] signature : signature of the index (see getSignature), computed once by the caller.
+     * \return false if the file doesn't exist or doesn't match the database (see getSignature)
+     */
+    bool load (const std::string& uri, u_int64_t signature);
 
-    /** The index itself. Defined as a vector of vectors. */
-    std::vector <IndexEntry>  _index;
+protected:
 
     /** Data type that holds a seed hash code. */
     typedef u_int32_t SeedHashCode;
 
+    /** The built index: the occurrences of the seed 'code' are the items of the occurrences
+     *  table from _offsets[code] to _offsets[code+1] (excluded). */
+    std::vector<u_int64_t>          _offsets;
+    std::vector<SeedOccurrenceProt> _occurrences;
+
+    /** Mapped index file (see load). */
+    os::IMemoryFile*          _mappedFile;
+
+    /** Tables actually read: either the built ones or the ones of the mapped index file. */
+    const u_int64_t*          _offsetsTable;
+    const SeedOccurrenceProt* _occurrencesTable;
+
+    /** Reads the built tables from now (the mapped index file is released). */
+    void useBuiltTables ();
+
+    /** Returns the occurrences of a seed, either from the built index or from the mapped index file.
+     * \param[in]  code : hash code of the seed
+     * \param[out] nb   : number of occurrences
+     * \return the occurrences table
+     */
+    const SeedOccurrenceProt* getOccurrences (SeedHashCode code, size_t& nb)
+    {
+        nb = _offsetsTable[code+1] - _offsetsTable[code];
+        return nb > 0 ? _occurrencesTable + _offsetsTable[code] : 0;
+    }
+
+    /** Returns a key for the parameters of the index that change its content (see getSignature).
+     * \return the key. */
+    virtual u_int64_t getParametersKey ()  { return 0; }
+
     /** Compute a seed hash code. Can be called in case a ISeed instance has no defined hash code
      * (probably computed by the iterator that provides it)
      * \param[in] kmer : the data for which we want a hash code
@@ -118,34 +189,77 @@ protected:
      */
     SeedHashCode getHashCode (const database::IWord& kmer);
 
-    /** Current sequence parsed during index build. */
-    const database::ISequence* _currentSequence;
+    /** Returns the hash code of a seed, computing it if the seed model didn't.
+     * \param[in] seed : the seed
+     * \return the hash code.
+     */
+    SeedHashCode getSeedCode (const seed::ISeed* seed)
+    {
+        return seed->code != seed::BAD_SEED_HASH_CODE ? seed->code : getHashCode (seed->kmer);
+    }
 
     /* Shortcut & optimization. */
     size_t _span;
     size_t _alphabetSize;
 
-    /** Offset in the database of the current sequence. */
-    u_int64_t _sequenceOffset;
+    /** Part of the database processed by one command of the build (see build(dp::ICommandDispatcher*)). */
+    struct BuildPart
+    {
+        /** The sequences of the part and the offset of the part in the whole database. */
+        database::ISequenceDatabase* database;
+        u_int64_t                    databaseOffset;
 
-    /** Callback to be called each time a seed is found in some data (sequence data for instance).
-     * \param[in] seed : the iterated seed
+        /** For each seed: number of occurrences in the part after the first pass, then index
+         *  of the next occurrence to be written in the occurrences table. */
+        std::vector<u_int32_t>       cursors;
+    };
+
+    /** Builds the index from parts of the database (ordered by offset in the database).
+     * \param[in] parts : the parts of the database.
+     * \param[in] dispatcher : dispatcher of the commands processing the parts.
      */
-    void iterateSeed (const seed::ISeed* seed);
+    void buildParts (std::vector<BuildPart>& parts, dp::ICommandDispatcher* dispatcher);
 
     /** */
     virtual seed::ISeedIterator* createSeedsIterator (const database::IWord& data);
 
+    /********************************************************************************/
+    /** \brief Command that counts (first pass) or writes (second pass) the occurrences of a part of the database.
+     *
+     * The commands of a pass work on different parts and write at different places of the
+     * occurrences table, so they don't need any synchronization.
+     */
+    class PartBuilder : public dp::ICommand
+    {
+    public:
+        PartBuilder (DatabaseIndex* index, BuildPart& part, bool fill)
+            : _index(index), _part(part), _fill(fill), _sequence(0), _sequenceOffset(0), _occurrences(0)  {}
+
+        void execute ();
+
+    private:
+        DatabaseIndex*             _index;
+        BuildPart&                 _part;
+        bool                       _fill;
+        const database::ISequence* _sequence;
+        u_int64_t                  _sequenceOffset;
+        SeedOccurrenceProt*        _occurrences;
+
+        /** Callbacks called for each seed of the current sequence. */
+        void countSeed (const seed::ISeed* seed);
+        void fillSeed  (const seed::ISeed* seed);
+    };
+
     /********************************************************************************/
     /** \brief IOccurrenceIterator implementation used by DatabaseIndex::createOccurrenceIterator class.
      */
     class DatabaseOccurrenceIterator : public IOccurrenceIterator
     {
     public:
-        DatabaseOccurrenceIterator (database::ISequenceDatabase* database, size_t span, IndexEntry* offsets, size_t neighbourSize)
+        DatabaseOccurrenceIterator (database::ISequenceDatabase* database, size_t span, const SeedOccurrenceProt* offsets, size_t nbOffsets, size_t neighbourSize)
             : _database(database), _span(span), _offsets(offsets), _neighbourSize(neighbourSize), _item(span+2*neighbourSize), _currentIdx(0)
         {
-            _lastIdx       = _offsets->size() - 1;
+            _lastIdx       = nbOffsets - 1;
         }
 
         void first()
@@ -175,7 +289,7 @@ protected:
     private:
         database::ISequenceDatabase* _database;
         size_t                       _span;
-        IndexEntry*                  _offsets;
+        const SeedOccurrenceProt*    _offsets;
         size_t                       _neighbourSize;
         ISeedOccurrence              _item;
         size_t                       _currentIdx;
@@ -193,9 +307,10 @@ protected:
         DatabaseOccurrenceBlockIterator (
             database::ISequenceDatabase* database,
             size_t span,
-            IndexEntry* offsets,
+            const SeedOccurrenceProt* offsets,
             size_t neighbourSize,
-            size_t nbSeedOccurPerIteration
+            size_t nbSeedOccurPerIteration,
+            const misc::Range<size_t>& occurRange
         );
 
         ~DatabaseOccurrenceBlockIterator ();
@@ -213,21 +328,32 @@ protected:
     private:
         database::ISequenceDatabase* _database;
         size_t                       _span;
-        IndexEntry*                  _offsets;
+        const SeedOccurrenceProt*    _offsets;
         size_t                       _neighbourSize;
         size_t                       _nbSeedOccurPerIteration;
         size_t                       _neighbourTotalSize;
 
         misc::Vector<const indexation::ISeedOccurrence*> _seedOccurVector;
 
+        /** Allocator of the occurrences table and of the neighbourhoods: these buffers only live
+         *  during a block of the iteration, so they are taken in the arena of the current thread. */
+        os::IMemoryAllocator&        _memory;
+
         indexation::ISeedOccurrence* _table;
+        size_t                       _tableSize;
         database::LETTER*            _neighbourhoods;
 
+        /** Release the occurrences table. */
+        void releaseTable ();
+
         bool _isDone;
 
         /** We need a seed occurrences range (evolves as iteration goes on). */
         misc::Range<size_t> _range;
 
+        /** Range of the seed occurrences to be iterated. */
+        misc::Range<size_t> _occurRange;
+
         /** Configuration of neighborhoods for a range of seed occurrences. */
         void configure ();
     };
@@ -264,6 +390,9 @@ protected:
 
     /** */
     seed::ISeedIterator* createSeedsIterator (const database::IWord& data);
+
+    /** \copydoc DatabaseIndex::getParametersKey */
+    u_int64_t getParametersKey ()  { return _range + 1; }
 };
 
 /********************************************************************************/
@@ -66,6 +66,13 @@ public:
         size_t blockSize
     );
 
+    IOccurrenceBlockIterator* createOccurrenceBlockIterator (
+        const seed::ISeed* seed,
+        size_t neighbourhoodSize,
+        size_t blockSize,
+        const misc::Range<size_t>& occurRange
+    )  { return 0; }
+
     size_t getOccurrenceNumber (const seed::ISeed* seed)  { return 0; }
 
     u_int64_t getTotalOccurrenceNumber () { return 0; }
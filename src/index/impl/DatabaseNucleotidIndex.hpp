@@ -88,6 +88,14 @@ public:
         size_t blockSize
     )  { return 0; }
 
+    /** \copydoc AbstractDatabaseIndex::createOccurrenceBlockIterator(const seed::ISeed*,size_t,size_t,const misc::Range<size_t>&) */
+    IOccurrenceBlockIterator* createOccurrenceBlockIterator (
+        const seed::ISeed* seed,
+        size_t neighbourhoodSize,
+        size_t blockSize,
+        const misc::Range<size_t>& occurRange
+    )  { return 0; }
+
     /** \copydoc AbstractDatabaseIndex::getEntry */
     IndexEntry& getEntry (const seed::ISeed* seed);
 
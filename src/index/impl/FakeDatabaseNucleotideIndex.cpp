@@ -54,8 +54,45 @@ FakeDatabaseNucleotideIndex::FakeDatabaseNucleotideIndex (ISequenceDatabase* dat
     _maskSize(0),
     _subjectUri(subjectUri),
     _queryUri(queryUri),
-    _kmersPerSequence(kmersPerSequence),
+    _kmersPerSequence(1, kmersPerSequence),
     _synchro(0)
+{
+    initMask ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+FakeDatabaseNucleotideIndex::FakeDatabaseNucleotideIndex (ISequenceDatabase* database,
+    ISeedModel* model,
+    std::string subjectUri,
+    std::string queryUri,
+    const std::vector<long>& kmersPerSequence)
+    : AbstractDatabaseIndex (database, model),
+    _maskOut(0),
+    _maskSize(0),
+    _subjectUri(subjectUri),
+    _queryUri(queryUri),
+    _kmersPerSequence(kmersPerSequence.begin(), kmersPerSequence.end()),
+    _synchro(0)
+{
+    initMask ();
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void FakeDatabaseNucleotideIndex::initMask ()
 {
     // compute the mask size
     size_t alphabetSize = getModel()->getAlphabet()->size;
@@ -93,21 +130,34 @@ FakeDatabaseNucleotideIndex::~FakeDatabaseNucleotideIndex ()
 *********************************************************************/
 void FakeDatabaseNucleotideIndex::build ()
 {
-    ISeedMaskGenerator* maskGenerator = getSeedMaskGenerator(_kmersPerSequence);
-    LOCAL(maskGenerator);
-
-    size_t generatedMaskSize = maskGenerator->getBitsetSize();
-
-    if (generatedMaskSize != _maskSize * sizeof(word_t)) {
-        std::cerr << "Expected mask size was "
-            << _maskSize * sizeof(word_t)
-            << " but was "
-            << generatedMaskSize
-            << std::endl;
-        throw "Internal error. FakeDatabaseNucleotideIndex::build";
+    for (size_t i = 0; i < _kmersPerSequence.size(); i++)
+    {
+        // A null number of kmers keeps all the seeds.
+        if (_kmersPerSequence[i] == 0) {
+            memset (_maskOut, ~0, sizeof(word_t)*_maskSize);
+            break;
+        }
+
+        ISeedMaskGenerator* maskGenerator = getSeedMaskGenerator(_kmersPerSequence[i]);
+        LOCAL(maskGenerator);
+
+        size_t generatedMaskSize = maskGenerator->getBitsetSize();
+
+        if (generatedMaskSize != _maskSize * sizeof(word_t)) {
+            std::cerr << "Expected mask size was "
+                << _maskSize * sizeof(word_t)
+                << " but was "
+                << generatedMaskSize
+                << std::endl;
+            throw "Internal error. FakeDatabaseNucleotideIndex::build";
+        }
+
+        // The mask is the union of the masks of each number of kmers.
+        const word_t* bitset = (const word_t*) maskGenerator->getBitset();
+        for (size_t j = 0; j < _maskSize; j++) {
+            _maskOut[j] |= bitset[j];
+        }
     }
-
-    memcpy(_maskOut, maskGenerator->getBitset(), generatedMaskSize);
 }
 
 /*********************************************************************
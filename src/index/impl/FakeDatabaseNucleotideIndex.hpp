@@ -26,6 +26,7 @@
 #include <os/api/IThread.hpp>
 
 #include <map>
+#include <vector>
 
 /********************************************************************************/
 namespace indexation {
@@ -88,6 +89,17 @@ public:
         std::string queryUri,
         long kmersPerSequence);
 
+    /** Constructor for a mask that is the union of the masks of several numbers of kmers.
+     *  A null number of kmers in the list means that all the seeds are kept.
+     * \param[in] database : the database to be indexed
+     * \param[in] model : the seed model whose seeds are index keys
+     * */
+    FakeDatabaseNucleotideIndex (database::ISequenceDatabase* database,
+        seed::ISeedModel* model,
+        std::string subjectUri,
+        std::string queryUri,
+        const std::vector<long>& kmersPerSequence);
+
     virtual ~FakeDatabaseNucleotideIndex ();
 
     /** \copydoc AbstractDatabaseIndex::build */
@@ -113,6 +125,14 @@ public:
      size_t blockSize
     )  { return 0; }
 
+    /** \copydoc AbstractDatabaseIndex::createOccurrenceBlockIterator(const seed::ISeed*,size_t,size_t,const misc::Range<size_t>&) */
+    IOccurrenceBlockIterator* createOccurrenceBlockIterator (
+     const seed::ISeed* seed,
+     size_t neighbourhoodSize,
+     size_t blockSize,
+     const misc::Range<size_t>& occurRange
+    )  { return 0; }
+
     /** \copydoc AbstractDatabaseIndex::getEntry */
     IndexEntry& getEntry (const seed::ISeed* seed);
 
@@ -132,7 +152,10 @@ protected:
 
     std::string _subjectUri;
     std::string _queryUri;
-    u_int64_t _kmersPerSequence;
+    std::vector<u_int64_t> _kmersPerSequence;
+
+    /** Allocate the mask (common part of the constructors). */
+    void initMask ();
 
 private:
 
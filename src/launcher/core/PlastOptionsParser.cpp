@@ -81,6 +81,7 @@ void PlastOptionsParser::build ()
     //this->add (new OptionOneParam ("-C", "Use composition-based score adjustments as in Bioinformatics 21:902-911 for plastp or tplastn [T/F]"));
 
     this->add (new OptionOneParam (STR_OPTION_MAX_DATABASE_SIZE,        STR_HELP_MAX_DATABASE_SIZE));
+    this->add (new OptionOneParam (STR_OPTION_BLOCKS_IN_FLIGHT,         STR_HELP_BLOCKS_IN_FLIGHT));
     this->add (new OptionOneParam (STR_OPTION_MAX_HIT_PER_QUERY,        STR_HELP_MAX_HIT_PER_QUERY));
     this->add (new OptionOneParam (STR_OPTION_MAX_HSP_PER_HIT,          STR_HELP_MAX_HSP_PER_HIT));
     //this->add (new OptionOneParam (STR_OPTION_MAX_HIT_PER_ITERATION,    STR_HELP_MAX_HIT_PER_ITERATION));
@@ -103,6 +104,7 @@ void PlastOptionsParser::build ()
     this->add (new OptionOneParam (STR_OPTION_FACTORY_GAP_RESULT,       STR_HELP_FACTORY_GAP_RESULT));
     this->add (new OptionOneParam (STR_OPTION_FACTORY_UNGAP_RESULT,     STR_HELP_FACTORY_UNGAP_RESULT));
     this->add (new OptionOneParam (STR_OPTION_FACTORY_SPLITTER,         STR_HELP_FACTORY_SPLITTER));
+    this->add (new OptionOneParam (STR_OPTION_FACTORY_SEMIGAP_ALIGN,    STR_HELP_FACTORY_SEMIGAP_ALIGN));
 
     this->add (new OptionOneParam (STR_OPTION_OPTIM_FILTER_UNGAP,       STR_HELP_OPTIM_FILTER_UNGAP));
 
@@ -123,6 +125,8 @@ void PlastOptionsParser::build ()
 
     this->add (new OptionOneParam (STR_OPTION_SEEDS_USE_RATIO,          STR_HELP_SEEDS_USE_RATIO));
     this->add (new OptionOneParam (STR_OPTION_INDEX_FILTER_SEED,        STR_HELP_INDEX_FILTER_SEED));
+    this->add (new OptionOneParam (STR_OPTION_INDEX_DIRECTORY,          STR_HELP_INDEX_DIRECTORY));
+    this->add (new OptionNoParam  (STR_OPTION_INDEX_ONLY,               STR_HELP_INDEX_ONLY));
 
     this->add (new OptionOneParam (STR_OPTION_COMPLETE_SUBJECT_DB_STATS_FILE,       STR_HELP_COMPLETE_SUBJECT_DB_STATS_FILE));
 
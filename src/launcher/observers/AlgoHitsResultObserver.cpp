@@ -27,6 +27,7 @@
 
 #include <os/api/ITime.hpp>
 #include <os/impl/DefaultOsFactory.hpp>
+#include <os/impl/ArenaMemory.hpp>
 
 #include <launcher/observers/AlgoHitsResultObserver.hpp>
 
@@ -192,6 +193,15 @@ void AlgoHitsPropertiesObserver::update (dp::EventInfo* evt, dp::ISubject* subje
             props.add (1, "database_split",     "%ld segment(s) of block size %ld bytes", e2->_total, dbSegment);
             props.add (1, "output_file",        "%lld bytes",   outputSize);
 
+            /** We get the use of the per thread arena allocators. */
+            ArenaMemoryAllocator::Stats arena = ArenaMemoryAllocator::getGlobalStats();
+            props.add (1, "arena_allocator");
+            props.add (2, "allocations",        "%lld",         arena.nbAllocs);
+            props.add (2, "allocated",          "%.1f Mb",      (float)arena.nbBytes / 1024.0 / 1024.0);
+            props.add (2, "resets",             "%lld",         arena.nbResets);
+            props.add (2, "peak",               "%.1f Mb",      (float)arena.peak / 1024.0 / 1024.0);
+            props.add (2, "capacity",           "%.1f Mb",      (float)arena.capacity / 1024.0 / 1024.0);
+
             props.add (0, "hits");
 
             /** We can now dump the aggregated information. */
@@ -175,6 +175,14 @@ namespace misc {
  */
 #define STR_OPTION_MAX_DATABASE_SIZE        misc::StringRepository::m_STR_OPTION_MAX_DATABASE_SIZE ()
 
+/** "-blocks-in-flight"    Command Line option giving the maximum number of database blocks (see "-max-database-size")
+ *  processed at the same time: the next blocks are read and indexed, and the alignments of the previous
+ *  block are dumped, while the alignments of the current block are computed. Each block in flight holds
+ *  its own databases and indexes, so this is also a memory budget.
+ *  Integer value (default 1, ie. the blocks are processed one after the other)
+ */
+#define STR_OPTION_BLOCKS_IN_FLIGHT         misc::StringRepository::m_STR_OPTION_BLOCKS_IN_FLIGHT ()
+
 /** "-max-hit_per-query"  Command Line option giving the maximum number of hits per query we want in the output.
  *  This may be useful for avoiding to have too many alignments for one query sequence (only the
  *  "best" ones are kept)
@@ -211,7 +219,7 @@ namespace misc {
 #define STR_OPTION_CODON_STOP_OPTIM         misc::StringRepository::m_STR_OPTION_CODON_STOP_OPTIM ()
 
 /** "-factory-dispatcher"   Command Line option giving the factory name for creating commands dispatcher.
- *  String value, one of: SerialCommandDispatcher, ParallelCommandDispatcher (default)
+ *  String value, one of: SerialCommandDispatcher, ParallelCommandDispatcher (default), ThreadPoolCommandDispatcher
  */
 #define STR_OPTION_FACTORY_DISPATCHER       misc::StringRepository::m_STR_OPTION_FACTORY_DISPATCHER ()
 
@@ -226,12 +234,15 @@ namespace misc {
 #define STR_OPTION_FACTORY_INDEXATION       misc::StringRepository::m_STR_OPTION_FACTORY_INDEXATION ()
 
 /** "-factory-hit-ungap"    Command Line option giving the factory name for creating ungap algorithm part instances.
- *  String value, one of: UngapHitIteratorNull, UngapHitIterator, UngapHitIteratorSSE16 (default)
+ *  String value, one of: UngapHitIteratorNull, UngapHitIterator, UngapHitIteratorSSE16, UngapHitIteratorAVX2,
+ *  UngapHitIteratorAVX512. By default, the widest SIMD implementation supported by the CPU is used.
  */
 #define STR_OPTION_FACTORY_HIT_UNGAP        misc::StringRepository::m_STR_OPTION_FACTORY_HIT_UNGAP ()
 
 /** "-factory-hit-smallgap" Command Line option giving the factory name for creating small gap algorithm part instances.
- *  String value, one of: SmallGapHitIteratorNull, SmallGapHitIteratorSSE8 (default)
+ *  String value, one of: SmallGapHitIteratorNull, SmallGapHitIteratorSSE8 (default), SmallGapHitIteratorAVX2,
+ *  SmallGapHitIteratorAVX512 (if supported by the CPU; they forward the hits by bigger batches, so a few
+ *  alignments may differ from the default).
  */
 #define STR_OPTION_FACTORY_HIT_SMALLGAP     misc::StringRepository::m_STR_OPTION_FACTORY_HIT_SMALLGAP ()
 
@@ -246,12 +257,12 @@ namespace misc {
 #define STR_OPTION_FACTORY_HIT_COMPOSITION  misc::StringRepository::m_STR_OPTION_FACTORY_HIT_COMPOSITION ()
 
 /** "-factory-gap-result" Command Line option giving the factory name for creating gap result instances (containing final alignments).
- *  String value, one of: BasicAlignmentResult
+ *  String value, one of: BasicAlignmentResult (default), FlatAlignmentResult
  */
 #define STR_OPTION_FACTORY_GAP_RESULT       misc::StringRepository::m_STR_OPTION_FACTORY_GAP_RESULT ()
 
 /** "-factory-ungap-result" Command Line option giving the factory name for creating ungap result instances (containing final ungap alignments).
- *  String value, one of: UngapAlignmentResult
+ *  String value, one of: UngapAlignmentResult, UngapAlignmentResultLockFree (default).
  */
 #define STR_OPTION_FACTORY_UNGAP_RESULT     misc::StringRepository::m_STR_OPTION_FACTORY_UNGAP_RESULT ()
 
@@ -260,6 +271,11 @@ namespace misc {
  */
 #define STR_OPTION_FACTORY_SPLITTER     misc::StringRepository::m_STR_OPTION_FACTORY_SPLITTER ()
 
+/** "-factory-semigap-align" Command Line option giving the factory name for creating the X-drop gapped extension.
+ *  String value, one of: SemiGapAlign (default), SemiGapAlignAVX2
+ */
+#define STR_OPTION_FACTORY_SEMIGAP_ALIGN    misc::StringRepository::m_STR_OPTION_FACTORY_SEMIGAP_ALIGN ()
+
 /** "-optim-filter-ungap" Command Line option giving the boolean value for filtering out already known ungap alignments before small gap algorithm.
  * This option may lead to great time optimization.
  *  String value (F or T). Default to true
@@ -330,6 +346,17 @@ namespace misc {
  */
 #define STR_OPTION_INDEX_FILTER_SEED         misc::StringRepository::m_STR_OPTION_INDEX_FILTER_SEED ()
 
+/** "-index-dir" command line option giving a directory where the subject indexes are saved; an index saved
+ *  by a previous execution for the same database is loaded instead of being built again.
+ *  String value.
+ */
+#define STR_OPTION_INDEX_DIRECTORY          misc::StringRepository::m_STR_OPTION_INDEX_DIRECTORY ()
+
+/** "-index-only" command line option telling that only the subject index has to be built (and saved, see "-index-dir").
+ *  No associated value.
+ */
+#define STR_OPTION_INDEX_ONLY               misc::StringRepository::m_STR_OPTION_INDEX_ONLY ()
+
 /** "-seeds-use-ratio"  Command Line option giving the ratio of seeds to be used. Setting a value less than 1.0 will speed up
  * the algorithm with the drawback to get fewer alignments. In some cases, setting the value to 0.05 with a evalue to 1e-30 will
  * lead to x2 speed up with a loss of about 1% of alignements.
@@ -426,6 +453,7 @@ namespace misc {
 #define STR_HELP_PENALTY                    misc::StringRepository::m_STR_HELP_PENALTY ()   // penalty for a nucleotide mismatch (plastn)
 #define STR_HELP_FORCE_QUERY_ORDERING       misc::StringRepository::m_STR_HELP_FORCE_QUERY_ORDERING ()   // Force queries ordering in output file.
 #define STR_HELP_MAX_DATABASE_SIZE          misc::StringRepository::m_STR_HELP_MAX_DATABASE_SIZE ()   // Maximum allowed size (in bytes) for a database. If greater, database is segmented.
+#define STR_HELP_BLOCKS_IN_FLIGHT           misc::StringRepository::m_STR_HELP_BLOCKS_IN_FLIGHT ()   // Maximum number of database blocks processed at the same time.
 #define STR_HELP_MAX_HIT_PER_QUERY			misc::StringRepository::m_STR_HELP_MAX_HIT_PER_QUERY ()
 #define STR_HELP_MAX_HSP_PER_HIT            misc::StringRepository::m_STR_HELP_MAX_HSP_PER_HIT ()   // Maximum hits per query. 0 value will dump all hits (default)
 #define STR_HELP_MAX_HIT_PER_ITERATION      misc::StringRepository::m_STR_HELP_MAX_HIT_PER_ITERATION ()   // Maximum hits per iteration (for memory usage control). 1000000 by default
@@ -442,10 +470,13 @@ namespace misc {
 #define STR_HELP_FACTORY_GAP_RESULT         misc::StringRepository::m_STR_HELP_FACTORY_GAP_RESULT ()   // Factory that creates gap alignments result.
 #define STR_HELP_FACTORY_UNGAP_RESULT       misc::StringRepository::m_STR_HELP_FACTORY_UNGAP_RESULT ()   // Factory that creates ungap alignments result.
 #define STR_HELP_FACTORY_SPLITTER           misc::StringRepository::m_STR_HELP_FACTORY_SPLITTER ()   // Factory that creates an alignment splitter
+#define STR_HELP_FACTORY_SEMIGAP_ALIGN      misc::StringRepository::m_STR_HELP_FACTORY_SEMIGAP_ALIGN ()   // Factory that creates the gapped extension
 #define STR_HELP_OPTIM_FILTER_UNGAP         misc::StringRepository::m_STR_HELP_OPTIM_FILTER_UNGAP ()   // Optimization that filters out through ungap alignments.
 #define STR_HELP_XML_FILTER_FILE            misc::StringRepository::m_STR_HELP_XML_FILTER_FILE ()   // Uri of a XML filter file.
 #define STR_HELP_SEEDS_USE_RATIO            misc::StringRepository::m_STR_HELP_SEEDS_USE_RATIO ()   // Ratio of seeds to be used.
 #define STR_HELP_INDEX_FILTER_SEED          misc::StringRepository::m_STR_HELP_INDEX_FILTER_SEED ()   // size of the seeds index filter.
+#define STR_HELP_INDEX_DIRECTORY            misc::StringRepository::m_STR_HELP_INDEX_DIRECTORY ()   // Directory of the saved subject indexes.
+#define STR_HELP_INDEX_ONLY                 misc::StringRepository::m_STR_HELP_INDEX_ONLY ()   // Only build the subject index.
 #define STR_HELP_HELP                       misc::StringRepository::m_STR_HELP_HELP ()   // help
 #define STR_HELP_INFO_BARGRAPH              misc::StringRepository::m_STR_HELP_INFO_BARGRAPH ()   // Display a progress bar during execution.
 #define STR_HELP_INFO_BARGRAPH_SIZE         misc::StringRepository::m_STR_HELP_INFO_BARGRAPH_SIZE ()   // Nb of characters of the bargraph.
@@ -466,21 +497,30 @@ namespace misc {
 #define STR_CONFIG_CLASS_SpougeStats				    misc::StringRepository::m_STR_CONFIG_CLASS_SpougeStats ()   // SpougeStats
 #define STR_CONFIG_CLASS_SerialCommandDispatcher        misc::StringRepository::m_STR_CONFIG_CLASS_SerialCommandDispatcher ()   // SerialCommandDispatcher
 #define STR_CONFIG_CLASS_ParallelCommandDispatcher      misc::StringRepository::m_STR_CONFIG_CLASS_ParallelCommandDispatcher ()   // ParallelCommandDispatcher
+#define STR_CONFIG_CLASS_ThreadPoolCommandDispatcher    misc::StringRepository::m_STR_CONFIG_CLASS_ThreadPoolCommandDispatcher ()   // ThreadPoolCommandDispatcher
 #define STR_CONFIG_CLASS_BasicIndexator                 misc::StringRepository::m_STR_CONFIG_CLASS_BasicIndexator ()   // BasicIndexator
 #define STR_CONFIG_CLASS_BasicSortedIndexator           misc::StringRepository::m_STR_CONFIG_CLASS_BasicSortedIndexator ()   // BasicSortedIndexator
 #define STR_CONFIG_CLASS_BasicIndexatorOptim            misc::StringRepository::m_STR_CONFIG_CLASS_BasicIndexatorOptim ()   // BasicIndexatorOptim
 #define STR_CONFIG_CLASS_UngapHitIteratorNull           misc::StringRepository::m_STR_CONFIG_CLASS_UngapHitIteratorNull ()   // UngapHitIteratorNull
 #define STR_CONFIG_CLASS_UngapHitIterator               misc::StringRepository::m_STR_CONFIG_CLASS_UngapHitIterator ()   // UngapHitIterator
 #define STR_CONFIG_CLASS_UngapHitIteratorSSE16          misc::StringRepository::m_STR_CONFIG_CLASS_UngapHitIteratorSSE16 ()   // UngapHitIteratorSSE16
+#define STR_CONFIG_CLASS_UngapHitIteratorAVX2           misc::StringRepository::m_STR_CONFIG_CLASS_UngapHitIteratorAVX2 ()   // UngapHitIteratorAVX2
+#define STR_CONFIG_CLASS_UngapHitIteratorAVX512         misc::StringRepository::m_STR_CONFIG_CLASS_UngapHitIteratorAVX512 ()   // UngapHitIteratorAVX512
 #define STR_CONFIG_CLASS_SmallGapHitIterator            misc::StringRepository::m_STR_CONFIG_CLASS_SmallGapHitIterator ()   // SmallGapHitIterator
 #define STR_CONFIG_CLASS_SmallGapHitIteratorNull        misc::StringRepository::m_STR_CONFIG_CLASS_SmallGapHitIteratorNull ()   // SmallGapHitIteratorNull
 #define STR_CONFIG_CLASS_SmallGapHitIteratorSSE8        misc::StringRepository::m_STR_CONFIG_CLASS_SmallGapHitIteratorSSE8 ()   // SmallGapHitIteratorSSE8
+#define STR_CONFIG_CLASS_SmallGapHitIteratorAVX2        misc::StringRepository::m_STR_CONFIG_CLASS_SmallGapHitIteratorAVX2 ()   // SmallGapHitIteratorAVX2
+#define STR_CONFIG_CLASS_SmallGapHitIteratorAVX512      misc::StringRepository::m_STR_CONFIG_CLASS_SmallGapHitIteratorAVX512 ()   // SmallGapHitIteratorAVX512
+#define STR_CONFIG_CLASS_SemiGapAlign                   misc::StringRepository::m_STR_CONFIG_CLASS_SemiGapAlign ()   // SemiGapAlign
+#define STR_CONFIG_CLASS_SemiGapAlignAVX2               misc::StringRepository::m_STR_CONFIG_CLASS_SemiGapAlignAVX2 ()   // SemiGapAlignAVX2
 #define STR_CONFIG_CLASS_FullGapHitIterator             misc::StringRepository::m_STR_CONFIG_CLASS_FullGapHitIterator ()   // FullGapHitIterator
 #define STR_CONFIG_CLASS_FullGapHitIteratorNull         misc::StringRepository::m_STR_CONFIG_CLASS_FullGapHitIteratorNull ()   // FullGapHitIteratorNull
 #define STR_CONFIG_CLASS_CompositionHitIterator         misc::StringRepository::m_STR_CONFIG_CLASS_CompositionHitIterator ()   // CompositionHitIterator
 #define STR_CONFIG_CLASS_CompositionHitIteratorNull     misc::StringRepository::m_STR_CONFIG_CLASS_CompositionHitIteratorNull ()   // CompositionHitIteratorNull
 #define STR_CONFIG_CLASS_BasicAlignmentResult           misc::StringRepository::m_STR_CONFIG_CLASS_BasicAlignmentResult ()   // BasicAlignmentResult
+#define STR_CONFIG_CLASS_FlatAlignmentResult            misc::StringRepository::m_STR_CONFIG_CLASS_FlatAlignmentResult ()   // FlatAlignmentResult
 #define STR_CONFIG_CLASS_UngapAlignmentResult           misc::StringRepository::m_STR_CONFIG_CLASS_UngapAlignmentResult ()   // UngapAlignmentResult
+#define STR_CONFIG_CLASS_UngapAlignmentResultLockFree   misc::StringRepository::m_STR_CONFIG_CLASS_UngapAlignmentResultLockFree ()   // UngapAlignmentResultLockFree
 
 #define STR_PARAM_params                misc::StringRepository::m_STR_PARAM_params ()   // params
 #define STR_PARAM_seedModelKind         misc::StringRepository::m_STR_PARAM_seedModelKind ()   // seedModelKind
@@ -242,6 +242,7 @@ public:
     static const char* m_STR_OPTION_STRAND () { return "-strand"; }
     static const char* m_STR_OPTION_FORCE_QUERY_ORDERING () { return "-force-query-order"; }
     static const char* m_STR_OPTION_MAX_DATABASE_SIZE () { return "-max-database-size"; }
+    static const char* m_STR_OPTION_BLOCKS_IN_FLIGHT () { return "-blocks-in-flight"; }
     static const char* m_STR_OPTION_MAX_HIT_PER_QUERY () { return "-max-hit-per-query"; }
     static const char* m_STR_OPTION_MAX_HSP_PER_HIT () { return "-max-hsp-per-hit"; }
     static const char* m_STR_OPTION_MAX_HIT_PER_ITERATION () { return "-max-hit-per-iteration"; }
@@ -257,6 +258,7 @@ public:
     static const char* m_STR_OPTION_FACTORY_GAP_RESULT () { return "-factory-gap-result"; }
     static const char* m_STR_OPTION_FACTORY_UNGAP_RESULT () { return "-factory-ungap-result"; }
     static const char* m_STR_OPTION_FACTORY_SPLITTER () { return "-splitter"; }
+    static const char* m_STR_OPTION_FACTORY_SEMIGAP_ALIGN () { return "-factory-semigap-align"; }
     static const char* m_STR_OPTION_OPTIM_FILTER_UNGAP () { return "-optim-filter-ungap"; }
     static const char* m_STR_OPTION_INFO_BARGRAPH () { return "-bargraph"; }
     static const char* m_STR_OPTION_INFO_BARGRAPH_SIZE () { return "-bargraph-size"; }
@@ -272,6 +274,8 @@ public:
     static const char* m_STR_OPTION_XML_FILTER_FILE () { return "-xmlfilter"; }
     static const char* m_STR_OPTION_SEEDS_USE_RATIO () { return "-seeds-use-ratio"; }
     static const char* m_STR_OPTION_INDEX_FILTER_SEED () { return "-seeds-index-filter"; }
+    static const char* m_STR_OPTION_INDEX_DIRECTORY () { return "-index-dir"; }
+    static const char* m_STR_OPTION_INDEX_ONLY () { return "-index-only"; }
     static const char* m_STR_OPTION_HELP () { return "-h"; }
     static const char* m_STR_OPTION_WORD_SIZE () { return "-W"; }
     static const char* m_STR_OPTION_COMPLETE_SUBJECT_DB_SIZE () { return "-complete-subject-database-size"; }
@@ -329,10 +333,11 @@ public:
     static const char* m_STR_HELP_PENALTY () { return "penalty for a nucleotide mismatch (plastn)"; }
     static const char* m_STR_HELP_FORCE_QUERY_ORDERING () { return "Force queries ordering in output file. 0 by default, which is equivalent to a value of 10000. To turn off, put a negative value (-1 for example)"; }
     static const char* m_STR_HELP_MAX_DATABASE_SIZE () { return "Maximum allowed size (in bytes) for a database. If greater, database is segmented."; }
+    static const char* m_STR_HELP_BLOCKS_IN_FLIGHT () { return "Maximum number of database blocks processed at the same time (reading, alignment and output are overlapped)."; }
     static const char* m_STR_HELP_MAX_HIT_PER_QUERY () { return "Maximum hits per query. 0 value will dump all hits (default)"; }
     static const char* m_STR_HELP_MAX_HSP_PER_HIT () { return "Maximum alignments per hit. 0 value will dump all hits (default)"; }
     static const char* m_STR_HELP_MAX_HIT_PER_ITERATION () { return "Maximum hits per iteration (for memory usage control). 1000000 by default"; }
-    static const char* m_STR_HELP_OUTPUT_FORMAT () { return "Output format: 1 for tabulated (default), 2 for extended tubulated, 4 for NCBI Blast-like."; }
+    static const char* m_STR_HELP_OUTPUT_FORMAT () { return "Output format: 1 for tabulated (default), 2 for extended tubulated, 4 for NCBI Blast-like, 5 for binary columnar."; }
     static const char* m_STR_HELP_STRANDS_LIST () { return "List of the strands (ex: \"1,2,6\") to be used when using algo using nucleotids databases."; }
     static const char* m_STR_HELP_CODON_STOP_OPTIM () { return "size of the allowed range between the last invalid character and the next stop codon"; }
     static const char* m_STR_HELP_FACTORY_DISPATCHER () { return "Factory that creates dispatcher."; }
@@ -342,13 +347,16 @@ public:
     static const char* m_STR_HELP_FACTORY_HIT_SMALLGAP () { return "Factory that creates small gap hits iterator."; }
     static const char* m_STR_HELP_FACTORY_HIT_FULLGAP () { return "Factory that creates full gap hits iterator."; }
     static const char* m_STR_HELP_FACTORY_HIT_COMPOSITION () { return "Factory that creates composition hits iterator."; }
-    static const char* m_STR_HELP_FACTORY_GAP_RESULT () { return "Factory that creates gap alignments result."; }
-    static const char* m_STR_HELP_FACTORY_UNGAP_RESULT () { return "Factory that creates ungap alignments result."; }
+    static const char* m_STR_HELP_FACTORY_GAP_RESULT () { return "Factory that creates gap alignments result. String: 'BasicAlignmentResult' (default) or 'FlatAlignmentResult'"; }
+    static const char* m_STR_HELP_FACTORY_UNGAP_RESULT () { return "Factory that creates ungap alignments result. String: 'UngapAlignmentResult' or 'UngapAlignmentResultLockFree' (default)"; }
     static const char* m_STR_HELP_FACTORY_SPLITTER () { return "Factory that creates an alignment splitter. String: 'normal' or 'banded' (default)"; }
+    static const char* m_STR_HELP_FACTORY_SEMIGAP_ALIGN () { return "Factory that creates the gapped extension. String: 'SemiGapAlign' (default) or 'SemiGapAlignAVX2'"; }
     static const char* m_STR_HELP_OPTIM_FILTER_UNGAP () { return "Optimization that filters out through ungap alignments."; }
     static const char* m_STR_HELP_XML_FILTER_FILE () { return "Uri of a XML filter file."; }
     static const char* m_STR_HELP_SEEDS_USE_RATIO () { return "Ratio of seeds to be used."; }
     static const char* m_STR_HELP_INDEX_FILTER_SEED () { return "seeds length to be used for the indexation filter."; }
+    static const char* m_STR_HELP_INDEX_DIRECTORY () { return "directory where the subject indexes are saved and reused by other executions on the same database"; }
+    static const char* m_STR_HELP_INDEX_ONLY () { return "only build the subject index (to be used with -index-dir)"; }
     static const char* m_STR_HELP_HELP () { return "help"; }
     static const char* m_STR_HELP_INFO_BARGRAPH () { return "Display a progress bar during execution."; }
     static const char* m_STR_HELP_INFO_BARGRAPH_SIZE () { return "Nb of characters of the bargraph."; }
@@ -368,21 +376,30 @@ public:
     static const char* m_STR_CONFIG_CLASS_SpougeStats () { return "SpougeStats"; }
     static const char* m_STR_CONFIG_CLASS_SerialCommandDispatcher () { return "SerialCommandDispatcher"; }
     static const char* m_STR_CONFIG_CLASS_ParallelCommandDispatcher () { return "ParallelCommandDispatcher"; }
+    static const char* m_STR_CONFIG_CLASS_ThreadPoolCommandDispatcher () { return "ThreadPoolCommandDispatcher"; }
     static const char* m_STR_CONFIG_CLASS_BasicIndexator () { return "BasicIndexator"; }
     static const char* m_STR_CONFIG_CLASS_BasicSortedIndexator () { return "BasicSortedIndexator"; }
     static const char* m_STR_CONFIG_CLASS_BasicIndexatorOptim () { return "BasicIndexatorOptim"; }
     static const char* m_STR_CONFIG_CLASS_UngapHitIteratorNull () { return "UngapHitIteratorNull"; }
     static const char* m_STR_CONFIG_CLASS_UngapHitIterator () { return "UngapHitIterator"; }
     static const char* m_STR_CONFIG_CLASS_UngapHitIteratorSSE16 () { return "UngapHitIteratorSSE16"; }
+    static const char* m_STR_CONFIG_CLASS_UngapHitIteratorAVX2 () { return "UngapHitIteratorAVX2"; }
+    static const char* m_STR_CONFIG_CLASS_UngapHitIteratorAVX512 () { return "UngapHitIteratorAVX512"; }
     static const char* m_STR_CONFIG_CLASS_SmallGapHitIterator () { return "SmallGapHitIterator"; }
     static const char* m_STR_CONFIG_CLASS_SmallGapHitIteratorNull () { return "SmallGapHitIteratorNull"; }
     static const char* m_STR_CONFIG_CLASS_SmallGapHitIteratorSSE8 () { return "SmallGapHitIteratorSSE8"; }
+    static const char* m_STR_CONFIG_CLASS_SmallGapHitIteratorAVX2 () { return "SmallGapHitIteratorAVX2"; }
+    static const char* m_STR_CONFIG_CLASS_SmallGapHitIteratorAVX512 () { return "SmallGapHitIteratorAVX512"; }
+    static const char* m_STR_CONFIG_CLASS_SemiGapAlign () { return "SemiGapAlign"; }
+    static const char* m_STR_CONFIG_CLASS_SemiGapAlignAVX2 () { return "SemiGapAlignAVX2"; }
     static const char* m_STR_CONFIG_CLASS_FullGapHitIterator () { return "FullGapHitIterator"; }
     static const char* m_STR_CONFIG_CLASS_FullGapHitIteratorNull () { return "FullGapHitIteratorNull"; }
     static const char* m_STR_CONFIG_CLASS_CompositionHitIterator () { return "CompositionHitIterator"; }
     static const char* m_STR_CONFIG_CLASS_CompositionHitIteratorNull () { return "CompositionHitIteratorNull"; }
     static const char* m_STR_CONFIG_CLASS_BasicAlignmentResult () { return "BasicAlignmentResult"; }
+    static const char* m_STR_CONFIG_CLASS_FlatAlignmentResult () { return "FlatAlignmentResult"; }
     static const char* m_STR_CONFIG_CLASS_UngapAlignmentResult () { return "UngapAlignmentResult"; }
+    static const char* m_STR_CONFIG_CLASS_UngapAlignmentResultLockFree () { return "UngapAlignmentResultLockFree"; }
     static const char* m_STR_PARAM_params () { return "params"; }
     static const char* m_STR_PARAM_seedModelKind () { return "seedModelKind"; }
     static const char* m_STR_PARAM_seedSpan () { return "seedSpan"; }
@@ -52,6 +52,12 @@ public:
 
     /** Wait the end of the thread. */
     virtual void join () = 0;
+
+    /** Try to bind the thread to one of the cores available for the process.
+     * \param[in] core : index of the core (modulo the number of available cores)
+     * \return true if the binding succeeded, false if it is not supported or failed.
+     */
+    virtual bool setAffinity (size_t core) = 0;
 };
 
 /********************************************************************************/
@@ -77,6 +83,29 @@ public:
 
 /********************************************************************************/
 
+/** \brief Define a counting semaphore abstraction
+ *
+ *  A semaphore holds a counter; wait() blocks while the counter is null and decrements it
+ *  otherwise, post() increments it and wakes up one waiting thread. Contrary to ISynchronizer,
+ *  post() and wait() may be called from different threads, so it can be used for signaling
+ *  between threads (a thread pool waiting for jobs for instance).
+ */
+class ISemaphore : public IResource
+{
+public:
+
+    /** Destructor. */
+    virtual ~ISemaphore () {}
+
+    /** Increment the counter of the semaphore. */
+    virtual void post () = 0;
+
+    /** Wait until the counter of the semaphore is positive, then decrement it. */
+    virtual void wait () = 0;
+};
+
+/********************************************************************************/
+
 /** \brief Factory that creates IThread instances.
  *
  *  Thread creation needs merely the main loop function that will be called.
@@ -104,10 +133,19 @@ public:
      */
     virtual ISynchronizer* newSynchronizer (void) = 0;
 
+    /** Creates a new semaphore object.
+     * \param[in] initialCount : initial value of the semaphore counter
+     * \return the created ISemaphore instance
+     */
+    virtual ISemaphore* newSemaphore (size_t initialCount=0) = 0;
+
     /** Returns the number of available cores.
      * \return the number of cores. */
     virtual size_t getNbCores () = 0;
 
+    /** Gives up the processor for the calling thread, so other threads may run. */
+    virtual void yield () = 0;
+
     /** Returns the host name.
      * \return the host name. */
     virtual std::string getHostName () = 0;
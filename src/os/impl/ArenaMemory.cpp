@@ -0,0 +1,367 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+
+#include <os/impl/ArenaMemory.hpp>
+#include <os/impl/DefaultOsFactory.hpp>
+
+#include <stdio.h>
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace os {
+/** \brief Implementation of Operating System abstraction layer */
+namespace impl {
+/********************************************************************************/
+
+/** Arenas created by the 'local' method. They are kept until the end of the process, so
+ *  their statistics can be reported even after their thread is done; the arenas given back
+ *  by their thread (see 'releaseLocal') are reused by the next threads. */
+struct ArenaRegistry
+{
+    ArenaRegistry ()  : synchro (DefaultFactory::thread().newSynchronizer())  {}
+
+    ~ArenaRegistry ()
+    {
+        for (size_t i=0; i<arenas.size(); i++)  {  delete arenas[i];  }
+        delete synchro;
+    }
+
+    ISynchronizer*                      synchro;
+    std::vector<ArenaMemoryAllocator*>  arenas;
+    std::vector<ArenaMemoryAllocator*>  available;
+};
+
+static ArenaRegistry& registry ()  { static ArenaRegistry instance;  return instance; }
+
+/** Arena of the current thread. */
+static __thread ArenaMemoryAllocator* localArena = 0;
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ArenaMemoryAllocator::Stats& ArenaMemoryAllocator::Stats::operator+= (const Stats& s)
+{
+    nbAllocs += s.nbAllocs;
+    nbBytes  += s.nbBytes;
+    nbResets += s.nbResets;
+    peak     += s.peak;
+    capacity += s.capacity;
+    return *this;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ArenaMemoryAllocator::Stats ArenaMemoryAllocator::Stats::operator- (const Stats& s) const
+{
+    Stats result (*this);
+    result.nbAllocs -= s.nbAllocs;
+    result.nbBytes  -= s.nbBytes;
+    result.nbResets -= s.nbResets;
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ArenaMemoryAllocator::ArenaMemoryAllocator (size_t chunkSize)
+    : _chunkSize(chunkSize), _current(0), _cursor(0), _inUse(0), _nbLive(0), _generation(0)
+{
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ArenaMemoryAllocator::~ArenaMemoryAllocator ()
+{
+    for (size_t i=0; i<_chunks.size(); i++)  {  ::free (_chunks[i].data);  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void* ArenaMemoryAllocator::malloc (Size_t size)
+{
+    size_t needed = sizeof(Header) + roundup (size);
+
+    /** We look for a chunk having enough room for the buffer. */
+    while (_current < _chunks.size()  &&  _cursor + needed > _chunks[_current].size)
+    {
+        _current++;
+        _cursor = 0;
+    }
+
+    /** We may need a new chunk. */
+    if (_current == _chunks.size())
+    {
+        size_t chunkSize = needed > _chunkSize ? needed : _chunkSize;
+
+        char* data = (char*) ::malloc (chunkSize);
+        if (!data)  {  throw MemoryFailure ("no memory for arena");  }
+
+        _chunks.push_back (Chunk (data, chunkSize));
+        _stats.capacity += chunkSize;
+
+        DEBUG (("ArenaMemoryAllocator::malloc (%p): new chunk of %ld bytes (nbChunks=%ld)\n", this, chunkSize, _chunks.size()));
+    }
+
+    Header* header = (Header*) (_chunks[_current].data + _cursor);
+    header->size       = size;
+    header->generation = _generation;
+
+    _cursor += needed;
+    _inUse  += needed;
+    _nbLive ++;
+
+    _stats.nbAllocs ++;
+    _stats.nbBytes  += size;
+    if (_inUse > _stats.peak)  {  _stats.peak = _inUse;  }
+
+    return header + 1;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void* ArenaMemoryAllocator::calloc (Size_t nmemb, Size_t size)
+{
+    void* result = this->malloc (nmemb*size);
+    memset (result, 0, nmemb*size);
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void* ArenaMemoryAllocator::realloc (void *ptr, Size_t size)
+{
+    if (ptr == 0)  {  return this->malloc (size);  }
+
+    Header* header = (Header*)ptr - 1;
+
+    /** If the buffer is the last one of the arena, we may just move the cursor. */
+    if (_current < _chunks.size()  &&  header->generation == _generation)
+    {
+        Chunk& chunk  = _chunks[_current];
+        size_t offset = (char*)ptr - chunk.data;
+
+        if (chunk.data + _cursor == (char*)ptr + roundup (header->size)  &&  offset + roundup (size) <= chunk.size)
+        {
+            _inUse  = _inUse - roundup (header->size) + roundup (size);
+            _cursor = offset + roundup (size);
+
+            if (size > header->size)   {  _stats.nbBytes += size - header->size;  }
+            if (_inUse > _stats.peak)  {  _stats.peak = _inUse;  }
+
+            header->size = size;
+            return ptr;
+        }
+    }
+
+    /** Otherwise, we copy the buffer. */
+    void* result = this->malloc (size);
+    memcpy (result, ptr, header->size < size ? header->size : size);
+    this->free (ptr);
+
+    return result;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ArenaMemoryAllocator::free (void *ptr)
+{
+    if (ptr == 0)  { return; }
+
+    Header* header = (Header*)ptr - 1;
+
+    /** A buffer allocated before the last reset has already been released. */
+    if (header->generation != _generation)
+    {
+        DEBUG (("ArenaMemoryAllocator::free (%p): buffer %p allocated before the last reset\n", this, ptr));
+        return;
+    }
+
+    /** If the buffer is the last one of the arena, its memory can be reused right now. */
+    if (_current < _chunks.size()  &&  _chunks[_current].data + _cursor == (char*)ptr + roundup (header->size))
+    {
+        size_t size = sizeof(Header) + roundup (header->size);
+        _cursor -= size;
+        _inUse  -= size;
+    }
+
+    /** If there is no more buffer in the arena, all its memory can be reused. */
+    if (_nbLive > 0  &&  --_nbLive == 0)  {  rewind ();  }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+char* ArenaMemoryAllocator::strdup (const char* s)
+{
+    size_t len = strlen (s) + 1;
+    return (char*) memcpy (this->malloc (len), s, len);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ArenaMemoryAllocator::reset ()
+{
+    _nbLive = 0;
+    _generation ++;
+    rewind ();
+
+    _stats.nbResets ++;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ArenaMemoryAllocator::rewind ()
+{
+    _current = 0;
+    _cursor  = 0;
+    _inUse   = 0;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ArenaMemoryAllocator& ArenaMemoryAllocator::local ()
+{
+    if (localArena == 0)
+    {
+        LocalSynchronizer sync (registry().synchro);
+
+        if (registry().available.empty() == false)
+        {
+            localArena = registry().available.back();
+            registry().available.pop_back();
+        }
+        else
+        {
+            localArena = new ArenaMemoryAllocator ();
+            registry().arenas.push_back (localArena);
+        }
+    }
+
+    return *localArena;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void ArenaMemoryAllocator::releaseLocal ()
+{
+    if (localArena != 0  &&  localArena->_nbLive == 0)
+    {
+        localArena->rewind ();
+
+        LocalSynchronizer sync (registry().synchro);
+        registry().available.push_back (localArena);
+
+        localArena = 0;
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ArenaMemoryAllocator::Stats ArenaMemoryAllocator::getGlobalStats ()
+{
+    Stats result;
+
+    LocalSynchronizer sync (registry().synchro);
+    for (size_t i=0; i<registry().arenas.size(); i++)  {  result += registry().arenas[i]->getStats();  }
+
+    return result;
+}
+
+/********************************************************************************/
+} } /* end of namespaces. */
+/********************************************************************************/
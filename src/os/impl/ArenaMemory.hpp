@@ -0,0 +1,196 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+
+/** \file ArenaMemory.hpp
+ *  \brief Per thread arena allocator for short lived buffers.
+ */
+
+#ifndef ARENA_MEMORY_HPP_
+#define ARENA_MEMORY_HPP_
+
+/********************************************************************************/
+
+#include <os/impl/CommonOsImpl.hpp>
+
+#include <vector>
+
+/********************************************************************************/
+namespace os {
+/** \brief Implementation of Operating System abstraction layer */
+namespace impl {
+/********************************************************************************/
+
+/** \brief Bump allocator whose memory is released all at once.
+ *
+ *  The memory is taken by increasing a cursor in big chunks that are allocated once and
+ *  then reused; there is no bookkeeping per buffer apart from a small header holding its
+ *  size (needed for realloc). The 'free' method releases the memory only if the buffer
+ *  is the last one of the arena (so buffers freed in the reverse order of their allocation
+ *  are actually released); the memory of the other buffers is released by 'reset', or when
+ *  all the buffers of the arena have been freed. Note that the buffers allocated before a
+ *  'reset' must not be freed after it; such a 'free' is ignored (the buffers are stamped with
+ *  the number of resets), so it doesn't release the memory of the buffers allocated since.
+ *
+ *  This allocator is intended for the buffers created for a block of the iteration and
+ *  that don't survive it (the seeds occurrences tables for instance). Since the instances
+ *  are not protected against concurrent accesses, each thread has to use its own instance
+ *  (see the 'local' method). A thread done with its arena gives it back through 'releaseLocal',
+ *  so the arena can be reused by another thread instead of being kept until the end.
+ *
+ *  Code sample:
+ *  \code
+ *  void sample ()
+ *  {
+ *      ArenaMemoryAllocator& arena = ArenaMemoryAllocator::local();
+ *
+ *      char* buffer = (char*) arena.malloc (1024);
+ *
+ *      // do something with the buffer...
+ *
+ *      // release all the buffers of the block at once.
+ *      arena.reset ();
+ *  }
+ *  \endcode
+ */
+class ArenaMemoryAllocator : public CommonMemory
+{
+public:
+
+    /** Statistics about the use of an arena. */
+    struct Stats
+    {
+        Stats () : nbAllocs(0), nbBytes(0), nbResets(0), peak(0), capacity(0)  {}
+
+        /** Number of allocations. */
+        u_int64_t nbAllocs;
+
+        /** Number of allocated bytes. */
+        u_int64_t nbBytes;
+
+        /** Number of calls to 'reset'. */
+        u_int64_t nbResets;
+
+        /** Maximum number of bytes used at the same time. */
+        u_int64_t peak;
+
+        /** Number of bytes of the chunks. */
+        u_int64_t capacity;
+
+        /** Accumulate some statistics. */
+        Stats& operator+= (const Stats& s);
+
+        /** Difference of two statistics (the peak and capacity of the left one are kept). */
+        Stats operator- (const Stats& s) const;
+    };
+
+    /** Constructor.
+     * \param[in] chunkSize : default size of the chunks of the arena.
+     */
+    ArenaMemoryAllocator (size_t chunkSize = 1<<20);
+
+    /** Destructor. */
+    virtual ~ArenaMemoryAllocator ();
+
+    /** \copydoc IMemoryAllocator::malloc */
+    void* malloc  (Size_t size);
+
+    /** \copydoc IMemoryAllocator::calloc */
+    void* calloc  (Size_t nmemb, Size_t size);
+
+    /** \copydoc IMemoryAllocator::realloc */
+    void* realloc (void *ptr, Size_t size);
+
+    /** \copydoc IMemoryAllocator::free */
+    void  free (void *ptr);
+
+    /** \copydoc IMemoryAllocator::strdup */
+    char* strdup (const char* s);
+
+    /** Release all the buffers of the arena; the chunks are kept for the next allocations.
+     * All the buffers allocated so far must not be used (nor freed) anymore. */
+    void reset ();
+
+    /** Statistics of the arena.
+     * \return the statistics. */
+    const Stats& getStats () const  { return _stats; }
+
+    /** Returns the arena of the current thread. At first call (or after 'releaseLocal'), the thread
+     * takes an arena released by another thread, or a new one.
+     * \return the arena. */
+    static ArenaMemoryAllocator& local ();
+
+    /** Gives back the arena of the current thread, so it can be used by another thread. Nothing is done
+     * if the arena still has some buffers; otherwise, it is reset and must not be used anymore by the
+     * current thread (except through a new call to 'local'). */
+    static void releaseLocal ();
+
+    /** Returns the sum of the statistics of the arenas of all the threads.
+     * \return the statistics. */
+    static Stats getGlobalStats ();
+
+private:
+
+    /** A chunk of memory where the buffers are taken. */
+    struct Chunk
+    {
+        Chunk (char* data, size_t size) : data(data), size(size)  {}
+        char*  data;
+        size_t size;
+    };
+
+    /** Header put before each buffer. The size makes the buffers aligned on 16 bytes. */
+    struct Header
+    {
+        Size_t    size;
+        u_int32_t generation;
+        char      padding[16 - sizeof(Size_t) - sizeof(u_int32_t)];
+    };
+
+    /** Round up a size to a multiple of the header size. */
+    static size_t roundup (size_t size)  { return (size + sizeof(Header) - 1) & ~(sizeof(Header) - 1); }
+
+    /** Default size of the chunks. */
+    size_t _chunkSize;
+
+    /** Chunks of the arena. */
+    std::vector<Chunk> _chunks;
+
+    /** Current chunk and position in this chunk. */
+    size_t _current;
+    size_t _cursor;
+
+    /** Number of bytes (headers included) currently used in the chunks. */
+    size_t _inUse;
+
+    /** Number of buffers not freed yet. */
+    size_t _nbLive;
+
+    /** Number of resets, stamped in the header of the buffers. */
+    u_int32_t _generation;
+
+    /** Statistics. */
+    Stats _stats;
+
+    /** Move the cursor at the beginning of the arena. */
+    void rewind ();
+};
+
+/********************************************************************************/
+} } /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* ARENA_MEMORY_HPP_ */
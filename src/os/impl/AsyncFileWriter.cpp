@@ -0,0 +1,512 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+#include <os/impl/AsyncFileWriter.hpp>
+#include <os/impl/DefaultOsFactory.hpp>
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __WINDOWS__
+    #include <io.h>
+#else
+    #include <unistd.h>
+    #include <sys/uio.h>
+#endif
+
+/** va_copy is C99; older compilers only provide the GNU version. */
+#ifndef va_copy
+    #define va_copy(dst,src)  __va_copy(dst,src)
+#endif
+
+#define DEBUG(a)  //printf a
+
+/********************************************************************************/
+namespace os {
+/** \brief Implementation of Operating System abstraction layer */
+namespace impl {
+/********************************************************************************/
+
+/** Powers of ten used by the fast formatting path. */
+static const double POWERS_OF_TEN[] = { 1.0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6 };
+
+static const size_t MAX_FAST_PRECISION = sizeof(POWERS_OF_TEN)/sizeof(POWERS_OF_TEN[0]) - 1;
+
+/** Limit of the scaled values handled by the fast path: below it, the error of the scaling
+ *  is far smaller than the tie window, so the rounding is the one of printf. */
+static const double MAX_FAST_SCALED = 1e9;
+static const double TIE_WINDOW      = 1e-6;
+
+/** Rounds a positive scaled value to the nearest integer, or returns false if the value is
+ *  too close to a tie to know how printf would round it (exact decimal expansion, ties to even). */
+static bool roundScaled (double scaled, u_int64_t& result)
+{
+    double floorValue = floor (scaled);
+    double frac       = scaled - floorValue;
+
+    if (fabs (frac - 0.5) < TIE_WINDOW)  { return false; }
+
+    result = (u_int64_t)floorValue + (frac > 0.5 ? 1 : 0);
+    return true;
+}
+
+/** Writes the digits of a number backwards from 'end'; returns the new beginning. */
+static char* digitsBackward (char* end, u_int64_t n, size_t minDigits)
+{
+    size_t nb = 0;
+    do  {  *(--end) = '0' + (n % 10);  n /= 10;  nb++;  }  while (n != 0 || nb < minDigits);
+    return end;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+AsyncFileWriter::AsyncFileWriter (const char* path, size_t bufferSize, size_t nbBuffers)
+    : _fd(-1), _bufferSize(bufferSize), _current(0), _currentIdx(0), _size(0), _position(0),
+      _nbSubmitted(0), _nbWritten(0), _finished(false), _writeError(false),
+      _synchro(0), _freeSem(0), _fullSem(0), _thread(0)
+{
+    if (nbBuffers < 2)  { nbBuffers = 2; }
+
+#ifdef __WINDOWS__
+    _fd = _open (path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0666);
+#else
+    _fd =  open (path,  O_WRONLY |  O_CREAT |  O_TRUNC, 0666);
+#endif
+
+    /** Nothing has been allocated yet, so we can throw from here. */
+    if (_fd < 0)  { throw "unable to create the output file"; }
+
+    for (size_t i=0; i<nbBuffers; i++)
+    {
+        _buffers.push_back ((char*) DefaultFactory::memory().malloc (_bufferSize));
+        _sizes.push_back (0);
+    }
+    _current = _buffers[_currentIdx];
+
+    /** All the buffers but the current one can be filled. */
+    _synchro = DefaultFactory::thread().newSynchronizer ();
+    _freeSem = DefaultFactory::thread().newSemaphore (nbBuffers-1);
+    _fullSem = DefaultFactory::thread().newSemaphore (0);
+
+    _thread = DefaultFactory::thread().newThread (mainloop, this);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+AsyncFileWriter::~AsyncFileWriter ()
+{
+    /** No exception from the destructor: write errors are only reported by flush. */
+    waitWritten ();
+
+    /** We stop the I/O thread. */
+    _synchro->lock ();
+    _finished = true;
+    _synchro->unlock ();
+    _fullSem->post ();
+
+    _thread->join ();
+    delete _thread;
+
+    delete _fullSem;
+    delete _freeSem;
+    delete _synchro;
+
+    for (size_t i=0; i<_buffers.size(); i++)  {  DefaultFactory::memory().free (_buffers[i]);  }
+
+#ifdef __WINDOWS__
+    if (_fd >= 0)  { _close (_fd); }
+#else
+    if (_fd >= 0)  {  close (_fd); }
+#endif
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AsyncFileWriter::write (const char* data, size_t size)
+{
+    while (size > 0)
+    {
+        if (_size == _bufferSize)  { submit (); }
+
+        size_t nb = _bufferSize - _size;
+        if (nb > size)  { nb = size; }
+
+        memcpy (_current + _size, data, nb);
+        _size += nb;
+        data  += nb;
+        size  -= nb;
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AsyncFileWriter::writeInteger (int value)
+{
+    char  tmp[16];
+    char* end = tmp + sizeof(tmp);
+
+    /** We work on the absolute value as unsigned for INT_MIN. */
+    u_int64_t n = value < 0 ? (u_int64_t) (-(int64_t)value) : (u_int64_t) value;
+
+    char* begin = digitsBackward (end, n, 1);
+    if (value < 0)  { *(--begin) = '-'; }
+
+    write (begin, end - begin);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : negative values, zeros and non finite values are given
+**           to snprintf (signed zeros, nan, inf...)
+*********************************************************************/
+void AsyncFileWriter::writeFixed (double value, size_t precision, size_t width)
+{
+    u_int64_t n = 0;
+
+    if (precision <= MAX_FAST_PRECISION &&  value > 0  &&  value * POWERS_OF_TEN[precision] < MAX_FAST_SCALED
+        &&  roundScaled (value * POWERS_OF_TEN[precision], n))
+    {
+        char  tmp[32];
+        char* end   = tmp + sizeof(tmp);
+        char* begin = end;
+
+        if (precision > 0)
+        {
+            u_int64_t p = (u_int64_t) POWERS_OF_TEN[precision];
+            begin = digitsBackward (begin, n % p, precision);
+            *(--begin) = '.';
+            n /= p;
+        }
+        begin = digitsBackward (begin, n, 1);
+
+        for (size_t len = end-begin; len < width; len++)  { write (' '); }
+        write (begin, end - begin);
+    }
+    else
+    {
+        print ("%*.*lf", (int)width, (int)precision, value);
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : values near the limits of the double type and ties are
+**           given to snprintf.
+*********************************************************************/
+void AsyncFileWriter::writeExponent (double value, size_t precision, size_t width)
+{
+    u_int64_t n = 0;
+
+    if (precision <= MAX_FAST_PRECISION  &&  value > 1e-290  &&  value < 1e290)
+    {
+        /** We compute the mantissa in [1,10[ and the exponent. */
+        int    exponent = (int) floor (log10 (value));
+        double mantissa = value / pow (10.0, exponent);
+
+        if (mantissa <  1.0)  { mantissa *= 10.0;  exponent--; }
+        if (mantissa >= 10.0) { mantissa /= 10.0;  exponent++; }
+
+        if (roundScaled (mantissa * POWERS_OF_TEN[precision], n))
+        {
+            u_int64_t p = (u_int64_t) POWERS_OF_TEN[precision];
+
+            /** The rounding may give 10.0 (for 9.96 with one digit for instance). */
+            if (n >= 10*p)  { n /= 10;  exponent++; }
+
+            char  tmp[32];
+            char* end   = tmp + sizeof(tmp);
+            char* begin = digitsBackward (end, exponent < 0 ? -exponent : exponent, 2);
+
+            *(--begin) = exponent < 0 ? '-' : '+';
+            *(--begin) = 'e';
+
+            if (precision > 0)
+            {
+                begin = digitsBackward (begin, n % p, precision);
+                *(--begin) = '.';
+            }
+            begin = digitsBackward (begin, n / p, 1);
+
+            for (size_t len = end-begin; len < width; len++)  { write (' '); }
+            write (begin, end - begin);
+            return;
+        }
+    }
+
+    print ("%*.*le", (int)width, (int)precision, value);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AsyncFileWriter::print (const char* format, ...)
+{
+    va_list args;
+    va_start (args, format);
+    vprint (format, args);
+    va_end (args);
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AsyncFileWriter::vprint (const char* format, va_list args)
+{
+    /** We try to format directly into the current buffer. */
+    va_list copy;
+    va_copy (copy, args);
+    int len = vsnprintf (_current + _size, _bufferSize - _size, format, copy);
+    va_end (copy);
+
+    if (len < 0)  { return; }
+
+    if ((size_t)len < _bufferSize - _size)
+    {
+        _size += len;
+    }
+    else
+    {
+        /** Not enough room: we format in a temporary buffer. */
+        char* tmp = (char*) DefaultFactory::memory().malloc (len+1);
+        vsnprintf (tmp, len+1, format, args);
+        write (tmp, len);
+        DefaultFactory::memory().free (tmp);
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AsyncFileWriter::flush ()
+{
+    waitWritten ();
+
+    _synchro->lock ();
+    bool error = _writeError;
+    _synchro->unlock ();
+
+    if (error)  { throw "error during the writing of the output file"; }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AsyncFileWriter::waitWritten ()
+{
+    if (_size > 0)  { submit (); }
+
+    /** The submitted buffers are all written once we can get all the free buffers. */
+    for (size_t i=0; i<_buffers.size()-1; i++)  { _freeSem->wait (); }
+    for (size_t i=0; i<_buffers.size()-1; i++)  { _freeSem->post (); }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : the buffers are written in the order of the ring, so the
+**           next buffer is the first one to be released.
+*********************************************************************/
+void AsyncFileWriter::submit ()
+{
+    DEBUG (("AsyncFileWriter::submit  idx=%ld  size=%ld\n", _currentIdx, _size));
+
+    _sizes[_currentIdx] = _size;
+    _position += _size;
+
+    _synchro->lock ();
+    _nbSubmitted++;
+    _synchro->unlock ();
+    _fullSem->post ();
+
+    /** We wait for the next buffer. */
+    _freeSem->wait ();
+
+    _currentIdx = (_currentIdx + 1) % _buffers.size();
+    _current    = _buffers[_currentIdx];
+    _size       = 0;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void* AsyncFileWriter::mainloop (void* data)
+{
+    ((AsyncFileWriter*) data)->run ();
+    return 0;
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void AsyncFileWriter::run ()
+{
+    while (true)
+    {
+        _fullSem->wait ();
+
+        /** We write all the buffers submitted so far at once. */
+        _synchro->lock ();
+        size_t first = _nbWritten;
+        size_t count = _nbSubmitted - _nbWritten;
+        bool   done  = _finished;
+        _synchro->unlock ();
+
+        if (count == 0)
+        {
+            if (done)  { break; }
+            continue;
+        }
+
+        bool ok = writeBuffers (first % _buffers.size(), count);
+
+        /** We consume the signals of the other written buffers. */
+        for (size_t i=1; i<count; i++)  { _fullSem->wait (); }
+
+        _synchro->lock ();
+        _nbWritten += count;
+        if (!ok)  { _writeError = true; }
+        _synchro->unlock ();
+
+        for (size_t i=0; i<count; i++)  { _freeSem->post (); }
+    }
+}
+
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+bool AsyncFileWriter::writeBuffers (size_t idx, size_t count)
+{
+#ifdef __WINDOWS__
+    for (size_t i=0; i<count; i++)
+    {
+        size_t k = (idx + i) % _buffers.size();
+        for (size_t done=0; done < _sizes[k]; )
+        {
+            int nb = _write (_fd, _buffers[k] + done, _sizes[k] - done);
+            if (nb <= 0)  { return false; }
+            done += nb;
+        }
+    }
+#else
+    std::vector<struct iovec> iov (count);
+    for (size_t i=0; i<count; i++)
+    {
+        size_t k = (idx + i) % _buffers.size();
+        iov[i].iov_base = _buffers[k];
+        iov[i].iov_len  = _sizes[k];
+    }
+
+    /** We loop in case of partial writes. */
+    struct iovec* current = &iov[0];
+    int           nbIov   = count;
+
+    while (nbIov > 0)
+    {
+        ssize_t nb = writev (_fd, current, nbIov);
+        if (nb < 0)  { DEBUG (("AsyncFileWriter::writeBuffers  error\n"));  return false; }
+
+        while (nbIov > 0 && (size_t)nb >= current->iov_len)
+        {
+            nb -= current->iov_len;
+            current++;
+            nbIov--;
+        }
+        if (nbIov > 0)
+        {
+            current->iov_base  = (char*)current->iov_base + nb;
+            current->iov_len  -= nb;
+        }
+    }
+#endif
+
+    return true;
+}
+
+/********************************************************************************/
+}} /* end of namespaces. */
+/********************************************************************************/
@@ -0,0 +1,190 @@
+/*****************************************************************************
+ *                                                                           *
+ *   PLAST : Parallel Local Alignment Search Tool                            *
+ *   Version 2.3, released November 2015                                     *
+ *   Copyright (c) 2009-2015 Inria-Cnrs-Ens                                  *
+ *                                                                           *
+ *   PLAST is free software; you can redistribute it and/or modify it under  *
+ *   the Affero GPL ver 3 License, that is compatible with the GNU General   *
+ *   Public License                                                          *
+ *                                                                           *
+ *   This program is distributed in the hope that it will be useful,         *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of          *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the            *
+ *   Affero GPL ver 3 License for more details.                              *
+ *****************************************************************************/
+
+/** \file AsyncFileWriter.hpp
+ *  \brief Buffered file writer whose actual writes are done in a background thread.
+ */
+
+#ifndef ASYNC_FILE_WRITER_HPP_
+#define ASYNC_FILE_WRITER_HPP_
+
+/********************************************************************************/
+
+#include <os/api/IThread.hpp>
+#include <misc/api/types.hpp>
+#include <designpattern/api/SmartPointer.hpp>
+
+#include <stdarg.h>
+#include <string.h>
+#include <vector>
+
+/********************************************************************************/
+namespace os {
+/** \brief Implementation of Operating System abstraction layer */
+namespace impl {
+/********************************************************************************/
+
+/** \brief Text file writer formatting into big buffers written by a background thread.
+ *
+ *  The data are formatted into the current buffer; when it is full, it is handed to an
+ *  I/O thread and the formatting goes on in the next buffer of a small ring. The I/O thread
+ *  writes all the buffers it has received with a single 'writev' call, so the formatting
+ *  thread never waits for the disk unless all the buffers are pending.
+ *
+ *  Numbers can be formatted without the printf machinery (see writeInteger, writeFixed and
+ *  writeExponent); the output is the same as the equivalent printf formats, the cases that
+ *  can't be formatted exactly by the fast path (ties, huge values...) being given to snprintf.
+ *
+ *  Only one thread may write into an instance (typically the one visiting the alignments).
+ *
+ *  Code sample:
+ *  \code
+ *  void sample ()
+ *  {
+ *      AsyncFileWriter writer ("/tmp/out.txt");
+ *
+ *      writer.write ("score=");
+ *      writer.writeFixed (42.25, 1);   // same as printf ("%.1f")
+ *      writer.write ('\n');
+ *
+ *      // wait until all the data are in the file.
+ *      writer.flush ();
+ *  }
+ *  \endcode
+ */
+class AsyncFileWriter : public dp::SmartPointer
+{
+public:
+
+    /** Constructor. Throws an exception if the file can't be created.
+     * \param[in] path : path of the file to be created (or truncated).
+     * \param[in] bufferSize : size of each buffer.
+     * \param[in] nbBuffers : number of buffers (at least 2).
+     */
+    AsyncFileWriter (const char* path, size_t bufferSize = 1<<20, size_t nbBuffers = 4);
+
+    /** Destructor. Writes the remaining data and closes the file. */
+    virtual ~AsyncFileWriter ();
+
+    /** Tells whether the file could be opened.
+     * \return true if the file is opened. */
+    bool isOpen ()  { return _fd >= 0; }
+
+    /** Writes a character. */
+    void write (char c)
+    {
+        if (_size == _bufferSize)  { submit (); }
+        _current[_size++] = c;
+    }
+
+    /** Writes a 0 terminated string. */
+    void write (const char* str)  { write (str, strlen (str)); }
+
+    /** Writes a buffer.
+     * \param[in] data : the bytes to be written.
+     * \param[in] size : number of bytes.
+     */
+    void write (const char* data, size_t size);
+
+    /** Writes an integer (like printf "%d"). */
+    void writeInteger (int value);
+
+    /** Writes a floating point value (like printf "%*.*f").
+     * \param[in] value : the value to be written
+     * \param[in] precision : number of digits after the decimal point
+     * \param[in] width : minimum width of the field, padded with leading spaces.
+     */
+    void writeFixed (double value, size_t precision, size_t width=0);
+
+    /** Writes a floating point value in exponent notation (like printf "%*.*e").
+     * \param[in] value : the value to be written
+     * \param[in] precision : number of digits after the decimal point of the mantissa
+     * \param[in] width : minimum width of the field, padded with leading spaces.
+     */
+    void writeExponent (double value, size_t precision, size_t width=0);
+
+    /** Writes formatted data (like printf).
+     * \param[in] format : printf format
+     * \param[in] ...  : the arguments
+     */
+    void print (const char* format, ...);
+
+    /** Writes formatted data (like vprintf).
+     * \param[in] format : printf format
+     * \param[in] args : the arguments
+     */
+    void vprint (const char* format, va_list args);
+
+    /** Hands the current buffer to the I/O thread and waits until all the data are written.
+     * Throws an exception if some data could not be written. */
+    void flush ();
+
+    /** Position in the file, including the data not written yet.
+     * \return the number of bytes written since the creation of the file. */
+    u_int64_t tell ()  { return _position + _size; }
+
+private:
+
+    /** File descriptor. */
+    int _fd;
+
+    /** Ring of buffers; the I/O thread writes them in the same order they are filled. */
+    std::vector<char*> _buffers;
+    std::vector<size_t> _sizes;
+    size_t _bufferSize;
+
+    /** Buffer being filled, its index and its number of bytes. */
+    char*  _current;
+    size_t _currentIdx;
+    size_t _size;
+
+    /** Number of bytes of the submitted buffers. */
+    u_int64_t _position;
+
+    /** Number of submitted and written buffers (protected by _synchro). */
+    size_t _nbSubmitted;
+    size_t _nbWritten;
+    bool   _finished;
+    bool   _writeError;
+
+    ISynchronizer* _synchro;
+
+    /** Counts the buffers that can be filled and the buffers that can be written. */
+    ISemaphore* _freeSem;
+    ISemaphore* _fullSem;
+
+    IThread* _thread;
+
+    /** Hands the current buffer to the I/O thread and takes the next one. */
+    void submit ();
+
+    /** Loop of the I/O thread. */
+    static void* mainloop (void* data);
+    void run ();
+
+    /** Waits until all the data given so far are written. */
+    void waitWritten ();
+
+    /** Writes 'count' buffers from the given index of the ring.
+     * \return false if the data could not be written. */
+    bool writeBuffers (size_t idx, size_t count);
+};
+
+/********************************************************************************/
+}} /* end of namespaces. */
+/********************************************************************************/
+
+#endif /* ASYNC_FILE_WRITER_HPP_ */
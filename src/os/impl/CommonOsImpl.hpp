@@ -270,9 +270,18 @@ public:
         return new SerialSynchronizer ();
     }
 
+    /** \copydoc IThreadFactory::newSemaphore */
+    ISemaphore* newSemaphore (size_t initialCount=0)
+    {
+        return new SerialSemaphore ();
+    }
+
     /** \copydoc IThreadFactory::getNbCores */
     size_t getNbCores ()  { return 1; }
 
+    /** \copydoc IThreadFactory::yield */
+    void yield ()  {}
+
     /** \copydoc IThreadFactory::getHostName */
     std::string getHostName ()  { return "127.0.0.1"; }
 
@@ -282,6 +291,7 @@ private:
     {
     public:
         void join () { /* do nothing */ }
+        bool setAffinity (size_t core)  { return false; }
     };
 
     class SerialSynchronizer : public ISynchronizer
@@ -290,6 +300,13 @@ private:
         void   lock () { /* do nothing */ }
         void unlock () { /* do nothing */ }
     };
+
+    class SerialSemaphore : public ISemaphore
+    {
+    public:
+        void post () { /* do nothing */ }
+        void wait () { /* do nothing */ }
+    };
 };
 
 /********************************************************************************/
@@ -22,6 +22,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
 
 #include <unistd.h>
 
@@ -45,6 +47,31 @@ public:
     LinuxThread (void* (mainloop) (void*), void* data)  { pthread_create (&_thread, NULL,  mainloop, data); }
     ~LinuxThread ()  { /* pthread_detach (_thread); */  }
     void join ()     { pthread_join   (_thread, NULL);  }
+
+    bool setAffinity (size_t core)
+    {
+        /** We look for the 'core'th cpu among the ones the process is allowed to run on. */
+        cpu_set_t allowed;
+        CPU_ZERO (&allowed);
+        if (sched_getaffinity (0, sizeof(allowed), &allowed) != 0)  { return false; }
+
+        int nbAllowed = CPU_COUNT (&allowed);
+        if (nbAllowed <= 0)  { return false; }
+
+        int rank = core % nbAllowed;
+        for (int cpu=0; cpu<CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET (cpu, &allowed) && rank-- == 0)
+            {
+                cpu_set_t set;
+                CPU_ZERO (&set);
+                CPU_SET  (cpu, &set);
+                return pthread_setaffinity_np (_thread, sizeof(set), &set) == 0;
+            }
+        }
+        return false;
+    }
+
 private:
     pthread_t  _thread;
 };
@@ -70,6 +97,27 @@ private:
     pthread_mutex_t  _mutex;
 };
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+class LinuxSemaphore : public ISemaphore
+{
+public:
+    LinuxSemaphore (size_t initialCount)  {  sem_init (&_sem, 0, initialCount);  }
+    virtual ~LinuxSemaphore()             {  sem_destroy (&_sem);                }
+
+    void post ()  { sem_post (&_sem); }
+    void wait ()  { while (sem_wait (&_sem) != 0) {} }
+
+private:
+    sem_t  _sem;
+};
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -96,6 +144,19 @@ ISynchronizer* LinuxThreadFactory::newSynchronizer (void)
     return new LinuxSynchronizer ();
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ISemaphore* LinuxThreadFactory::newSemaphore (size_t initialCount)
+{
+    return new LinuxSemaphore (initialCount);
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -127,6 +188,19 @@ size_t LinuxThreadFactory::getNbCores ()
     return result;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void LinuxThreadFactory::yield ()
+{
+    sched_yield ();
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
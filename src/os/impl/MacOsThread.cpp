@@ -22,6 +22,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <pthread.h>
+#include <sched.h>
 #include <sys/types.h>
 #include <sys/sysctl.h>
 
@@ -49,6 +50,10 @@ public:
     MacOsThread (void* (mainloop) (void*), void* data)  { pthread_create (&_thread, NULL,  mainloop, data); }
     ~MacOsThread ()  { pthread_detach (_thread);        }
     void join ()     { pthread_join   (_thread, NULL);  }
+
+    /** Note: MacOs doesn't provide a way to bind a thread to a specific core. */
+    bool setAffinity (size_t core)  { return false; }
+
 private:
     pthread_t  _thread;
 };
@@ -74,6 +79,52 @@ private:
     pthread_mutex_t  _mutex;
 };
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS : unnamed POSIX semaphores are not supported on MacOs, so
+**           we rely on a mutex and a condition variable.
+*********************************************************************/
+class MacOsSemaphore : public ISemaphore
+{
+public:
+    MacOsSemaphore (size_t initialCount) : _count(initialCount)
+    {
+        pthread_mutex_init (&_mutex, NULL);
+        pthread_cond_init  (&_cond,  NULL);
+    }
+
+    virtual ~MacOsSemaphore()
+    {
+        pthread_cond_destroy  (&_cond);
+        pthread_mutex_destroy (&_mutex);
+    }
+
+    void post ()
+    {
+        pthread_mutex_lock   (&_mutex);
+        _count++;
+        pthread_cond_signal  (&_cond);
+        pthread_mutex_unlock (&_mutex);
+    }
+
+    void wait ()
+    {
+        pthread_mutex_lock   (&_mutex);
+        while (_count == 0)  {  pthread_cond_wait (&_cond, &_mutex);  }
+        _count--;
+        pthread_mutex_unlock (&_mutex);
+    }
+
+private:
+    pthread_mutex_t  _mutex;
+    pthread_cond_t   _cond;
+    size_t           _count;
+};
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -100,6 +151,19 @@ ISynchronizer* MacOsThreadFactory::newSynchronizer (void)
     return new MacOsSynchronizer ();
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ISemaphore* MacOsThreadFactory::newSemaphore (size_t initialCount)
+{
+    return new MacOsSemaphore (initialCount);
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -133,6 +197,19 @@ size_t MacOsThreadFactory::getNbCores ()
     return numCPU;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void MacOsThreadFactory::yield ()
+{
+    sched_yield ();
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -50,9 +50,15 @@ public:
     /** \copydoc IThreadFactory::newSynchronizer */
     ISynchronizer* newSynchronizer (void);
 
+    /** \copydoc IThreadFactory::newSemaphore */
+    ISemaphore* newSemaphore (size_t initialCount=0);
+
     /** \copydoc IThreadFactory::getNbCores */
     size_t getNbCores ();
 
+    /** \copydoc IThreadFactory::yield */
+    void yield ();
+
     /** \copydoc IThreadFactory::getHostName */
     std::string getHostName ();
 };
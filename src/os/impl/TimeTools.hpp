@@ -98,6 +98,18 @@ public:
         _entries [name] += _time.gettime() - _entriesT0 [name];
     }
 
+    /** Adds the durations of another instance to the durations of this instance.
+     * \param[in] other : the time information to be added.
+     */
+    void merge (TimeInfo& other)
+    {
+        std::map <std::string, u_int32_t>::const_iterator  it;
+        for (it = other.getEntries().begin(); it != other.getEntries().end();  it++)
+        {
+            _entries [it->first] += it->second;
+        }
+    }
+
     /** Provides (as a map) all got durations for each known label/
      * \return a map holding all retrieved timing information.
      */
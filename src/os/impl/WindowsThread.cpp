@@ -65,6 +65,27 @@ public:
         CloseHandle (_thread);
     }
 
+    bool setAffinity (size_t core)
+    {
+        DWORD_PTR processMask = 0;
+        DWORD_PTR systemMask  = 0;
+        if (!GetProcessAffinityMask (GetCurrentProcess(), &processMask, &systemMask) || processMask==0)  { return false; }
+
+        /** We look for the 'core'th cpu among the ones the process is allowed to run on. */
+        size_t nbAllowed = 0;
+        for (size_t i=0; i<8*sizeof(DWORD_PTR); i++)  {  if (processMask & ((DWORD_PTR)1 << i))  { nbAllowed++; }  }
+
+        size_t rank = core % nbAllowed;
+        for (size_t i=0; i<8*sizeof(DWORD_PTR); i++)
+        {
+            if ((processMask & ((DWORD_PTR)1 << i)) && rank-- == 0)
+            {
+                return SetThreadAffinityMask (_thread, (DWORD_PTR)1 << i) != 0;
+            }
+        }
+        return false;
+    }
+
 private:
     HANDLE  _thread;
 };
@@ -104,6 +125,41 @@ private:
     HANDLE  _mutex;
 };
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+class WindowsSemaphore : public ISemaphore
+{
+public:
+    WindowsSemaphore (size_t initialCount)
+    {
+        _sem = CreateSemaphore (NULL, (LONG)initialCount, 0x7FFFFFFF, NULL);
+    }
+
+    virtual ~WindowsSemaphore()
+    {
+        CloseHandle (_sem);
+    }
+
+    void post ()
+    {
+        ReleaseSemaphore (_sem, 1, NULL);
+    }
+
+    void wait ()
+    {
+        WaitForSingleObject (_sem, INFINITE);
+    }
+
+private:
+    HANDLE  _sem;
+};
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -130,6 +186,19 @@ ISynchronizer* WindowsThreadFactory::newSynchronizer (void)
     return new WindowsSynchronizer ();
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+ISemaphore* WindowsThreadFactory::newSemaphore (size_t initialCount)
+{
+    return new WindowsSemaphore (initialCount);
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -151,6 +220,19 @@ size_t WindowsThreadFactory::getNbCores ()
     return result;
 }
 
+/*********************************************************************
+** METHOD  :
+** PURPOSE :
+** INPUT   :
+** OUTPUT  :
+** RETURN  :
+** REMARKS :
+*********************************************************************/
+void WindowsThreadFactory::yield ()
+{
+    SwitchToThread ();
+}
+
 /*********************************************************************
 ** METHOD  :
 ** PURPOSE :
@@ -83,6 +83,9 @@ struct Sequence
     /* union, for integer scores? */
     struct PerScoreVec *foo;
     int *bar;
+
+    struct WindowContext *context; /* for windows */
+    struct Sequence *nextfree;     /* for the windows pool */
 };
 
 /********************************************************************************/
@@ -168,8 +171,25 @@ struct PerScoreVec
 
 /********************************************************************************/
 
-void             genwininit (void);
-struct Sequence* openwin    (struct Sequence* parent,  int start, int length);
+/* Everything needed for computing windows: the residues tables, the entropies of
+ * the window size and the closed windows, kept with their buffers for being reused.
+ * Each thread must use its own context, so the functions below are reentrant. */
+struct WindowContext
+{
+    int              aaindex[128];
+    unsigned char    aaflag[128];
+
+    int              window;
+    double           entray[256];
+
+    struct Sequence* pool;
+};
+
+/********************************************************************************/
+
+void             genwininit (struct WindowContext* context, int window);
+void             genwinexit (struct WindowContext* context);
+struct Sequence* openwin    (struct WindowContext* context, struct Sequence* parent,  int start, int length);
 struct Sequence* nextwin    (struct Sequence* win,     int shift);
 int              shiftwin1  (struct Sequence * win);
 void             closewin   (struct Sequence* win);
@@ -179,9 +199,7 @@ void             enton      (struct Sequence* win);
 int              readhdr    (struct Sequence *seq);
 void             readseq    (struct Sequence* seq);
 
-void   entropy_init (int  window);
-void   entropy_exit ();
-double entropy (int* sv);
+double entropy (struct WindowContext* context, int* sv);
 
 struct Sequence* readentry (struct Database *dbase);
 
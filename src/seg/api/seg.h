@@ -17,6 +17,8 @@
 #ifndef SEG_H_
 #define SEG_H_
 
+#include <seg/api/genwin.h>
+
 /********************************************************************************/
 
 struct Segment
@@ -28,17 +30,41 @@ struct Segment
 
 /********************************************************************************/
 
+/* Working data of the SEG algorithm: the windows context and the entropies buffers
+ * (one per recursion level of segseq), kept from one sequence to the other. A context
+ * must be used by only one thread at a time. */
+struct SegContext
+{
+    struct WindowContext windows;
+
+    int downset;
+    int upset;
+
+    double** entropies;
+    int*     capacities;
+    int      nbBuffers;
+    int      depth;
+};
+
+/********************************************************************************/
+
 double getprob (int* sv, int total);
 double lnperm  (int* sv, int tot);
 double lnass   (int* sv);
 
+struct SegContext* seg_newContext    (void);
+void               seg_deleteContext (struct SegContext* context);
+
+void seg_filterSequenceContext (struct SegContext* context, char* sequence, int length);
 void seg_filterSequence (char* sequence, int length);
-void segseq (struct Sequence* seq, struct Segment** segs, int offset);
-double* seqent (struct Sequence* seq);
+void seg_releaseContext (void);
+
+void segseq (struct SegContext* context, struct Sequence* seq, struct Segment** segs, int offset);
+double* seqent (struct SegContext* context, struct Sequence* seq);
 int hasdash (struct Sequence* win);
 int findlo (int i, int limit, double* H);
 int findhi (int i, int limit, double* H);
-void trim (struct Sequence* seq, int* leftend, int* rightend);
+void trim (struct SegContext* context, struct Sequence* seq, int* leftend, int* rightend);
 double getprob (int* sv, int total);
 double lnperm (int* sv, int tot);
 double lnass (int* sv);
@@ -19,11 +19,7 @@
 void decrementsv (register int* sv, register int class);
 void incrementsv (register int* sv, int class);
 
-/********************************************************************************/
-
-static int              aaindex[128];
-static unsigned char	aaflag[128];
-static char             aachar[20];
+#define LN2	0.69314718055994530941723212145818
 
 /*********************************************************************
  ** METHOD  :
@@ -33,33 +29,67 @@ static char             aachar[20];
  ** RETURN  :
  ** REMARKS :
  *********************************************************************/
-void genwininit (void)
+void genwininit (struct WindowContext* context, int window)
 {
-    static char first = 1;
+    const char *cp, *cp0;
+    int		i;
+    char	c;
+    double	x, xw;
 
-    if (first)
+    for (i = 0; i < sizeof(context->aaindex)/sizeof(context->aaindex[0]); ++i)
     {
-        char *cp, *cp0;
-        int		i;
-        char	c;
+        context->aaindex[i] = 20;
+        context->aaflag[i] = TRUE;
+    }
 
-        for (i = 0; i < sizeof(aaindex)/sizeof(aaindex[0]); ++i)
-        {
-            aaindex[i] = 20;
-            aaflag[i] = TRUE;
-        }
+    for (cp = cp0 = "ACDEFGHIKLMNPQRSTVWY"; (c = *cp) != '\0'; ++cp)
+    {
+        i = cp - cp0;
+        context->aaindex[(int)c] = i;
+        context->aaindex[tolower(c)] = i;
+        context->aaflag[(int)c] = FALSE;
+        context->aaflag[tolower(c)] = FALSE;
+    }
 
-        for (cp = cp0 = "ACDEFGHIKLMNPQRSTVWY"; (c = *cp) != '\0'; ++cp)
-        {
-            i = cp - cp0;
-            aaindex[(int)c] = i;
-            aaindex[tolower(c)] = i;
-            aachar[i] = tolower(c);
-            aaflag[(int)c] = FALSE;
-            aaflag[tolower(c)] = FALSE;
-        }
+    if (window >= sizeof(context->entray)/sizeof(context->entray[0]))
+    {
+        fprintf (stderr, "genwininit: window size too big (%d)\n", window);
+        exit (1);
+    }
 
-        first = 0;
+    xw = window;
+    for (i = 1; i <= window; ++i)
+    {
+        x = i / xw;
+        context->entray[i] = -x * log(x) / LN2;
+    }
+
+    context->window = window;
+    context->pool   = (struct Sequence *) NULL;
+}
+
+/*********************************************************************
+ ** METHOD  :
+ ** PURPOSE :
+ ** INPUT   :
+ ** OUTPUT  :
+ ** RETURN  :
+ ** REMARKS : releases the windows kept in the pool.
+ *********************************************************************/
+void genwinexit (struct WindowContext* context)
+{
+    struct Sequence* win;
+
+    while ((win = context->pool) != NULL)
+    {
+        context->pool = win->nextfree;
+
+        if (win->state!=NULL)       free(win->state);
+        if (win->composition!=NULL) free(win->composition);
+        if (win->classvec!=NULL)    free(win->classvec);
+        if (win->scorevec!=NULL)    free(win->scorevec);
+
+        free(win);
     }
 }
 
@@ -71,7 +101,7 @@ void genwininit (void)
  ** RETURN  :
  ** REMARKS :
  *********************************************************************/
-struct Sequence* openwin (struct Sequence *parent,  int start, int length)
+struct Sequence* openwin (struct WindowContext* context, struct Sequence *parent,  int start, int length)
 {
     struct Sequence* win;
 
@@ -80,7 +110,24 @@ struct Sequence* openwin (struct Sequence *parent,  int start, int length)
         return((struct Sequence *) NULL);
     }
 
-    win = (struct Sequence *) malloc(sizeof(struct Sequence));
+    /*------[reuse a closed window and its buffers if possible]---*/
+
+    if (context->pool != NULL)
+    {
+        win = context->pool;
+        context->pool = win->nextfree;
+    }
+    else
+    {
+        win = (struct Sequence *) malloc(sizeof(struct Sequence));
+        win->state          = (int*)    NULL;
+        win->composition    = (int*)    NULL;
+        win->classvec       = (char*)   NULL;
+        win->scorevec       = (double*) NULL;
+    }
+
+    win->context  = context;
+    win->nextfree = (struct Sequence *) NULL;
 
     /*------[set links, up and down]---*/
 
@@ -120,11 +167,8 @@ struct Sequence* openwin (struct Sequence *parent,  int start, int length)
     /*------[initially unconfiguerd window]---*/
 
     win->entropy        = -2.;
-    win->state          = (int*)    NULL;
-    win->composition    = (int*)    NULL;
-    win->classvec       = (char*)   NULL;
-    win->scorevec       = (double*) NULL;
 
+    compon  (win);
     stateon (win);
 
     return win;
@@ -146,7 +190,7 @@ struct Sequence* nextwin (struct Sequence* win, int shift)
     }
     else
     {
-        return openwin (win->parent, win->start+shift, win->length);
+        return openwin (win->context, win->parent, win->start+shift, win->length);
     }
 }
 
@@ -162,6 +206,8 @@ int shiftwin1 (struct Sequence	*win)
 {
     register int	j, length;
     register int	*comp;
+    const int		*aaindex = win->context->aaindex;
+    const unsigned char	*aaflag  = win->context->aaflag;
 
     length = win->length;
     comp = win->composition;
@@ -182,7 +228,7 @@ int shiftwin1 (struct Sequence	*win)
         incrementsv(win->state, comp[aaindex[j]]++);
 
     if (win->entropy > -2.)
-        win->entropy = entropy(win->state);
+        win->entropy = entropy(win->context, win->state);
 
     return TRUE;
 }
@@ -199,12 +245,9 @@ void closewin (struct Sequence* win)
 {
     if (win==NULL) return;
 
-    if (win->state!=NULL)       free(win->state);
-    if (win->composition!=NULL) free(win->composition);
-    if (win->classvec!=NULL)    free(win->classvec);
-    if (win->scorevec!=NULL)    free(win->scorevec);
-
-    free(win);
+    /* The window is kept with its buffers for the next openwin. */
+    win->nextfree = win->context->pool;
+    win->context->pool = win;
 }
 
 /*********************************************************************
@@ -220,8 +263,15 @@ void compon (struct Sequence* win)
     register int	*comp;
     register int	aa;
     register char	*seq, *seqmax;
+    const int		*aaindex = win->context->aaindex;
+    const unsigned char	*aaflag  = win->context->aaflag;
+
+    if (win->composition == NULL)
+        win->composition = (int *) malloc(20*sizeof(*comp));
+
+    comp = win->composition;
+    memset (comp, 0, 20*sizeof(*comp));
 
-    win->composition = comp = (int *) calloc(20*sizeof(*comp), 1);
     seq = win->seq;
     seqmax = seq + win->length;
 
@@ -287,60 +337,7 @@ void enton (struct Sequence* win)
 {
     if (win->state==NULL) {stateon(win);}
 
-    win->entropy = entropy(win->state);
-}
-
-/*********************************************************************
-** METHOD  :
-** PURPOSE :
-** INPUT   :
-** OUTPUT  :
-** RETURN  :
-** REMARKS :
-*********************************************************************/
-static int		thewindow;
-static double	entray[256];
-
-#define LN2	0.69314718055994530941723212145818
-
-void entropy_init (int	window)
-{
-    static char first = 1;
-
-    if (first)
-    {
-        int		i;
-        double	x, xw;
-
-        if (window >= sizeof(entray)/sizeof(entray[0]))
-        {
-            fprintf (stderr, "entropy_init: window size too big (%d)\n", window);
-            exit (1);
-        }
-
-        xw = window;
-        for (i = 1; i <= window; ++i)
-        {
-            x = i / xw;
-            entray[i] = -x * log(x) / LN2;
-        }
-
-        thewindow = window;
-
-        first = 0;
-    }
-}
-
-/*********************************************************************
-** METHOD  :
-** PURPOSE :
-** INPUT   :
-** OUTPUT  :
-** RETURN  :
-** REMARKS :
-*********************************************************************/
-void entropy_exit ()
-{
+    win->entropy = entropy(win->context, win->state);
 }
 
 /*********************************************************************
@@ -351,7 +348,7 @@ void entropy_exit ()
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-double entropy (register int* sv)
+double entropy (struct WindowContext* context, register int* sv)
 {
     int	*sv0 = sv;
     register double	ent;
@@ -363,11 +360,11 @@ double entropy (register int* sv)
         total += i;
     svmax = sv;
     ent = 0.0;
-    if (total == thewindow)
+    if (total == context->window)
     {
         for (sv = sv0; sv < svmax; )
         {
-            ent += entray[*sv++];
+            ent += context->entray[*sv++];
         }
         return ent;
     }
@@ -19,8 +19,6 @@
 #include <seg/impl/lnfac.pri>
 
 int window = 12;
-int downset = 0;
-int upset   = 0;
 double locut = 2.2;
 double hicut = 2.5;
 
@@ -46,54 +44,118 @@ int maxtrim = 100;
  ** RETURN  :
  ** REMARKS :
  *********************************************************************/
-void seg_filterSequence (char* sequence, int length)
+struct SegContext* seg_newContext (void)
 {
-    struct Sequence* seq  = 0;
-    struct Segment*  segs = 0;
-
-    seq = (struct Sequence *) malloc(sizeof(struct Sequence));
-
-    seq->seq         = sequence;
-    seq->length      = length;  //strlen(sequence);
-    seq->db          = NULL;
-    seq->parent      = (struct Sequence *)  NULL;
-    seq->root        = (struct Sequence *)  NULL;
-    seq->children    = (struct Sequence **) NULL;
-    seq->rubberwin   = FALSE;
-    seq->floatwin    = FALSE;
-    seq->punctuation = FALSE;
-    seq->entropy     = -2.;
-    seq->state       = (int*)    NULL;
-    seq->composition = (int*)    NULL;
-    seq->classvec    = (char*)   NULL;
-    seq->scorevec    = (double*) NULL;
-
-    genwininit();
-
-    downset = (window+1)/2 - 1;
-    upset   = window - downset;
-
-    singleseq  = TRUE;
-    prettyseq  = FALSE;
-    prettytree = FALSE;
-    hionly     = TRUE;
-    loonly     = FALSE;
-
-    entropy_init (window);
+    struct SegContext* context = (struct SegContext *) malloc(sizeof(struct SegContext));
 
-    segs = (struct Segment *) NULL;
+    genwininit (&context->windows, window);
+
+    context->downset = (window+1)/2 - 1;
+    context->upset   = window - context->downset;
+
+    context->entropies  = (double **) NULL;
+    context->capacities = (int *)     NULL;
+    context->nbBuffers  = 0;
+    context->depth      = 0;
+
+    return context;
+}
+
+/*********************************************************************
+ ** METHOD  :
+ ** PURPOSE :
+ ** INPUT   :
+ ** OUTPUT  :
+ ** RETURN  :
+ ** REMARKS :
+ *********************************************************************/
+void seg_deleteContext (struct SegContext* context)
+{
+    int i;
+
+    if (context==NULL) return;
+
+    genwinexit (&context->windows);
+
+    for (i=0; i<context->nbBuffers; i++)  { free (context->entropies[i]); }
+
+    free (context->entropies);
+    free (context->capacities);
+    free (context);
+}
+
+/*********************************************************************
+ ** METHOD  :
+ ** PURPOSE :
+ ** INPUT   :
+ ** OUTPUT  :
+ ** RETURN  :
+ ** REMARKS :
+ *********************************************************************/
+void seg_filterSequenceContext (struct SegContext* context, char* sequence, int length)
+{
+    struct Sequence seq;
+    struct Segment* segs = 0;
+
+    seq.seq         = sequence;
+    seq.length      = length;  //strlen(sequence);
+    seq.db          = NULL;
+    seq.parent      = (struct Sequence *)  NULL;
+    seq.root        = (struct Sequence *)  NULL;
+    seq.children    = (struct Sequence **) NULL;
+    seq.rubberwin   = FALSE;
+    seq.floatwin    = FALSE;
+    seq.punctuation = FALSE;
+    seq.entropy     = -2.;
+    seq.state       = (int*)    NULL;
+    seq.composition = (int*)    NULL;
+    seq.classvec    = (char*)   NULL;
+    seq.scorevec    = (double*) NULL;
+    seq.context     = &context->windows;
+    seq.nextfree    = (struct Sequence *) NULL;
 
-    segseq (seq, &segs, 0);
+    segs = (struct Segment *) NULL;
 
-    mergesegs (seq, segs);
+    segseq (context, &seq, &segs, 0);
 
-    singreport (seq, segs);
+    mergesegs (&seq, segs);
 
-    entropy_exit ();
+    singreport (&seq, segs);
 
     freesegs (segs);
+}
+
+/*********************************************************************
+ ** METHOD  :
+ ** PURPOSE :
+ ** INPUT   :
+ ** OUTPUT  :
+ ** RETURN  :
+ ** REMARKS : the context of the calling thread is created at the first
+ **           call and kept until seg_releaseContext is called.
+ *********************************************************************/
+static __thread struct SegContext* threadContext = 0;
+
+void seg_filterSequence (char* sequence, int length)
+{
+    if (threadContext == NULL)  { threadContext = seg_newContext (); }
+
+    seg_filterSequenceContext (threadContext, sequence, length);
+}
+
+/*********************************************************************
+ ** METHOD  :
+ ** PURPOSE :
+ ** INPUT   :
+ ** OUTPUT  :
+ ** RETURN  :
+ ** REMARKS :
+ *********************************************************************/
+void seg_releaseContext (void)
+{
+    seg_deleteContext (threadContext);
 
-    free (seq);
+    threadContext = 0;
 }
 
 /*********************************************************************
@@ -104,16 +166,18 @@ void seg_filterSequence (char* sequence, int length)
  ** RETURN  :
  ** REMARKS :
  *********************************************************************/
-void segseq (struct Sequence* seq, struct Segment** segs, int offset)
+void segseq (struct SegContext* context, struct Sequence* seq, struct Segment** segs, int offset)
 {
     struct Segment *seg, *leftsegs;
     struct Sequence *leftseq;
     int first, last, lowlim;
     int loi, hii, i;
     int leftend, rightend, lend, rend;
-    double *H, *seqent();
+    int downset = context->downset;
+    int upset   = context->upset;
+    double *H;
 
-    H = seqent(seq);
+    H = seqent(context, seq);
     if (H==NULL) return;
 
     first = downset;
@@ -130,16 +194,16 @@ void segseq (struct Sequence* seq, struct Segment** segs, int offset)
             leftend = loi - downset;
             rightend = hii + upset - 1;
 
-            trim(openwin(seq, leftend, rightend-leftend+1), &leftend, &rightend);
+            trim(context, openwin(&context->windows, seq, leftend, rightend-leftend+1), &leftend, &rightend);
 
             if (i+upset-1<leftend)   /* check for trigger window in left trim */
             {
                 lend = loi - downset;
                 rend = leftend - 1;
 
-                leftseq = openwin(seq, lend, rend-lend+1);
+                leftseq = openwin(&context->windows, seq, lend, rend-lend+1);
                 leftsegs = (struct Segment *) NULL;
-                segseq(leftseq, &leftsegs, offset+lend);
+                segseq(context, leftseq, &leftsegs, offset+lend);
                 if (leftsegs!=NULL)
                 {
                     if (*segs==NULL) *segs = leftsegs;
@@ -170,7 +234,8 @@ void segseq (struct Sequence* seq, struct Segment** segs, int offset)
         }
     }
 
-    free(H);
+    /* The entropies buffer of this level is released for the next sequences. */
+    context->depth--;
     return;
 }
 
@@ -182,25 +247,45 @@ void segseq (struct Sequence* seq, struct Segment** segs, int offset)
  ** RETURN  :
  ** REMARKS :
  *********************************************************************/
-double* seqent (struct Sequence* seq)
+double* seqent (struct SegContext* context, struct Sequence* seq)
 {
     struct Sequence *win;
     double *H;
     int i, first, last;
+    int downset = context->downset;
+    int upset   = context->upset;
 
     if (window>seq->length)
     {
         return((double *) NULL);
     }
 
-    H = (double *) malloc(seq->length*sizeof(double));
+    /* We use the entropies buffer of the current recursion level of segseq;
+     * the buffers of the previous levels are still in use, so they are kept as is. */
+    if (context->depth == context->nbBuffers)
+    {
+        context->nbBuffers++;
+        context->entropies  = (double **) realloc(context->entropies,  context->nbBuffers*sizeof(double*));
+        context->capacities = (int *)     realloc(context->capacities, context->nbBuffers*sizeof(int));
+        context->entropies  [context->depth] = (double *) NULL;
+        context->capacities [context->depth] = 0;
+    }
+
+    if (context->capacities[context->depth] < seq->length)
+    {
+        free(context->entropies[context->depth]);
+        context->entropies  [context->depth] = (double *) malloc(seq->length*sizeof(double));
+        context->capacities [context->depth] = seq->length;
+    }
+
+    H = context->entropies[context->depth++];
 
     for (i=0; i<seq->length; i++)
     {
         H[i] = -1.;
     }
 
-    win = openwin(seq, 0, window);
+    win = openwin(&context->windows, seq, 0, window);
     enton(win);
 
     first = downset;
@@ -293,7 +378,7 @@ int findhi (int i, int limit, double* H)
 ** RETURN  :
 ** REMARKS :
 *********************************************************************/
-void trim (struct Sequence* seq, int* leftend, int* rightend)
+void trim (struct SegContext* context, struct Sequence* seq, int* leftend, int* rightend)
 {
     struct Sequence *win;
     double prob, minprob;
@@ -311,7 +396,7 @@ void trim (struct Sequence* seq, int* leftend, int* rightend)
     minprob = 1.;
     for (len=seq->length; len>minlen; len--)
     {
-        win = openwin(seq, 0, len);
+        win = openwin(&context->windows, seq, 0, len);
         stateon(win);
         i = 0;
 
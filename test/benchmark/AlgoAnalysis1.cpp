@@ -296,10 +296,10 @@ protected:
         u_int8_t sizeHalfNeighbour = _span + 1*_parameters->ungapNeighbourLength;
         u_int8_t sizeNeighbour     = _span + 2*_parameters->ungapNeighbourLength;
 
-        for (list<IdxCouple>::iterator it = hit->indexes.begin();  it != hit->indexes.end();  it++)
+        for (size_t it=hit->indexes.first();  it != hit->indexes.end();  it=hit->indexes.next(it))
         {
-            const ISeedOccurrence* occur1 = occur1Vector.data[it->first];
-            const ISeedOccurrence* occur2 = occur2Vector.data[it->second];
+            const ISeedOccurrence* occur1 = occur1Vector.data[hit->indexes[it].first];
+            const ISeedOccurrence* occur2 = occur2Vector.data[hit->indexes[it].second];
 
             LETTER* neighbour1 = occur1->neighbourhood.letters.data;
             LETTER* neighbour2 = occur2->neighbourhood.letters.data;
@@ -308,7 +308,7 @@ protected:
 //computeScores (neighbour1, neighbour2, score, maxScore, minScore, DummyScore ());
 //if (maxScore < _parameters->ungapScoreThreshold)
 //{
-//    printf ("[%ld,%ld]\n", it->first, it->second);
+//    printf ("[%ld,%ld]\n", hit->indexes[it].first, hit->indexes[it].second);
 //    printf ("  "); for (size_t i=0; i<sizeNeighbour; i++)  {  printf ("%c   ", AcidAscii[neighbour1[i]]);  }  printf ("\n");
 //    printf ("  "); for (size_t i=0; i<sizeNeighbour; i++)  {  printf ("%c   ", AcidAscii[neighbour2[i]]);  }  printf ("\n");
 //    printf ("\n");
@@ -366,7 +366,7 @@ protected:
 
             if (identity >= _identThreshold)
             {
-                bool isOk = (_alignOnly &&  (isAlignement = dynapro (occur1Vector.data [it->first], occur2Vector.data [it->second]))) || (!_alignOnly) ;
+                bool isOk = (_alignOnly &&  (isAlignement = dynapro (occur1Vector.data [hit->indexes[it].first], occur2Vector.data [hit->indexes[it].second]))) || (!_alignOnly) ;
 
                 if (isOk)
                 {
@@ -161,15 +161,15 @@ protected:
         u_int8_t sizeHalfNeighbour = _span + 1*_parameters->ungapNeighbourLength;
         u_int8_t sizeNeighbour     = _span + 2*_parameters->ungapNeighbourLength;
 
-        for (list<IdxCouple>::iterator it = hit->indexes.begin();  it != hit->indexes.end();  it++)
+        for (size_t it=hit->indexes.first();  it != hit->indexes.end();  it=hit->indexes.next(it))
         {
-            LETTER* neighbour1 = occur1Vector.data[it->first]->neighbourhood.letters.data;
-            LETTER* neighbour2 = occur2Vector.data[it->second]->neighbourhood.letters.data;
+            LETTER* neighbour1 = occur1Vector.data[hit->indexes[it].first]->neighbourhood.letters.data;
+            LETTER* neighbour2 = occur2Vector.data[hit->indexes[it].second]->neighbourhood.letters.data;
 
-            size_t nb1 = occur1Vector.data[it->first]->neighbourhood.letters.size;
-            size_t nb2 = occur2Vector.data[it->second]->neighbourhood.letters.size;
+            size_t nb1 = occur1Vector.data[hit->indexes[it].first]->neighbourhood.letters.size;
+            size_t nb2 = occur2Vector.data[hit->indexes[it].second]->neighbourhood.letters.size;
 #if 1
-//            printf ("[%ld,%ld]\n", it->first, it->second);
+//            printf ("[%ld,%ld]\n", hit->indexes[it].first, hit->indexes[it].second);
 //            for (size_t i=0; i<nb1; i++)  {  printf ("%c", AcidAscii[neighbour1[i]]);  }  printf ("\n");
 //            for (size_t i=0; i<nb2; i++)  {  printf ("%c", AcidAscii[neighbour2[i]]);  }  printf ("\n");
 
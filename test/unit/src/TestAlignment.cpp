@@ -20,30 +20,47 @@
 #include <alignment/core/api/IAlignmentContainer.hpp>
 #include <alignment/core/api/IAlignmentContainerVisitor.hpp>
 #include <alignment/core/impl/AlignmentContainerFactory.hpp>
+#include <alignment/core/impl/UngapAlignmentContainerLockFree.hpp>
+#include <alignment/core/impl/BasicAlignmentContainer.hpp>
+#include <alignment/core/impl/FlatAlignmentContainer.hpp>
 #include <alignment/visitors/impl/TabulatedOutputVisitor.hpp>
+#include <alignment/visitors/impl/BinaryOutputVisitor.hpp>
 #include <alignment/visitors/impl/CompareContainerVisitor.hpp>
 #include <alignment/visitors/impl/ShrinkContainerVisitor.hpp>
 #include <alignment/visitors/impl/FilterContainerVisitor.hpp>
 #include <alignment/visitors/impl/ModelBuilderVisitor.hpp>
+#include <alignment/visitors/impl/HierarchyAlignmentVisitor.hpp>
+#include <alignment/visitors/impl/QueryReorderVisitor.hpp>
 #include <alignment/tools/impl/AlignmentOverlapCmd.hpp>
 
 #include <database/api/ISequence.hpp>
+#include <database/impl/FastaDatabaseQuickReader.hpp>
+
+#include <algo/core/impl/DatabasesProvider.hpp>
 
 #include <designpattern/impl/FileLineIterator.hpp>
+#include <designpattern/impl/CommandDispatcher.hpp>
 #include <designpattern/impl/TokenizerIterator.hpp>
 
 #include <map>
 #include <list>
+#include <set>
 #include <string>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
 
 using namespace std;
 using namespace misc;
 using namespace database;
+using namespace database::impl;
 using namespace alignment::core;
 using namespace alignment::core::impl;
 using namespace alignment::visitors::impl;
 using namespace alignment::tools::impl;
+using namespace dp;
 using namespace dp::impl;
+using namespace algo::core::impl;
 
 /** Macro that returns random number in [0..999] */
 #define MAX_RAND  500
@@ -88,6 +105,10 @@ public:
          result->addTest (new TestCaller<TestAlignment> ("test_ContainerCompare2",          &TestAlignment::test_ContainerCompare2) );
          result->addTest (new TestCaller<TestAlignment> ("test_ContainerBigNbAlign",          &TestAlignment::test_ContainerBigNbAlign) );
          result->addTest (new TestCaller<TestAlignment> ("test_Model",          &TestAlignment::test_Model) );
+         result->addTest (new TestCaller<TestAlignment> ("test_UngapResultLockFree",    &TestAlignment::test_UngapResultLockFree) );
+         result->addTest (new TestCaller<TestAlignment> ("test_FlatContainer",          &TestAlignment::test_FlatContainer) );
+         result->addTest (new TestCaller<TestAlignment> ("test_BinaryOutput",           &TestAlignment::test_BinaryOutput) );
+         result->addTest (new TestCaller<TestAlignment> ("test_QueryReorder",           &TestAlignment::test_QueryReorder) );
 //    	 result->addTest (new TestCaller<TestAlignment> ("test_compare",          &TestAlignment::test_compare) );
          return result;
     }
@@ -394,6 +415,400 @@ public:
         container->accept (&v);
     }
 
+    /********************************************************************************/
+    /** Returns the sorted lines of a file. */
+    vector<string> getSortedLines (const char* uri)
+    {
+        vector<string> result;
+        ifstream file (uri);
+        string line;
+        while (getline (file, line))  { result.push_back (line); }
+        sort (result.begin(), result.end());
+        return result;
+    }
+
+    /********************************************************************************/
+    void test_BinaryOutput ()
+    {
+        srand (0);
+
+        vector<string> qryNames;
+        vector<string> sbjNames;
+        for (size_t i=0; i<30; i++)  {  stringstream ss;  ss << "query_"   << i << " some comment";  qryNames.push_back (ss.str());  }
+        for (size_t i=0; i<10; i++)  {  stringstream ss;  ss << "subject_" << i << " some comment";  sbjNames.push_back (ss.str());  }
+
+        vector<ISequence> qrySeqs (qryNames.size());
+        vector<ISequence> sbjSeqs (sbjNames.size());
+        for (size_t i=0; i<qrySeqs.size(); i++)  { qrySeqs[i].index = i;  qrySeqs[i].comment = qryNames[i].c_str();  qrySeqs[i].length = 1000; }
+        for (size_t i=0; i<sbjSeqs.size(); i++)  { sbjSeqs[i].index = i;  sbjSeqs[i].comment = sbjNames[i].c_str();  sbjSeqs[i].length = 2000; }
+
+        IAlignmentContainer* ref = AlignmentContainerFactory::singleton().createContainer();
+        LOCAL (ref);
+
+        for (size_t i=0; i<2000; i++)
+        {
+            Alignment al (
+                Alignment::AlignSequenceInfo (&sbjSeqs [rand() % sbjSeqs.size()], getRandomRange()),
+                Alignment::AlignSequenceInfo (&qrySeqs [rand() % qrySeqs.size()], getRandomRange())
+            );
+            al.setLength       (100 + rand() % 100);
+            al.setNbIdentities (rand() % 100);
+            al.setNbMisses     (al.getLength() - al.getNbIdentities());
+            al.setScore        (rand() % 1000);
+            al.setBitScore     (al.getScore() / 2.3);
+            al.setEvalue       (1.0 / (1 + rand()));
+
+            ref->insert (al, 0);
+        }
+
+        /** We use small blocks in order to check the names table over several blocks. */
+        {  BinaryOutputVisitor    v ("/tmp/binaryRef", 100);     ref->accept (&v);  }
+        {  TabulatedOutputVisitor v ("/tmp/binaryRef.txt");      ref->accept (&v);  }
+
+        /** The binary file is detected and read back without loss. */
+        IAlignmentContainer* ref2 = AlignmentContainerFactory::singleton().createContainerFromUri ("/tmp/binaryRef");
+        LOCAL (ref2);
+        CPPUNIT_ASSERT (ref2->getAlignmentsNumber() == ref->getAlignmentsNumber());
+
+        {  TabulatedOutputVisitor v ("/tmp/binaryRef2.txt");     ref2->accept (&v);  }
+
+        CPPUNIT_ASSERT (getSortedLines ("/tmp/binaryRef.txt") == getSortedLines ("/tmp/binaryRef2.txt"));
+    }
+
+    /********************************************************************************/
+    void test_QueryReorder ()
+    {
+        srand (0);
+
+        const char* qryUri = "/tmp/queryReorder.fa";
+        const char* outUri = "/tmp/queryReorder.txt";
+        const char* refUri = "/tmp/queryReorderRef.txt";
+
+        /** We create a query database; it will be split into several blocks. */
+        size_t nbQueries = 40;
+        FILE* file = fopen (qryUri, "w");
+        CPPUNIT_ASSERT (file != 0);
+        for (size_t i=0; i<nbQueries; i++)  {  fprintf (file, ">query_%d some comment\nMKVLAAGIVALLLAAGCSSSKEETPAAEPVAQEAAPKQ\n", (int)i);  }
+        fclose (file);
+
+        FastaDatabaseQuickReader* qryReader = new FastaDatabaseQuickReader (qryUri, true);
+        LOCAL (qryReader);
+        qryReader->read (500);
+
+        vector<u_int64_t>& offsets = qryReader->getOffsets();
+        size_t nbBlocks = offsets.size() - 1;
+        CPPUNIT_ASSERT (nbBlocks >= 4);
+
+        DatabasesProvider* provider = new DatabasesProvider (0);
+        LOCAL (provider);
+
+        vector<ISequenceDatabase*> blocks;
+        for (size_t j=0; j<nbBlocks; j++)
+        {
+            blocks.push_back (provider->createDatabase (qryUri, Range64 (offsets[j], offsets[j+1]-1), false, 0));
+            blocks.back()->use ();
+        }
+
+        ISequence sbjSeqs[5];
+        string    sbjNames[5];
+        for (size_t i=0; i<5; i++)
+        {
+            stringstream ss;  ss << "subject_" << i;  sbjNames[i] = ss.str();
+            sbjSeqs[i].index = i;  sbjSeqs[i].comment = sbjNames[i].c_str();  sbjSeqs[i].length = 2000;
+        }
+
+        /** The containers of the blocks come in a mixed order, each block having several containers. */
+        size_t order[] = { 3, 0, 2, 3, 1, 0, 3, 2, 1, 0 };
+
+        {
+            QueryRunsVisitor* runsVisitor = new QueryRunsVisitor (string(outUri) + ".tmp");
+
+            QueryReorderVisitor* reorder = new QueryReorderVisitor (
+                provider, outUri, runsVisitor, runsVisitor, new TabulatedOutputVisitor (outUri), qryReader, 10*1000, 500, 0
+            );
+            LOCAL (reorder);
+
+            TabulatedOutputVisitor ref (refUri);
+
+            for (size_t k=0; k<sizeof(order)/sizeof(order[0]); k++)
+            {
+                size_t j = order[k] % nbBlocks;
+
+                IAlignmentContainer* container = AlignmentContainerFactory::singleton().createContainer();
+                LOCAL (container);
+
+                for (size_t n=0; n<15; n++)
+                {
+                    ISequence* qrySeq = blocks[j]->getSequenceRefByIndex (rand() % blocks[j]->getSequencesNumber());
+                    CPPUNIT_ASSERT (qrySeq != 0);
+
+                    Alignment al (
+                        Alignment::AlignSequenceInfo (&sbjSeqs[rand() % 5], getRandomRange()),
+                        Alignment::AlignSequenceInfo (qrySeq,               getRandomRange())
+                    );
+                    al.setLength       (100 + rand() % 100);
+                    al.setNbIdentities (rand() % 100);
+                    al.setNbMisses     (al.getLength() - al.getNbIdentities());
+                    al.setScore        (rand() % 1000);
+                    al.setBitScore     (al.getScore() / 2.3);
+                    al.setEvalue       (1.0 / (1 + rand()));
+
+                    container->insert (al, 0);
+                }
+
+                container->accept (&ref);
+
+                IAlignmentContainerVisitor* blockVisitor = reorder->createBlockVisitor (Range64 (offsets[j], offsets[j+1]-1));
+                LOCAL (blockVisitor);
+                container->accept (blockVisitor);
+            }
+
+            /** The output file is complete once the visitors are deleted. */
+            reorder->finalize ();
+        }
+
+        for (size_t j=0; j<nbBlocks; j++)  {  blocks[j]->forget ();  }
+
+        /** We get the same alignments. */
+        CPPUNIT_ASSERT (getSortedLines (outUri) == getSortedLines (refUri));
+
+        /** The queries are in the order of the query database, and all the alignments of a query are together. */
+        ifstream output (outUri);
+        string   line;
+        int      lastQuery = -1;
+        set<int> queries;
+        while (getline (output, line))
+        {
+            int query = -1;
+            CPPUNIT_ASSERT (sscanf (line.c_str(), "query_%d", &query) == 1);
+            CPPUNIT_ASSERT (query >= lastQuery);
+
+            if (query != lastQuery)  {  CPPUNIT_ASSERT (queries.insert (query).second);  }
+            lastQuery = query;
+        }
+        CPPUNIT_ASSERT (queries.size() > nbQueries / 2);
+    }
+
+    /********************************************************************************/
+    struct UngapItem  {  Range64 qry;  Range64 sbj;  u_int32_t qryIdx;  };
+
+    /** Insert ungap alignments into a container and count the new ones. */
+    class UngapInsertCommand : public ICommand
+    {
+    public:
+        UngapInsertCommand (IAlignmentContainer* container, const vector<UngapItem>& items, size_t* nbNew)
+            : _container(container), _items(items), _nbNew(nbNew)  {}
+
+        void execute ()
+        {
+            for (size_t i=0; i<_items.size(); i++)
+            {
+                if (_container->insert (_items[i].qry, _items[i].sbj, _items[i].qryIdx) == false)  {  __sync_fetch_and_add (_nbNew, 1);  }
+            }
+        }
+
+    private:
+        IAlignmentContainer*      _container;
+        const vector<UngapItem>&  _items;
+        size_t*                   _nbNew;
+    };
+
+    void test_UngapResultLockFree ()
+    {
+        srand (0);
+
+        /** We generate overlapping ungap alignments on a few diagonals. */
+        vector<UngapItem> items;
+        for (size_t i=0; i<20000; i++)
+        {
+            UngapItem item;
+            u_int64_t q   = rand() % 100000;
+            u_int64_t len = 5 + rand() % 50;
+            u_int64_t s   = q + 1000 * (rand() % 20);
+            item.qry    = Range64 (q, q+len);
+            item.sbj    = Range64 (s, s+len);
+            item.qryIdx = rand() % 10;
+            items.push_back (item);
+        }
+
+        /** The lock free implementation must give the same answers as the reference one. */
+        UngapAlignmentResult*         ref  = new UngapAlignmentResult (10);
+        UngapAlignmentResultLockFree* impl = new UngapAlignmentResultLockFree (10);
+        LOCAL (ref);
+        LOCAL (impl);
+
+        for (size_t i=0; i<items.size(); i++)
+        {
+            CPPUNIT_ASSERT (
+                ref-> insert (items[i].qry, items[i].sbj, items[i].qryIdx) ==
+                impl->insert (items[i].qry, items[i].sbj, items[i].qryIdx)
+            );
+        }
+        CPPUNIT_ASSERT (ref->getAlignmentsNumber() == impl->getAlignmentsNumber());
+
+        /** Concurrent insertions of the same alignments: each one must be inserted only once. */
+        UngapAlignmentResultLockFree* shared = new UngapAlignmentResultLockFree (10);
+        LOCAL (shared);
+
+        size_t nbNew = 0;
+        list<ICommand*> commands;
+        for (size_t i=0; i<8; i++)  {  commands.push_back (new UngapInsertCommand (shared, items, &nbNew));  }
+
+        ParallelCommandDispatcher dispatcher (8);
+        dispatcher.dispatchCommands (commands, 0);
+
+        CPPUNIT_ASSERT (nbNew == shared->getAlignmentsNumber());
+
+        /** No cell has been lost: all the alignments are now known. */
+        for (size_t i=0; i<items.size(); i++)
+        {
+            CPPUNIT_ASSERT (shared->insert (items[i].qry, items[i].sbj, items[i].qryIdx) == true);
+        }
+    }
+
+    /********************************************************************************/
+    /** Visitor that dumps the visited items into a string. */
+    class DumpVisitor : public HierarchyAlignmentResultVisitor
+    {
+    public:
+        void visitQuerySequence   (const ISequence* seq, const ProgressInfo& progress)  {  _ss << "Q " << seq->index << " " << progress << endl;  }
+        void visitSubjectSequence (const ISequence* seq, const ProgressInfo& progress)  {  _ss << "S " << seq->index << " " << progress << endl;  }
+        void visitAlignment (Alignment* align, const ProgressInfo& progress)
+        {
+            _ss << "A " << align->getRange(Alignment::QUERY)   << " " << align->getRange(Alignment::SUBJECT)
+                << " "  << align->getScore() << " " << align->getBitScore() << " " << progress << endl;
+        }
+        void postVisit (IAlignmentContainer* result)  {}
+        string str ()  { return _ss.str(); }
+    private:
+        stringstream _ss;
+    };
+
+    void test_FlatContainer ()
+    {
+        srand (0);
+
+        vector<ISequence> qrySeqs (50);
+        vector<ISequence> sbjSeqs (20);
+        for (size_t i=0; i<qrySeqs.size(); i++)  { qrySeqs[i].index = i; }
+        for (size_t i=0; i<sbjSeqs.size(); i++)  { sbjSeqs[i].index = i; }
+
+        BasicAlignmentContainer* ref  = new BasicAlignmentContainer (5, 3);
+        FlatAlignmentContainer*  impl = new FlatAlignmentContainer  (5, 3, 7);
+        LOCAL (ref);
+        LOCAL (impl);
+
+        /** Both containers must accept or reject the same alignments. */
+        for (size_t i=0; i<20000; i++)
+        {
+            Alignment al (
+                Alignment::AlignSequenceInfo (&sbjSeqs [rand() % sbjSeqs.size()], getRandomRange()),
+                Alignment::AlignSequenceInfo (&qrySeqs [rand() % qrySeqs.size()], getRandomRange())
+            );
+            al.setScore    (rand() % 100);
+            al.setBitScore (al.getScore() / 2);
+
+            Alignment al2 = al;
+
+            CPPUNIT_ASSERT (ref->doesExist (al) == impl->doesExist (al2));
+            CPPUNIT_ASSERT (ref->insert (al, 0) == impl->insert (al2, 0));
+        }
+
+        ref ->insertFirstLevel (&qrySeqs[0]);
+        impl->insertFirstLevel (&qrySeqs[0]);
+
+        CPPUNIT_ASSERT (ref->getAlignmentsNumber()  == impl->getAlignmentsNumber());
+        CPPUNIT_ASSERT (ref->getFirstLevelNumber()  == impl->getFirstLevelNumber());
+        CPPUNIT_ASSERT (ref->getSecondLevelNumber() == impl->getSecondLevelNumber());
+
+        /** Same visit, before and after the shrink. */
+        DumpVisitor v1, v2;
+        ref ->accept (&v1);
+        impl->accept (&v2);
+        CPPUNIT_ASSERT (v1.str() == v2.str());
+
+        /** The lists are owned by the containers: same content for both, and the same list (kept up to date) for each call. */
+        for (size_t q=0; q<qrySeqs.size(); q++)
+        {
+            for (size_t s=0; s<sbjSeqs.size(); s++)
+            {
+                list<Alignment>* l1 = ref ->getContainer (&qrySeqs[q], &sbjSeqs[s]);
+                list<Alignment>* l2 = impl->getContainer (&qrySeqs[q], &sbjSeqs[s]);
+
+                CPPUNIT_ASSERT ((l1 == 0) == (l2 == 0));
+                if (l1 == 0)  { continue; }
+
+                CPPUNIT_ASSERT (l2 == impl->getContainer (&qrySeqs[q], &sbjSeqs[s]));
+
+                Alignment al (
+                    Alignment::AlignSequenceInfo (&sbjSeqs[s], Range32 (1000+q, 1100+q)),
+                    Alignment::AlignSequenceInfo (&qrySeqs[q], Range32 (1000+s, 1100+s))
+                );
+                al.setScore    (50);
+                al.setBitScore (25);
+                Alignment al2 = al;
+
+                CPPUNIT_ASSERT (ref->insert (al, 0) == impl->insert (al2, 0));
+
+                CPPUNIT_ASSERT (l1->size() == l2->size());
+                for (list<Alignment>::iterator i1 = l1->begin(), i2 = l2->begin(); i1 != l1->end(); ++i1, ++i2)
+                {
+                    CPPUNIT_ASSERT (i1->getRange(Alignment::QUERY) == i2->getRange(Alignment::QUERY));
+                    CPPUNIT_ASSERT (i1->getScore()                 == i2->getScore());
+                }
+            }
+        }
+
+        DumpVisitor v6, v7;
+        ref ->accept (&v6);
+        impl->accept (&v7);
+        CPPUNIT_ASSERT (v6.str() == v7.str());
+
+        /** Merging a container into an empty one gives the same visit (but the queries without hit). */
+        FlatAlignmentContainer* merged = new FlatAlignmentContainer ();
+        LOCAL (merged);
+        merged->merge (vector<IAlignmentContainer*> (1, impl));
+        merged->insertFirstLevel (&qrySeqs[0]);
+
+        DumpVisitor v5;
+        merged->accept (&v5);
+        CPPUNIT_ASSERT (v7.str() == v5.str());
+
+        ref ->shrink ();
+        impl->shrink ();
+
+        DumpVisitor v3, v4;
+        ref ->accept (&v3);
+        impl->accept (&v4);
+        CPPUNIT_ASSERT (v3.str() == v4.str());
+        CPPUNIT_ASSERT (ref->getSecondLevelNumber() == impl->getSecondLevelNumber());
+
+        /** The subject copy belongs to the hit: a subject of the next database block may have the
+         *  key (database address and index) of a subject of a previous block, but not its content. */
+        FlatAlignmentContainer* blocks = new FlatAlignmentContainer (1, 0, 1);
+        LOCAL (blocks);
+
+        ISequence qry1 ("qry1"),  qry2 ("qry2");
+        ISequence sbj1 ("sbj1"),  sbj2 ("sbj2"),  sbj3 ("sbj3");
+        qry2.index = 1;
+        sbj1.index = sbj3.index = 5;
+        sbj2.index = 6;
+
+        Alignment al1 (Alignment::AlignSequenceInfo (&sbj1, Range32 (0,99)), Alignment::AlignSequenceInfo (&qry1, Range32 (0,99)));
+        Alignment al2 (Alignment::AlignSequenceInfo (&sbj2, Range32 (0,99)), Alignment::AlignSequenceInfo (&qry1, Range32 (0,99)));
+        Alignment al3 (Alignment::AlignSequenceInfo (&sbj3, Range32 (0,99)), Alignment::AlignSequenceInfo (&qry2, Range32 (0,99)));
+        al1.setBitScore (20);
+        al2.setBitScore (10);
+
+        blocks->insert (al1, 0);
+        blocks->insert (al2, 0);
+        blocks->shrink ();
+        CPPUNIT_ASSERT (blocks->getSecondLevelNumber() == 1);
+
+        blocks->insert (al3, 0);
+        CPPUNIT_ASSERT (strcmp (al3.getSequence(Alignment::SUBJECT)->comment, "sbj3") == 0);
+    }
+
     /********************************************************************************/
     void test_Model ()
     {
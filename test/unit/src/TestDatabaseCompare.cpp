@@ -32,6 +32,7 @@
 #include <algo/hits/seed/SeedHitIteratorCached.hpp>
 
 #include <set>
+#include <list>
 
 using namespace std;
 using namespace dp;
@@ -74,6 +75,7 @@ public:
     	 result->addTest (new TestCaller<TestDatabaseCompare> ("testIndexCompareSequences",       &TestDatabaseCompare::testIndexCompareSequences ) );
     	 result->addTest (new TestCaller<TestDatabaseCompare> ("testIndexCompareSequencesFasta",  &TestDatabaseCompare::testIndexCompareSequencesFasta ) );
     	 result->addTest (new TestCaller<TestDatabaseCompare> ("testHitIterator",                 &TestDatabaseCompare::testHitIterator ) );
+    	 result->addTest (new TestCaller<TestDatabaseCompare> ("testHitIndexes",                  &TestDatabaseCompare::testHitIndexes ) );
          return result;
     }
 
@@ -301,6 +303,56 @@ public:
         }
     }
 
+    /********************************************************************************/
+    /* We remove random couples from the indexes of a hit and from a list, then check
+     * that both iterate the same couples in the same order; the hit is reused several times. */
+    /********************************************************************************/
+    void testHitIndexes ()
+    {
+        Hit hit;
+
+        CPPUNIT_ASSERT (hit.indexes.empty() && hit.indexes.first() == hit.indexes.end());
+
+        size_t sizes[] = { 1, 63, 64, 65, 200, 1000, 3 };
+
+        for (size_t n=0; n<sizeof(sizes)/sizeof(sizes[0]); n++)
+        {
+            list<IdxCouple> check;
+
+            CPPUNIT_ASSERT (hit.resetIndexes() == 0);
+
+            for (size_t i=0; i<sizes[n]; i++)
+            {
+                CPPUNIT_ASSERT (hit.addIndexes (i, 2*i) == i+1);
+                check.push_back (IdxCouple (i, 2*i));
+            }
+
+            /** We remove some couples while iterating. */
+            list<IdxCouple>::iterator itCheck = check.begin();
+            for (size_t k=hit.indexes.first(); k!=hit.indexes.end(); k=hit.indexes.next(k))
+            {
+                CPPUNIT_ASSERT (hit.indexes[k] == *itCheck);
+
+                if (rand() % 3 == 0)  {  hit.indexes.erase (k);  itCheck = check.erase (itCheck);  }
+                else                  {  itCheck++;  }
+            }
+
+            /** We also remove the last couple (possibly already removed). */
+            hit.indexes.erase (sizes[n]-1);
+            if (check.empty() == false && check.back().first == sizes[n]-1)  { check.pop_back(); }
+
+            CPPUNIT_ASSERT (hit.indexes.size() == check.size());
+            CPPUNIT_ASSERT (hit.size()         == sizes[n]);
+
+            itCheck = check.begin();
+            for (size_t k=hit.indexes.first(); k!=hit.indexes.end(); k=hit.indexes.next(k), itCheck++)
+            {
+                CPPUNIT_ASSERT (hit.indexes[k] == *itCheck);
+            }
+            CPPUNIT_ASSERT (itCheck == check.end());
+        }
+    }
+
 };
 
 /********************************************************************************/
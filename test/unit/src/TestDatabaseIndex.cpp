@@ -184,7 +184,10 @@ public:
          result->addTest (new TestCaller<TestDatabaseIndex> ("testIndexDispatchParallel",   &TestDatabaseIndex::testIndexDispatchParallel ) );
          result->addTest (new TestCaller<TestDatabaseIndex> ("testIndexDispatchSerial",     &TestDatabaseIndex::testIndexDispatchSerial ) );
          result->addTest (new TestCaller<TestDatabaseIndex> ("testIndexMergeCheck",         &TestDatabaseIndex::testIndexMergeCheck ) );
+         result->addTest (new TestCaller<TestDatabaseIndex> ("testIndexBuildDispatch",      &TestDatabaseIndex::testIndexBuildDispatch ) );
          result->addTest (new TestCaller<TestDatabaseIndex> ("testIndexOccurrenceIterator", &TestDatabaseIndex::testIndexOccurrenceIterator ) );
+         result->addTest (new TestCaller<TestDatabaseIndex> ("testIndexOccurrenceBlockIterator", &TestDatabaseIndex::testIndexOccurrenceBlockIterator ) );
+         result->addTest (new TestCaller<TestDatabaseIndex> ("testIndexSaveLoad",           &TestDatabaseIndex::testIndexSaveLoad ) );
          result->addTest (new TestCaller<TestDatabaseIndex> ("testDatabaseADN",        &TestDatabaseIndex::testDatabaseADN ) );
          result->addTest (new TestCaller<TestDatabaseIndex> ("testIndexDatabaseADN",        &TestDatabaseIndex::testIndexDatabaseADN ) );
     	 return result;
@@ -426,6 +429,73 @@ public:
         CPPUNIT_ASSERT (checkIndex(globalIndex) == true);
     }
 
+    /********************************************************************************/
+    /* */
+    /********************************************************************************/
+    void testIndexBuildDispatch ()
+    {
+        /** We create a sequences database. */
+        ISequenceDatabase* database = new BufferedSequenceDatabase (fastaIterator, false);
+        LOCAL (database);
+
+        /** We build the same index in the current thread, in parallel, and by merging children indexes. */
+        DatabaseIndex* serialIndex = new DatabaseIndex (database, modelSpan3);
+        LOCAL (serialIndex);
+        serialIndex->build ();
+
+        /** We force several execution units, so the database is split whatever the number of cores. */
+        ICommandDispatcher* dispatcher = new ParallelCommandDispatcher (4);
+        LOCAL (dispatcher);
+
+        DatabaseIndex* parallelIndex = new DatabaseIndex (database, modelSpan3);
+        LOCAL (parallelIndex);
+        parallelIndex->build (dispatcher);
+
+        DatabaseIndex* mergedIndex = new DatabaseIndex (database, modelSpan3);
+        LOCAL (mergedIndex);
+
+        vector<ISequenceDatabase*> splits = database->split (4);
+        for (size_t i=0; i<splits.size(); i++)
+        {
+            IDatabaseIndex* index = new DatabaseIndex (splits[i], modelSpan3);
+            mergedIndex->addChildIndex (index);
+            index->build ();
+        }
+        mergedIndex->merge ();
+
+        CPPUNIT_ASSERT (serialIndex->getTotalOccurrenceNumber() > 0);
+        CPPUNIT_ASSERT (parallelIndex->getTotalOccurrenceNumber() == serialIndex->getTotalOccurrenceNumber());
+        CPPUNIT_ASSERT (mergedIndex->getTotalOccurrenceNumber()   == serialIndex->getTotalOccurrenceNumber());
+
+        /** The occurrences of each seed must be the same, in the same order. */
+        ISeedIterator* itSeed = modelSpan3->createAllSeedsIterator();
+        LOCAL (itSeed);
+
+        size_t nbOccurrences = 0;
+        for (itSeed->first(); !itSeed->isDone(); itSeed->next())
+        {
+            const ISeed* seed = itSeed->currentItem();
+
+            IOccurrenceIterator* it1 = serialIndex->createOccurrenceIterator   (seed);
+            IOccurrenceIterator* it2 = parallelIndex->createOccurrenceIterator (seed);
+            IOccurrenceIterator* it3 = mergedIndex->createOccurrenceIterator   (seed);
+            LOCAL (it1);
+            LOCAL (it2);
+            LOCAL (it3);
+
+            for (it1->first(), it2->first(), it3->first(); !it1->isDone(); it1->next(), it2->next(), it3->next(), nbOccurrences++)
+            {
+                CPPUNIT_ASSERT (it2->isDone() == false);
+                CPPUNIT_ASSERT (it3->isDone() == false);
+                CPPUNIT_ASSERT (it2->currentItem()->offsetInDatabase == it1->currentItem()->offsetInDatabase);
+                CPPUNIT_ASSERT (it3->currentItem()->offsetInDatabase == it1->currentItem()->offsetInDatabase);
+            }
+            CPPUNIT_ASSERT (it2->isDone() == true);
+            CPPUNIT_ASSERT (it3->isDone() == true);
+        }
+        CPPUNIT_ASSERT (nbOccurrences == serialIndex->getTotalOccurrenceNumber());
+    }
+
     /********************************************************************************/
     /* */
     /********************************************************************************/
@@ -504,6 +574,173 @@ public:
         }
     }
 
+    /********************************************************************************/
+    /* */
+    /********************************************************************************/
+    void testIndexSaveLoad ()
+    {
+        const char* uri = "TestDatabaseIndex.pidx";
+
+        /** We create a database from an iterator. */
+        ISequenceDatabase* database = new BufferedSequenceDatabase (
+            new StringSequenceIterator (3,
+                "RTKLLAAAIAAAPT",
+                "PAAALKN",
+                "FMWMAAARKLAAAMN"
+            ), false
+        );
+        LOCAL (database);
+
+        /** We build an index and save it. */
+        DatabaseIndex* index = new DatabaseIndex (database, modelSpan3);
+        LOCAL (index);
+        index->build ();
+        u_int64_t signature = index->getSignature();
+        CPPUNIT_ASSERT (index->save (uri, signature) == true);
+
+        /** We load the saved index into another index for the same database. */
+        DatabaseIndex* loadedIndex = new DatabaseIndex (database, modelSpan3);
+        LOCAL (loadedIndex);
+        CPPUNIT_ASSERT (loadedIndex->getSignature() == signature);
+        CPPUNIT_ASSERT (loadedIndex->load (uri, signature+1) == false);
+        CPPUNIT_ASSERT (loadedIndex->load (uri, signature)   == true);
+
+        /** Both indexes must have the same occurrences. */
+        CPPUNIT_ASSERT (loadedIndex->getTotalOccurrenceNumber() == index->getTotalOccurrenceNumber());
+
+        ISeedIterator* itSeed = modelSpan3->createAllSeedsIterator();
+        LOCAL (itSeed);
+
+        size_t nbOccurrences = 0;
+        for (itSeed->first(); !itSeed->isDone(); itSeed->next())
+        {
+            const ISeed* seed = itSeed->currentItem();
+            CPPUNIT_ASSERT (loadedIndex->getOccurrenceNumber(seed) == index->getOccurrenceNumber(seed));
+
+            /** Both indexes must provide the same neighbourhoods. */
+            IOccurrenceBlockIterator* itBlock       = index->createOccurrenceBlockIterator       (seed, 4, 100);
+            IOccurrenceBlockIterator* itLoadedBlock = loadedIndex->createOccurrenceBlockIterator (seed, 4, 100);
+            if (itBlock == 0)  {  CPPUNIT_ASSERT (itLoadedBlock == 0);  continue;  }
+            LOCAL (itBlock);
+            LOCAL (itLoadedBlock);
+
+            for (itBlock->first(), itLoadedBlock->first(); !itBlock->isDone(); itBlock->next(), itLoadedBlock->next())
+            {
+                CPPUNIT_ASSERT (itLoadedBlock->isDone() == false);
+
+                Vector<const ISeedOccurrence*>& table       = itBlock->currentItem();
+                Vector<const ISeedOccurrence*>& loadedTable = itLoadedBlock->currentItem();
+                CPPUNIT_ASSERT (table.size == loadedTable.size);
+
+                for (size_t i=0; i<table.size; i++, nbOccurrences++)
+                {
+                    CPPUNIT_ASSERT (table.data[i]->offsetInDatabase == loadedTable.data[i]->offsetInDatabase);
+                    CPPUNIT_ASSERT (table.data[i]->neighbourhood.toString() == loadedTable.data[i]->neighbourhood.toString());
+                }
+            }
+        }
+        CPPUNIT_ASSERT (nbOccurrences == index->getTotalOccurrenceNumber());
+
+        /** The saved index must be rejected for another database. */
+        ISequenceDatabase* otherDatabase = new BufferedSequenceDatabase (
+            new StringSequenceIterator (3,
+                "RTKLLAAAIAAAPT",
+                "PAAALKN",
+                "FMWMAAARKLAAAMQ"
+            ), false
+        );
+        LOCAL (otherDatabase);
+
+        DatabaseIndex* otherIndex = new DatabaseIndex (otherDatabase, modelSpan3);
+        LOCAL (otherIndex);
+        CPPUNIT_ASSERT (otherIndex->load (uri, otherIndex->getSignature()) == false);
+
+        remove (uri);
+    }
+
+    /********************************************************************************/
+    /* */
+    /********************************************************************************/
+    void testIndexOccurrenceBlockIterator ()
+    {
+        /** We create a database from an iterator. */
+        ISequenceDatabase* database = new BufferedSequenceDatabase (
+            new StringSequenceIterator (2,
+                "MKVMKVMKVMKVMKV",
+                "LLAMKVPTN"
+            ), false
+        );
+        CPPUNIT_ASSERT (database != 0);
+
+        /** We create an index for this model. */
+        IDatabaseIndex* index = new DatabaseIndex (database, modelSpan3);
+        CPPUNIT_ASSERT (index != 0);
+        LOCAL (index);
+
+        /** We build the index. */
+        index->build ();
+
+        /** We look for the seed having the biggest number of occurrences. */
+        ISeed  seed;
+        size_t nbMax = 0;
+        ISeedIterator* itSeed = modelSpan3->createAllSeedsIterator ();
+        LOCAL (itSeed);
+        for (itSeed->first(); !itSeed->isDone(); itSeed->next())
+        {
+            size_t nb = index->getOccurrenceNumber (itSeed->currentItem());
+            if (nb > nbMax)  {  seed = *itSeed->currentItem();  nbMax = nb;  }
+        }
+
+        CPPUNIT_ASSERT (nbMax >= 4);
+
+        /** We retrieve all the occurrences by blocks of 2 occurrences. */
+        vector<Offset> all;
+        IOccurrenceBlockIterator* itAll = index->createOccurrenceBlockIterator (&seed, 4, 2);
+        CPPUNIT_ASSERT (itAll != 0);
+        LOCAL (itAll);
+
+        size_t nbBlocks = 0;
+        for (itAll->first(); ! itAll->isDone(); itAll->next(), nbBlocks++)
+        {
+            Vector<const ISeedOccurrence*>& table = itAll->currentItem();
+            for (size_t i=0; i<table.size; i++)  { all.push_back (table.data[i]->offsetInDatabase); }
+        }
+        CPPUNIT_ASSERT (nbBlocks   == (nbMax+1)/2);
+        CPPUNIT_ASSERT (all.size() == nbMax);
+
+        /** We retrieve the occurrences [1,3] by blocks of 2 occurrences. */
+        vector<Offset> part;
+        IOccurrenceBlockIterator* itPart = index->createOccurrenceBlockIterator (&seed, 4, 2, Range<size_t>(1,3));
+        CPPUNIT_ASSERT (itPart != 0);
+        LOCAL (itPart);
+
+        nbBlocks = 0;
+        for (itPart->first(); ! itPart->isDone(); itPart->next(), nbBlocks++)
+        {
+            Vector<const ISeedOccurrence*>& table = itPart->currentItem();
+            for (size_t i=0; i<table.size; i++)  { part.push_back (table.data[i]->offsetInDatabase); }
+        }
+        CPPUNIT_ASSERT (nbBlocks    == 2);
+        CPPUNIT_ASSERT (part.size() == 3);
+
+        for (size_t i=0; i<part.size(); i++)  {  CPPUNIT_ASSERT (part[i] == all[i+1]);  }
+
+        /** A range beyond the occurrences is truncated. */
+        IOccurrenceBlockIterator* itLast = index->createOccurrenceBlockIterator (&seed, 4, 10, Range<size_t>(nbMax-1,nbMax+20));
+        CPPUNIT_ASSERT (itLast != 0);
+        LOCAL (itLast);
+
+        itLast->first();
+        CPPUNIT_ASSERT (itLast->isDone() == false);
+        CPPUNIT_ASSERT (itLast->currentItem().size == 1);
+        CPPUNIT_ASSERT (itLast->currentItem().data[0]->offsetInDatabase == all[nbMax-1]);
+        itLast->next();
+        CPPUNIT_ASSERT (itLast->isDone() == true);
+
+        /** A range starting after the last occurrence gives no iterator. */
+        CPPUNIT_ASSERT (index->createOccurrenceBlockIterator (&seed, 4, 10, Range<size_t>(nbMax,nbMax+20)) == 0);
+    }
+
     /********************************************************************************/
     /* */
     /********************************************************************************/
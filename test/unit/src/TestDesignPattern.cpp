@@ -102,6 +102,7 @@ public:
          result->addTest (new TestCaller<TestDesignPattern> ("testTokenizer",           &TestDesignPattern::testTokenizer) );
          result->addTest (new TestCaller<TestDesignPattern> ("testWrapper",             &TestDesignPattern::testWrapper) );
          result->addTest (new TestCaller<TestDesignPattern> ("testCommandFactories",    &TestDesignPattern::testCommandFactories) );
+         result->addTest (new TestCaller<TestDesignPattern> ("testThreadPoolDispatcher",&TestDesignPattern::testThreadPoolDispatcher) );
          result->addTest (new TestCaller<TestDesignPattern> ("testSystemCommand",       &TestDesignPattern::testSystemCommand) );
          result->addTest (new TestCaller<TestDesignPattern> ("testProperties",          &TestDesignPattern::testProperties) );
          result->addTest (new TestCaller<TestDesignPattern> ("testXmlReader",           &TestDesignPattern::testXmlReader) );
@@ -432,6 +433,93 @@ public:
         dispatcher.dispatchCommands (commands, 0);
     }
 
+    /********************************************************************************/
+    class CountCommand : public ICommand
+    {
+    public:
+        CountCommand (int* counter, ICommandDispatcher* nested=0) : _counter(counter), _nested(nested)  {}
+
+        void execute ()
+        {
+            /** We may dispatch commands from a worker thread of the dispatcher. */
+            if (_nested != 0)
+            {
+                list<ICommand*> commands;
+                for (size_t i=0; i<10; i++)  {  commands.push_back (new CountCommand (_counter));  }
+                _nested->dispatchCommands (commands, 0);
+            }
+            __sync_fetch_and_add (_counter, 1);
+        }
+
+    private:
+        int*                _counter;
+        ICommandDispatcher* _nested;
+    };
+
+    /** Command failing on execution. */
+    class FailCommand : public ICommand
+    {
+    public:
+        void execute ()  {  throw "command failure";  }
+    };
+
+    /** */
+    void testThreadPoolDispatcher ()
+    {
+        ThreadPoolCommandDispatcher* dispatcher = new ThreadPoolCommandDispatcher (4);
+        LOCAL (dispatcher);
+
+        CPPUNIT_ASSERT (dispatcher->getExecutionUnitsNumber() == 4);
+
+        /** The same threads are used for several dispatches, with more commands than threads. */
+        for (size_t loop=0; loop<50; loop++)
+        {
+            int counter = 0;
+            int post    = 0;
+
+            list<ICommand*> commands;
+            for (size_t i=0; i<37; i++)  {  commands.push_back (new CountCommand (&counter));  }
+
+            dispatcher->dispatchCommands (commands, new CountCommand (&post));
+
+            CPPUNIT_ASSERT (counter == 37);
+            CPPUNIT_ASSERT (post    == 1);
+        }
+
+        /** Commands dispatching other commands through the same pool. */
+        int counter = 0;
+        list<ICommand*> commands;
+        for (size_t i=0; i<8; i++)  {  commands.push_back (new CountCommand (&counter, dispatcher));  }
+        dispatcher->dispatchCommands (commands, 0);
+        CPPUNIT_ASSERT (counter == 8*11);
+
+        /** Empty list of commands. */
+        dispatcher->dispatchCommands (list<ICommand*>(), 0);
+
+        /** A failing command: the other commands are done and the error is thrown in the calling thread. */
+        for (size_t loop=0; loop<10; loop++)
+        {
+            int counter = 0;
+            list<ICommand*> failing;
+            for (size_t i=0; i<16; i++)  {  failing.push_back (new CountCommand (&counter));  }
+            failing.push_back (new FailCommand ());
+
+            const char* error = 0;
+            try  {  dispatcher->dispatchCommands (failing, 0);  }
+            catch (const char* e)  {  error = e;  }
+
+            CPPUNIT_ASSERT (error != 0 && strcmp (error, "command failure") == 0);
+            CPPUNIT_ASSERT (counter == 16);
+        }
+
+        /** The workers are still alive after the failure. */
+        counter = 0;
+        commands.clear ();
+        for (size_t i=0; i<8; i++)  {  commands.push_back (new CountCommand (&counter));  }
+        dispatcher->dispatchCommands (commands, 0);
+        CPPUNIT_ASSERT (counter == 8);
+    }
+
     /** */
     void testSystemCommand ()
     {
@@ -19,6 +19,9 @@
 #include <designpattern/api/ICommand.hpp>
 #include <designpattern/impl/CommandDispatcher.hpp>
 #include <misc/api/types.hpp>
+#include <os/impl/ArenaMemory.hpp>
+#include <os/impl/DefaultOsFactory.hpp>
+#include <os/impl/AsyncFileWriter.hpp>
 
 #include <math.h>
 #include <stdlib.h>
@@ -55,6 +58,8 @@ public:
          TestSuite* result = new TestSuite ("OsTest");
 
          result->addTest (new TestCaller<TestOs> ("testMemory", &TestOs::testMemory ) );
+         result->addTest (new TestCaller<TestOs> ("testArenaMemory", &TestOs::testArenaMemory ) );
+         result->addTest (new TestCaller<TestOs> ("testAsyncFileWriter", &TestOs::testAsyncFileWriter ) );
          result->addTest (new TestCaller<TestOs> ("testVector", &TestOs::testVector ) );
          result->addTest (new TestCaller<TestOs> ("testThread1", &TestOs::testThread1) );
 
@@ -68,6 +73,120 @@ public:
         CPPUNIT_ASSERT (true);
     }
 
+    /********************************************************************************/
+    /********************************************************************************/
+    void testArenaMemory ()
+    {
+        /** We use small chunks in order to check allocations across several chunks. */
+        ArenaMemoryAllocator arena (256);
+
+        char* b1 = (char*) arena.malloc (10);
+        char* b2 = (char*) arena.calloc (20, sizeof(int));
+        CPPUNIT_ASSERT (b1 != 0  &&  b2 != 0);
+        CPPUNIT_ASSERT (((size_t)b1 % 16) == 0  &&  ((size_t)b2 % 16) == 0);
+        for (size_t i=0; i<20*sizeof(int); i++)  { CPPUNIT_ASSERT (b2[i] == 0); }
+
+        /** The last buffer is enlarged in place. */
+        memset (b2, 7, 20*sizeof(int));
+        CPPUNIT_ASSERT (arena.realloc (b2, 30*sizeof(int)) == b2);
+
+        /** A buffer bigger than the chunks. */
+        char* b3 = (char*) arena.realloc (b1, 1000);
+        CPPUNIT_ASSERT (b3 != b1);
+        CPPUNIT_ASSERT (arena.getStats().capacity >= 256 + 1000);
+
+        /** The buffers freed in the reverse order of their allocation are reused. */
+        char* b4 = (char*) arena.malloc (16);
+        arena.free (b4);
+        CPPUNIT_ASSERT (arena.malloc (16) == b4);
+
+        CPPUNIT_ASSERT (arena.getStats().nbAllocs == 5);
+
+        /** After a reset, the memory of the first chunk is reused. */
+        arena.reset ();
+        char* b5 = (char*) arena.malloc (10);
+        CPPUNIT_ASSERT (b5 == b1);
+        CPPUNIT_ASSERT (arena.getStats().nbResets == 1);
+
+        /** A buffer allocated before the reset is already released: freeing it must not release b5. */
+        arena.free (b4);
+        CPPUNIT_ASSERT (arena.malloc (16) == b5 + 32);
+
+        /** Each thread has its own arena. */
+        CPPUNIT_ASSERT (&ArenaMemoryAllocator::local() == &ArenaMemoryAllocator::local());
+        CPPUNIT_ASSERT (ArenaMemoryAllocator::getGlobalStats().capacity >= ArenaMemoryAllocator::local().getStats().capacity);
+
+        /** An arena given back by its thread is reused by the next thread. */
+        ArenaMemoryAllocator* released = &ArenaMemoryAllocator::local();
+        ArenaMemoryAllocator::releaseLocal ();
+
+        ArenaMemoryAllocator* reused = 0;
+        IThread* thread = DefaultFactory::thread().newThread (arenaLoop, &reused);
+        thread->join ();
+        delete thread;
+
+        CPPUNIT_ASSERT (reused == released);
+    }
+
+    /********************************************************************************/
+    static void* arenaLoop (void* args)
+    {
+        *((ArenaMemoryAllocator**) args) = &ArenaMemoryAllocator::local();
+        ArenaMemoryAllocator::releaseLocal ();
+        return 0;
+    }
+
+    /********************************************************************************/
+    /********************************************************************************/
+    void testAsyncFileWriter ()
+    {
+        const char* uri = "/tmp/testAsyncFileWriter";
+
+        string expected;
+        char   buffer[64];
+
+        double values[] = { 0.125, 0.375, 1.005, 9.96, 99.995, 0.00095, 1e-100, 123456.789, 0.0, -2.5 };
+        size_t nbValues = sizeof(values)/sizeof(values[0]);
+
+        {
+            /** We use small buffers in order to go through the ring several times. */
+            AsyncFileWriter writer (uri, 64, 3);
+            CPPUNIT_ASSERT (writer.isOpen());
+
+            for (size_t loop=0; loop<100; loop++)
+            {
+                for (size_t i=0; i<nbValues; i++)
+                {
+                    writer.writeFixed    (values[i], 2);     snprintf (buffer, sizeof(buffer), "%.2lf",  values[i]);  expected += buffer;
+                    writer.write ('\t');                                                                              expected += '\t';
+                    writer.writeFixed    (values[i], 0, 5);  snprintf (buffer, sizeof(buffer), "%5.0lf", values[i]);  expected += buffer;
+                    writer.write ('\t');                                                                              expected += '\t';
+                    writer.writeExponent (values[i], 0, 3);  snprintf (buffer, sizeof(buffer), "%3.0le", values[i]);  expected += buffer;
+                    writer.write ('\t');                                                                              expected += '\t';
+                    writer.writeInteger  ((int)loop - 50);   snprintf (buffer, sizeof(buffer), "%d", (int)loop - 50); expected += buffer;
+                    writer.print ("\t%s\n", "end");                                                                   expected += "\tend\n";
+                }
+            }
+
+            /** The position includes the data not written yet. */
+            CPPUNIT_ASSERT (writer.tell() == expected.size());
+        }
+
+        /** We read the file back. */
+        string content;
+        FILE* file = fopen (uri, "rb");
+        CPPUNIT_ASSERT (file != 0);
+        size_t nb = 0;
+        while ( (nb = fread (buffer, 1, sizeof(buffer), file)) > 0)  { content.append (buffer, nb); }
+        fclose (file);
+        remove (uri);
+
+        CPPUNIT_ASSERT (content == expected);
+
+        /** A file that can't be created must not be silently ignored. */
+        CPPUNIT_ASSERT_THROW (AsyncFileWriter ("/nonexistent/dir/testAsyncFileWriter"), const char*);
+    }
+
     /********************************************************************************/
     /********************************************************************************/
     void testVector ()
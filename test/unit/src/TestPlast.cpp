@@ -49,6 +49,8 @@ using namespace algo::core;
 using namespace algo::core::impl;
 using namespace alignment::core;
 using namespace launcher::core;
+
+extern const char* getPath (const char* file);
 /********************************************************************************/
 
 class TestPlast : public TestFixture
@@ -72,6 +74,7 @@ public:
     	 TestSuite* result = new TestSuite ("PlastTest");
          //result->addTest (new TestCaller<TestPlast> ("test_plast1", &TestPlast::test_plast1) );
          result->addTest (new TestCaller<TestPlast> ("test_plast2", &TestPlast::test_plast2) );
+         result->addTest (new TestCaller<TestPlast> ("test_blocks_in_flight", &TestPlast::test_blocks_in_flight) );
          return result;
     }
 
@@ -176,6 +179,78 @@ public:
         thread->join ();
         delete thread;
     }
+
+    /********************************************************************************/
+    static string readFile (const char* filename)
+    {
+        string result;
+        char buffer[4*1024];
+
+        FILE* file = fopen (filename, "r");
+        CPPUNIT_ASSERT (file != 0);
+        for (size_t n=0; (n = fread (buffer, 1, sizeof(buffer), file)) > 0; )  {  result.append (buffer, n);  }
+        fclose (file);
+
+        return result;
+    }
+
+    /********************************************************************************/
+    void test_blocks_in_flight_aux (
+        const char* algo,
+        const char* subject,
+        const char* query,
+        const char* maxDbSize,
+        const char* inflight,
+        const char* output
+    )
+    {
+        string subjectPath = getPath (subject);
+        string queryPath   = getPath (query);
+
+        IProperties* props = new Properties ();
+        LOCAL (props);
+        props->add (0, "-p",                 algo);
+        props->add (0, "-d",                 subjectPath.c_str());
+        props->add (0, "-i",                 queryPath.c_str());
+        props->add (0, "-o",                 output);
+        props->add (0, "-a",                 "1");
+        props->add (0, "-e",                 "10");
+        props->add (0, "-max-database-size", maxDbSize);
+        props->add (0, "-blocks-in-flight",  inflight);
+
+        PlastCmd* plast = new PlastCmd (props);
+        LOCAL (plast);
+        plast->execute ();
+    }
+
+    /********************************************************************************/
+    void test_blocks_in_flight_compare (const char* algo, const char* subject, const char* query, const char* maxDbSize)
+    {
+        test_blocks_in_flight_aux (algo, subject, query, maxDbSize, "1", "/tmp/plast_inflight1.out");
+        test_blocks_in_flight_aux (algo, subject, query, maxDbSize, "2", "/tmp/plast_inflight2.out");
+
+        string out1 = readFile ("/tmp/plast_inflight1.out");
+        string out2 = readFile ("/tmp/plast_inflight2.out");
+
+        CPPUNIT_ASSERT (out1.empty() == false);
+        CPPUNIT_ASSERT (out1 == out2);
+
+        remove ("/tmp/plast_inflight1.out");
+        remove ("/tmp/plast_inflight2.out");
+    }
+
+    /********************************************************************************/
+    /*  The databases are segmented in several blocks; overlapping the reading and  */
+    /*  output of the blocks with the alignments must not change the result. For   */
+    /*  plastx and tplastn, the reading frames databases of the blocks are created  */
+    /*  in parallel, so their addresses (and the order of their alignments) vary.   */
+    /********************************************************************************/
+    void test_blocks_in_flight ()
+    {
+        test_blocks_in_flight_compare ("plastp",  "query.fa",     "query.fa",     "10000");
+        test_blocks_in_flight_compare ("plastx",  "query.fa",     "bug15696.fa",  "5000");
+        test_blocks_in_flight_compare ("tplastn", "bug15696.fa",  "query.fa",     "5000");
+    }
 };
 
 /********************************************************************************/
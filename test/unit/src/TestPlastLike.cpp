@@ -39,11 +39,20 @@
 #include <algo/core/impl/BasicAlgoIndexator.hpp>
 #include <algo/core/impl/ScoreMatrix.hpp>
 
+#include <algo/hits/ungap/UngapHitIteratorSSE16.hpp>
+#include <algo/hits/ungap/UngapHitIteratorAVX2.hpp>
+#include <algo/hits/ungap/UngapHitIteratorAVX512.hpp>
 #include <algo/hits/seed/SeedHitIterator.hpp>
 #include <algo/hits/gap/SmallGapHitIterator.hpp>
 #include <algo/hits/gap/SmallGapHitIteratorSSE8.hpp>
+#include <algo/hits/gap/SmallGapHitIteratorAVX2.hpp>
+#include <algo/hits/gap/SmallGapHitIteratorAVX512.hpp>
+#include <algo/hits/hsp/HspGeneratorCmd.hpp>
+
+#include <alignment/core/impl/NullAlignmentContainer.hpp>
 
 #include <map>
+#include <stdlib.h>
 
 using namespace std;
 using namespace misc;
@@ -60,6 +69,113 @@ using namespace indexation::impl;
 using namespace algo::core;
 using namespace algo::core::impl;
 using namespace algo::hits;
+using namespace algo::hits::ungapped;
+using namespace algo::hits::gapped;
+using namespace algo::hits::hsp;
+using namespace alignment::core;
+using namespace alignment::core::impl;
+
+/********************************************************************************/
+
+/** Gives access to the scores computation of a small gap kernel. */
+template<class Kernel> class SmallGapScores : public Kernel
+{
+public:
+    SmallGapScores (IScoreMatrix* scoreMatrix, IParameters* params) : Kernel (0, 0, scoreMatrix, params, 0, 0)  {}
+
+    void compute (size_t nb, const LETTER* neighbourhoods1, const LETTER* neighbourhoods2, int* scores)
+    {
+        this->computeScores (nb, neighbourhoods1, neighbourhoods2, scores);
+    }
+};
+
+/********************************************************************************/
+
+/** Letter by letter ungapped extensions of a plastn seed, used as reference for the HSPGenerator ones. */
+static bool isSeenSeed (const u_int8_t* mask, int code)  {  return (mask[code >> 3] & (1 << (code & 7))) != 0;  }
+
+static int extensionRightScalar (const HSPGenerator::ExtensionParams& params, int code, const LETTER* s1, const LETTER* s2, size_t& length, size_t span, bool& alreadySeen)
+{
+    int code_ss1 = code;
+    alreadySeen = false;
+
+    size_t  nbMatch = span;
+    int32_t score   = nbMatch * params.match;
+    int32_t maxi    = score;
+
+    int32_t bitshift = 2*(span-1);
+    int32_t bitmask  = (1 << (2*span)) - 1;
+
+    u_int32_t kmaxi=span;
+    for (u_int32_t k=span;  (maxi-score) <= params.xdrop  &&  k<length;  k++)
+    {
+        code_ss1 = ((code_ss1 >> 2)  +  (s1[k] << bitshift)) & bitmask;
+
+        if (s1[k] == s2[k]  &&  s1[k] < params.badLetter)
+        {
+            score += params.match;
+            nbMatch++;
+
+            if (score > maxi)  {  maxi = score;  kmaxi = k;  }
+
+            if (params.extraSpan==0  &&  nbMatch >= span  &&  code_ss1 < code  &&  isSeenSeed (params.mask, code_ss1))
+            {
+                alreadySeen = true;
+                break;
+            }
+        }
+        else
+        {
+            score  += params.mismatch;
+            nbMatch = 0;
+        }
+    }
+
+    length = kmaxi + 1;
+    return maxi;
+}
+
+static int extensionLeftScalar (const HSPGenerator::ExtensionParams& params, int code, const LETTER* s1, const LETTER* s2, size_t& length, size_t span, bool& alreadySeen)
+{
+    int code_ss1 = code;
+    alreadySeen = false;
+
+    size_t  nbMatch = span;
+    int32_t score   = nbMatch * params.match;
+    int32_t maxi    = score;
+
+    int32_t bitmask = (1 << (2*span)) - 1;
+
+    u_int32_t kmaxi=0;
+    for (u_int32_t k=0;  (maxi-score) <= params.xdrop  &&  k<length;  k++)
+    {
+        LETTER letter = s1[-1-(int)k];
+
+        code_ss1 = ((code_ss1 << 2) & bitmask) + (letter & 3);
+
+        if (letter == s2[-1-(int)k]  &&  letter < params.badLetter)
+        {
+            score += params.match;
+            nbMatch++;
+
+            if (score > maxi)  {  maxi = score;  kmaxi = k;  }
+
+            if (params.extraSpan==0  &&  nbMatch >= span  &&  code_ss1 < code  &&  isSeenSeed (params.mask, code_ss1))
+            {
+                alreadySeen = true;
+                break;
+            }
+        }
+        else
+        {
+            score  += params.mismatch;
+            nbMatch = 0;
+        }
+    }
+
+    length = kmaxi + 1;
+    return maxi;
+}
 
 /********************************************************************************/
 
@@ -110,6 +226,11 @@ public:
     {
     	 TestSuite* result = new TestSuite ("PlastLikeTest");
          result->addTest (new TestCaller<TestPlastLike> ("test_tplastn_unitary", &TestPlastLike::test_tplastn_unitary ) );
+         result->addTest (new TestCaller<TestPlastLike> ("test_ungap_kernels",   &TestPlastLike::test_ungap_kernels ) );
+         result->addTest (new TestCaller<TestPlastLike> ("test_ungap_profiles_cache", &TestPlastLike::test_ungap_profiles_cache ) );
+         result->addTest (new TestCaller<TestPlastLike> ("test_ungap_profiles_cache_seeds", &TestPlastLike::test_ungap_profiles_cache_seeds ) );
+         result->addTest (new TestCaller<TestPlastLike> ("test_smallgap_kernels", &TestPlastLike::test_smallgap_kernels ) );
+         result->addTest (new TestCaller<TestPlastLike> ("test_hsp_extensions",   &TestPlastLike::test_hsp_extensions ) );
          return result;
     }
 
@@ -436,6 +557,482 @@ public:
 
         //printf ("FOUND: %d SEEDS ALIGNEMENTS,  %d UNGAP ALIGNMENTS \n", _nbSeedsAlignments, _nbUngapsAlignments);
     }
+
+    /********************************************************************************/
+    /** Writes random proteins holding a mutated copy of a common motif (so some seeds have
+     *  many occurrences in both databases). */
+    void writeProteins (const char* filename, size_t nbSequences, size_t length, const char* motif, unsigned int seed)
+    {
+        static const char* letters = "ACDEFGHIKLMNPQRSTVWY";
+
+        srand (seed);
+
+        FILE* file = fopen (filename, "w");
+        CPPUNIT_ASSERT (file != 0);
+
+        for (size_t n=0; n<nbSequences; n++)
+        {
+            string data;
+            for (size_t i=0; i<length; i++)  {  data += letters [rand() % 20];  }
+
+            string copy (motif);
+            for (size_t i=0; i<copy.size(); i++)  {  if (rand() % 8 == 0)  { copy[i] = letters [rand() % 20]; }  }
+            data.replace (rand() % (length - copy.size()), copy.size(), copy);
+
+            fprintf (file, ">seq%ld\n%s\n", n, data.c_str());
+        }
+
+        fclose (file);
+    }
+
+    /********************************************************************************/
+    /** Writes random proteins holding many copies of a word, separated by random letters
+     *  (so the seeds of the word have many occurrences with different neighbourhoods). */
+    void writeRepeats (const char* filename, size_t nbSequences, size_t nbCopies, const char* word, unsigned int seed)
+    {
+        static const char* letters = "ACDEFGHIKLMNPQRSTVWY";
+
+        srand (seed);
+
+        FILE* file = fopen (filename, "w");
+        CPPUNIT_ASSERT (file != 0);
+
+        for (size_t n=0; n<nbSequences; n++)
+        {
+            string data;
+            for (size_t c=0; c<nbCopies; c++)
+            {
+                size_t spacing = 6 + rand() % 10;
+                for (size_t i=0; i<spacing; i++)  {  data += letters [rand() % 20];  }
+                data += word;
+            }
+
+            fprintf (file, ">seq%ld\n%s\n", n, data.c_str());
+        }
+
+        fclose (file);
+    }
+
+    /********************************************************************************/
+    vector<pair<u_int32_t,u_int32_t> > _ungapHits;
+
+    /** Profiles cache statistics of the last computeUngapHits. */
+    u_int64_t _profilesHits;
+    u_int64_t _profilesMisses;
+
+    /** Memorizes the (subject offset, query offset) of the hits forwarded by an ungap iterator. */
+    void ungapHits_aux (Hit* hit)
+    {
+        IdxCoupleBuffer& indexes = hit->indexes;
+        for (size_t it=indexes.first(); it != indexes.end(); it=indexes.next(it))
+        {
+            _ungapHits.push_back (make_pair (
+                hit->occur1.data[indexes[it].first]->offsetInDatabase,
+                hit->occur2.data[indexes[it].second]->offsetInDatabase
+            ));
+        }
+    }
+
+    /** Returns the hits forwarded by an ungap iterator on the seeds hits of two databases. */
+    vector<pair<u_int32_t,u_int32_t> > computeUngapHits (
+        const string&       kernel,
+        ISequenceDatabase*  subjectDatabase,
+        ISequenceDatabase*  queryDatabase,
+        ISeedModel*         seedModel,
+        IScoreMatrix*       scoreMatrix,
+        IParameters*        params,
+        size_t              profilesCacheSize = UngapHitIteratorSSE16::PROFILES_CACHE_SIZE
+    )
+    {
+        bool isRunning = true;
+
+        ICommandDispatcher* dispatcher = new SerialCommandDispatcher ();
+        LOCAL (dispatcher);
+
+        IIndexator* indexator = new BasicSortedIndexator (seedModel, params, new DatabaseIndexFactory(), 1.0, isRunning);
+        LOCAL (indexator);
+
+        indexator->setSubjectDatabase (subjectDatabase);
+        indexator->setQueryDatabase   (queryDatabase);
+        indexator->build (dispatcher);
+
+        IHitIterator* itHit = indexator->createHitIterator();
+        CPPUNIT_ASSERT (itHit != 0);
+        LOCAL (itHit);
+
+        IAlignmentContainer* ungapResult = new NullAlignmentResult ();
+        LOCAL (ungapResult);
+
+        UngapHitIteratorSSE16* ungap = 0;
+        if (kernel == "SSE16")   { ungap = new UngapHitIteratorSSE16  (itHit, seedModel, scoreMatrix, params, ungapResult, 0, isRunning); }
+        if (kernel == "AVX2")    { ungap = new UngapHitIteratorAVX2   (itHit, seedModel, scoreMatrix, params, ungapResult, 0, isRunning); }
+        if (kernel == "AVX512")  { ungap = new UngapHitIteratorAVX512 (itHit, seedModel, scoreMatrix, params, ungapResult, 0, isRunning); }
+        CPPUNIT_ASSERT (ungap != 0);
+        LOCAL (ungap);
+
+        ungap->setProfilesCacheSize (profilesCacheSize);
+
+        _ungapHits.clear ();
+        ungap->iterate (this, (Iterator<Hit*>::Method) &TestPlastLike::ungapHits_aux);
+
+        IProperties* props = ungap->getProperties();
+        LOCAL (props);
+        _profilesHits   = props->getProperty ("hits")->getInt();
+        _profilesMisses = props->getProperty ("misses")->getInt();
+
+        return _ungapHits;
+    }
+
+    /********************************************************************************/
+    void test_ungap_kernels ()
+    {
+        const char* subjectName = "/tmp/ungap_subject.fa";
+        const char* queryName   = "/tmp/ungap_query.fa";
+
+        /** The motif is shared by all the sequences, so its seeds have more than 64 occurrences
+         *  (several groups for the wide kernels, with a partial last group). */
+        const char* motif = "MKWVTFISLLFLFSSAYSRGVFRRDAHKSEVAHRFKDLGEE";
+
+        writeProteins (subjectName, 150, 200, motif, 1);
+        writeProteins (queryName,   110, 200, motif, 2);
+
+        ISequenceDatabase* subjectDatabase = new BufferedSequenceDatabase (new FastaSequenceIterator (subjectName), false);
+        LOCAL (subjectDatabase);
+
+        ISequenceDatabase* queryDatabase = new BufferedSequenceDatabase (new FastaSequenceIterator (queryName), false);
+        LOCAL (queryDatabase);
+
+        ISeedModel* seedModel = new SubSeedModel (4,
+            "A,C,D,E,F,G,H,I,K,L,M,N,P,Q,R,S,T,V,W,Y",
+            "CFYWMLIV,GPATSNHQEDRK",
+            "A,C,FYW,G,IV,ML,NH,P,QED,RK,TS",
+            "A,C,D,E,F,G,H,I,K,L,M,N,P,Q,R,S,T,V,W,Y"
+        );
+        LOCAL (seedModel);
+
+        IScoreMatrix* scoreMatrix = ScoreMatrixManager::singleton().getMatrix ("BLOSUM62", SUBSEED, 0, 0);
+        LOCAL (scoreMatrix);
+
+        IParameters* params = _config->createDefaultParameters ("plastp");
+        LOCAL (params);
+
+        vector<pair<u_int32_t,u_int32_t> > ref = computeUngapHits ("SSE16", subjectDatabase, queryDatabase, seedModel, scoreMatrix, params);
+        CPPUNIT_ASSERT (ref.empty() == false);
+
+        /** The wide kernels must forward the same hits in the same order (the CPU may not support them). */
+        if (UngapHitIteratorAVX2::isSupported())
+        {
+            CPPUNIT_ASSERT (computeUngapHits ("AVX2",   subjectDatabase, queryDatabase, seedModel, scoreMatrix, params) == ref);
+        }
+        if (UngapHitIteratorAVX512::isSupported())
+        {
+            CPPUNIT_ASSERT (computeUngapHits ("AVX512", subjectDatabase, queryDatabase, seedModel, scoreMatrix, params) == ref);
+        }
+
+        remove (subjectName);
+        remove (queryName);
+    }
+
+    /********************************************************************************/
+    void test_ungap_profiles_cache ()
+    {
+        const char* subjectName = "/tmp/profiles_subject.fa";
+        const char* queryName   = "/tmp/profiles_query.fa";
+
+        /** The seeds of the word have more than 20000 subject occurrences, so they are cut into several
+         *  subject blocks and their query blocks come back. Their 4000 query occurrences need more
+         *  profiles than the 4 MB of the default cache can hold. */
+        const char* word = "SAAS";
+
+        writeRepeats (subjectName, 300, 72, word, 1);
+        writeRepeats (queryName,    80, 50, word, 2);
+
+        ISequenceDatabase* subjectDatabase = new BufferedSequenceDatabase (new FastaSequenceIterator (subjectName), false);
+        LOCAL (subjectDatabase);
+
+        ISequenceDatabase* queryDatabase = new BufferedSequenceDatabase (new FastaSequenceIterator (queryName), false);
+        LOCAL (queryDatabase);
+
+        ISeedModel* seedModel = new SubSeedModel (4,
+            "A,C,D,E,F,G,H,I,K,L,M,N,P,Q,R,S,T,V,W,Y",
+            "CFYWMLIV,GPATSNHQEDRK",
+            "A,C,FYW,G,IV,ML,NH,P,QED,RK,TS",
+            "A,C,D,E,F,G,H,I,K,L,M,N,P,Q,R,S,T,V,W,Y"
+        );
+        LOCAL (seedModel);
+
+        IScoreMatrix* scoreMatrix = ScoreMatrixManager::singleton().getMatrix ("BLOSUM62", SUBSEED, 0, 0);
+        LOCAL (scoreMatrix);
+
+        IParameters* params = _config->createDefaultParameters ("plastp");
+        LOCAL (params);
+
+        /** Without cache. */
+        vector<pair<u_int32_t,u_int32_t> > ref = computeUngapHits ("SSE16", subjectDatabase, queryDatabase, seedModel, scoreMatrix, params, 0);
+        CPPUNIT_ASSERT (ref.empty() == false);
+        CPPUNIT_ASSERT (_profilesHits == 0  &&  _profilesMisses == 0);
+
+        /** With a cache big enough for all the profiles. */
+        CPPUNIT_ASSERT (computeUngapHits ("SSE16", subjectDatabase, queryDatabase, seedModel, scoreMatrix, params, 64*1024*1024) == ref);
+        u_int64_t allHits   = _profilesHits;
+        u_int64_t allMisses = _profilesMisses;
+        CPPUNIT_ASSERT (allHits > 0);
+
+        /** With the default cache: it is full before the end of the query block, so some profiles
+         *  are built again for each subject block. */
+        CPPUNIT_ASSERT (computeUngapHits ("SSE16", subjectDatabase, queryDatabase, seedModel, scoreMatrix, params) == ref);
+        CPPUNIT_ASSERT (_profilesHits > 0  &&  _profilesHits < allHits);
+        CPPUNIT_ASSERT (_profilesMisses > allMisses);
+
+        /** The wide kernels use the same cache with bigger profiles. */
+        if (UngapHitIteratorAVX2::isSupported())
+        {
+            CPPUNIT_ASSERT (computeUngapHits ("AVX2",   subjectDatabase, queryDatabase, seedModel, scoreMatrix, params) == ref);
+            CPPUNIT_ASSERT (_profilesHits > 0);
+        }
+        if (UngapHitIteratorAVX512::isSupported())
+        {
+            CPPUNIT_ASSERT (computeUngapHits ("AVX512", subjectDatabase, queryDatabase, seedModel, scoreMatrix, params) == ref);
+            CPPUNIT_ASSERT (_profilesHits > 0);
+        }
+
+        remove (subjectName);
+        remove (queryName);
+    }
+
+    /********************************************************************************/
+    /*  The two seeds of the word have more than 20000 subject occurrences, so the  */
+    /*  query blocks of both seeds come back and start at the same occurrences      */
+    /*  indexes; the profiles of a seed must not be used for the other one.         */
+    /********************************************************************************/
+    void test_ungap_profiles_cache_seeds ()
+    {
+        const char* subjectName = "/tmp/profiles_seeds_subject.fa";
+        const char* queryName   = "/tmp/profiles_seeds_query.fa";
+
+        writeRepeats (subjectName, 300, 72, "SAASW", 3);
+        writeRepeats (queryName,    20, 50, "SAASW", 4);
+
+        ISequenceDatabase* subjectDatabase = new BufferedSequenceDatabase (new FastaSequenceIterator (subjectName), false);
+        LOCAL (subjectDatabase);
+
+        ISequenceDatabase* queryDatabase = new BufferedSequenceDatabase (new FastaSequenceIterator (queryName), false);
+        LOCAL (queryDatabase);
+
+        ISeedModel* seedModel = new SubSeedModel (4,
+            "A,C,D,E,F,G,H,I,K,L,M,N,P,Q,R,S,T,V,W,Y",
+            "CFYWMLIV,GPATSNHQEDRK",
+            "A,C,FYW,G,IV,ML,NH,P,QED,RK,TS",
+            "A,C,D,E,F,G,H,I,K,L,M,N,P,Q,R,S,T,V,W,Y"
+        );
+        LOCAL (seedModel);
+
+        IScoreMatrix* scoreMatrix = ScoreMatrixManager::singleton().getMatrix ("BLOSUM62", SUBSEED, 0, 0);
+        LOCAL (scoreMatrix);
+
+        IParameters* params = _config->createDefaultParameters ("plastp");
+        LOCAL (params);
+
+        vector<pair<u_int32_t,u_int32_t> > ref = computeUngapHits ("SSE16", subjectDatabase, queryDatabase, seedModel, scoreMatrix, params, 0);
+        CPPUNIT_ASSERT (ref.empty() == false);
+
+        /** Each seed builds its own profiles, then reuses them for its next subject blocks. */
+        CPPUNIT_ASSERT (computeUngapHits ("SSE16", subjectDatabase, queryDatabase, seedModel, scoreMatrix, params, 64*1024*1024) == ref);
+        CPPUNIT_ASSERT (_profilesHits > 0  &&  _profilesMisses > 0);
+
+        remove (subjectName);
+        remove (queryName);
+    }
+
+    /********************************************************************************/
+    /** Computes small gap scores with a given kernel. */
+    template<class Kernel> vector<int> computeSmallGapScores (
+        IScoreMatrix* scoreMatrix,
+        IParameters*  params,
+        size_t        nb,
+        const vector<LETTER>& neighbourhoods1,
+        const vector<LETTER>& neighbourhoods2
+    )
+    {
+        SmallGapScores<Kernel>* kernel = new SmallGapScores<Kernel> (scoreMatrix, params);
+        LOCAL (kernel);
+
+        vector<int> scores (nb, 0);
+        kernel->compute (nb, &neighbourhoods1[0], &neighbourhoods2[0], &scores[0]);
+        return scores;
+    }
+
+    /********************************************************************************/
+    void test_smallgap_kernels ()
+    {
+        IScoreMatrix* scoreMatrix = ScoreMatrixManager::singleton().getMatrix ("BLOSUM62", SUBSEED, 0, 0);
+        LOCAL (scoreMatrix);
+
+        IParameters* params = _config->createDefaultParameters ("plastp");
+        LOCAL (params);
+
+        size_t length = params->smallGapBandLength;
+
+        srand (3);
+
+        /** Scores numbers that fill the wide registers or not (the remaining scores go to the SSE kernel). */
+        size_t nbList[] = { 8, 16, 24, 32, 40, 56, 64, 72, 200 };
+
+        for (size_t t=0; t<sizeof(nbList)/sizeof(nbList[0]); t++)
+        {
+            size_t nb = nbList[t];
+
+            vector<LETTER> neighbourhoods1 (nb*length);
+            vector<LETTER> neighbourhoods2 (nb*length);
+
+            for (size_t k=0; k<nb; k++)
+            {
+                LETTER* n1 = &neighbourhoods1 [k*length];
+                LETTER* n2 = &neighbourhoods2 [k*length];
+
+                for (size_t i=0; i<length; i++)  {  n2[i] = rand() % 20;  }
+
+                /** Most neighbourhoods are similar (mutations and a gap in the band), some are random. */
+                size_t shift = rand() % 4;
+                for (size_t i=0; i<length; i++)
+                {
+                    if (k % 5 == 4 || rand() % 6 == 0)  {  n1[i] = rand() % 20;  }
+                    else                                {  n1[i] = i < length/2 || i+shift >= length ? n2[i] : n2[i+shift];  }
+                }
+            }
+
+            vector<int> ref = computeSmallGapScores<SmallGapHitIteratorSSE8> (scoreMatrix, params, nb, neighbourhoods1, neighbourhoods2);
+
+            /** We check that we have some scores above the threshold. */
+            int maxScore = 0;
+            for (size_t k=0; k<nb; k++)  {  maxScore = MAX (maxScore, ref[k]);  }
+            CPPUNIT_ASSERT (maxScore >= params->smallGapThreshold);
+
+            if (SmallGapHitIteratorAVX2::isSupported())
+            {
+                CPPUNIT_ASSERT (computeSmallGapScores<SmallGapHitIteratorAVX2>   (scoreMatrix, params, nb, neighbourhoods1, neighbourhoods2) == ref);
+            }
+            if (SmallGapHitIteratorAVX512::isSupported())
+            {
+                CPPUNIT_ASSERT (computeSmallGapScores<SmallGapHitIteratorAVX512> (scoreMatrix, params, nb, neighbourhoods1, neighbourhoods2) == ref);
+            }
+        }
+    }
+
+    /********************************************************************************/
+    /** Checks that the plastn ungapped extensions (16 letters at once) give the same results
+     *  as the letter by letter ones. */
+    void test_hsp_extensions ()
+    {
+        LETTER bad = EncodingManager::singleton().getAlphabet(SUBSEED)->any;
+
+        /** Scores and X-drops: the cut-offs happen inside a block of 16 letters or after several ones. */
+        int32_t scores[][3] = { {1,-3,20}, {1,-3,5}, {2,-3,40}, {1,-2,60}, {1,-1,100}, {5,-4,3} };
+
+        size_t spans[] = { 8, 11 };
+
+        srand (5);
+
+        /** We count the different ways of ending the extensions, in order to check that the test covers them. */
+        size_t nbSeen=0, nbDropped=0, nbFull=0;
+
+        for (size_t sp=0; sp<sizeof(spans)/sizeof(spans[0]); sp++)
+        {
+            size_t span = spans[sp];
+
+            /** A few seeds are said to be already extended. */
+            vector<u_int8_t> mask ((1 << (2*span)) / 8, 0);
+            for (size_t i=0; i<mask.size(); i++)  {  if (rand() % 50 == 0)  {  mask[i] = 1 << (rand() % 8);  }  }
+
+            for (size_t sc=0; sc<sizeof(scores)/sizeof(scores[0]); sc++)
+            {
+                for (size_t extraSpan=0; extraSpan<=1; extraSpan++)
+                {
+                    HSPGenerator::ExtensionParams params;
+                    params.match     = scores[sc][0];
+                    params.mismatch  = scores[sc][1];
+                    params.xdrop     = scores[sc][2];
+                    params.extraSpan = extraSpan;
+                    params.badLetter = bad;
+                    params.mask      = &mask[0];
+
+                    for (size_t t=0; t<300; t++)
+                    {
+                        /** The seed is at 'pos' in two sequences of 'size' letters. */
+                        size_t size = 2*span + rand() % 300;
+                        size_t pos  = rand() % (size - span + 1);
+
+                        /** Letters outside the sequences match, so an extension going past the ends would change the results. */
+                        size_t guard = 64;
+                        vector<LETTER> buf1 (size + 2*guard, 0);
+                        vector<LETTER> buf2 (size + 2*guard, 0);
+                        LETTER* seq1 = &buf1[guard];
+                        LETTER* seq2 = &buf2[guard];
+
+                        /** The second sequence is a mutated copy of the first one, from identical to random. */
+                        int rate = rand() % 6 == 0 ? 75 : (rand() % 6 == 0 ? 0 : rand() % 30);
+                        for (size_t i=0; i<size; i++)
+                        {
+                            seq1[i] = rand() % 4;
+                            seq2[i] = rand() % 100 < rate ? rand() % 4 : seq1[i];
+                        }
+
+                        /** Runs of N or of other non ACGT letters, in one sequence or in both. */
+                        size_t nbRuns = rand() % 3;
+                        for (size_t r=0; r<nbRuns; r++)
+                        {
+                            size_t start = rand() % size;
+                            size_t len   = 1 + rand() % 40;
+                            LETTER other = rand() % 2 ? bad : bad + 1 + rand() % 3;
+                            int    where = rand() % 3;
+                            for (size_t i=start; i<size && i<start+len; i++)
+                            {
+                                if (where != 1)  {  seq1[i] = other;  }
+                                if (where != 0)  {  seq2[i] = other;  }
+                            }
+                        }
+
+                        /** The seed itself matches. */
+                        int code = 0;
+                        for (size_t i=0; i<span; i++)
+                        {
+                            seq1[pos+i] = seq2[pos+i] = rand() % 4;
+                            code += seq1[pos+i] << (2*i);
+                        }
+
+                        /** The extensions go up to the ends of the sequences, or a bit less. */
+                        size_t rightLen = size - pos;
+                        size_t leftLen  = pos;
+                        if (rand() % 3 == 0)  {  rightLen = span + rand() % (rightLen - span + 1);  }
+                        if (rand() % 3 == 0)  {  leftLen  = rand() % (leftLen + 1);  }
+
+                        const LETTER* s1 = seq1 + pos;
+                        const LETTER* s2 = seq2 + pos;
+
+                        size_t rightLen1 = rightLen,  rightLen2 = rightLen;
+                        bool   rightSeen1 = false,    rightSeen2 = true;
+                        int    right1 = extensionRightScalar                (params, code, s1, s2, rightLen1, span, rightSeen1);
+                        int    right2 = HSPGenerator::computeExtensionRight (params, code, s1, s2, rightLen2, span, rightSeen2);
+
+                        CPPUNIT_ASSERT (right1 == right2  &&  rightLen1 == rightLen2  &&  rightSeen1 == rightSeen2);
+
+                        size_t leftLen1 = leftLen,  leftLen2 = leftLen;
+                        bool   leftSeen1 = false,   leftSeen2 = true;
+                        int    left1 = extensionLeftScalar                (params, code, s1, s2, leftLen1, span, leftSeen1);
+                        int    left2 = HSPGenerator::computeExtensionLeft (params, code, s1, s2, leftLen2, span, leftSeen2);
+
+                        CPPUNIT_ASSERT (left1 == left2  &&  leftLen1 == leftLen2  &&  leftSeen1 == leftSeen2);
+
+                        if (rightSeen1 || leftSeen1)                                    {  nbSeen++;    }
+                        else if (rightLen1 == rightLen && leftLen1 == MAX (leftLen,1))  {  nbFull++;    }
+                        else                                                            {  nbDropped++; }
+                    }
+                }
+            }
+        }
+
+        CPPUNIT_ASSERT (nbSeen > 0  &&  nbDropped > 0  &&  nbFull > 0);
+    }
 };
 
 /********************************************************************************/
@@ -31,6 +31,7 @@
 #include <alignment/tools/impl/AlignmentSplitterBanded.hpp>
 
 #include <alignment/tools/impl/SemiGappedAlign.hpp>
+#include <alignment/tools/impl/SemiGappedAlignAVX2.hpp>
 
 using namespace std;
 using namespace os;
@@ -72,6 +73,7 @@ public:
          result->addTest (new TestCaller<TestScoreMatrix> ("testSplitter",        &TestScoreMatrix::testSplitter) );
 //         result->addTest (new TestCaller<TestScoreMatrix> ("testSplitter2",        &TestScoreMatrix::testSplitter2) );
          result->addTest (new TestCaller<TestScoreMatrix> ("testSemiGappedAlign", &TestScoreMatrix::testSemiGappedAlign) );
+         result->addTest (new TestCaller<TestScoreMatrix> ("testSemiGappedAlignAVX2", &TestScoreMatrix::testSemiGappedAlignAVX2) );
          result->addTest (new TestCaller<TestScoreMatrix> ("testDumpMatrix",      &TestScoreMatrix::testDumpMatrix) );
          result->addTest (new TestCaller<TestScoreMatrix> ("testDoubleScore",     &TestScoreMatrix::testDoubleScore) );
 
@@ -914,6 +916,90 @@ public:
         }
     }
 
+    /********************************************************************************/
+    /* Check that the vectorized X-drop extension gives the same results as the reference one. */
+    /********************************************************************************/
+    void testSemiGappedAlignAVX2 ()
+    {
+        const char* seq1 =
+            "MNSSGPGYPLASLYAGDLHPDVTEAMLYEKFSPAGPILSIRVCRDVATRRSLGYAYINFQ" \
+            "QPADAERALDTMNFEVIKGQPIRIMWSQRDPGLRKSGVGNIFIKNLEDSIDNKALYDTFS" \
+            "TFGNILSCKVVCDDHGSRGFGFVHFETHEAAQNAISTMNGMLLNDRKVFVGHFKPRRERD" \
+            "AELGARAMEFTNIYVKNLHVDVDEQCLQDLFSQFGKILSVKVMDDSHPRFGFVNFETHEA";
+
+        /** Same sequence with some substitutions and indels. */
+        const char* seq2 =
+            "MNSSGPGYPLASLYAGDLHPDVTEAMLYEKFSPAGPILSIRVCRDVATRRSLGYAYINFQ" \
+            "QPADAERALDTMNFEVIKGQPIRIKWSQRDPGLRKSGVGNIFIKNLEDSIDNKALYDTFS" \
+            "TFGNILSCKVVCDDHGSGFGFVHFETHEAAQNAISTMNGMLLNDRKAAVFVGHFKPRRERD" \
+            "AELGARAMEFTNIYVKNLHVDVDEQCLQDLFSQFGKILSVKVMDDSHPRFGFVNFETHEA";
+
+        IScoreMatrix* scoreMatrix = ScoreMatrixManager::singleton().getMatrix ("BLOSUM62", SUBSEED, 0, 0);
+        CPPUNIT_ASSERT (scoreMatrix != 0);
+        LOCAL (scoreMatrix);
+
+        ISequenceDatabase* subject = new BufferedSequenceDatabase (new StringSequenceIterator (1, seq1), false);
+        LOCAL (subject);
+
+        ISequenceDatabase* query = new BufferedSequenceDatabase (new StringSequenceIterator (1, seq2), false);
+        LOCAL (query);
+
+        ISequence subjectSeq;   subject->getSequenceByIndex (0, subjectSeq);
+        ISequence querySeq;     query->getSequenceByIndex   (0, querySeq);
+
+        const char* queryData   = querySeq.data.letters.data;
+        const char* subjectData = subjectSeq.data.letters.data;
+
+        u_int32_t queryLen   = querySeq.data.letters.size;
+        u_int32_t subjectLen = subjectSeq.data.letters.size;
+
+        SemiGapAlign     ref (scoreMatrix, 11, 1, 38);
+        SemiGapAlignAVX2 opt (scoreMatrix, 11, 1, 38);
+
+        /** Extensions to be computed as a batch, with the expected results. */
+        vector<ISemiGapAlign::Extension> batch;
+        vector<ISemiGapAlign::Extension> expected;
+
+        for (u_int32_t offsetInQry=0; offsetInQry<queryLen; offsetInQry+=7)
+        {
+            for (u_int32_t offsetInSbj=0; offsetInSbj<subjectLen; offsetInSbj+=5)
+            {
+                u_int32_t q1=0, s1=0, q2=0, s2=0;
+
+                /** Left extension. */
+                int score1 = ref.compute (queryData, subjectData, offsetInQry+1, offsetInSbj+1, &q1, &s1, 1);
+                int score2 = opt.compute (queryData, subjectData, offsetInQry+1, offsetInSbj+1, &q2, &s2, 1);
+
+                CPPUNIT_ASSERT (score1==score2 && q1==q2 && s1==s2);
+
+                ISemiGapAlign::Extension left = { queryData, subjectData, offsetInQry+1, offsetInSbj+1, true, score1, q1, s1 };
+                expected.push_back (left);
+
+                /** Right extension. */
+                score1 = ref.compute (queryData + offsetInQry, subjectData + offsetInSbj, queryLen - offsetInQry - 1, subjectLen - offsetInSbj - 1, &q1, &s1, 0);
+                score2 = opt.compute (queryData + offsetInQry, subjectData + offsetInSbj, queryLen - offsetInQry - 1, subjectLen - offsetInSbj - 1, &q2, &s2, 0);
+
+                CPPUNIT_ASSERT (score1==score2 && q1==q2 && s1==s2);
+
+                ISemiGapAlign::Extension right = { queryData + offsetInQry, subjectData + offsetInSbj, queryLen - offsetInQry - 1, subjectLen - offsetInSbj - 1, false, score1, q1, s1 };
+                expected.push_back (right);
+            }
+        }
+
+        /** We compute all the extensions at once (ie. several extensions in the same registers). */
+        batch = expected;
+        for (size_t i=0; i<batch.size(); i++)  {  batch[i].score = -1;  batch[i].a_offset = batch[i].b_offset = 0;  }
+
+        opt.computeBatch (&batch[0], batch.size());
+
+        for (size_t i=0; i<batch.size(); i++)
+        {
+            CPPUNIT_ASSERT (batch[i].score    == expected[i].score);
+            CPPUNIT_ASSERT (batch[i].a_offset == expected[i].a_offset);
+            CPPUNIT_ASSERT (batch[i].b_offset == expected[i].b_offset);
+        }
+    }
+
     /********************************************************************************/
     /* */
     /********************************************************************************/
@@ -24,6 +24,8 @@
 #include <database/impl/CompositeSequenceDatabase.hpp>
 #include <database/impl/FastaDatabaseQuickReader.hpp>
 #include <database/impl/FastaSequenceOutput.hpp>
+#include <database/impl/FastaSequencePureIterator.hpp>
+#include <database/impl/CachedSubDatabase.hpp>
 
 #include <designpattern/impl/IteratorGet.hpp>
 #include <designpattern/impl/CommandDispatcher.hpp>
@@ -95,6 +97,10 @@ public:
          result->addTest (new TestCaller<TestSequenceDatabase> ("testCompositeDatabase",                &TestSequenceDatabase::testCompositeDatabase ) );
          result->addTest (new TestCaller<TestSequenceDatabase> ("testCompositeDatabase2",                &TestSequenceDatabase::testCompositeDatabase2 ) );
          result->addTest (new TestCaller<TestSequenceDatabase> ("testDatabaseIteratorGet",                &TestSequenceDatabase::testDatabaseIteratorGet ) );
+         result->addTest (new TestCaller<TestSequenceDatabase> ("testPackedResidues",                     &TestSequenceDatabase::testPackedResidues ) );
+         result->addTest (new TestCaller<TestSequenceDatabase> ("testPackedDatabase",                     &TestSequenceDatabase::testPackedDatabase ) );
+         result->addTest (new TestCaller<TestSequenceDatabase> ("testCachedSubDatabaseView",              &TestSequenceDatabase::testCachedSubDatabaseView ) );
+         result->addTest (new TestCaller<TestSequenceDatabase> ("testReadingFrameCaches",                 &TestSequenceDatabase::testReadingFrameCaches ) );
 
     	 return result;
     }
@@ -653,6 +659,229 @@ public:
       }
 #endif
     }
+
+    /********************************************************************************/
+    /*  Pack some residues tables and check that they are decoded correctly.        */
+    /********************************************************************************/
+    void testPackedResidues ()
+    {
+        /** Tables with 4 letters and a few exceptions, 16 letters, 25 letters, and all the letters. */
+        size_t nbLetters[]     = { 4,  16, 25, 256 };
+        size_t expectedBits[]  = { 2,  4,  5,  8   };
+
+        srand (1);
+        for (size_t t=0; t<ARRAYSIZE(nbLetters); t++)
+        {
+            vector<LETTER> data (10000);
+            for (size_t i=0; i<data.size(); i++)  {  data[i] = (LETTER) (rand() % nbLetters[t]);  }
+            if (t==0)  {  for (size_t i=0; i<data.size(); i+=500)  { data[i] = 10; }  }
+
+            PackedResidues packed;
+            packed.pack (&data[0], data.size());
+
+            CPPUNIT_ASSERT (packed.getSize()   == data.size());
+            CPPUNIT_ASSERT (packed.getNbBits() == expectedBits[t]);
+
+            for (size_t i=0; i<data.size(); i++)  {  CPPUNIT_ASSERT (packed.getLetter(i) == data[i]);  }
+
+            /** We decode some ranges. */
+            for (size_t k=0; k<100; k++)
+            {
+                size_t begin = rand() % data.size();
+                size_t end   = begin + rand() % (data.size() - begin + 1);
+
+                vector<LETTER> buffer (end - begin + 1);
+                packed.decode (begin, end, &buffer[0]);
+
+                CPPUNIT_ASSERT (equal (data.begin() + begin, data.begin() + end, buffer.begin()));
+            }
+        }
+    }
+
+    /********************************************************************************/
+    /*  Pack a database and check that we get the same sequences.                   */
+    /********************************************************************************/
+    void testPackedDatabase ()
+    {
+        const char* filename = "/tmp/packed.fa";
+
+        FILE* file = fopen (filename, "w");
+        CPPUNIT_ASSERT (file != 0);
+        srand (1);
+        for (size_t i=0; i<200; i++)
+        {
+            fprintf (file, ">seq%ld\n", i);
+            size_t len = 1 + rand() % 300;
+            for (size_t j=0; j<len; j++)  {  fprintf (file, "%c", rand()%50==0 ? 'N' : "ACGT"[rand()%4]);  }
+            fprintf (file, "\n");
+        }
+        fclose (file);
+
+        BufferedSequenceDatabase* db1 = new BufferedCachedSequenceDatabase (new FastaSequenceIterator (filename, 100), false);
+        LOCAL (db1);
+
+        BufferedSequenceDatabase* db2 = new BufferedCachedSequenceDatabase (new FastaSequenceIterator (filename, 100), false);
+        LOCAL (db2);
+
+        db2->pack ();
+
+        CPPUNIT_ASSERT (db1->getSequencesNumber() == db2->getSequencesNumber());
+        CPPUNIT_ASSERT (db1->getSize()            == db2->getSize());
+
+        /** We check the direct access. */
+        ISequence s1, s2;
+        for (size_t i=0; i<db1->getSequencesNumber(); i++)
+        {
+            CPPUNIT_ASSERT (db1->getSequenceByIndex (i, s1));
+            CPPUNIT_ASSERT (db2->getSequenceByIndex (i, s2));
+            CPPUNIT_ASSERT (s1.data.toString() == s2.data.toString());
+            CPPUNIT_ASSERT (strcmp (s1.comment, s2.comment) == 0);
+        }
+
+        /** The residues decoded into a sequence don't depend on the next requests to the database. */
+        ISequence first;
+        CPPUNIT_ASSERT (db2->getSequenceByIndex (0, first));
+        CPPUNIT_ASSERT (db2->getSequenceByIndex (1, s2));
+        CPPUNIT_ASSERT (db1->getSequenceByIndex (0, s1));
+        CPPUNIT_ASSERT (s1.data.toString() == first.data.toString());
+
+        /** We check the access by offset. */
+        for (u_int64_t offset=0; offset<db1->getSize(); offset+=37)
+        {
+            u_int32_t off1=0, off2=0;  u_int64_t actual1=0, actual2=0;
+            CPPUNIT_ASSERT (db1->getSequenceByOffset (offset, s1, off1, actual1));
+            CPPUNIT_ASSERT (db2->getSequenceByOffset (offset, s2, off2, actual2));
+            CPPUNIT_ASSERT (off1 == off2  &&  actual1 == actual2  &&  s1.index == s2.index);
+            CPPUNIT_ASSERT (s1.data.toString() == s2.data.toString());
+        }
+
+        /** We check the iteration. */
+        ISequenceIterator* it1 = db1->createSequenceIterator();  LOCAL (it1);
+        ISequenceIterator* it2 = db2->createSequenceIterator();  LOCAL (it2);
+        for (it1->first(), it2->first(); !it1->isDone(); it1->next(), it2->next())
+        {
+            CPPUNIT_ASSERT (!it2->isDone());
+            CPPUNIT_ASSERT (it1->currentItem()->data.toString() == it2->currentItem()->data.toString());
+        }
+        CPPUNIT_ASSERT (it2->isDone());
+
+        remove (filename);
+    }
+
+    /********************************************************************************/
+    /*  Create filtered views of a cached database and check their sequences.      */
+    /********************************************************************************/
+    void testCachedSubDatabaseView ()
+    {
+        const char* filename = getPath ("query.fa");
+
+        /** The pure iterator needs the range of the file to be read. */
+        IFile* file = DefaultFactory::file().newFile (filename, "r");
+        u_int64_t fileSize = file->getSize();
+        delete file;
+
+        CachedSubDatabase* db = new CachedSubDatabase (new FastaSequencePureIterator (filename, 1024, 0, fileSize));
+        LOCAL (db);
+
+        /** We blacklist one sequence over two. */
+        std::set<u_int64_t> blacklist;
+        size_t nbSequences = 0;
+        ISequenceIterator* it = db->createSequenceIterator();  LOCAL (it);
+        for (it->first(); !it->isDone(); it->next(), nbSequences++)
+        {
+            if (nbSequences%2 == 0)  {  blacklist.insert (it->currentItem()->offsetInDb);  }
+        }
+        CPPUNIT_ASSERT (nbSequences > 0);
+
+        /** We create two views: the first one is not filtered. */
+        CachedSubDatabase* view1 = new CachedSubDatabase (db, 0);           LOCAL (view1);
+        CachedSubDatabase* view2 = new CachedSubDatabase (db, &blacklist);  LOCAL (view2);
+
+        ISequenceIterator* it0 = db->createSequenceIterator();     LOCAL (it0);
+        ISequenceIterator* it1 = view1->createSequenceIterator();  LOCAL (it1);
+        ISequenceIterator* it2 = view2->createSequenceIterator();  LOCAL (it2);
+
+        size_t i = 0;
+        for (it0->first(), it1->first(), it2->first(); !it0->isDone(); it0->next(), it1->next(), it2->next(), i++)
+        {
+            CPPUNIT_ASSERT (!it1->isDone() && !it2->isDone());
+
+            const ISequence* s0 = it0->currentItem();
+            const ISequence* s1 = it1->currentItem();
+            const ISequence* s2 = it2->currentItem();
+
+            CPPUNIT_ASSERT (s1->database == view1  &&  s2->database == view2);
+            CPPUNIT_ASSERT (s0->offsetInDb == s1->offsetInDb  &&  s0->offsetInDb == s2->offsetInDb);
+            CPPUNIT_ASSERT (s0->data.toString() == s1->data.toString());
+
+            /** Blacklisted sequences have no letters in the filtered view. */
+            if (i%2 == 0)  {  CPPUNIT_ASSERT (s2->data.letters.size == 0);  }
+            else           {  CPPUNIT_ASSERT (s0->data.toString() == s2->data.toString());  }
+        }
+        CPPUNIT_ASSERT (it1->isDone() && it2->isDone());
+    }
+
+    /********************************************************************************/
+    /*  Check that the frames built at once for each strand are the same as the ones
+     *  built one after the other by their own iterator. */
+    /********************************************************************************/
+    void testReadingFrameCaches ()
+    {
+        ISequenceDatabase* database = new BufferedSequenceDatabase (
+            new FastaSequenceIterator (getPath("sapiens_1Mo.fa"), 100),
+            false
+        );
+        LOCAL (database);
+
+        for (int filtering=0; filtering<=1; filtering++)
+        {
+            /** We mix the frames of the two strands; a database other than a frame one is ignored. */
+            int order[] = { FRAME_4, FRAME_1, FRAME_6, FRAME_2, FRAME_5, FRAME_3 };
+
+            list<ISequenceDatabase*> framesAtOnce;
+            vector<ISequenceDatabase*> framesLazy;
+            for (size_t i=0; i<sizeof(order)/sizeof(order[0]); i++)
+            {
+                framesAtOnce.push_back (new ReadingFrameSequenceDatabase ((ReadingFrame_e)order[i], database, filtering));
+                framesLazy.push_back   (new ReadingFrameSequenceDatabase ((ReadingFrame_e)order[i], database, filtering));
+                framesAtOnce.back()->use();
+                framesLazy.back()->use();
+            }
+            framesAtOnce.push_back (database);
+
+            ReadingFrameSequenceDatabase::buildCaches (framesAtOnce);
+
+            framesAtOnce.pop_back ();
+
+            size_t k = 0;
+            for (list<ISequenceDatabase*>::iterator itDb = framesAtOnce.begin(); itDb != framesAtOnce.end(); itDb++, k++)
+            {
+                ISequenceDatabase* db1 = *itDb;
+                ISequenceDatabase* db2 = framesLazy[k];
+
+                CPPUNIT_ASSERT (db1->getSequencesNumber() == db2->getSequencesNumber());
+                CPPUNIT_ASSERT (db1->getSize()            == db2->getSize());
+
+                ISequenceIterator* it1 = db1->createSequenceIterator();  LOCAL (it1);
+                ISequenceIterator* it2 = db2->createSequenceIterator();  LOCAL (it2);
+
+                for (it1->first(), it2->first(); !it1->isDone(); it1->next(), it2->next())
+                {
+                    CPPUNIT_ASSERT (!it2->isDone());
+
+                    const ISequence* s1 = it1->currentItem();
+                    const ISequence* s2 = it2->currentItem();
+
+                    CPPUNIT_ASSERT (s1->data == s2->data);
+                    CPPUNIT_ASSERT (strcmp (s1->comment, s2->comment) == 0);
+                }
+                CPPUNIT_ASSERT (it2->isDone());
+
+                db1->forget();
+                db2->forget();
+            }
+        }
+    }
 };
 
 /********************************************************************************/
@@ -21,8 +21,10 @@
 #include <database/impl/ReadingFrameSequenceIterator.hpp>
 #include <database/impl/FastaSequenceOutput.hpp>
 #include <database/impl/SequenceTokenizer.hpp>
+#include <database/impl/FastaDatabaseQuickReader.hpp>
 
 #include <os/impl/TimeTools.hpp>
+#include <misc/api/macros.hpp>
 
 using namespace std;
 using namespace misc;
@@ -80,11 +82,14 @@ public:
          //result->addTest (new TestCaller<TestSequenceIterator> ("testFastaBigFile",         &TestSequenceIterator::testFastaBigFile ) );
     	 result->addTest (new TestCaller<TestSequenceIterator> ("testStringIterator", 	    &TestSequenceIterator::testStringIterator ) );
          result->addTest (new TestCaller<TestSequenceIterator> ("testReadingFrameIterator", &TestSequenceIterator::testReadingFrameIterator ) );
+         result->addTest (new TestCaller<TestSequenceIterator> ("testReadingFrameTranslation", &TestSequenceIterator::testReadingFrameTranslation ) );
          result->addTest (new TestCaller<TestSequenceIterator> ("testFastaOutput",          &TestSequenceIterator::testFastaOutput ) );
          result->addTest (new TestCaller<TestSequenceIterator> ("testFiltering",            &TestSequenceIterator::testFiltering ) );
          result->addTest (new TestCaller<TestSequenceIterator> ("testFastaOutputFrame",     &TestSequenceIterator::testFastaOutputFrame ) );
          result->addTest (new TestCaller<TestSequenceIterator> ("testSequenceTokenizer",    &TestSequenceIterator::testSequenceTokenizer ) );
          result->addTest (new TestCaller<TestSequenceIterator> ("testFilesList",            &TestSequenceIterator::testFilesList ) );
+         result->addTest (new TestCaller<TestSequenceIterator> ("testFastaMapped",          &TestSequenceIterator::testFastaMapped ) );
+         result->addTest (new TestCaller<TestSequenceIterator> ("testFastaParallelRead",    &TestSequenceIterator::testFastaParallelRead ) );
     	 //result->addTest (new TestCaller<TestSequenceIterator> ("testFastaHugeFile",            &TestSequenceIterator::testFastaHugeFile) );
 
     	 return result;
@@ -304,6 +309,44 @@ public:
         CPPUNIT_ASSERT (seq->data.toString().compare ("RICKDHDLIHST*PL") == 0);
     }
 
+    /********************************************************************************/
+    /********************************************************************************/
+    void testReadingFrameTranslation ()
+    {
+        IAlphabet* alphabet = EncodingManager::singleton().getAlphabet (SUBSEED);
+
+        /** The nucleotides (with an unknown letter) and their complements. */
+        LETTER letters[5]     = { alphabet->letters[CODE_A], alphabet->letters[CODE_C], alphabet->letters[CODE_G], alphabet->letters[CODE_T], alphabet->any };
+        LETTER complements[5] = { alphabet->letters[CODE_T], alphabet->letters[CODE_G], alphabet->letters[CODE_C], alphabet->letters[CODE_A], alphabet->any };
+
+        srand (1234);
+
+        for (size_t size=3; size<1200; size += 1 + size/8)
+        {
+            vector<LETTER> seq (size), revcomp (size);
+            for (size_t i=0; i<size; i++)
+            {
+                size_t k = (rand() % 50 == 0 ? 4 : rand() % 4);
+                seq[i] = letters[k];
+                revcomp[size-1-i] = complements[k];
+            }
+
+            vector<LETTER> scalar (size), vectorized (size), reversed (size);
+
+            /** The vectorized translation (if supported) must match the scalar one, on both strands. */
+            for (int direction=1; direction>=-1; direction-=2)
+            {
+                ReadingFrameSequenceIterator::translateCodons (&seq[0], size, direction, &scalar[0],     false);
+                ReadingFrameSequenceIterator::translateCodons (&seq[0], size, direction, &vectorized[0], true);
+                CPPUNIT_ASSERT (scalar == vectorized);
+            }
+
+            /** The reverse strand is the direct strand of the reverse complement. */
+            ReadingFrameSequenceIterator::translateCodons (&revcomp[0], size,  1, &reversed[0]);
+            CPPUNIT_ASSERT (scalar == reversed);
+        }
+    }
+
     /********************************************************************************/
     /********************************************************************************/
     void testFastaOutput ()
@@ -459,6 +502,142 @@ public:
         CPPUNIT_ASSERT (info1 == info2);
     }
 
+    /********************************************************************************/
+    /********************************************************************************/
+    void testFastaMapped (void)
+    {
+        const char* filename1 = "/tmp/mapped1.fa";
+        const char* filename2 = "/tmp/mapped2.fa";
+
+        /** A long line, longer than the comments max size. */
+        string longLine (3000, 'K');
+
+        /** We create two files with some unusual lines: spaces in comments, DOS end of lines,
+         *  '>' inside data lines, empty sequence, no end of line at the end of the file. */
+        FILE* file = fopen (filename1, "w");
+        CPPUNIT_ASSERT (file != 0);
+        fprintf (file, "\n>  foo 1\nAAAI\nKL>A\n\n>bar\r\nFAAA\r\nMM\r\n>empty\n>long\n%s\nW", longLine.c_str());
+        fclose (file);
+
+        file = fopen (filename2, "w");
+        CPPUNIT_ASSERT (file != 0);
+        fprintf (file, ">dub\nAAAAA\nCC\n");
+        fclose (file);
+
+        const char* comments[] = { "foo 1", "bar", "empty", "long", "dub" };
+        string      data[]     = { "AAAIKLA", "FAAAMM", "", longLine + "W", "AAAAACC" };
+
+        string uri = string(filename1) + "," + string(filename2);
+
+        /** We iterate the whole files. */
+        ISequenceIterator* itSeq = new FastaSequenceIterator (uri.c_str(), 100);
+        LOCAL (itSeq);
+
+        size_t i = 0;
+        for (itSeq->first(); ! itSeq->isDone(); itSeq->next (), i++)
+        {
+            const ISequence* seq = itSeq->currentItem();
+            CPPUNIT_ASSERT (seq != 0  &&  i < 5);
+
+            CPPUNIT_ASSERT (strcmp (seq->comment, comments[i]) == 0);
+            CPPUNIT_ASSERT (seq->data.toString().compare (data[i]) == 0);
+        }
+        CPPUNIT_ASSERT (i == 5);
+
+        /** We iterate the files by blocks computed by the quick reader. */
+        FastaDatabaseQuickReader reader (uri, false);
+        reader.read (10);
+
+        CPPUNIT_ASSERT (reader.getNbSequences() == 5);
+        CPPUNIT_ASSERT (reader.getDataSize()    == 8 + 6 + longLine.size() + 1 + 7);
+
+        vector<u_int64_t>& offsets = reader.getOffsets();
+        CPPUNIT_ASSERT (offsets.size() > 2);
+
+        i = 0;
+        for (size_t k=0; k<offsets.size()-1; k++)
+        {
+            ISequenceIterator* itBlock = new FastaSequenceIterator (uri.c_str(), 100, offsets[k], offsets[k+1]-1);
+            LOCAL (itBlock);
+
+            for (itBlock->first(); ! itBlock->isDone(); itBlock->next (), i++)
+            {
+                const ISequence* seq = itBlock->currentItem();
+                CPPUNIT_ASSERT (seq != 0  &&  i < 5);
+
+                CPPUNIT_ASSERT (strcmp (seq->comment, comments[i]) == 0);
+                CPPUNIT_ASSERT (seq->data.toString().compare (data[i]) == 0);
+            }
+        }
+        CPPUNIT_ASSERT (i == 5);
+
+        remove (filename1);
+        remove (filename2);
+    }
+
+    /********************************************************************************/
+    /********************************************************************************/
+    void testFastaParallelRead (void)
+    {
+        const char* filename1 = "/tmp/parallel1.fa";
+        const char* filename2 = "/tmp/parallel2.fa";
+
+        /** We create two files with sequences of various sizes, some of them with '>' inside the data
+         *  lines, so the ranges bounds may fall anywhere in comments or data lines. */
+        srand (1);
+        const char* filenames[] = { filename1, filename2 };
+        for (size_t f=0; f<2; f++)
+        {
+            FILE* file = fopen (filenames[f], "w");
+            CPPUNIT_ASSERT (file != 0);
+
+            for (size_t i=0; i<500; i++)
+            {
+                fprintf (file, ">seq %ld %ld\n", f, i);
+
+                size_t nbLines = rand() % 5;
+                for (size_t j=0; j<nbLines; j++)
+                {
+                    string line (1 + rand() % 80, "ACDEFGHIKLMNPQRSTVWY" [rand() % 20]);
+                    if (rand()%10 == 0 && line.size() > 2)  { line[line.size()/2] = '>'; }
+                    fprintf (file, "%s%s", line.c_str(), (rand()%10 == 0 ? "\r\n" : "\n"));
+                }
+            }
+            fclose (file);
+        }
+
+        string uri = string(filename1) + "," + string(filename2);
+
+        u_int64_t blockSizes[] = { 0, 1, 100, 1000, 10000 };
+        size_t    nbThreads[]  = { 2, 3, 7, 16 };
+
+        for (size_t b=0; b<ARRAYSIZE(blockSizes); b++)
+        {
+            /** We get the reference with a serial parsing. */
+            FastaDatabaseQuickReader reader1 (uri, true);
+            reader1.setNbThreads (1);
+            reader1.read (blockSizes[b]);
+
+            CPPUNIT_ASSERT (reader1.getNbSequences() == 1000);
+
+            for (size_t t=0; t<ARRAYSIZE(nbThreads); t++)
+            {
+                FastaDatabaseQuickReader reader2 (uri, true);
+                reader2.setNbThreads (nbThreads[t], 100);
+                reader2.read (blockSizes[b]);
+
+                CPPUNIT_ASSERT (reader1.getTotalSize()   == reader2.getTotalSize());
+                CPPUNIT_ASSERT (reader1.getDataSize()    == reader2.getDataSize());
+                CPPUNIT_ASSERT (reader1.getNbSequences() == reader2.getNbSequences());
+                CPPUNIT_ASSERT (reader1.getKind()        == reader2.getKind());
+                CPPUNIT_ASSERT (reader1.getOffsets()     == reader2.getOffsets());
+            }
+        }
+
+        remove (filename1);
+        remove (filename2);
+    }
+
     /********************************************************************************/
     /********************************************************************************/
     void testFilesList (void)
@@ -23,12 +23,20 @@
 
 #include <misc/api/types.hpp>
 
+#include <designpattern/impl/CommandDispatcher.hpp>
+
+extern "C" {
+#include <seg/api/seg.h>
+}
+
 #include <string.h>
 
 using namespace std;
 using namespace misc;
 using namespace database;
 using namespace database::impl;
+using namespace dp;
+using namespace dp::impl;
 
 extern const char* getPath (const char* file);
 
@@ -56,6 +64,7 @@ public:
     	 TestSuite* result = new TestSuite ("PlastTestSequenceMask");
          //result->addTest (new TestCaller<TestSequenceMask> ("test_dustmasker",  &TestSequenceMask::test_dustmasker) );
          result->addTest (new TestCaller<TestSequenceMask> ("test_maskdb",      &TestSequenceMask::test_maskdb) );
+         result->addTest (new TestCaller<TestSequenceMask> ("test_segParallel", &TestSequenceMask::test_segParallel) );
          return result;
     }
 
@@ -117,6 +126,60 @@ public:
         }
 
     }
+
+    /********************************************************************************/
+    struct SegCmd : public ICommand
+    {
+        SegCmd (vector<string>& seqs, size_t idx, size_t nb) : seqs(seqs), idx(idx), nb(nb) {}
+
+        void execute ()
+        {
+            for (size_t i=idx; i<seqs.size(); i+=nb)  {  seg_filterSequence (&seqs[i][0], seqs[i].size());  }
+            seg_releaseContext ();
+        }
+
+        vector<string>& seqs;  size_t idx;  size_t nb;
+    };
+
+    void test_segParallel ()
+    {
+        const char* residues = "ACDEFGHIKLMNPQRSTVWY";
+
+        /** We build sequences with some low complexity regions. */
+        srand (1);
+        vector<string> seqs;
+        for (size_t i=0; i<500; i++)
+        {
+            string seq;
+            size_t nbParts = 1 + rand() % 6;
+            for (size_t j=0; j<nbParts; j++)
+            {
+                size_t len = 5 + rand() % 60;
+                if (rand() % 3 == 0)  {  for (size_t k=0; k<len; k++)  { seq += residues [rand() % 2];  }  }
+                else                  {  for (size_t k=0; k<len; k++)  { seq += residues [rand() % 20]; }  }
+            }
+            seqs.push_back (seq);
+        }
+
+        /** We mask the sequences with a single context. */
+        vector<string> seqs1 (seqs);
+        struct SegContext* context = seg_newContext ();
+        for (size_t i=0; i<seqs1.size(); i++)  {  seg_filterSequenceContext (context, &seqs1[i][0], seqs1[i].size());  }
+        seg_deleteContext (context);
+
+        size_t nbMasked = 0;
+        for (size_t i=0; i<seqs1.size(); i++)  {  if (seqs1[i].find ('X') != string::npos)  { nbMasked++; }  }
+        CPPUNIT_ASSERT (nbMasked > 0);
+
+        /** We mask the sequences with several threads; we must get the same result. */
+        vector<string> seqs2 (seqs);
+        size_t nbThreads = 4;
+        list<ICommand*> commands;
+        for (size_t i=0; i<nbThreads; i++)  {  commands.push_back (new SegCmd (seqs2, i, nbThreads));  }
+        ParallelCommandDispatcher(nbThreads).dispatchCommands (commands);
+
+        CPPUNIT_ASSERT (seqs1 == seqs2);
+    }
 };
 
 /********************************************************************************/
@@ -23,6 +23,8 @@
 
 #include <database/impl/FastaDatabaseQuickReader.hpp>
 
+#include <launcher/core/PlastCmd.hpp>
+
 #define DEBUG(a)  printf a
 #define INFO(a)   printf a
 
@@ -35,6 +37,7 @@ using namespace misc;
 using namespace misc::impl;
 using namespace database;
 using namespace database::impl;
+using namespace launcher::core;
 
 /*********************************************************************
  ** METHOD  :
@@ -52,6 +55,8 @@ int main (int argc, char* argv[])
     parser.add (new OptionOneParam (STR_OPTION_MAX_DATABASE_SIZE,   "block size (default 20000000)", false));
     parser.add (new OptionOneParam (STR_OPTION_OUTPUT_FILE,         "output filename (default bankname + .info)",  false));
     parser.add (new OptionNoParam  (STR_OPTION_INFO_VERBOSE,        "verbose",  false));
+    parser.add (new OptionOneParam (STR_OPTION_INDEX_DIRECTORY,     "directory where the subject index is saved (not built if not set)",  false));
+    parser.add (new OptionOneParam (STR_OPTION_ALGO_TYPE,           "program the subject index is built for (default plastp)",  false));
 
     try {
         /** We parse the provided options. */
@@ -99,6 +104,27 @@ int main (int argc, char* argv[])
             info.accept (&v);
         }
 
+        /** We may want to build the subject index, so that next PLAST executions with the same
+         *  index directory won't need to build it. */
+        if (props.getProperty (STR_OPTION_INDEX_DIRECTORY))
+        {
+            string program = props.getProperty (STR_OPTION_ALGO_TYPE) ?  props.getProperty (STR_OPTION_ALGO_TYPE)->getValue() : "plastp";
+
+            IProperties* plastProps = new Properties ();
+            LOCAL (plastProps);
+
+            plastProps->add (0, STR_OPTION_ALGO_TYPE,             program);
+            plastProps->add (0, STR_OPTION_SUBJECT_URI,           filename);
+            plastProps->add (0, STR_OPTION_QUERY_URI,             filename);
+            plastProps->add (0, STR_OPTION_OUTPUT_FILE,           "/dev/null");
+            plastProps->add (0, STR_OPTION_MAX_DATABASE_SIZE,     "%lld", (long long) maxdatabasesize);
+            plastProps->add (0, STR_OPTION_INDEX_DIRECTORY,       props.getProperty (STR_OPTION_INDEX_DIRECTORY)->getValue());
+            plastProps->add (0, STR_OPTION_INDEX_ONLY,            "");
+
+            PlastCmd cmd (plastProps);
+            cmd.execute();
+        }
+
     }
     catch (OptionFailure& e)
     {